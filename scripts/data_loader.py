@@ -1,17 +1,41 @@
+import importlib.util
 import warnings
-from typing import Optional
+from typing import Iterator, Optional
 
+import numpy as np
 import pandas as pd
 
+from scripts.plot_data import DEFAULT_MAX_EVENT_ROWS, PlotData
+from scripts.trace_reader import TraceReader, is_trace_file
+
+# Column types of the CSV output. Repetitive text columns are read as categoricals, storing each
+# distinct value once (and parsing each distinct timestamp once) instead of one string per row.
+CSV_DTYPES = {
+    'Timestamp': 'category',
+    'Operation': 'category',
+    'Time': 'float64',
+    'Fragmentation': 'float64',
+    'Source': 'category',
+    'CallStack': 'category',
+    'MemoryAddress': 'category',
+    'ThreadID': 'category',
+    'AllocationID': 'category',
+}
+
+# Columns whose conversion errors make a row unusable; summary rows legitimately leave the others empty
+REQUIRED_COLUMNS = ['Timestamp', 'BlockSize', 'Time', 'Fragmentation']
+
+HAS_PYARROW = importlib.util.find_spec('pyarrow') is not None
+
 
 class DataLoader:
     """
-    A class for loading and preprocessing performance data from CSV files.
+    A class for loading and preprocessing performance data from CSV files or binary traces.
 
     Attributes
     ----------
     file_path : str
-        The path to the CSV file containing performance data.
+        The path to the CSV file or .trace file containing performance data.
 
     Methods
     -------
@@ -19,6 +43,10 @@ class DataLoader:
         Loads data from the CSV file into a pandas DataFrame.
     preprocess_data(df: pd.DataFrame) -> pd.DataFrame
         Cleans and preprocesses the DataFrame.
+    iter_chunks(chunk_rows: int) -> Iterator[pd.DataFrame]
+        Yields the input as preprocessed DataFrames of at most chunk_rows rows.
+    load_plot_data(chunk_rows: int, max_event_rows: Optional[int]) -> Optional[PlotData]
+        Loads and preprocesses the input into the aggregates the Visualizer plots.
     """
 
     def __init__(self, file_path: str):
@@ -36,20 +64,29 @@ class DataLoader:
         """
         Loads data from the CSV file into a pandas DataFrame.
 
+        Binary traces (recognised by their magic, whatever the extension) are memory-mapped
+        through TraceReader instead of parsed as text. Compressed CSV files are decompressed by
+        pandas according to their extension (.csv.gz, or .csv.zst with the zstandard package).
+        CSV files are parsed with the pyarrow engine when pyarrow is installed, and with the
+        columns typed by CSV_DTYPES either way.
+
         Returns
         -------
         Optional[pd.DataFrame]
             The loaded DataFrame, or None if an error occurred.
         """
         try:
-            df = pd.read_csv(self.file_path)
+            if is_trace_file(self.file_path):
+                df = TraceReader(self.file_path).to_dataframe()
+            else:
+                df = self._read_csv()
             print(f"Data loaded successfully from {self.file_path}")
             return df
         except FileNotFoundError:
             print(f"Error: File not found at {self.file_path}")
         except pd.errors.EmptyDataError:
             print(f"Error: File at {self.file_path} is empty")
-        except pd.errors.ParserError:
+        except (pd.errors.ParserError, ValueError):
             print(f"Error: File at {self.file_path} could not be parsed")
         except Exception as e:
             print(f"An unexpected error occurred: {e}")
@@ -69,8 +106,91 @@ class DataLoader:
         pd.DataFrame
             The preprocessed DataFrame.
         """
-        # Converts 'Timestamp' to datetime using known formats and suppressing parser warnings
-        if 'Timestamp' in df.columns:
+        df = self._preprocess(df)
+        print("Data preprocessing completed.")
+        return df
+
+    def iter_chunks(self, chunk_rows: int) -> Iterator[pd.DataFrame]:
+        """
+        Yields the input as preprocessed DataFrames of at most chunk_rows rows, in file order.
+
+        Only one chunk is held at a time: CSV files are read incrementally, and traces are sliced
+        from their memory map.
+
+        Parameters
+        ----------
+        chunk_rows : int
+            Rows per chunk; must be positive.
+        """
+        if is_trace_file(self.file_path):
+            reader = TraceReader(self.file_path)
+            for start in range(0, len(reader), chunk_rows):
+                yield self._preprocess(reader.to_dataframe(start, start + chunk_rows))
+            return
+
+        with pd.read_csv(self.file_path, dtype=CSV_DTYPES, chunksize=chunk_rows) as chunks:
+            for chunk in chunks:
+                yield self._preprocess(chunk)
+
+    def load_plot_data(self, chunk_rows: int = 0,
+                       max_event_rows: Optional[int] = DEFAULT_MAX_EVENT_ROWS) -> Optional[PlotData]:
+        """
+        Loads and preprocesses the input into the aggregates the Visualizer plots.
+
+        Parameters
+        ----------
+        chunk_rows : int, default=0
+            Stream the input in chunks of this many rows, keeping a sample of at most
+            max_event_rows event rows; 0 loads the whole input and keeps every row.
+        max_event_rows : Optional[int], default=DEFAULT_MAX_EVENT_ROWS
+            Bound on the event rows kept when streaming, or None for no bound.
+
+        Returns
+        -------
+        Optional[PlotData]
+            The aggregates, or None if an error occurred.
+        """
+        if chunk_rows <= 0:
+            df = self.load_data()
+            return PlotData.from_frame(self.preprocess_data(df)) if df is not None else None
+
+        try:
+            data = PlotData.from_chunks(self.iter_chunks(chunk_rows), max_event_rows)
+            sampled = f", {len(data.events)} kept for per-event plots" if data.sampled else ""
+            print(f"Data streamed from {self.file_path}: {data.event_count} events{sampled}")
+            return data
+        except FileNotFoundError:
+            print(f"Error: File not found at {self.file_path}")
+        except pd.errors.EmptyDataError:
+            print(f"Error: File at {self.file_path} is empty")
+        except (pd.errors.ParserError, ValueError):
+            print(f"Error: File at {self.file_path} could not be parsed")
+        except Exception as e:
+            print(f"An unexpected error occurred: {e}")
+        return None
+
+    def _read_csv(self) -> pd.DataFrame:
+        """
+        Reads the whole CSV file with the fastest engine available, falling back to untyped
+        parsing when a column does not match CSV_DTYPES.
+        """
+        if HAS_PYARROW:
+            try:
+                return pd.read_csv(self.file_path, engine='pyarrow', dtype=CSV_DTYPES)
+            except (ValueError, TypeError):
+                pass
+        try:
+            return pd.read_csv(self.file_path, dtype=CSV_DTYPES)
+        except (ValueError, TypeError):
+            return pd.read_csv(self.file_path)
+
+    def _preprocess(self, df: pd.DataFrame) -> pd.DataFrame:
+        """
+        preprocess_data without the progress message, applied to every chunk when streaming.
+        """
+        # Converts 'Timestamp' to datetime using known formats and suppressing parser warnings;
+        # binary traces already carry datetime64 values
+        if 'Timestamp' in df.columns and not pd.api.types.is_datetime64_any_dtype(df['Timestamp']):
             df['Timestamp'] = self._parse_timestamps(df['Timestamp'])
 
         # Converts 'Operation' to categorical
@@ -91,23 +211,46 @@ class DataLoader:
         df['AllocationID'] = df['AllocationID'].astype(str)
 
         # Handles 'Source' and 'CallStack' columns (ensure they are strings)
-        df['Source'] = df['Source'].astype(str)
-        df['CallStack'] = df['CallStack'].astype(str)
+        df['Source'] = self._as_text(df['Source'])
+        df['CallStack'] = self._as_text(df['CallStack'])
 
-        # Drops rows with any NaN values that resulted from conversion errors
-        df = df.dropna()
+        # Drops rows whose timestamp or numeric fields failed to convert
+        df = df.dropna(subset=[column for column in REQUIRED_COLUMNS if column in df.columns])
 
         # Resets index after dropping rows
         df = df.reset_index(drop=True)
-
-        print("Data preprocessing completed.")
         return df
 
+    @staticmethod
+    def _as_text(series: pd.Series) -> pd.Series:
+        """
+        Converts a column to strings, keeping trace categoricals categorical ('nan' for empty fields).
+        """
+        if isinstance(series.dtype, pd.CategoricalDtype):
+            if series.isna().any():
+                if 'nan' not in series.cat.categories:
+                    series = series.cat.add_categories(['nan'])
+                series = series.fillna('nan')
+            return series
+        return series.astype(str)
+
     @staticmethod
     def _parse_timestamps(series: pd.Series) -> pd.Series:
         """
         Parse timestamp strings using known formats, falling back silently when necessary.
+
+        Categorical columns are parsed once per distinct value.
         """
+        if isinstance(series.dtype, pd.CategoricalDtype):
+            codes = series.cat.codes.to_numpy()
+            values = np.full(len(series), np.datetime64('NaT'), dtype='datetime64[ns]')
+            categories = series.cat.categories
+            if len(categories):
+                parsed_categories = DataLoader._parse_timestamps(pd.Series(categories.astype(str)))
+                present = codes >= 0
+                values[present] = parsed_categories.to_numpy(dtype='datetime64[ns]')[codes[present]]
+            return pd.Series(values, index=series.index)
+
         parsed = pd.Series(pd.NaT, index=series.index, dtype="datetime64[ns]")
         valid_mask = series.notna()
         formats = ("%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M:%S.%f")
@@ -0,0 +1,128 @@
+import struct
+from dataclasses import dataclass
+from typing import List
+
+import numpy as np
+
+# Layout written by src/logger/heap_snapshot_writer.h; both must change together.
+HEAP_MAGIC = b'DMAHEAPS'
+HEAP_VERSION = 1
+FILE_HEADER_FORMAT = '<8sII'
+SNAPSHOT_HEADER_FORMAT = '<qIIBB14x'
+FREE_BIT = 0x80
+
+
+@dataclass
+class HeapSnapshot:
+    """
+    One run-length encoded pool layout, as written by HeapSnapshotWriter.
+
+    Attributes
+    ----------
+    timestamp_ns : int
+        Nanoseconds since 1970-01-01, on the clock of the event logs.
+    min_order, max_order : int
+        The allocator's orders; the pool is 2^max_order bytes of 2^min_order-byte units.
+    orders : np.ndarray
+        Block order of each run.
+    free : np.ndarray
+        Whether each run's blocks are free.
+    blocks : np.ndarray
+        Number of blocks in each run.
+    """
+    timestamp_ns: int
+    min_order: int
+    max_order: int
+    orders: np.ndarray
+    free: np.ndarray
+    blocks: np.ndarray
+
+    def unit_states(self) -> np.ndarray:
+        """
+        Expands the runs into one boolean per minimum-size unit, True where it is allocated.
+        """
+        units = self.blocks.astype(np.int64) << (self.orders.astype(np.int64) - self.min_order)
+        return np.repeat(~self.free, units)
+
+    def occupancy(self, width: int) -> np.ndarray:
+        """
+        Fraction of each of width equal slices of the pool that is allocated.
+
+        Parameters
+        ----------
+        width : int
+            Number of slices; clamped to the number of units, and rounded down to a power of two
+            so slices hold whole units.
+        """
+        units = 1 << (self.max_order - self.min_order)
+        width = 1 << (max(1, min(width, units)).bit_length() - 1)
+        return self.unit_states().reshape(width, units // width).mean(axis=1)
+
+
+def read_heap_snapshots(file_path: str) -> List[HeapSnapshot]:
+    """
+    Reads every snapshot in a .heap file.
+
+    Parameters
+    ----------
+    file_path : str
+        The path to the .heap file.
+
+    Raises
+    ------
+    ValueError
+        If the file is not a heap snapshot file of a supported version.
+    """
+    with open(file_path, 'rb') as heap:
+        data = heap.read()
+
+    header_size = struct.calcsize(FILE_HEADER_FORMAT)
+    if len(data) < header_size:
+        raise ValueError(f"{file_path} is too short to be a heap snapshot file")
+    magic, version, _ = struct.unpack_from(FILE_HEADER_FORMAT, data)
+    if magic != HEAP_MAGIC or version != HEAP_VERSION:
+        raise ValueError(f"{file_path} is not a version {HEAP_VERSION} heap snapshot file")
+
+    snapshots: List[HeapSnapshot] = []
+    offset = header_size
+    record_size = struct.calcsize(SNAPSHOT_HEADER_FORMAT)
+    while offset + record_size <= len(data):
+        timestamp_ns, payload_bytes, run_count, min_order, max_order = struct.unpack_from(
+            SNAPSHOT_HEADER_FORMAT, data, offset)
+        offset += record_size
+        payload = data[offset:offset + payload_bytes]
+        if len(payload) < payload_bytes:
+            break  # Truncated by a writer that did not finish
+        offset += payload_bytes
+
+        states = np.empty(run_count, dtype=np.uint8)
+        blocks = np.empty(run_count, dtype=np.uint64)
+        cursor = 0
+        for run in range(run_count):
+            states[run] = payload[cursor]
+            cursor += 1
+            count, shift = 0, 0
+            while True:
+                byte = payload[cursor]
+                cursor += 1
+                count |= (byte & 0x7F) << shift
+                shift += 7
+                if byte < 0x80:
+                    break
+            blocks[run] = count
+
+        snapshots.append(HeapSnapshot(timestamp_ns=timestamp_ns, min_order=min_order, max_order=max_order,
+                                      orders=states & (FREE_BIT - 1), free=(states & FREE_BIT) != 0,
+                                      blocks=blocks))
+    return snapshots
+
+
+def is_heap_snapshot_file(file_path: str) -> bool:
+    """
+    Returns True if the file starts with the heap snapshot magic.
+    """
+    try:
+        with open(file_path, 'rb') as candidate:
+            return candidate.read(len(HEAP_MAGIC)) == HEAP_MAGIC
+    except OSError:
+        return False
@@ -0,0 +1,263 @@
+from typing import Dict, Iterable, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+
+# Rows written by DataLogger::logSummary rather than per event
+LATENCY_SUMMARY_OPERATIONS = ['AllocationLatency', 'DeallocationLatency']
+SUMMARY_OPERATIONS = ['Summary'] + LATENCY_SUMMARY_OPERATIONS
+
+# Bound on the per-event rows kept when PlotData is built from chunks
+DEFAULT_MAX_EVENT_ROWS = 1_000_000
+
+
+class _StrideSample:
+    """
+    Keeps every stride-th row of a stream, doubling the stride whenever more than limit rows are kept.
+
+    The rows kept are always those whose position in the stream is a multiple of the current
+    stride, so the sample stays evenly spread however long the stream turns out to be.
+    """
+
+    def __init__(self, limit: Optional[int]):
+        self.limit = limit
+        self.stride = 1
+        self.seen = 0
+        self.kept = 0
+        self.parts: List[Tuple[np.ndarray, pd.DataFrame]] = []
+
+    def add(self, frame: pd.DataFrame) -> None:
+        positions = self.seen + np.arange(len(frame))
+        self.seen += len(frame)
+        if self.limit is None:
+            self.parts.append((positions, frame))
+            return
+
+        keep = positions % self.stride == 0
+        self.parts.append((positions[keep], frame[keep]))
+        self.kept += int(keep.sum())
+        while self.kept > self.limit:
+            self.stride *= 2
+            thinned = []
+            for part_positions, part in self.parts:
+                keep = part_positions % self.stride == 0
+                thinned.append((part_positions[keep], part[keep]))
+            self.parts = thinned
+            self.kept = sum(len(part) for _, part in self.parts)
+
+    def frame(self) -> pd.DataFrame:
+        if not self.parts:
+            return pd.DataFrame()
+        if len(self.parts) == 1:
+            return self.parts[0][1].reset_index(drop=True)
+        return pd.concat([part for _, part in self.parts], ignore_index=True)
+
+
+class PlotData:
+    """
+    Everything the Visualizer plots, computed from the events in a single pass.
+
+    Built once per input, so the plots share one split into events and summary rows and one set
+    of aggregates instead of each filtering the full DataFrame again. Counts, sums and the memory
+    usage curve are exact. Per-event rows (events, allocations) are complete when built from a
+    DataFrame; when built from chunks they are an evenly spaced sample of at most max_event_rows
+    rows, so inputs larger than memory can be plotted.
+
+    Attributes
+    ----------
+    events : pd.DataFrame
+        Allocation and deallocation rows in timestamp order (a sample when `sampled`).
+    summary : pd.DataFrame
+        Summary and latency summary rows.
+    memory_usage : pd.DataFrame
+        Timestamp and TotalMemory (bytes allocated minus bytes freed so far) after each event;
+        sampled like events.
+    rates : pd.DataFrame
+        Events per second, one column per operation.
+    allocation_sizes : pd.Series
+        Number of allocations of each block size.
+    by_source : pd.DataFrame
+        Bytes, Count and LatencySum of the allocations of each source.
+    call_stacks : pd.Series
+        Number of allocations of each call stack, most frequent first.
+    event_count : int
+        Allocation and deallocation rows seen, sampled or not.
+    sampled : bool
+        True when events and memory_usage hold fewer rows than event_count.
+
+    Methods
+    -------
+    of(data) -> PlotData
+        Returns data itself if it is a PlotData, or builds one from a DataFrame.
+    from_frame(df: pd.DataFrame) -> PlotData
+        Builds the aggregates of a preprocessed DataFrame, keeping every event row.
+    from_chunks(chunks: Iterable[pd.DataFrame], max_event_rows: Optional[int]) -> PlotData
+        Builds the aggregates chunk by chunk, sampling the event rows.
+    operation_events(operation: str) -> pd.DataFrame
+        Event rows of one operation, indexed by timestamp.
+    """
+
+    def __init__(self, max_event_rows: Optional[int] = None):
+        """
+        Creates empty aggregates; use from_frame or from_chunks.
+
+        Parameters
+        ----------
+        max_event_rows : Optional[int], default=None
+            Bound on the per-event rows kept, or None to keep them all.
+        """
+        self._events = _StrideSample(max_event_rows)
+        self._memory = _StrideSample(max_event_rows)
+        self._memory_total = 0.0
+        self._summary_parts: List[pd.DataFrame] = []
+        self._rate_parts: List[pd.DataFrame] = []
+        self._size_parts: List[pd.Series] = []
+        self._source_parts: List[pd.DataFrame] = []
+        self._call_stack_parts: List[pd.Series] = []
+        self._operation_events: Dict[str, pd.DataFrame] = {}
+        self._allocations: Optional[pd.DataFrame] = None
+
+        self.events = pd.DataFrame()
+        self.summary = pd.DataFrame()
+        self.memory_usage = pd.DataFrame(columns=['Timestamp', 'TotalMemory'])
+        self.rates = pd.DataFrame()
+        self.allocation_sizes = pd.Series(dtype='int64')
+        self.by_source = pd.DataFrame(columns=['Bytes', 'Count', 'LatencySum'])
+        self.call_stacks = pd.Series(dtype='int64')
+        self.event_count = 0
+        self.sampled = False
+
+    @classmethod
+    def of(cls, data) -> 'PlotData':
+        """
+        Returns data if it already is a PlotData, so Visualizer methods accept either form.
+        """
+        return data if isinstance(data, PlotData) else cls.from_frame(data)
+
+    @classmethod
+    def from_frame(cls, df: pd.DataFrame) -> 'PlotData':
+        """
+        Builds the aggregates of a whole preprocessed DataFrame.
+
+        Parameters
+        ----------
+        df : pd.DataFrame
+            A DataFrame returned by DataLoader.preprocess_data.
+        """
+        data = cls(max_event_rows=None)
+        data.add_chunk(df)
+        data.finish()
+        return data
+
+    @classmethod
+    def from_chunks(cls, chunks: Iterable[pd.DataFrame],
+                    max_event_rows: Optional[int] = DEFAULT_MAX_EVENT_ROWS) -> 'PlotData':
+        """
+        Builds the aggregates from preprocessed chunks, holding only one chunk at a time.
+
+        Chunks are taken in file order; each is sorted by timestamp, but rows are not reordered
+        across chunks (the loggers write them in time order).
+
+        Parameters
+        ----------
+        chunks : Iterable[pd.DataFrame]
+            Preprocessed chunks, e.g. from DataLoader.iter_chunks.
+        max_event_rows : Optional[int], default=DEFAULT_MAX_EVENT_ROWS
+            Bound on the per-event rows kept, or None to keep them all.
+        """
+        data = cls(max_event_rows=max_event_rows)
+        for chunk in chunks:
+            data.add_chunk(chunk)
+        data.finish()
+        return data
+
+    def add_chunk(self, df: pd.DataFrame) -> None:
+        """
+        Folds one preprocessed chunk into the aggregates.
+        """
+        summary_mask = df['Operation'].isin(SUMMARY_OPERATIONS).to_numpy()
+        if summary_mask.any():
+            self._summary_parts.append(df[summary_mask])
+        events = df[~summary_mask].sort_values('Timestamp', kind='stable')
+        if events.empty:
+            return
+        self.event_count += len(events)
+        self._events.add(events)
+
+        is_allocation = (events['Operation'] == 'Allocation').to_numpy()
+        sizes = events['BlockSize'].to_numpy(dtype='float64')
+        total = self._memory_total + np.cumsum(np.where(is_allocation, sizes, -sizes))
+        self._memory_total = float(total[-1])
+        self._memory.add(pd.DataFrame({'Timestamp': events['Timestamp'].to_numpy(), 'TotalMemory': total}))
+
+        rates = events.groupby([events['Timestamp'].dt.floor('1s'), 'Operation'], observed=True).size().unstack(
+            fill_value=0)
+        rates.columns = rates.columns.astype(str)
+        self._rate_parts.append(rates)
+
+        allocations = events[is_allocation]
+        if allocations.empty:
+            return
+        self._size_parts.append(allocations['BlockSize'].value_counts())
+        by_source = allocations.groupby('Source', observed=True).agg(
+            Bytes=('BlockSize', 'sum'), Count=('BlockSize', 'size'), LatencySum=('Time', 'sum'))
+        by_source.index = by_source.index.astype(str)
+        self._source_parts.append(by_source)
+        call_stacks = allocations['CallStack'].value_counts()
+        call_stacks = call_stacks[call_stacks > 0]
+        call_stacks.index = call_stacks.index.astype(str)
+        self._call_stack_parts.append(call_stacks)
+
+    def finish(self) -> None:
+        """
+        Combines the per-chunk aggregates; called once after the last add_chunk.
+        """
+        self.events = self._events.frame()
+        self.memory_usage = self._memory.frame()
+        if self.memory_usage.empty:
+            self.memory_usage = pd.DataFrame(columns=['Timestamp', 'TotalMemory'])
+        self.sampled = len(self.events) < self.event_count
+        if self._summary_parts:
+            self.summary = pd.concat(self._summary_parts, ignore_index=True)
+
+        if self._rate_parts:
+            # Seconds without events become zero rows, as pd.Grouper(freq='1s') produces
+            rates = pd.concat(self._rate_parts).fillna(0).groupby(level=0).sum()
+            self.rates = rates.resample('1s').sum().astype('int64')
+        if self._size_parts:
+            self.allocation_sizes = pd.concat(self._size_parts).groupby(level=0).sum().sort_index()
+        if self._source_parts:
+            self.by_source = pd.concat(self._source_parts).groupby(level=0).sum().sort_index()
+        if self._call_stack_parts:
+            self.call_stacks = pd.concat(self._call_stack_parts).groupby(level=0).sum().sort_values(
+                ascending=False, kind='stable')
+
+        self._events = self._memory = None
+        self._summary_parts = self._rate_parts = self._size_parts = []
+        self._source_parts = self._call_stack_parts = []
+
+    @property
+    def allocations(self) -> pd.DataFrame:
+        """
+        Allocation rows of events, selected once.
+        """
+        if self._allocations is None:
+            self._allocations = self.operation_events('Allocation').reset_index()
+        return self._allocations
+
+    def operation_events(self, operation: str) -> pd.DataFrame:
+        """
+        Event rows of one operation in timestamp order, indexed by timestamp; computed once per operation.
+
+        Parameters
+        ----------
+        operation : str
+            'Allocation' or 'Deallocation'.
+        """
+        if operation not in self._operation_events:
+            if 'Operation' in self.events.columns:
+                selected = self.events[(self.events['Operation'] == operation).to_numpy()].set_index('Timestamp')
+            else:
+                selected = pd.DataFrame()
+            self._operation_events[operation] = selected
+        return self._operation_events[operation]
@@ -0,0 +1,158 @@
+import struct
+from typing import List, Optional
+
+import numpy as np
+import pandas as pd
+
+# Layout written by src/logger/trace_writer.h; both must change together.
+TRACE_MAGIC = b'DMATRACE'
+TRACE_VERSION = 1
+HEADER_SIZE = 64
+HEADER_FORMAT = '<8sIIQQ'
+NO_STRING = 0xFFFFFFFF
+
+TRACE_DTYPE = np.dtype([
+    ('timestamp_ns', '<i8'),
+    ('block_size', '<u8'),
+    ('time', '<f8'),
+    ('fragmentation', '<f8'),
+    ('memory_address', '<u8'),
+    ('allocation_id', '<i8'),
+    ('operation', '<u4'),
+    ('source', '<u4'),
+    ('call_stack', '<u4'),
+    ('thread_id', '<u4'),
+])
+
+
+class TraceReader:
+    """
+    Zero-copy reader for the binary traces written by DataLogger with LogFormat::Binary.
+
+    The record block is memory-mapped as a numpy structured array, so opening a trace costs
+    the size of its string table, not of its records; columns are strided views into the map.
+
+    Attributes
+    ----------
+    records : np.memmap
+        One TRACE_DTYPE record per logged row.
+    strings : List[str]
+        Interned string table; the operation, source, call_stack and thread_id fields index it.
+
+    Methods
+    -------
+    column(name: str) -> np.ndarray
+        Returns a zero-copy view of one record field.
+    strings_of(name: str, records: Optional[np.ndarray] = None) -> pd.Categorical
+        Decodes a string-table field into a categorical without copying the strings per row.
+    to_dataframe(start: int = 0, stop: Optional[int] = None) -> pd.DataFrame
+        Builds a DataFrame with the same columns as the CSV output, optionally of a slice of records.
+    """
+
+    def __init__(self, file_path: str):
+        """
+        Opens a trace and maps its records.
+
+        Parameters
+        ----------
+        file_path : str
+            The path to the .trace file.
+
+        Raises
+        ------
+        ValueError
+            If the file is not a trace of a supported version, or was not closed by its writer.
+        """
+        self.file_path = file_path
+        with open(file_path, 'rb') as trace:
+            header = trace.read(HEADER_SIZE)
+            if len(header) < HEADER_SIZE:
+                raise ValueError(f"{file_path} is too short to be a trace")
+            magic, version, record_size, record_count, table_offset = struct.unpack_from(HEADER_FORMAT, header)
+            if magic != TRACE_MAGIC or version != TRACE_VERSION or record_size != TRACE_DTYPE.itemsize:
+                raise ValueError(f"{file_path} is not a version {TRACE_VERSION} allocator trace")
+            if table_offset == 0:
+                raise ValueError(f"{file_path} was not closed by its writer (no string table)")
+
+            trace.seek(table_offset)
+            (count,) = struct.unpack('<I', trace.read(4))
+            self.strings: List[str] = []
+            for _ in range(count):
+                (length,) = struct.unpack('<I', trace.read(4))
+                self.strings.append(trace.read(length).decode('utf-8', errors='replace'))
+
+        if record_count:
+            self.records = np.memmap(file_path, dtype=TRACE_DTYPE, mode='r', offset=HEADER_SIZE,
+                                     shape=(record_count,))
+        else:
+            self.records = np.empty(0, dtype=TRACE_DTYPE)
+
+    def __len__(self) -> int:
+        return len(self.records)
+
+    def column(self, name: str) -> np.ndarray:
+        """
+        Returns a zero-copy view of one record field.
+
+        Parameters
+        ----------
+        name : str
+            A TRACE_DTYPE field name, e.g. 'time' or 'block_size'.
+        """
+        return self.records[name]
+
+    def strings_of(self, name: str, records: Optional[np.ndarray] = None) -> pd.Categorical:
+        """
+        Decodes a string-table field; empty fields (NO_STRING) become NaN.
+
+        Parameters
+        ----------
+        name : str
+            One of 'operation', 'source', 'call_stack' or 'thread_id'.
+        records : Optional[np.ndarray], default=None
+            A slice of records to decode instead of all of them.
+        """
+        ids = (self.records if records is None else records)[name]
+        codes = np.where(ids == NO_STRING, -1, ids).astype(np.int32)
+        return pd.Categorical.from_codes(codes, categories=self.strings, validate=False)
+
+    def to_dataframe(self, start: int = 0, stop: Optional[int] = None) -> pd.DataFrame:
+        """
+        Builds a DataFrame with the CSV column names, so the visualizer accepts either input.
+
+        String columns are categoricals over the string table, with NaN where the field was empty
+        (as pd.read_csv reads an empty CSV field); MemoryAddress and AllocationID stay numeric, and
+        an empty AllocationID is -1.
+
+        Parameters
+        ----------
+        start : int, default=0
+            Index of the first record to include.
+        stop : Optional[int], default=None
+            Index one past the last record to include, or None for the end of the trace. Only
+            the records in [start, stop) are read from the map, so a trace can be read in chunks.
+        """
+        records = self.records[start:stop]
+        return pd.DataFrame({
+            'Timestamp': records['timestamp_ns'].view('datetime64[ns]'),
+            'Operation': self.strings_of('operation', records),
+            'BlockSize': records['block_size'],
+            'Time': records['time'],
+            'Fragmentation': records['fragmentation'],
+            'Source': self.strings_of('source', records),
+            'CallStack': self.strings_of('call_stack', records),
+            'MemoryAddress': records['memory_address'],
+            'ThreadID': self.strings_of('thread_id', records),
+            'AllocationID': records['allocation_id'],
+        })
+
+
+def is_trace_file(file_path: str) -> bool:
+    """
+    Returns True if the file starts with the trace magic.
+    """
+    try:
+        with open(file_path, 'rb') as candidate:
+            return candidate.read(len(TRACE_MAGIC)) == TRACE_MAGIC
+    except OSError:
+        return False
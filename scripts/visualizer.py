@@ -1,10 +1,13 @@
 import pandas as pd
 import matplotlib.pyplot as plt
-from typing import Optional
+from typing import List, Optional, Union
 import numpy as np
 import os
 import warnings
 
+from scripts.heap_snapshot_reader import HeapSnapshot
+from scripts.plot_data import LATENCY_SUMMARY_OPERATIONS, PlotData
+
 # Suppress non-critical warnings (Optional)
 warnings.filterwarnings("ignore", category=FutureWarning)
 warnings.filterwarnings("ignore", category=pd.errors.SettingWithCopyWarning)
@@ -14,6 +17,9 @@ class Visualizer:
     """
     A class for generating visualizations from performance data.
 
+    Every method taking df accepts either a preprocessed DataFrame or a PlotData built from one;
+    pass a PlotData when drawing several plots, so the events are split and aggregated only once.
+
     Methods
     -------
     total_memory_usage_over_time(df: pd.DataFrame, output_path: Optional[str] = None) -> None
@@ -39,6 +45,10 @@ class Visualizer:
         Plots the frequency of allocations from each call stack.
     throughput_trends(df: pd.DataFrame, output_path: Optional[str] = None) -> None
         Plots allocation and deallocation throughput trends over multiple benchmarks.
+    latency_summary_percentiles(df: pd.DataFrame, output_path: Optional[str] = None) -> None
+        Plots the p50/p99/p999 latencies recorded by the allocator's histograms.
+    heap_occupancy_map(snapshots: List[HeapSnapshot], output_path: Optional[str] = None) -> None
+        Renders heap snapshots as an occupancy map of the pool over time.
     """
 
     def __init__(self):
@@ -88,8 +98,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -98,20 +108,19 @@ class Visualizer:
         None
         """
         try:
-            # Exclude summary logs
-            df_sorted = df[df['Operation'] != 'Summary'].sort_values('Timestamp').copy()
-            df_sorted['NetMemoryChange'] = df_sorted.apply(
-                lambda row: row['BlockSize'] if row['Operation'] == 'Allocation' else -row['BlockSize'], axis=1)
-            df_sorted['TotalMemory'] = df_sorted['NetMemoryChange'].cumsum()
+            usage = PlotData.of(df).memory_usage
+            if usage.empty:
+                print("No data available for Total Memory Usage Over Time plot.")
+                return
 
             plt.figure(figsize=(12, 6))
-            plt.plot(df_sorted['Timestamp'], df_sorted['TotalMemory'], linewidth=2)
+            plt.plot(usage['Timestamp'], usage['TotalMemory'], linewidth=2)
             plt.title('Total Memory Usage Over Time', fontsize=14, fontweight='bold')
             plt.xlabel('Timestamp', fontsize=12)
             plt.ylabel('Total Allocated Memory (bytes)', fontsize=12)
 
             # Set x-axis limits based on data
-            self.set_x_limits(plt, df_sorted['Timestamp'])
+            self.set_x_limits(plt, usage['Timestamp'])
 
             plt.tight_layout()
 
@@ -132,8 +141,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         interval : str, default='1s'
             Time interval for grouping (e.g., '1s' for 1 second).
         output_path : Optional[str], default=None
@@ -144,10 +153,10 @@ class Visualizer:
         None
         """
         try:
-            # Exclude summary logs
-            df_temp = df[df['Operation'] != 'Summary'].copy()
-            df_temp.set_index('Timestamp', inplace=True)
-            counts = df_temp.groupby([pd.Grouper(freq=interval.lower()), 'Operation'], observed=False).size().unstack(fill_value=0)
+            # Per-second counts are precomputed; other intervals are resampled from them
+            counts = PlotData.of(df).rates
+            if not counts.empty and interval.lower() != '1s':
+                counts = counts.resample(interval.lower()).sum()
 
             if counts.empty:
                 print("No data available for Allocation/Deallocation Rates Over Time plot.")
@@ -186,8 +195,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -196,15 +205,13 @@ class Visualizer:
         None
         """
         try:
-            # Exclude summary logs
-            df = df[df['Operation'] != 'Summary']
-            if df.empty:
+            events = PlotData.of(df).events
+            if events.empty:
                 print("No data available for Allocation Latency Over Time plot.")
                 return
 
             plt.figure(figsize=(12, 6))
-            for operation in df['Operation'].unique():
-                op_data = df[df['Operation'] == operation]
+            for operation, op_data in events.groupby('Operation', observed=True, sort=False):
                 plt.plot(op_data['Timestamp'], op_data['Time'], 
                         marker='o', label=operation, alpha=0.7, linewidth=1.5)
             plt.title('Allocation/Deallocation Latency Over Time', fontsize=14, fontweight='bold')
@@ -213,7 +220,7 @@ class Visualizer:
             plt.legend(title='Operation', loc='best')
 
             # Set x-axis limits based on data
-            self.set_x_limits(plt, df['Timestamp'])
+            self.set_x_limits(plt, events['Timestamp'])
 
             plt.tight_layout()
 
@@ -234,8 +241,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
         window_size : str, default='10s'
@@ -246,9 +253,8 @@ class Visualizer:
         None
         """
         try:
-            # Exclude summary logs
-            df = df[df['Operation'] != 'Summary'].copy()
-            if df.empty:
+            data = PlotData.of(df)
+            if data.events.empty:
                 print("No data available for Allocation Latency Percentiles plot.")
                 return
 
@@ -256,14 +262,12 @@ class Visualizer:
             fig, axes = plt.subplots(2, 1, figsize=(14, 10))
 
             for idx, operation in enumerate(['Allocation', 'Deallocation']):
-                op_data = df[df['Operation'] == operation].copy()
+                # Already in timestamp order and indexed by it
+                op_data = data.operation_events(operation)
                 if op_data.empty:
                     print(f"No {operation} data available for percentile calculation.")
                     continue
 
-                # Sort by timestamp and set as index
-                op_data = op_data.sort_values('Timestamp').set_index('Timestamp')
-
                 # Calculate rolling percentiles
                 p50 = op_data['Time'].rolling(window=window_size).quantile(0.50)
                 p95 = op_data['Time'].rolling(window=window_size).quantile(0.95)
@@ -300,8 +304,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -310,13 +314,15 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')]
-            if alloc_df.empty:
+            sizes = PlotData.of(df).allocation_sizes
+            if sizes.empty:
                 print("No allocation data available for Allocation Size Distribution plot.")
                 return
 
+            # One weighted value per distinct size draws the same histogram as every allocation
             plt.figure(figsize=(10, 6))
-            plt.hist(alloc_df['BlockSize'], bins=30, edgecolor='black', alpha=0.7)
+            plt.hist(sizes.index.to_numpy(dtype='float64'), bins=30, weights=sizes.to_numpy(), edgecolor='black',
+                     alpha=0.7)
             plt.title('Allocation Size Distribution', fontsize=14, fontweight='bold')
             plt.xlabel('Block Size (bytes)', fontsize=12)
             plt.ylabel('Number of Allocations', fontsize=12)
@@ -338,8 +344,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -348,18 +354,13 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')]
-            if alloc_df.empty:
+            by_source = PlotData.of(df).by_source
+            if by_source.empty:
                 print("No allocation data available for Memory Usage By Source plot.")
                 return
 
-            memory_by_source = alloc_df.groupby('Source')['BlockSize'].sum().reset_index()
-            if memory_by_source.empty:
-                print("No memory usage data available for Memory Usage By Source plot.")
-                return
-
             plt.figure(figsize=(12, 6))
-            plt.bar(memory_by_source['Source'], memory_by_source['BlockSize'], 
+            plt.bar(by_source.index, by_source['Bytes'], 
                    edgecolor='black', alpha=0.7)
             plt.title('Total Memory Usage by Source', fontsize=14, fontweight='bold')
             plt.xlabel('Source', fontsize=12)
@@ -383,8 +384,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -393,16 +394,13 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')]
-            if alloc_df.empty:
+            by_source = PlotData.of(df).by_source
+            if by_source.empty:
                 print("No allocation data available for Number of Allocations By Source plot.")
                 return
 
-            counts_by_source = alloc_df['Source'].value_counts().reset_index()
+            counts_by_source = by_source['Count'].sort_values(ascending=False, kind='stable').reset_index()
             counts_by_source.columns = ['Source', 'AllocationCount']
-            if counts_by_source.empty:
-                print("No allocation count data available for Number of Allocations By Source plot.")
-                return
 
             plt.figure(figsize=(12, 6))
             plt.bar(counts_by_source['Source'], counts_by_source['AllocationCount'],
@@ -429,8 +427,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -439,18 +437,13 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')]
-            if alloc_df.empty:
+            by_source = PlotData.of(df).by_source
+            if by_source.empty:
                 print("No allocation data available for Average Allocation Latency By Source plot.")
                 return
 
-            latency_by_source = alloc_df.groupby('Source')['Time'].mean().reset_index()
-            if latency_by_source.empty:
-                print("No latency data available for Average Allocation Latency By Source plot.")
-                return
-
             plt.figure(figsize=(12, 6))
-            plt.bar(latency_by_source['Source'], latency_by_source['Time'],
+            plt.bar(by_source.index, by_source['LatencySum'] / by_source['Count'],
                    edgecolor='black', alpha=0.7)
             plt.title('Average Allocation Latency by Source', fontsize=14, fontweight='bold')
             plt.xlabel('Source', fontsize=12)
@@ -474,8 +467,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -484,7 +477,7 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')].copy()
+            alloc_df = PlotData.of(df).allocations.copy()
             if alloc_df.empty:
                 print("No allocation data available for Allocation Size Vs Time Heatmap plot.")
                 return
@@ -535,8 +528,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the plot image. If None, the plot is displayed.
 
@@ -545,16 +538,13 @@ class Visualizer:
         None
         """
         try:
-            alloc_df = df[(df['Operation'] == 'Allocation') & (df['Operation'] != 'Summary')]
-            if alloc_df.empty:
+            call_stacks = PlotData.of(df).call_stacks
+            if call_stacks.empty:
                 print("No allocation data available for Call Stack Trace Frequency plot.")
                 return
 
-            callstack_counts = alloc_df['CallStack'].value_counts().reset_index()
+            callstack_counts = call_stacks.reset_index()
             callstack_counts.columns = ['CallStack', 'AllocationCount']
-            if callstack_counts.empty:
-                print("No call stack trace data available for Call Stack Trace Frequency plot.")
-                return
 
             plt.figure(figsize=(12, 6))
             plt.bar(callstack_counts['CallStack'], callstack_counts['AllocationCount'],
@@ -581,8 +571,8 @@ class Visualizer:
 
         Parameters
         ----------
-        df : pd.DataFrame
-            The preprocessed DataFrame containing performance data, including summary logs.
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, including summary logs, or its PlotData.
         output_path : Optional[str], default=None
             The file path to save the throughput trends plot image. If None, the plot is displayed.
 
@@ -592,7 +582,8 @@ class Visualizer:
         """
         try:
             # Filter summary logs
-            summary_df = df[df['Operation'] == 'Summary'].copy()
+            summary = PlotData.of(df).summary
+            summary_df = summary[summary['Operation'] == 'Summary'].copy() if not summary.empty else summary
             if summary_df.empty:
                 print("No summary data available for Throughput Trends plot.")
                 return
@@ -634,4 +625,113 @@ class Visualizer:
                 plt.close()
 
         except Exception as e:
-            print(f"An error occurred while generating the throughput trends plot: {e}")
\ No newline at end of file
+            print(f"An error occurred while generating the throughput trends plot: {e}")
+
+    def latency_summary_percentiles(self, df: pd.DataFrame, output_path: Optional[str] = None) -> None:
+        """
+        Plots the p50, p99 and p999 latencies from the allocator's own histograms.
+
+        Unlike allocation_latency_percentiles, this needs no per-event rows: it reads the
+        AllocationLatency and DeallocationLatency rows logged with each benchmark summary.
+
+        Parameters
+        ----------
+        df : Union[pd.DataFrame, PlotData]
+            The preprocessed DataFrame containing performance data, including summary logs, or its PlotData.
+        output_path : Optional[str], default=None
+            The file path to save the plot image. If None, the plot is displayed.
+
+        Returns
+        -------
+        None
+        """
+        try:
+            summary = PlotData.of(df).summary
+            latency_df = summary[summary['Operation'].isin(LATENCY_SUMMARY_OPERATIONS)].copy() \
+                if not summary.empty else summary
+            if latency_df.empty:
+                print("No latency summary data available for Latency Summary Percentiles plot.")
+                return
+
+            # 'Time' = p50, 'Fragmentation' = p99, 'Source' = p999 (nanoseconds), 'CallStack' = summary description
+            latency_df['p50'] = latency_df['Time']
+            latency_df['p99'] = latency_df['Fragmentation']
+            latency_df['p999'] = pd.to_numeric(latency_df['Source'], errors='coerce')
+            latency_df.sort_values('Timestamp', inplace=True)
+
+            fig, axes = plt.subplots(1, 2, figsize=(14, 6), sharey=True)
+            for idx, operation in enumerate(LATENCY_SUMMARY_OPERATIONS):
+                op_data = latency_df[latency_df['Operation'] == operation]
+                labels = [f"{description}\n{timestamp:%H:%M:%S}"
+                          for description, timestamp in zip(op_data['CallStack'], op_data['Timestamp'])]
+                positions = np.arange(len(op_data))
+                width = 0.27
+                for offset, column in zip((-width, 0.0, width), ('p50', 'p99', 'p999')):
+                    axes[idx].bar(positions + offset, op_data[column], width, label=column)
+                axes[idx].set_xticks(positions)
+                axes[idx].set_xticklabels(labels, rotation=30, ha='right', fontsize=9)
+                axes[idx].set_title(operation.replace('Latency', ' Latency'), fontsize=13, fontweight='bold')
+                axes[idx].set_ylabel('Latency (nanoseconds)', fontsize=11)
+                axes[idx].set_yscale('log')
+                axes[idx].legend(loc='best')
+
+            plt.tight_layout()
+
+            if output_path:
+                plt.savefig(output_path)
+                print(f"Latency summary percentiles plot saved to {os.path.abspath(output_path)}")
+                plt.close()
+            else:
+                plt.show(block=True)
+                plt.close()
+        except Exception as e:
+            print(f"An error occurred while generating the latency summary percentiles plot: {e}")
+
+    def heap_occupancy_map(self, snapshots: List[HeapSnapshot], output_path: Optional[str] = None,
+                           width: int = 1024) -> None:
+        """
+        Renders heap snapshots as an occupancy map: one row per snapshot, pool addresses across.
+
+        Each cell is the allocated fraction of its slice of the pool, so scattered small
+        allocations show as a speckled band and coalesced free space as solid dark runs.
+
+        Parameters
+        ----------
+        snapshots : List[HeapSnapshot]
+            Snapshots read by scripts.heap_snapshot_reader.read_heap_snapshots, in time order.
+        output_path : Optional[str], default=None
+            The file path to save the plot image. If None, the plot is displayed.
+        width : int, default=1024
+            Slices the pool is divided into across the map.
+
+        Returns
+        -------
+        None
+        """
+        try:
+            if not snapshots:
+                print("No heap snapshots available for Heap Occupancy Map plot.")
+                return
+
+            occupancy = np.vstack([snapshot.occupancy(width) for snapshot in snapshots])
+            elapsed = (snapshots[-1].timestamp_ns - snapshots[0].timestamp_ns) / 1e9
+            pool_kib = (1 << snapshots[0].max_order) / 1024
+
+            plt.figure(figsize=(12, 6))
+            plt.imshow(occupancy, aspect='auto', interpolation='nearest', cmap='viridis', vmin=0.0, vmax=1.0,
+                       extent=(0, pool_kib, elapsed, 0))
+            plt.colorbar(label='Fraction allocated')
+            plt.title('Heap Occupancy Over Time', fontsize=14, fontweight='bold')
+            plt.xlabel('Pool offset (KiB)', fontsize=12)
+            plt.ylabel('Seconds since first snapshot', fontsize=12)
+            plt.tight_layout()
+
+            if output_path:
+                plt.savefig(output_path)
+                print(f"Heap occupancy map saved to {os.path.abspath(output_path)}")
+                plt.close()
+            else:
+                plt.show(block=True)
+                plt.close()
+        except Exception as e:
+            print(f"An error occurred while generating the heap occupancy map: {e}")
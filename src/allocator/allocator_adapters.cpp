@@ -0,0 +1,24 @@
+// allocator_adapters.cpp
+#include "allocator_adapters.h"
+
+#if ALLOCATOR_HAS_PMR
+CustomMemoryResource::CustomMemoryResource(CustomAllocator& allocator, size_t minAlignment)
+    : allocator(&allocator), minAlignment(minAlignment) {}
+
+void* CustomMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    void* ptr = allocator->allocate(bytes, std::max(alignment, minAlignment));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void CustomMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    allocator->deallocate(ptr, bytes, std::max(alignment, minAlignment));
+}
+
+bool CustomMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    const CustomMemoryResource* custom = dynamic_cast<const CustomMemoryResource*>(&other);
+    return custom && custom->allocator == allocator && custom->minAlignment == minAlignment;
+}
+#endif
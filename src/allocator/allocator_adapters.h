@@ -0,0 +1,114 @@
+#ifndef ALLOCATOR_ADAPTERS_H
+#define ALLOCATOR_ADAPTERS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "custom_allocator.h"
+
+#if defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #include <memory_resource>
+        #define ALLOCATOR_HAS_PMR 1
+    #endif
+#endif
+#ifndef ALLOCATOR_HAS_PMR
+    #define ALLOCATOR_HAS_PMR 0
+#endif
+
+#if ALLOCATOR_HAS_PMR
+/**
+ * @class CustomMemoryResource
+ * @brief std::pmr::memory_resource backed by a CustomAllocator the caller owns.
+ *
+ * Every allocation is aligned to at least minAlignment (the [allocator] alignment setting) and
+ * to what the caller asks for, and freed through the sized deallocate(). Exhaustion, or an
+ * alignment above CustomAllocator::getPoolAlignment(), throws std::bad_alloc, as
+ * memory_resource requires.
+ * Two resources compare equal when they draw from the same allocator with the same minimum
+ * alignment, so either can free the other's memory.
+ */
+class CustomMemoryResource : public std::pmr::memory_resource {
+   public:
+    explicit CustomMemoryResource(CustomAllocator& allocator,
+                                  size_t minAlignment = CustomAllocator::NATURAL_ALIGNMENT);
+
+    CustomAllocator& getAllocator() const { return *allocator; }
+    size_t getMinAlignment() const { return minAlignment; }
+
+   protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+   private:
+    CustomAllocator* allocator;
+    size_t minAlignment;
+};
+#endif
+
+/**
+ * @class CustomStlAllocator
+ * @brief Allocator (in the standard library's sense) drawing from a CustomAllocator the caller owns.
+ *
+ * Copies, and rebound copies for node-based containers, share the allocator, so a container may
+ * outlive neither. Allocations are aligned to alignof(T) or minAlignment, whichever is larger,
+ * and freed through the sized deallocate().
+ *
+ * @tparam T Element type.
+ */
+template <typename T>
+class CustomStlAllocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit CustomStlAllocator(CustomAllocator& allocator,
+                                size_t minAlignment = CustomAllocator::NATURAL_ALIGNMENT) noexcept
+        : allocator(&allocator), minAlignment(minAlignment) {}
+
+    template <typename U>
+    CustomStlAllocator(const CustomStlAllocator<U>& other) noexcept
+        : allocator(other.allocator), minAlignment(other.minAlignment) {}
+
+    T* allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = allocator->allocate(count * sizeof(T), alignment());
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept { allocator->deallocate(ptr, count * sizeof(T), alignment()); }
+
+    CustomAllocator& getAllocator() const noexcept { return *allocator; }
+    size_t getMinAlignment() const noexcept { return minAlignment; }
+
+    template <typename U>
+    bool operator==(const CustomStlAllocator<U>& other) const noexcept {
+        return allocator == other.allocator && minAlignment == other.minAlignment;
+    }
+
+    template <typename U>
+    bool operator!=(const CustomStlAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+   private:
+    template <typename U>
+    friend class CustomStlAllocator;
+
+    CustomAllocator* allocator;
+    size_t minAlignment;
+
+    size_t alignment() const noexcept { return std::max(alignof(T), minAlignment); }
+};
+
+#endif  // ALLOCATOR_ADAPTERS_H
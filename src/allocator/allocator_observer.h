@@ -0,0 +1,43 @@
+#ifndef ALLOCATOR_OBSERVER_H
+#define ALLOCATOR_OBSERVER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Kind of operation reported to an AllocatorObserver.
+ */
+enum class AllocatorEventType : uint8_t {
+    Allocation,
+    Deallocation,
+};
+
+/**
+ * @struct AllocatorEvent
+ * @brief One allocation or deallocation, as the allocator saw it.
+ */
+struct AllocatorEvent {
+    AllocatorEventType type;
+    void* address;           ///< User pointer
+    size_t size;             ///< Requested bytes; for deallocations the block's usable bytes (requests are not stored)
+    size_t order;            ///< The block spans 2^order bytes including its metadata
+    size_t allocationIndex;  ///< The N of getAllocationID's "AllocN"
+    size_t freeBytes;        ///< Free bytes in the pool just after the operation
+    uint64_t latencyNs;      ///< Duration of the call; batch calls report their average per block
+};
+
+/**
+ * @class AllocatorObserver
+ * @brief Receives an event for every block a CustomAllocator hands out or takes back.
+ *
+ * Installed with CustomAllocator::setObserver. onEvent runs on the thread that made the call,
+ * after the operation and outside the allocator's lock, so it may query the allocator; it must be
+ * thread-safe if several threads share the allocator.
+ */
+class AllocatorObserver {
+   public:
+    virtual ~AllocatorObserver() = default;
+    virtual void onEvent(const AllocatorEvent& event) = 0;
+};
+
+#endif  // ALLOCATOR_OBSERVER_H
@@ -0,0 +1,235 @@
+#ifndef BUDDY_ALLOCATOR_H
+#define BUDDY_ALLOCATOR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "buddy_core.h"
+#include "latency_histogram.h"
+#include "memory_pool.h"
+
+/**
+ * @class BuddyAllocator
+ * @brief Buddy allocator with its block orders fixed at compile time.
+ *
+ * Runs the same BuddyCore split and coalesce code as CustomAllocator's core path, and times
+ * operations the same way (LatencyTimer sampling into LatencyHistograms), but with MinOrder and
+ * MaxOrder as template parameters: the free lists are a std::array, every shift and bound is a
+ * constant, and sizeToOrder folds to a constant for constant request sizes, so the whole hot
+ * path inlines. Comparisons against CustomAllocator therefore measure how the orders are known.
+ *
+ * CustomAllocator remains the runtime-configured variant and the only one offering the thread
+ * cache, lock-free stacks, headerless layout and batch API.
+ *
+ * @tparam MinOrder Order of the smallest block; a block must be able to hold its header.
+ * @tparam MaxOrder Order of the pool.
+ */
+template <size_t MinOrder, size_t MaxOrder>
+class BuddyAllocator {
+    static_assert(MinOrder <= MaxOrder && MaxOrder < 64, "orders must satisfy MinOrder <= MaxOrder < 64");
+
+   public:
+    static constexpr size_t minOrder = MinOrder;
+    static constexpr size_t maxOrder = MaxOrder;
+    static constexpr size_t poolSize = static_cast<size_t>(1) << MaxOrder;
+
+    explicit BuddyAllocator(const PoolOptions& pool = PoolOptions(), const TimingOptions& timing = TimingOptions())
+        : poolMemory(poolSize, pool),
+          memoryPool(static_cast<char*>(poolMemory.data())),
+          freeLists{},
+          freeOrderMask(0),
+          timer(timing),
+          totalFreeMemory(poolSize),
+          allocationCounter(0),
+          totalAllocations(0),
+          totalDeallocations(0) {
+        Block* initialBlock = reinterpret_cast<Block*>(memoryPool);
+        initialBlock->order = static_cast<uint8_t>(MaxOrder);
+        initialBlock->allocationIndex = INVALID_ALLOCATION_ID;
+        Core::pushFreeBlock(*this, initialBlock);
+    }
+
+    BuddyAllocator(const BuddyAllocator&) = delete;
+    BuddyAllocator& operator=(const BuddyAllocator&) = delete;
+
+    /**
+     * @brief Allocates memory of at least the given size.
+     * @param size The minimum size to allocate.
+     * @return Pointer to the allocated memory or nullptr if allocation fails.
+     */
+    void* allocate(size_t size) {
+        if (size > getMaxAllocationSize()) {
+            return nullptr;  // Cannot allocate memory larger than pool
+        }
+        size_t requiredOrder = sizeToOrder(size == 0 ? 1 : size);
+
+        bool timed = timer.sample();
+        std::lock_guard<std::mutex> lock(allocatorMutex);
+        uint64_t startTicks = timed ? timer.now() : 0;
+
+        Block* block = Core::takeBlock(*this, freeOrderMask, requiredOrder);
+        if (!block) {
+            return nullptr;
+        }
+        totalFreeMemory -= static_cast<size_t>(1) << requiredOrder;
+        block->allocationIndex = allocationCounter.fetch_add(1, std::memory_order_relaxed);
+        totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (timed) {
+            allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+        }
+        return reinterpret_cast<char*>(block) + headerSize;
+    }
+
+    /**
+     * @brief Deallocates the memory pointed to by ptr; null and foreign pointers are ignored.
+     */
+    void deallocate(void* ptr) {
+        Block* block = blockFromPointer(ptr);
+        if (!block) {
+            return;
+        }
+
+        bool timed = timer.sample();
+        std::lock_guard<std::mutex> lock(allocatorMutex);
+        uint64_t startTicks = timed ? timer.now() : 0;
+
+        totalFreeMemory += static_cast<size_t>(1) << block->order;
+        Core::releaseBlock(*this, block);
+        totalDeallocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (timed) {
+            deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+        }
+    }
+
+    /**
+     * @brief Maps a request size (header excluded) to the order of the block that holds it.
+     *
+     * The result exceeds MaxOrder if the request cannot be satisfied by the pool.
+     */
+    static constexpr size_t sizeToOrder(size_t size) {
+        size_t order = buddy_detail::ceilLog2(size + headerSize);
+        return order < MinOrder ? MinOrder : order;
+    }
+
+    // Performance metrics, estimated from the sampled operations as CustomAllocator reports them
+    double getAllocationTime() const {
+        return static_cast<double>(getLatencyStats().allocation.totalNanoseconds) * timer.scale() * 1e-9;
+    }
+    double getDeallocationTime() const {
+        return static_cast<double>(getLatencyStats().deallocation.totalNanoseconds) * timer.scale() * 1e-9;
+    }
+    LatencyStats getLatencyStats() const {
+        LatencyStats stats;
+        allocationLatency.addTo(stats.allocation);
+        deallocationLatency.addTo(stats.deallocation);
+        stats.threads = 1;
+        return stats;
+    }
+    double getFragmentation() const {
+        std::lock_guard<std::mutex> lock(allocatorMutex);
+        return static_cast<double>(totalFreeMemory) / poolSize;
+    }
+
+    std::string getAllocationID(void* ptr) {
+        Block* block = blockFromPointer(ptr);
+        if (!block) {
+            return "";
+        }
+        std::lock_guard<std::mutex> lock(allocatorMutex);
+        if (block->allocationIndex == INVALID_ALLOCATION_ID) {
+            return "";
+        }
+        return "Alloc" + std::to_string(block->allocationIndex);
+    }
+
+    std::string getMemoryAddress(void* ptr) {
+        std::ostringstream memAddrStream;
+        memAddrStream << ptr;
+        return memAddrStream.str();
+    }
+
+    size_t getTotalAllocations() const { return totalAllocations.load(std::memory_order_relaxed); }
+    size_t getTotalDeallocations() const { return totalDeallocations.load(std::memory_order_relaxed); }
+
+    // Pool geometry
+    bool owns(const void* ptr) const {
+        const char* ptrChar = static_cast<const char*>(ptr);
+        return ptrChar >= memoryPool && ptrChar < memoryPool + poolSize;
+    }
+    const void* getPoolBase() const { return memoryPool; }
+    static constexpr size_t getPoolSize() { return poolSize; }
+    static constexpr size_t getMaxAllocationSize() { return poolSize - headerSize; }
+
+   private:
+    friend struct BuddyCore<BuddyAllocator>;
+    using Core = BuddyCore<BuddyAllocator>;
+
+    struct alignas(std::max_align_t) Block {
+        Block* next;  // Next free block of the same order (free blocks only)
+        Block* prev;  // Previous free block of the same order (free blocks only)
+        size_t allocationIndex;
+        uint8_t order;
+        bool free;
+    };
+
+    static constexpr size_t headerSize = sizeof(Block);
+    static constexpr size_t INVALID_ALLOCATION_ID = std::numeric_limits<size_t>::max();
+    static_assert((static_cast<size_t>(1) << MinOrder) >= sizeof(Block), "a MinOrder block must hold its header");
+
+    MemoryPool poolMemory;
+    char* memoryPool;  // poolMemory.data(), cached for the hot paths
+
+    std::array<Block*, MaxOrder + 1> freeLists;
+    uint64_t freeOrderMask;  // Bit i is set while freeLists[i] is non-empty
+
+    // Written under allocatorMutex (so recordOwned suffices), read without it
+    LatencyTimer timer;
+    LatencyHistogram allocationLatency;
+    LatencyHistogram deallocationLatency;
+
+    size_t totalFreeMemory;
+    mutable std::mutex allocatorMutex;
+
+    std::atomic<size_t> allocationCounter;
+    std::atomic<size_t> totalAllocations;
+    std::atomic<size_t> totalDeallocations;
+
+    // Block metadata for BuddyCore: always the in-band header
+    size_t orderOf(const Block* block) const { return block->order; }
+    void setOrder(Block* block, size_t order) { block->order = static_cast<uint8_t>(order); }
+    bool isFree(const Block* block) const { return block->free; }
+    void setFree(Block* block, bool free) { block->free = free; }
+    void setAllocationIndex(Block* block, size_t index) { block->allocationIndex = index; }
+
+    // Free-list bookkeeping for BuddyCore
+    void onFreeListPush(size_t order) { freeOrderMask |= static_cast<uint64_t>(1) << order; }
+    void onFreeListRemove(size_t order, bool emptied) {
+        if (emptied) {
+            freeOrderMask &= ~(static_cast<uint64_t>(1) << order);
+        }
+    }
+    Block* popFreeBlock(size_t order) {
+        Block* block = freeLists[order];
+        Core::removeFreeBlock(*this, block);
+        return block;
+    }
+
+    Block* blockFromPointer(void* ptr) const {
+        // As an unsigned offset, a pointer below the pool wraps around and fails the upper bound
+        uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(memoryPool);
+        if (offset < headerSize || offset >= poolSize) {
+            return nullptr;
+        }
+        return reinterpret_cast<Block*>(memoryPool + (offset - headerSize));
+    }
+};
+
+#endif  // BUDDY_ALLOCATOR_H
@@ -0,0 +1,190 @@
+#ifndef BUDDY_CORE_H
+#define BUDDY_CORE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace buddy_detail {
+
+/**
+ * @brief ceil(log2(size)) for size >= 1; usable in constant expressions on GCC and Clang.
+ */
+constexpr size_t ceilLog2(size_t size) {
+    if (size <= 1) {
+        return 0;
+    }
+#if defined(_MSC_VER)
+    size_t order = 0;
+    for (size_t value = size - 1; value != 0; value >>= 1) {
+        ++order;
+    }
+    return order;
+#else
+    return 64 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(size) - 1));
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit; value must be non-zero.
+ */
+inline size_t countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+}
+
+}  // namespace buddy_detail
+
+/**
+ * @struct BuddyCore
+ * @brief The buddy algorithm shared by CustomAllocator and BuddyAllocator: free-list links,
+ *        splitting and coalescing.
+ *
+ * Layout decides where block metadata lives and how the orders are known (runtime members or
+ * template constants), so each allocator keeps its own storage while the algorithm exists once.
+ * Every operation inlines into the caller; with constant orders the shifts and bounds fold.
+ * A Layout befriends BuddyCore<Layout> and provides:
+ *
+ * - `Block`, an intrusive free-list node with `next` and `prev` links;
+ * - `memoryPool` (the pool base), `maxOrder`, `freeLists[order]` (list heads) and
+ *   `INVALID_ALLOCATION_ID`;
+ * - `orderOf`, `setOrder`, `isFree`, `setFree` and `setAllocationIndex` on a block;
+ * - `popFreeBlock(order)`, normally `removeFreeBlock` on the list head;
+ * - `onFreeListPush(order)` and `onFreeListRemove(order, emptied)` for its bookkeeping (the
+ *   non-empty order mask, per-order counts).
+ *
+ * Callers hold the Layout's lock and do their own free-byte accounting.
+ *
+ * @tparam Layout The allocator class.
+ */
+template <typename Layout>
+struct BuddyCore {
+    using Block = typename Layout::Block;
+
+    /// Links a block at the head of the free list for its order and marks it free.
+    static void pushFreeBlock(Layout& layout, Block* block) {
+        size_t order = layout.orderOf(block);
+        Block*& head = layout.freeLists[order];
+        layout.setFree(block, true);
+        block->prev = nullptr;
+        block->next = head;
+        if (head) {
+            head->prev = block;
+        }
+        head = block;
+        layout.onFreeListPush(order);
+    }
+
+    /// Unlinks a block from the free list for its order in constant time.
+    static void removeFreeBlock(Layout& layout, Block* block) {
+        size_t order = layout.orderOf(block);
+        bool emptied = false;
+        if (block->prev) {
+            block->prev->next = block->next;
+        } else {
+            layout.freeLists[order] = block->next;
+            emptied = !block->next;
+        }
+        if (block->next) {
+            block->next->prev = block->prev;
+        }
+        layout.setFree(block, false);
+        block->next = nullptr;
+        block->prev = nullptr;
+        layout.onFreeListRemove(order, emptied);
+    }
+
+    /// The block's buddy at its current order, or nullptr for a whole-pool block.
+    static Block* buddyOf(const Layout& layout, const Block* block) {
+        size_t order = layout.orderOf(block);
+        if (order >= layout.maxOrder) {
+            return nullptr;
+        }
+        char* base = static_cast<char*>(layout.memoryPool);
+        size_t offset = static_cast<size_t>(reinterpret_cast<const char*>(block) - base);
+        return reinterpret_cast<Block*>(base + (offset ^ (static_cast<size_t>(1) << order)));
+    }
+
+    /**
+     * @brief Halves a block down to targetOrder, freeing the upper half at each step.
+     * @param block A block on no free list.
+     * @return The block, now of targetOrder.
+     */
+    static Block* splitBlock(Layout& layout, Block* block, size_t targetOrder) {
+        size_t currentOrder = layout.orderOf(block);
+        while (currentOrder > targetOrder) {
+            --currentOrder;
+            char* upperHalf = reinterpret_cast<char*>(block) + (static_cast<size_t>(1) << currentOrder);
+            Block* buddy = reinterpret_cast<Block*>(upperHalf);
+            layout.setOrder(buddy, currentOrder);
+            layout.setAllocationIndex(buddy, Layout::INVALID_ALLOCATION_ID);
+            pushFreeBlock(layout, buddy);
+            layout.setOrder(block, currentOrder);
+            layout.setAllocationIndex(block, Layout::INVALID_ALLOCATION_ID);
+        }
+        return block;
+    }
+
+    /**
+     * @brief Joins a block with its free buddies for as long as they are whole free blocks.
+     *
+     * A buddy that has been split further reports a smaller order, so it stops the merge.
+     *
+     * @param block A block on no free list.
+     * @param merges Incremented once per buddy pair joined.
+     * @return The merged block, on no free list.
+     */
+    static Block* mergeBlock(Layout& layout, Block* block, uint64_t& merges) {
+        while (Block* buddy = buddyOf(layout, block)) {
+            size_t order = layout.orderOf(block);
+            if (!layout.isFree(buddy) || layout.orderOf(buddy) != order) {
+                break;
+            }
+            removeFreeBlock(layout, buddy);
+            layout.setAllocationIndex(buddy, Layout::INVALID_ALLOCATION_ID);
+            if (buddy < block) {
+                block = buddy;
+            }
+            layout.setOrder(block, order + 1);
+            ++merges;
+        }
+        return block;
+    }
+
+    /**
+     * @brief Removes a block of exactly the given order, splitting the smallest larger one if needed.
+     * @param freeOrderMask Bit i set while freeLists[i] is non-empty.
+     * @return The block, or nullptr if no free block of that order or larger exists.
+     */
+    static Block* takeBlock(Layout& layout, uint64_t freeOrderMask, size_t order) {
+        uint64_t candidates = freeOrderMask & (~static_cast<uint64_t>(0) << order);
+        if (!candidates) {
+            return nullptr;
+        }
+        Block* block = layout.popFreeBlock(buddy_detail::countTrailingZeros(candidates));
+        return splitBlock(layout, block, order);
+    }
+
+    /**
+     * @brief Returns a block to the free lists, coalesced with its free buddies.
+     * @param block A block on no free list.
+     * @return Buddy pairs joined.
+     */
+    static uint64_t releaseBlock(Layout& layout, Block* block) {
+        uint64_t merges = 0;
+        block = mergeBlock(layout, block, merges);
+        layout.setAllocationIndex(block, Layout::INVALID_ALLOCATION_ID);
+        pushFreeBlock(layout, block);
+        return merges;
+    }
+};
+
+#endif  // BUDDY_CORE_H
@@ -2,39 +2,290 @@
 #include "custom_allocator.h"
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
-#include <sstream>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
 #include <thread>
+#include <unordered_set>
 
-CustomAllocator::CustomAllocator(size_t min_order, size_t max_order)
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace {
+
+using buddy_detail::countTrailingZeros;
+
+/**
+ * @brief Returns the number of leading zero bits; value must be non-zero.
+ */
+inline size_t countLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<size_t>(63 - index);
+#else
+    return static_cast<size_t>(__builtin_clzll(value));
+#endif
+}
+
+/// Source of per-instance ids; ids are never reused, so stale thread-local slots cannot alias a new allocator.
+std::atomic<uint64_t> nextInstanceId{1};
+
+/// Allocation indices handed to a thread cache per trip to the shared counter.
+constexpr size_t THREAD_CACHE_INDEX_BATCH = 64;
+
+/**
+ * @brief Registry of live allocators, all of which hand out per-thread state.
+ *
+ * Exiting threads consult it before flushing into an allocator, and allocators unregister
+ * under the same lock before they are destroyed.
+ */
+std::mutex& liveAllocatorMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_set<uint64_t>& liveAllocatorIds() {
+    static std::unordered_set<uint64_t> ids;
+    return ids;
+}
+
+/**
+ * @brief Increments a counter that only the owning thread writes, avoiding a locked RMW.
+ */
+inline void bumpOwnedCounter(std::atomic<size_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+/// Side-table encoding of a block start in the headerless layout: order in the low bits, free flag on top.
+constexpr uint8_t BLOCK_FREE_BIT = 0x80;
+constexpr uint8_t BLOCK_ORDER_MASK = 0x7F;
+
+/// Head words of the lock-free stacks pack an ABA tag above a 32-bit block index.
+constexpr uint64_t STACK_INDEX_MASK = 0xFFFFFFFFull;
+constexpr uint64_t STACK_TAG_STEP = STACK_INDEX_MASK + 1;
+
+}  // namespace
+
+/**
+ * @struct CustomAllocator::ThreadCache
+ * @brief Per-thread state: magazines of ready-to-use blocks, one per cacheable order, and the
+ * thread's latency histograms.
+ *
+ * Every thread that allocates holds one while it lives, even with the thread cache disabled,
+ * in which case the magazines stay empty. Only the holding thread touches the magazines or
+ * records; the counters and histograms are atomics so other threads can aggregate them, but
+ * they are written with plain relaxed stores.
+ */
+struct CustomAllocator::ThreadCache {
+    std::vector<std::vector<Block*>> magazines;
+    bool inUse = false;
+    size_t nextAllocationIndex = 0;
+    size_t allocationIndexLimit = 0;
+
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+    std::atomic<size_t> deallocations{0};
+    std::atomic<size_t> lockFreeHits{0};   // Kept here, not on the stack, to stay off its head's line
+    std::atomic<size_t> lockFreeFrees{0};
+    LatencyHistogram allocationLatency;  // Every path: locked, batch, lock-free and magazine
+    LatencyHistogram deallocationLatency;
+};
+
+/**
+ * @struct CustomAllocator::ThreadCacheSlots
+ * @brief Thread-local table mapping allocator instances to the cache this thread holds.
+ *
+ * On thread exit every cache whose allocator is still alive is flushed back to its pool.
+ */
+struct CustomAllocator::ThreadCacheSlots {
+    struct Slot {
+        uint64_t allocatorId;
+        CustomAllocator* allocator;
+        ThreadCache* cache;
+    };
+    std::vector<Slot> slots;
+
+    ~ThreadCacheSlots() {
+        std::lock_guard<std::mutex> liveLock(liveAllocatorMutex());
+        for (const Slot& slot : slots) {
+            if (liveAllocatorIds().count(slot.allocatorId)) {
+                slot.allocator->releaseThreadCache(*slot.cache);
+            }
+        }
+    }
+};
+
+/**
+ * @struct CustomAllocator::LockFreeStack
+ * @brief Treiber stack of parked blocks of one order.
+ *
+ * Parked blocks are neither in the buddy free lists nor marked free, so the buddy system leaves
+ * them alone until they are popped again or drained. The head holds a tag that changes on every
+ * successful push and pop, so a stale head cannot win a compare-exchange (ABA). Each stack sits
+ * on its own cache line.
+ */
+struct alignas(64) CustomAllocator::LockFreeStack {
+    std::atomic<uint64_t> head{0};  ///< (tag << 32) | block index, index 0 = empty
+    std::atomic<size_t> depth{0};   ///< Blocks currently parked (approximate while pushes race)
+    size_t limit = 0;               ///< Maximum depth; 0 = order not served lock-free
+};
+
+// ============================================================================
+// Block metadata accessors: in-band header, or side tables with options.headerless
+// ============================================================================
+
+inline size_t CustomAllocator::unitOf(const Block* block) const {
+    return static_cast<size_t>(reinterpret_cast<const char*>(block) - static_cast<const char*>(memoryPool)) >>
+           minOrder;
+}
+
+inline size_t CustomAllocator::orderOf(const Block* block) const {
+    if (options.headerless) {
+        return blockStates[unitOf(block)] & BLOCK_ORDER_MASK;
+    }
+    return block->order;
+}
+
+inline void CustomAllocator::setOrder(Block* block, size_t order) {
+    if (options.headerless) {
+        uint8_t& state = blockStates[unitOf(block)];
+        state = static_cast<uint8_t>((state & BLOCK_FREE_BIT) | order);
+    } else {
+        block->order = static_cast<uint8_t>(order);
+    }
+}
+
+inline bool CustomAllocator::isFree(const Block* block) const {
+    if (options.headerless) {
+        return (blockStates[unitOf(block)] & BLOCK_FREE_BIT) != 0;
+    }
+    return block->free;
+}
+
+inline void CustomAllocator::setFree(Block* block, bool free) {
+    if (options.headerless) {
+        uint8_t& state = blockStates[unitOf(block)];
+        state = static_cast<uint8_t>(free ? (state | BLOCK_FREE_BIT) : (state & BLOCK_ORDER_MASK));
+    } else {
+        block->free = free;
+    }
+}
+
+inline size_t CustomAllocator::allocationIndexOf(const Block* block) const {
+    if (options.headerless) {
+        return blockAllocationIndices[unitOf(block)];
+    }
+    return block->allocationIndex;
+}
+
+inline void CustomAllocator::setAllocationIndex(Block* block, size_t index) {
+    if (options.headerless) {
+        blockAllocationIndices[unitOf(block)] = index;
+    } else {
+        block->allocationIndex = index;
+    }
+}
+
+CustomAllocator::CustomAllocator(size_t min_order, size_t max_order, const AllocatorOptions& options)
     : minOrder(min_order),
       maxOrder(max_order),
-      allocationTime(0.0),
-      deallocationTime(0.0),
+      options(options),
+      freeOrderMask(0),
+      timer(options.timing),
       allocationCounter(0),
       totalAllocations(0),
-      totalDeallocations(0) {  // Initializes atomic counters
-    totalSize = static_cast<size_t>(1) << maxOrder;
-    memoryPool = std::malloc(totalSize);
-    if (!memoryPool) {
-        throw std::bad_alloc();
+      totalDeallocations(0),  // Initializes atomic counters
+      inPlaceReallocations(0),
+      hotOrderMask(0),
+      deferredOrderMask(0),
+      fragmentationAfterCoalesce(0.0),
+      mergeCount(0),
+      deferredFreeCount(0),
+      bulkCoalesceCount(0),
+      bulkMergeCount(0),
+      observer(nullptr),
+      instanceId(nextInstanceId.fetch_add(1, std::memory_order_relaxed)),
+      threadCacheMaxOrder(0),
+      lockFreeMaxOrder(0) {
+    if (maxOrder >= 64 || minOrder > maxOrder) {
+        throw std::invalid_argument("CustomAllocator: orders must satisfy min_order <= max_order < 64");
+    }
+    if (this->options.threadCache && this->options.lockFree) {
+        throw std::invalid_argument("CustomAllocator: threadCache and lockFree are mutually exclusive");
+    }
+
+    // Headerless blocks keep only their free-list links in-band, and only while they are free
+    headerSize = this->options.headerless ? 0 : sizeof(Block);
+    if (this->options.headerless) {
+        if (this->options.lockFree || (static_cast<size_t>(1) << minOrder) < 2 * sizeof(Block*)) {
+            throw std::invalid_argument("CustomAllocator: headerless needs min_order >= 4 and excludes lockFree");
+        }
+        // One state byte and one allocation index per minimum-size block replace the in-band header
+        size_t units = static_cast<size_t>(1) << (maxOrder - minOrder);
+        blockStates.assign(units, 0);
+        blockAllocationIndices.assign(units, INVALID_ALLOCATION_ID);
     }
-    totalFreeMemory = totalSize;
+
+    totalSize = static_cast<size_t>(1) << maxOrder;
+    poolMemory = std::make_unique<MemoryPool>(totalSize, this->options.pool);
+    memoryPool = poolMemory->data();
+    uintptr_t baseAddress = reinterpret_cast<uintptr_t>(memoryPool);
+    poolAlignment = std::min<size_t>(baseAddress & (~baseAddress + 1), totalSize);
+    totalFreeMemory.store(totalSize, std::memory_order_relaxed);
 
     // Initialize free lists
-    freeLists.resize(maxOrder + 1);
+    freeLists.assign(maxOrder + 1, nullptr);
+    freeBlockCounts.reset(new std::atomic<size_t>[maxOrder + 1]());
+    deferredBlocks.assign(maxOrder + 1, 0);
 
     // Add the entire memory pool to the largest free list
     Block* initialBlock = reinterpret_cast<Block*>(memoryPool);
-    initialBlock->order = maxOrder;
-    initialBlock->free = true;
-    initialBlock->next = nullptr;
-    initialBlock->allocationIndex = INVALID_ALLOCATION_ID;
-    freeLists[maxOrder].push_back(initialBlock);
+    setOrder(initialBlock, maxOrder);
+    setAllocationIndex(initialBlock, INVALID_ALLOCATION_ID);
+    pushFreeBlock(initialBlock);
+
+    // Only cache orders whose full magazine pair stays within 1/16 of the pool, so a handful of
+    // threads cannot strand most of the memory in their caches.
+    size_t magazinePairBlocks = 2 * this->options.magazineSize;
+    size_t cacheBudget = totalSize / 16;
+    if (this->options.threadCache && magazinePairBlocks > 0 && (magazinePairBlocks << minOrder) <= cacheBudget) {
+        threadCacheMaxOrder = minOrder;
+        while (threadCacheMaxOrder + 1 < maxOrder && (magazinePairBlocks << (threadCacheMaxOrder + 1)) <= cacheBudget) {
+            ++threadCacheMaxOrder;
+        }
+    } else {
+        this->options.threadCache = false;  // Disabled, or the pool is too small for any cacheable order
+    }
+
+    // Lock-free stacks use the same budget per order, and store 32-bit block indices
+    if (this->options.lockFree && this->options.lockFreeDepth > 0 && maxOrder - minOrder < 32) {
+        lockFreeStacks.reset(new LockFreeStack[maxOrder + 1]);
+        for (size_t order = minOrder; order < maxOrder; ++order) {
+            size_t limit = std::min(this->options.lockFreeDepth, cacheBudget >> order);
+            if (limit == 0) {
+                break;
+            }
+            lockFreeStacks[order].limit = limit;
+            lockFreeMaxOrder = order;
+        }
+    }
+    if (!lockFreeStacks || lockFreeStacks[minOrder].limit == 0) {
+        this->options.lockFree = false;
+    }
+
+    std::lock_guard<std::mutex> liveLock(liveAllocatorMutex());
+    liveAllocatorIds().insert(instanceId);
 }
 
 CustomAllocator::~CustomAllocator() {
-    std::free(memoryPool);
+    // Waits for any exiting thread that is flushing into this allocator
+    std::lock_guard<std::mutex> liveLock(liveAllocatorMutex());
+    liveAllocatorIds().erase(instanceId);
 }
 
 /**
@@ -45,243 +296,1044 @@ size_t CustomAllocator::generateAllocationIndex() {
     return allocationCounter.fetch_add(1, std::memory_order_relaxed);
 }
 
-std::string CustomAllocator::getAllocationID(void* ptr) {
-    std::lock_guard<std::mutex> lock(allocatorMutex);
-    if (!ptr)
-        return "";
-
-    // Validate that the pointer is within our memory pool
-    char* ptrChar = reinterpret_cast<char*>(ptr);
-    char* poolStart = reinterpret_cast<char*>(memoryPool);
-    char* poolEnd = poolStart + totalSize;
+size_t CustomAllocator::getAllocationIndex(const void* ptr) const {
+    const Block* block = blockFromPointer(ptr);
+    return block ? allocationIndexOf(block) : INVALID_ALLOCATION_ID;
+}
 
-    if (ptrChar < poolStart || ptrChar >= poolEnd) {
-        return "";  // Invalid pointer
-    }
+size_t CustomAllocator::getBlockOrder(const void* ptr) const {
+    const Block* block = blockFromPointer(ptr);
+    return block ? orderOf(block) : 0;
+}
 
-    Block* block = reinterpret_cast<Block*>(ptrChar - sizeof(Block));
+std::string CustomAllocator::getAllocationID(const void* ptr) const {
+    size_t index = getAllocationIndex(ptr);
+    return index == INVALID_ALLOCATION_ID ? std::string() : "Alloc" + std::to_string(index);
+}
 
-    // Validate that the block is within bounds
-    if (reinterpret_cast<char*>(block) < poolStart || reinterpret_cast<char*>(block) >= poolEnd) {
-        return "";  // Invalid block
+std::string CustomAllocator::getMemoryAddress(const void* ptr) const {
+    // Same text as operator<< and CsvWriter::appendPointer: 0x-prefixed lowercase hex, or 0 for null
+    uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+    if (value == 0) {
+        return "0";
     }
+    char text[2 + 2 * sizeof(uintptr_t)] = {'0', 'x'};
+    char* end = std::to_chars(text + 2, text + sizeof(text), value, 16).ptr;
+    return std::string(text, end);
+}
 
-    if (block->allocationIndex == INVALID_ALLOCATION_ID) {
-        return "";
+/**
+ * @brief Allocates memory of at least the given size.
+ * @param size The minimum size to allocate.
+ * @return Pointer to the allocated memory or nullptr if allocation fails.
+ */
+void* CustomAllocator::allocate(size_t size) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    if (!current) {
+        return allocateUnobserved(size);
     }
 
-    return "Alloc" + std::to_string(block->allocationIndex);
+    uint64_t startTicks = timer.now();
+    void* ptr = allocateUnobserved(size);
+    uint64_t latency = timer.elapsedNanoseconds(startTicks);
+    if (ptr) {
+        notifyObserver(*current, AllocatorEventType::Allocation, ptr, size == 0 ? 1 : size, latency);
+    }
+    return ptr;
 }
 
-std::string CustomAllocator::getMemoryAddress(void* ptr) {
-    std::ostringstream memAddrStream;
-    memAddrStream << ptr;
-    return memAddrStream.str();
+/**
+ * @brief Deallocates the memory pointed to by ptr.
+ * @param ptr Pointer to the memory to deallocate.
+ */
+void CustomAllocator::deallocate(void* ptr) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    Block* block = current && ptr ? blockFromPointer(ptr) : nullptr;
+    if (!block) {
+        deallocateUnobserved(ptr);
+        return;
+    }
+
+    // The block's metadata is gone once it is freed, so the event is filled in first
+    AllocatorEvent event = blockEvent(AllocatorEventType::Deallocation, ptr, block);
+    uint64_t startTicks = timer.now();
+    deallocateUnobserved(ptr);
+    event.latencyNs = timer.elapsedNanoseconds(startTicks);
+    event.freeBytes = freeBytes();
+    current->onEvent(event);
 }
 
 /**
- * @brief Allocates memory of at least the given size.
+ * @brief Allocates memory of at least the given size at the given alignment.
  * @param size The minimum size to allocate.
+ * @param alignment Required alignment; a power of two.
  * @return Pointer to the allocated memory or nullptr if allocation fails.
  */
-void* CustomAllocator::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(allocatorMutex);
-    auto startTime = std::chrono::high_resolution_clock::now();
+void* CustomAllocator::allocate(size_t size, size_t alignment) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    if (!current) {
+        return allocateAlignedUnobserved(size, alignment);
+    }
+
+    uint64_t startTicks = timer.now();
+    void* ptr = allocateAlignedUnobserved(size, alignment);
+    uint64_t latency = timer.elapsedNanoseconds(startTicks);
+    if (ptr) {
+        notifyObserver(*current, AllocatorEventType::Allocation, ptr, size == 0 ? 1 : size, latency);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Deallocates ptr, trusting the size and alignment it was allocated with.
+ * @param ptr Pointer to the memory to deallocate.
+ * @param size The size passed to allocate.
+ * @param alignment The alignment passed to allocate.
+ */
+void CustomAllocator::deallocate(void* ptr, size_t size, size_t alignment) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    if (!current || !ptr) {
+        deallocateSizedUnobserved(ptr, size, alignment);
+        return;
+    }
 
+    Block* block = reinterpret_cast<Block*>(static_cast<char*>(ptr) - alignedOffset(alignment));
+    AllocatorEvent event = blockEvent(AllocatorEventType::Deallocation, ptr, block);
+    uint64_t startTicks = timer.now();
+    deallocateSizedUnobserved(ptr, size, alignment);
+    event.latencyNs = timer.elapsedNanoseconds(startTicks);
+    event.freeBytes = freeBytes();
+    current->onEvent(event);
+}
+
+/**
+ * @brief Resizes the allocation at ptr, in place when its buddies allow.
+ * @param ptr Pointer to the allocation to resize, or nullptr.
+ * @param newSize The new minimum size.
+ * @return Pointer to the resized allocation or nullptr if resizing fails.
+ */
+void* CustomAllocator::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+    Block* block = blockFromPointer(ptr);
+    if (!block || newSize > totalSize) {
+        return nullptr;
+    }
+    if (newSize == 0) {
+        newSize = 1;
+    }
+
+    // Over-aligned pointers sit further into their block; the offset is kept when resizing in place
+    size_t offset = static_cast<size_t>(static_cast<char*>(ptr) - reinterpret_cast<char*>(block));
+    size_t currentOrder = orderOf(block);
+    size_t requiredOrder = sizeToOrder(newSize + offset);
+    if (requiredOrder > maxOrder) {
+        return nullptr;
+    }
+    if (requiredOrder == currentOrder) {
+        return ptr;
+    }
+
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    AllocatorEvent freed{};
+    uint64_t startTicks = 0;
+    if (current) {
+        freed = blockEvent(AllocatorEventType::Deallocation, ptr, block);
+        startTicks = timer.now();
+    }
+    if (resizeInPlace(block, requiredOrder)) {
+        if (current) {
+            freed.latencyNs = timer.elapsedNanoseconds(startTicks);
+            freed.freeBytes = freeBytes();
+            current->onEvent(freed);
+            notifyObserver(*current, AllocatorEventType::Allocation, ptr, newSize, freed.latencyNs);
+        }
+        return ptr;
+    }
+
+    // Only growth can be blocked, so the whole old block's contents fit
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return nullptr;
+    }
+    std::memcpy(moved, ptr, (static_cast<size_t>(1) << currentOrder) - offset);
+    deallocate(ptr);
+    return moved;
+}
+
+void CustomAllocator::setObserver(AllocatorObserver* newObserver) {
+    observer.store(newObserver, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Describes an allocated block; reads only its own metadata, which the caller owns.
+ */
+AllocatorEvent CustomAllocator::blockEvent(AllocatorEventType type, void* ptr, const Block* block) const {
+    AllocatorEvent event;
+    event.type = type;
+    event.address = ptr;
+    event.order = orderOf(block);
+    event.size = (static_cast<size_t>(1) << event.order) - headerSize;
+    event.allocationIndex = allocationIndexOf(block);
+    event.freeBytes = freeBytes();
+    event.latencyNs = 0;
+    return event;
+}
+
+void CustomAllocator::notifyObserver(AllocatorObserver& target, AllocatorEventType type, void* ptr, size_t size,
+                                     uint64_t latencyNs) const {
+    AllocatorEvent event = blockEvent(type, ptr, blockFromPointer(ptr));
+    event.size = size;
+    event.latencyNs = latencyNs;
+    target.onEvent(event);
+}
+
+void* CustomAllocator::allocateUnobserved(size_t size) {
     // Handle zero-size allocation
     if (size == 0) {
         size = 1;  // Allocate at least 1 byte
     }
+    if (size > totalSize) {
+        return nullptr;  // Also keeps size + headerSize from wrapping around
+    }
 
-    size_t requiredOrder = sizeToOrder(size + sizeof(Block));
+    size_t requiredOrder = sizeToOrder(size + headerSize);
     if (requiredOrder > maxOrder) {
         // Cannot allocate memory larger than pool
         return nullptr;
     }
 
-    for (size_t order = requiredOrder; order <= maxOrder; ++order) {
-        if (!freeLists[order].empty()) {
-            Block* block = freeLists[order].front();
-            freeLists[order].pop_front();
+    Block* block = allocateBlock(requiredOrder);
 
-            // Split blocks until we reach the required order
-            while (order > requiredOrder) {
-                block = splitBlock(block, --order);
-                if (!block) {
-                    return nullptr;  // Split failed
-                }
-            }
+    // Returns the memory address after the block metadata
+    return block ? reinterpret_cast<void*>(reinterpret_cast<char*>(block) + headerSize) : nullptr;
+}
 
-            block->free = false;
-            block->next = nullptr;  // Initialize next pointer
-            block->allocationIndex = generateAllocationIndex();
-            totalFreeMemory -= (1 << block->order);
+void CustomAllocator::deallocateUnobserved(void* ptr) {
+    if (!ptr)
+        return;
 
-            totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    Block* block = blockFromPointer(ptr);
+    if (!block) {
+        return;  // Invalid pointer, ignore
+    }
+    deallocateBlock(block, orderOf(block));
+}
 
-            auto endTime = std::chrono::high_resolution_clock::now();
-            recordAllocationTime(std::chrono::duration<double>(endTime - startTime).count());
+void* CustomAllocator::allocateAlignedUnobserved(size_t size, size_t alignment) {
+    if (alignment <= NATURAL_ALIGNMENT) {
+        return allocateUnobserved(size);
+    }
+    if ((alignment & (alignment - 1)) != 0 || alignment > poolAlignment || size > totalSize) {
+        return nullptr;
+    }
 
-            // Returns the memory address after the block metadata
-            return reinterpret_cast<void*>(reinterpret_cast<char*>(block) + sizeof(Block));
+    size_t requiredOrder = alignedOrder(size, alignment);
+    if (requiredOrder > maxOrder) {
+        return nullptr;
+    }
+    Block* block = allocateBlock(requiredOrder);
+    if (!block) {
+        return nullptr;
+    }
+
+    size_t offset = alignedOffset(alignment);
+    char* ptr = reinterpret_cast<char*>(block) + offset;
+    if (offset != headerSize) {
+        // Header layout: point the header slot in front of ptr back at the block
+        Block* forward = reinterpret_cast<Block*>(ptr - headerSize);
+        forward->order = FORWARDED_ORDER;
+        forward->next = block;
+    }
+    return ptr;
+}
+
+void CustomAllocator::deallocateSizedUnobserved(void* ptr, size_t size, size_t alignment) {
+    if (!ptr) {
+        return;
+    }
+    Block* block = reinterpret_cast<Block*>(static_cast<char*>(ptr) - alignedOffset(alignment));
+    deallocateBlock(block, alignedOrder(size, alignment));
+}
+
+/**
+ * @brief Bytes between a block and the user pointer of an allocation with the given alignment.
+ *
+ * Over-aligned pointers in the header layout leave room for the real header and, right in front
+ * of the pointer, a forwarding header, so the two never overlap.
+ */
+size_t CustomAllocator::alignedOffset(size_t alignment) const {
+    if (options.headerless || alignment <= NATURAL_ALIGNMENT) {
+        return headerSize;
+    }
+    return (2 * headerSize + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Order of the block allocate(size, alignment) uses; matches allocate(size) up to NATURAL_ALIGNMENT.
+ */
+size_t CustomAllocator::alignedOrder(size_t size, size_t alignment) const {
+    size_t order = sizeToOrder((size == 0 ? 1 : size) + alignedOffset(alignment));
+    return alignment > NATURAL_ALIGNMENT ? std::max(order, countTrailingZeros(alignment)) : order;
+}
+
+/**
+ * @brief Hands out a block of exactly the given order through the configured fast paths.
+ * @return The block, with a fresh allocation index, or nullptr if the pool is exhausted.
+ */
+CustomAllocator::Block* CustomAllocator::allocateBlock(size_t requiredOrder) {
+    if (options.threadCache && requiredOrder <= threadCacheMaxOrder) {
+        return allocateFromThreadCache(requiredOrder);
+    }
+
+    ThreadCache* timing = sampleLatency();
+
+    if (options.lockFree && requiredOrder <= lockFreeMaxOrder) {
+        ThreadCache& cache = timing ? *timing : localThreadCache();
+        uint64_t startTicks = timing ? timer.now() : 0;
+        Block* block = popLockFree(requiredOrder);
+        if (block) {
+            setAllocationIndex(block, generateAllocationIndex());
+            bumpOwnedCounter(cache.lockFreeHits);
+            if (timing) {
+                timing->allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+            }
+            return block;
         }
+        // Empty stack: fall through to the locked path, which may split
     }
 
-    // No suitable block found
-    return nullptr;
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    uint64_t startTicks = timing ? timer.now() : 0;
+
+    if (options.deferredCoalescing) {
+        if (needsCoalesceFor(requiredOrder)) {
+            coalesceDeferred(countTrailingZeros(deferredOrderMask));
+        }
+        hotOrderMask |= static_cast<uint64_t>(1) << requiredOrder;
+    }
+    Block* block = takeBlock(requiredOrder);
+    if (!block && options.lockFree) {
+        // Parked blocks cannot coalesce; return them to the buddy lists and retry once
+        drainLockFreeStacks();
+        block = takeBlock(requiredOrder);
+    }
+    if (!block && options.deferredCoalescing) {
+        // Deferred blocks taken by aligned or in-place paths leave no trace in the counts, so
+        // pair every order before giving up
+        coalesceDeferred(minOrder);
+        block = takeBlock(requiredOrder);
+    }
+    if (!block) {
+        // No suitable block found
+        return nullptr;
+    }
+    setAllocationIndex(block, generateAllocationIndex());
+
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (timing) {
+        timing->allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+    return block;
 }
 
 /**
- * @brief Deallocates the memory pointed to by ptr.
- * @param ptr Pointer to the memory to deallocate.
+ * @brief Returns an allocated block of the given order through the configured fast paths.
  */
-void CustomAllocator::deallocate(void* ptr) {
-    if (!ptr)
+void CustomAllocator::deallocateBlock(Block* block, size_t order) {
+    if (options.threadCache && order <= threadCacheMaxOrder) {
+        deallocateToThreadCache(block, order);
         return;
+    }
 
-    std::lock_guard<std::mutex> lock(allocatorMutex);
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    // Validate that the pointer is within our memory pool
-    char* ptrChar = reinterpret_cast<char*>(ptr);
-    char* poolStart = reinterpret_cast<char*>(memoryPool);
-    char* poolEnd = poolStart + totalSize;
+    ThreadCache* timing = sampleLatency();
 
-    if (ptrChar < poolStart || ptrChar >= poolEnd) {
-        return;  // Invalid pointer, ignore
+    if (options.lockFree && order <= lockFreeMaxOrder) {
+        ThreadCache& cache = timing ? *timing : localThreadCache();
+        uint64_t startTicks = timing ? timer.now() : 0;
+        setAllocationIndex(block, INVALID_ALLOCATION_ID);
+        if (pushLockFree(block)) {
+            bumpOwnedCounter(cache.lockFreeFrees);
+            if (timing) {
+                timing->deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+            }
+            return;
+        }
+        // Stack full: merge through the locked path instead
     }
 
-    Block* block = reinterpret_cast<Block*>(ptrChar - sizeof(Block));
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    uint64_t startTicks = timing ? timer.now() : 0;
 
-    block->free = true;
-    block->next = nullptr;  // Initialize next pointer
-    block->allocationIndex = INVALID_ALLOCATION_ID;
-    totalFreeMemory += (1 << block->order);
+    setAllocationIndex(block, INVALID_ALLOCATION_ID);
+    if (!options.deferredCoalescing || !deferBlock(block, order)) {
+        releaseBlock(block);
+    }
 
     totalDeallocations.fetch_add(1, std::memory_order_relaxed);
 
-    // Merge with buddy blocks if possible
-    Block* mergedBlock = mergeBlock(block);
-    if (mergedBlock) {
-        mergedBlock->next = nullptr;  // Initialize next pointer
-        mergedBlock->allocationIndex = INVALID_ALLOCATION_ID;
-        freeLists[mergedBlock->order].push_back(mergedBlock);
+    if (timing) {
+        timing->deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
     }
-
-    auto endTime = std::chrono::high_resolution_clock::now();
-    recordDeallocationTime(std::chrono::duration<double>(endTime - startTime).count());
 }
 
-size_t CustomAllocator::sizeToOrder(size_t size) const {
-    size_t order = minOrder;
-    size_t blockSize = 1 << order;
-    while (blockSize < size && order < maxOrder) {
-        ++order;
-        blockSize <<= 1;
+size_t CustomAllocator::allocateBatch(size_t size, size_t count, void** out) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    if (!current) {
+        return allocateBatchUnobserved(size, count, out);
+    }
+
+    uint64_t startTicks = timer.now();
+    size_t produced = allocateBatchUnobserved(size, count, out);
+    if (produced > 0) {
+        uint64_t latency = timer.elapsedNanoseconds(startTicks) / produced;
+        for (size_t i = 0; i < produced; ++i) {
+            notifyObserver(*current, AllocatorEventType::Allocation, out[i], size == 0 ? 1 : size, latency);
+        }
     }
-    return order;
+    return produced;
 }
 
-CustomAllocator::Block* CustomAllocator::splitBlock(CustomAllocator::Block* block, size_t targetOrder) {
-    if (!block) {
-        return nullptr;
+void CustomAllocator::deallocateBatch(void** ptrs, size_t count) {
+    AllocatorObserver* current = observer.load(std::memory_order_relaxed);
+    if (!current || !ptrs || count == 0) {
+        deallocateBatchUnobserved(ptrs, count);
+        return;
     }
 
-    size_t currentOrder = block->order;
-    while (currentOrder > targetOrder) {
-        currentOrder--;
-        size_t size = 1 << currentOrder;
-        Block* buddy = reinterpret_cast<Block*>(reinterpret_cast<char*>(block) + size);
+    // The batch is reordered and its metadata released, so the events are filled in first
+    thread_local std::vector<AllocatorEvent> events;
+    events.clear();
+    for (size_t i = 0; i < count; ++i) {
+        Block* block = ptrs[i] ? blockFromPointer(ptrs[i]) : nullptr;
+        if (block) {
+            events.push_back(blockEvent(AllocatorEventType::Deallocation, ptrs[i], block));
+        }
+    }
 
-        // Initialize the new buddy block metadata
-        buddy->order = currentOrder;
-        buddy->free = true;
-        buddy->next = nullptr;
-        buddy->allocationIndex = INVALID_ALLOCATION_ID;
-        freeLists[currentOrder].push_back(buddy);
-        block->order = currentOrder;
-        block->allocationIndex = INVALID_ALLOCATION_ID;
+    uint64_t startTicks = timer.now();
+    deallocateBatchUnobserved(ptrs, count);
+    uint64_t latency = events.empty() ? 0 : timer.elapsedNanoseconds(startTicks) / events.size();
+    size_t available = freeBytes();
+    for (AllocatorEvent& event : events) {
+        event.latencyNs = latency;
+        event.freeBytes = available;
+        current->onEvent(event);
     }
-    return block;
 }
 
-CustomAllocator::Block* CustomAllocator::mergeBlock(CustomAllocator::Block* block) {
-    if (!block) {
-        return nullptr;
+size_t CustomAllocator::allocateBatchUnobserved(size_t size, size_t count, void** out) {
+    if (count == 0 || !out) {
+        return 0;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > totalSize) {
+        return 0;
     }
 
-    size_t currentOrder = block->order;
-    while (currentOrder < maxOrder) {
-        Block* buddy = getBuddy(block);
-        if (!buddy) {
-            break;
+    size_t requiredOrder = sizeToOrder(size + headerSize);
+    if (requiredOrder > maxOrder) {
+        return 0;
+    }
+
+    ThreadCache* timing = sampleLatency();
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    uint64_t startTicks = timing ? timer.now() : 0;
+
+    // One trip to the shared counter for the whole batch; indices of a short batch are skipped
+    size_t firstIndex = allocationCounter.fetch_add(count, std::memory_order_relaxed);
+
+    if (options.deferredCoalescing) {
+        if (needsCoalesceFor(requiredOrder)) {
+            coalesceDeferred(countTrailingZeros(deferredOrderMask));
+        }
+        hotOrderMask |= static_cast<uint64_t>(1) << requiredOrder;
+    }
+
+    size_t produced = 0;
+    bool drained = false;
+    bool coalesced = !options.deferredCoalescing;
+    while (produced < count) {
+        uint64_t candidates =
+            freeOrderMask.load(std::memory_order_relaxed) & (~static_cast<uint64_t>(0) << requiredOrder);
+        if (!candidates && options.lockFree && !drained) {
+            drainLockFreeStacks();
+            drained = true;
+            continue;
+        }
+        if (!candidates && !coalesced) {
+            coalesceDeferred(minOrder);
+            coalesced = true;
+            continue;
         }
+        if (!candidates) {
+            break;  // Pool exhausted
+        }
+        Block* block = popFreeBlock(countTrailingZeros(candidates));
+        produced += carveBlock(block, requiredOrder, count - produced, firstIndex + produced, out + produced);
+    }
 
-        auto& buddyList = freeLists[currentOrder];
+    totalAllocations.fetch_add(produced, std::memory_order_relaxed);
 
-        auto it = std::find(buddyList.begin(), buddyList.end(), buddy);
-        if (it != buddyList.end() && buddy->free) {
-            // Remove buddy from free list
-            buddyList.erase(it);
-            buddy->allocationIndex = INVALID_ALLOCATION_ID;
-            if (buddy > block) {
-                block->order++;
-            } else {
-                block = buddy;
-                block->order++;
+    if (timing) {
+        timing->allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+    return produced;
+}
+
+void CustomAllocator::deallocateBatchUnobserved(void** ptrs, size_t count) {
+    if (!ptrs || count == 0) {
+        return;
+    }
+
+    // The blocks still belong to the caller, so sorting them needs no lock
+    std::sort(ptrs, ptrs + count, std::less<void*>());
+
+    // Merging them does: the sweep rewrites block orders, which snapshotHeap() walks over every
+    // block, allocated or not, and which the headerless layout keeps in the shared state table
+    ThreadCache* timing = sampleLatency();
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    uint64_t startTicks = timing ? timer.now() : 0;
+
+    // Sweep in address order, using ptrs as a stack of pending blocks; whenever the top two are
+    // buddies of the same order they are replaced by their parent.
+    size_t pending = 0;
+    size_t released = 0;
+    uint64_t merged = 0;
+    void* previous = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        void* ptr = ptrs[i];
+        Block* block = ptr && ptr != previous ? blockFromPointer(ptr) : nullptr;
+        previous = ptr;
+        if (!block) {
+            continue;  // Null, foreign or repeated pointer
+        }
+        setAllocationIndex(block, INVALID_ALLOCATION_ID);
+        ++released;
+
+        while (pending > 0) {
+            Block* lower = static_cast<Block*>(ptrs[pending - 1]);
+            size_t order = orderOf(lower);
+            size_t offset = static_cast<size_t>(reinterpret_cast<char*>(lower) - reinterpret_cast<char*>(memoryPool));
+            bool isLowerBuddy = (offset & (static_cast<size_t>(1) << order)) == 0;
+            if (order >= maxOrder || order != orderOf(block) || !isLowerBuddy ||
+                reinterpret_cast<char*>(lower) + (static_cast<size_t>(1) << order) != reinterpret_cast<char*>(block)) {
+                break;
             }
-            currentOrder++;
-        } else {
-            break;
+            --pending;
+            setOrder(lower, orderOf(lower) + 1);
+            block = lower;
+            ++merged;
         }
+        ptrs[pending++] = block;
+    }
+
+    mergeCount.store(mergeCount.load(std::memory_order_relaxed) + merged, std::memory_order_relaxed);
+    for (size_t i = 0; i < pending; ++i) {
+        releaseBlock(static_cast<Block*>(ptrs[i]));
+    }
+    totalDeallocations.fetch_add(released, std::memory_order_relaxed);
+
+    if (timing) {
+        timing->deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+}
+
+/**
+ * @brief Maps a user pointer back to its block header.
+ * @return The block, or nullptr if the pointer does not belong to this pool.
+ */
+CustomAllocator::Block* CustomAllocator::blockFromPointer(const void* ptr) const {
+    char* ptrChar = const_cast<char*>(static_cast<const char*>(ptr));
+    char* poolStart = reinterpret_cast<char*>(memoryPool);
+    char* poolEnd = poolStart + totalSize;
+
+    if (ptrChar < poolStart + headerSize || ptrChar >= poolEnd) {
+        return nullptr;
+    }
+    Block* block = reinterpret_cast<Block*>(ptrChar - headerSize);
+    if (!options.headerless && block->order == FORWARDED_ORDER) {
+        block = block->next;  // Over-aligned pointer: the slot in front of it forwards to the block
     }
     return block;
 }
 
-CustomAllocator::Block* CustomAllocator::getBuddy(CustomAllocator::Block* block) {
+/**
+ * @brief Removes a block of exactly the given order from the pool, splitting a larger one if needed.
+ *
+ * Caller must hold allocatorMutex.
+ *
+ * @param order The order of block to produce.
+ * @return The block, or nullptr if no free block of that order or larger exists.
+ */
+CustomAllocator::Block* CustomAllocator::takeBlock(size_t order) {
+    Block* block = Core::takeBlock(*this, freeOrderMask.load(std::memory_order_relaxed), order);
     if (!block) {
         return nullptr;
     }
 
-    size_t size = 1 << block->order;
-    uintptr_t offset = reinterpret_cast<char*>(block) - reinterpret_cast<char*>(memoryPool);
-    uintptr_t buddyOffset = offset ^ size;
+    size_t blockSize = static_cast<size_t>(1) << order;
+    totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) - blockSize, std::memory_order_relaxed);
+    return block;
+}
+
+/**
+ * @brief Splits a block taken off the free lists into up to count siblings of the given order.
+ *
+ * Siblings are carved from the low end of the block. The rest is pushed back as the largest
+ * self-aligned blocks that cover it, which are exactly the buddies repeated splitting leaves.
+ * Caller must hold allocatorMutex.
+ *
+ * @return Number of siblings written to out.
+ */
+size_t CustomAllocator::carveBlock(CustomAllocator::Block* block, size_t order, size_t count, size_t firstIndex,
+                                   void** out) {
+    size_t blockSize = static_cast<size_t>(1) << orderOf(block);
+    size_t siblingSize = static_cast<size_t>(1) << order;
+    size_t siblings = std::min(count, blockSize / siblingSize);
+    char* base = reinterpret_cast<char*>(block);
 
-    // Validate buddy offset is within bounds
-    if (buddyOffset >= totalSize) {
-        return nullptr;
+    for (size_t i = 0; i < siblings; ++i) {
+        Block* sibling = reinterpret_cast<Block*>(base + i * siblingSize);
+        setOrder(sibling, order);
+        setFree(sibling, false);
+        setAllocationIndex(sibling, firstIndex + i);
+        out[i] = reinterpret_cast<void*>(reinterpret_cast<char*>(sibling) + headerSize);
     }
 
-    Block* buddy = reinterpret_cast<Block*>(reinterpret_cast<char*>(memoryPool) + buddyOffset);
-    return buddy;
+    // The offset is a multiple of siblingSize and below blockSize, so each tail block is a
+    // valid buddy of an order between order and the carved block's order.
+    for (size_t offset = siblings * siblingSize; offset < blockSize;) {
+        Block* tail = reinterpret_cast<Block*>(base + offset);
+        setOrder(tail, countTrailingZeros(offset));
+        setAllocationIndex(tail, INVALID_ALLOCATION_ID);
+        pushFreeBlock(tail);
+        offset += static_cast<size_t>(1) << orderOf(tail);
+    }
+
+    size_t carvedSize = siblings * siblingSize;
+    totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) - carvedSize, std::memory_order_relaxed);
+    return siblings;
 }
 
-void CustomAllocator::recordAllocationTime(double time) {
-    allocationTime += time;
+/**
+ * @brief Returns a block to the pool, coalescing it with free buddies.
+ *
+ * Caller must hold allocatorMutex.
+ *
+ * @param block The block being released; it must not be on any free list.
+ */
+void CustomAllocator::releaseBlock(CustomAllocator::Block* block) {
+    size_t blockSize = static_cast<size_t>(1) << orderOf(block);
+    totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) + blockSize, std::memory_order_relaxed);
+
+    uint64_t merged = Core::releaseBlock(*this, block);
+    if (merged) {
+        mergeCount.store(mergeCount.load(std::memory_order_relaxed) + merged, std::memory_order_relaxed);
+    }
 }
 
-void CustomAllocator::recordDeallocationTime(double time) {
-    deallocationTime += time;
+/**
+ * @brief Frees a block without merging it, if the deferred coalescing policy allows.
+ *
+ * Only orders allocated since the last bulk pass are deferred, and at most deferredWatermark
+ * blocks of each. Caller must hold allocatorMutex.
+ *
+ * @return Whether the block was freed; if not, the caller releases it as usual.
+ */
+bool CustomAllocator::deferBlock(CustomAllocator::Block* block, size_t order) {
+    uint64_t bit = static_cast<uint64_t>(1) << order;
+    if (order >= maxOrder || !(hotOrderMask & bit) || deferredBlocks[order] >= options.deferredWatermark) {
+        return false;
+    }
+
+    size_t blockSize = static_cast<size_t>(1) << order;
+    totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) + blockSize, std::memory_order_relaxed);
+    pushFreeBlock(block);
+    ++deferredBlocks[order];
+    deferredOrderMask |= bit;
+    deferredFreeCount.store(deferredFreeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    double fragmentation = getExternalFragmentation();
+    if (fragmentation > options.coalesceThreshold && fragmentation > fragmentationAfterCoalesce) {
+        coalesceDeferred(countTrailingZeros(deferredOrderMask));
+    }
+    return true;
+}
+
+/**
+ * @brief Whether deferred blocks below order might merge into the block a request of that order
+ * needs: the order's own list is empty, so the request would otherwise split a larger block (or fail).
+ */
+bool CustomAllocator::needsCoalesceFor(size_t order) const {
+    uint64_t bit = static_cast<uint64_t>(1) << order;
+    return (deferredOrderMask & (bit - 1)) != 0 && (freeOrderMask.load(std::memory_order_relaxed) & bit) == 0;
+}
+
+/**
+ * @brief Merges every free block with a free buddy, from fromOrder up.
+ *
+ * Eager merging leaves no two free buddies, so only the deferred blocks and the blocks they
+ * merge into can pair up; merged blocks land on the next order's list and are paired there in
+ * turn. Costs one pass over the free lists from fromOrder, normally the lowest deferred order.
+ * Caller must hold allocatorMutex.
+ */
+void CustomAllocator::coalesceDeferred(size_t fromOrder) {
+    uint64_t merged = 0;
+    for (size_t order = fromOrder; order < maxOrder; ++order) {
+        Block* block = freeLists[order];
+        while (block) {
+            Block* next = block->next;
+            Block* buddy = getBuddy(block);
+            if (buddy && isFree(buddy) && orderOf(buddy) == order) {
+                if (buddy == next) {
+                    next = next->next;
+                }
+                removeFreeBlock(block);
+                removeFreeBlock(buddy);
+                Block* lower = std::min(block, buddy);
+                setOrder(lower, order + 1);
+                setAllocationIndex(lower, INVALID_ALLOCATION_ID);
+                pushFreeBlock(lower);
+                ++merged;
+            }
+            block = next;
+        }
+    }
+
+    std::fill(deferredBlocks.begin(), deferredBlocks.end(), 0);
+    deferredOrderMask = 0;
+    hotOrderMask = 0;
+    fragmentationAfterCoalesce = getExternalFragmentation();
+    mergeCount.store(mergeCount.load(std::memory_order_relaxed) + merged, std::memory_order_relaxed);
+    bulkMergeCount.store(bulkMergeCount.load(std::memory_order_relaxed) + merged, std::memory_order_relaxed);
+    bulkCoalesceCount.store(bulkCoalesceCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Maps a request size (header included) to the smallest order that can hold it.
+ *
+ * Uses ceil(log2(size)) via a leading-zero count, clamped below at minOrder. The result may
+ * exceed maxOrder, in which case the request cannot be satisfied by the pool.
+ */
+size_t CustomAllocator::sizeToOrder(size_t size) const {
+    size_t order = size > 1 ? 64 - countLeadingZeros(static_cast<uint64_t>(size) - 1) : 0;
+    return std::max(order, minOrder);
+}
+
+void CustomAllocator::pushFreeBlock(CustomAllocator::Block* block) {
+    Core::pushFreeBlock(*this, block);
+}
+
+void CustomAllocator::removeFreeBlock(CustomAllocator::Block* block) {
+    Core::removeFreeBlock(*this, block);
+}
+
+/**
+ * @brief Free-list bookkeeping for BuddyCore: the non-empty order mask and per-order counts,
+ * which getStats() reads without the lock.
+ */
+inline void CustomAllocator::onFreeListPush(size_t order) {
+    freeOrderMask.store(freeOrderMask.load(std::memory_order_relaxed) | (static_cast<uint64_t>(1) << order),
+                        std::memory_order_relaxed);
+    freeBlockCounts[order].store(freeBlockCounts[order].load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+}
+
+inline void CustomAllocator::onFreeListRemove(size_t order, bool emptied) {
+    if (emptied) {
+        freeOrderMask.store(freeOrderMask.load(std::memory_order_relaxed) & ~(static_cast<uint64_t>(1) << order),
+                            std::memory_order_relaxed);
+    }
+    freeBlockCounts[order].store(freeBlockCounts[order].load(std::memory_order_relaxed) - 1,
+                                 std::memory_order_relaxed);
 }
 
+/**
+ * @brief Removes and returns the head of the free list for the given order.
+ * @param order The order to take a block from.
+ * @return The removed block, or nullptr if the list is empty.
+ */
+CustomAllocator::Block* CustomAllocator::popFreeBlock(size_t order) {
+    Block* block = freeLists[order];
+    if (block) {
+        removeFreeBlock(block);
+        // Deferred blocks sit at the head of their list, so this is most likely one of them
+        uint64_t bit = static_cast<uint64_t>(1) << order;
+        if ((deferredOrderMask & bit) && --deferredBlocks[order] == 0) {
+            deferredOrderMask &= ~bit;
+        }
+    }
+    return block;
+}
+
+CustomAllocator::Block* CustomAllocator::getBuddy(CustomAllocator::Block* block) {
+    return Core::buddyOf(*this, block);
+}
+
+/**
+ * @brief Changes the order of an allocated block without moving its start.
+ *
+ * Growing requires the block to be the lower buddy at every order up to the target, with each
+ * upper buddy (the one getBuddy would return at that order) a whole free block; all are checked
+ * before any is taken, so a refused growth changes nothing. Shrinking frees the upper half at each
+ * order on the way down; those halves' buddies are the block itself, so nothing can coalesce.
+ *
+ * @param block An allocated block owned by the caller.
+ * @param order The order it should have.
+ * @return Whether the block now has that order.
+ */
+bool CustomAllocator::resizeInPlace(CustomAllocator::Block* block, size_t order) {
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    size_t currentOrder = orderOf(block);
+    char* base = reinterpret_cast<char*>(block);
+    size_t offset = static_cast<size_t>(base - reinterpret_cast<char*>(memoryPool));
+    size_t currentSize = static_cast<size_t>(1) << currentOrder;
+    size_t targetSize = static_cast<size_t>(1) << order;
+
+    if (order > currentOrder) {
+        for (size_t step = currentOrder; step < order; ++step) {
+            size_t half = static_cast<size_t>(1) << step;
+            Block* buddy = reinterpret_cast<Block*>(base + half);
+            if ((offset & half) != 0 || !isFree(buddy) || orderOf(buddy) != step) {
+                return false;
+            }
+        }
+        for (size_t step = currentOrder; step < order; ++step) {
+            Block* buddy = reinterpret_cast<Block*>(base + (static_cast<size_t>(1) << step));
+            removeFreeBlock(buddy);
+            setAllocationIndex(buddy, INVALID_ALLOCATION_ID);
+        }
+        totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) - (targetSize - currentSize),
+                              std::memory_order_relaxed);
+    } else {
+        for (size_t step = currentOrder; step-- > order;) {
+            Block* upper = reinterpret_cast<Block*>(base + (static_cast<size_t>(1) << step));
+            setOrder(upper, step);
+            setAllocationIndex(upper, INVALID_ALLOCATION_ID);
+            pushFreeBlock(upper);
+        }
+        totalFreeMemory.store(totalFreeMemory.load(std::memory_order_relaxed) + (currentSize - targetSize),
+                              std::memory_order_relaxed);
+    }
+    setOrder(block, order);
+    inPlaceReallocations.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Estimated total allocation time in seconds: the sampled time scaled by the sample rate.
+ */
 double CustomAllocator::getAllocationTime() const {
-    return allocationTime;
+    return static_cast<double>(getAllocationLatency().totalNanoseconds) * timer.scale() * 1e-9;
 }
 
 double CustomAllocator::getDeallocationTime() const {
-    return deallocationTime;
+    return static_cast<double>(getDeallocationLatency().totalNanoseconds) * timer.scale() * 1e-9;
+}
+
+LatencySnapshot CustomAllocator::getAllocationLatency() const {
+    return getLatencyStats().allocation;
+}
+
+LatencySnapshot CustomAllocator::getDeallocationLatency() const {
+    return getLatencyStats().deallocation;
+}
+
+/**
+ * @brief Merges the per-thread histograms of every thread that has used this allocator.
+ *
+ * Threads keep recording while the merge runs, so the result may include part of an operation's
+ * counters, but nothing is ever lost or counted twice across later calls.
+ */
+LatencyStats CustomAllocator::getLatencyStats() const {
+    LatencyStats stats;
+    std::lock_guard<std::mutex> cacheLock(threadCacheMutex);
+    for (const auto& cache : threadCaches) {
+        cache->allocationLatency.addTo(stats.allocation);
+        cache->deallocationLatency.addTo(stats.deallocation);
+    }
+    stats.threads = threadCaches.size();
+    return stats;
 }
 
+/**
+ * @brief Free fraction of the pool; blocks parked on the lock-free stacks count as free.
+ */
 double CustomAllocator::getFragmentation() const {
-    return static_cast<double>(totalFreeMemory) / totalSize;
+    return static_cast<double>(freeBytes()) / totalSize;
+}
+
+size_t CustomAllocator::freeBytes() const {
+    size_t freeMemory = totalFreeMemory.load(std::memory_order_relaxed);
+    if (options.lockFree) {
+        for (size_t order = minOrder; order <= lockFreeMaxOrder; ++order) {
+            freeMemory += lockFreeStacks[order].depth.load(std::memory_order_relaxed) << order;
+        }
+    }
+    return freeMemory;
+}
+
+/**
+ * @brief Order of the largest free block, listed or parked on a lock-free stack; 0 when none is free.
+ */
+size_t CustomAllocator::largestFreeOrder() const {
+    uint64_t listed = freeOrderMask.load(std::memory_order_relaxed);
+    size_t largest = listed ? 63 - countLeadingZeros(listed) : 0;
+    if (options.lockFree) {
+        // Parked blocks only matter when they are larger than every listed one
+        for (size_t order = std::max(largest + 1, minOrder); order <= lockFreeMaxOrder; ++order) {
+            if (lockFreeStacks[order].depth.load(std::memory_order_relaxed) > 0) {
+                largest = order;
+            }
+        }
+    }
+    return largest;
+}
+
+AllocatorStats CustomAllocator::getStats() const {
+    AllocatorStats stats;
+    stats.totalBytes = totalSize;
+    for (size_t order = minOrder; order <= maxOrder; ++order) {
+        stats.freeBlocks[order] = freeBlockCounts[order].load(std::memory_order_relaxed);
+    }
+    if (options.lockFree) {
+        for (size_t order = minOrder; order <= lockFreeMaxOrder; ++order) {
+            stats.freeBlocks[order] += lockFreeStacks[order].depth.load(std::memory_order_relaxed);
+        }
+    }
+    stats.freeBytes = freeBytes();
+    stats.largestFreeOrder = stats.freeBytes ? largestFreeOrder() : 0;
+    return stats;
+}
+
+double CustomAllocator::getExternalFragmentation() const {
+    size_t free = freeBytes();
+    size_t largest = static_cast<size_t>(1) << largestFreeOrder();
+    // A concurrent snapshot can briefly see the largest block without all of the free bytes
+    return largest < free ? 1.0 - static_cast<double>(largest) / static_cast<double>(free) : 0.0;
+}
+
+void CustomAllocator::snapshotHeap(HeapSnapshot& snapshot) {
+    snapshot.minOrder = minOrder;
+    snapshot.maxOrder = maxOrder;
+    snapshot.runs.clear();
+
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    char* base = static_cast<char*>(memoryPool);
+    for (size_t offset = 0; offset < totalSize;) {
+        const Block* block = reinterpret_cast<const Block*>(base + offset);
+        uint8_t order = static_cast<uint8_t>(orderOf(block));
+        bool free = isFree(block);
+        if (!snapshot.runs.empty() && snapshot.runs.back().order == order && snapshot.runs.back().free == free) {
+            ++snapshot.runs.back().blocks;
+        } else {
+            snapshot.runs.push_back({order, free, 1});
+        }
+        offset += static_cast<size_t>(1) << order;
+    }
+}
+
+OperationTotals CustomAllocator::getTotals() const {
+    ThreadCounters counters = sumThreadCounters();
+    OperationTotals totals;
+    totals.allocations =
+        totalAllocations.load(std::memory_order_relaxed) + counters.hits + counters.misses + counters.lockFreeHits;
+    totals.deallocations =
+        totalDeallocations.load(std::memory_order_relaxed) + counters.deallocations + counters.lockFreeFrees;
+    return totals;
 }
 
 size_t CustomAllocator::getTotalAllocations() const {
-    return totalAllocations.load(std::memory_order_relaxed);
+    return getTotals().allocations;
 }
 
 size_t CustomAllocator::getTotalDeallocations() const {
-    return totalDeallocations.load(std::memory_order_relaxed);
+    return getTotals().deallocations;
+}
+
+/**
+ * @brief Checks whether a pointer lies inside this allocator's memory pool.
+ */
+bool CustomAllocator::owns(const void* ptr) const {
+    const char* ptrChar = static_cast<const char*>(ptr);
+    const char* poolStart = static_cast<const char*>(memoryPool);
+    return ptrChar >= poolStart && ptrChar < poolStart + totalSize;
+}
+
+const void* CustomAllocator::getPoolBase() const {
+    return memoryPool;
+}
+
+size_t CustomAllocator::getPoolAlignment() const {
+    return poolAlignment;
+}
+
+size_t CustomAllocator::getPoolSize() const {
+    return totalSize;
+}
+
+CoalescingStats CustomAllocator::getCoalescingStats() const {
+    CoalescingStats stats;
+    stats.merges = mergeCount.load(std::memory_order_relaxed);
+    stats.deferredFrees = deferredFreeCount.load(std::memory_order_relaxed);
+    stats.bulkCoalesces = bulkCoalesceCount.load(std::memory_order_relaxed);
+    stats.bulkMerges = bulkMergeCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t CustomAllocator::getMinOrder() const {
+    return minOrder;
+}
+
+size_t CustomAllocator::getMaxOrder() const {
+    return maxOrder;
+}
+
+size_t CustomAllocator::getMaxAllocationSize() const {
+    return totalSize - headerSize;
+}
+
+size_t CustomAllocator::getThreadCacheHits() const {
+    return sumThreadCounters().hits;
+}
+
+size_t CustomAllocator::getThreadCacheMisses() const {
+    return sumThreadCounters().misses;
+}
+
+size_t CustomAllocator::getInPlaceReallocations() const {
+    return inPlaceReallocations.load(std::memory_order_relaxed);
+}
+
+size_t CustomAllocator::getLockFreeHits() const {
+    return sumThreadCounters().lockFreeHits;
+}
+
+/**
+ * @brief Adds up the counters of every thread's state in a single pass under threadCacheMutex.
+ *
+ * The totals getters each take the lock once however many of the counters they combine.
+ */
+CustomAllocator::ThreadCounters CustomAllocator::sumThreadCounters() const {
+    ThreadCounters counters;
+    std::lock_guard<std::mutex> cacheLock(threadCacheMutex);
+    for (const auto& cache : threadCaches) {
+        counters.hits += cache->hits.load(std::memory_order_relaxed);
+        counters.misses += cache->misses.load(std::memory_order_relaxed);
+        counters.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+        counters.lockFreeHits += cache->lockFreeHits.load(std::memory_order_relaxed);
+        counters.lockFreeFrees += cache->lockFreeFrees.load(std::memory_order_relaxed);
+    }
+    return counters;
+}
+
+LockContention CustomAllocator::getLockContention() const {
+    return allocatorMutex.contention();
 }
 
 bool CustomAllocator::isValidBlock(Block* block) const {
@@ -299,12 +1351,12 @@ bool CustomAllocator::isValidBlock(Block* block) const {
     }
 
     // Check if block order is valid
-    if (block->order < minOrder || block->order > maxOrder) {
+    if (orderOf(block) < minOrder || orderOf(block) > maxOrder) {
         return false;
     }
 
     // Check if block size is valid (must be power of 2)
-    size_t blockSize = 1 << block->order;
+    size_t blockSize = static_cast<size_t>(1) << orderOf(block);
     if (blockSize == 0) {
         return false;
     }
@@ -316,3 +1368,252 @@ bool CustomAllocator::isValidBlock(Block* block) const {
 
     return true;
 }
+
+// ============================================================================
+// Thread cache (magazine) layer
+// ============================================================================
+
+CustomAllocator::ThreadCacheSlots& CustomAllocator::localThreadCacheSlots() {
+    thread_local ThreadCacheSlots slots;
+    return slots;
+}
+
+/**
+ * @brief Finds or claims the calling thread's cache for this allocator.
+ *
+ * The common case is a linear probe of a one- or two-entry thread-local table. The first call
+ * from a thread claims a cache released by an exited thread, or creates a new one.
+ */
+CustomAllocator::ThreadCache& CustomAllocator::localThreadCache() {
+    ThreadCacheSlots& local = localThreadCacheSlots();
+    for (const auto& slot : local.slots) {
+        if (slot.allocatorId == instanceId) {
+            return *slot.cache;
+        }
+    }
+
+    // Drop slots left behind by allocators that have since been destroyed
+    {
+        std::lock_guard<std::mutex> liveLock(liveAllocatorMutex());
+        const auto& live = liveAllocatorIds();
+        local.slots.erase(std::remove_if(local.slots.begin(), local.slots.end(),
+                                         [&live](const ThreadCacheSlots::Slot& slot) {
+                                             return live.count(slot.allocatorId) == 0;
+                                         }),
+                          local.slots.end());
+    }
+
+    ThreadCache* claimed = nullptr;
+    {
+        std::lock_guard<std::mutex> cacheLock(threadCacheMutex);
+        for (const auto& cache : threadCaches) {
+            if (!cache->inUse) {
+                claimed = cache.get();
+                break;
+            }
+        }
+        if (!claimed) {
+            threadCaches.push_back(std::make_unique<ThreadCache>());
+            claimed = threadCaches.back().get();
+            if (options.threadCache) {
+                claimed->magazines.resize(threadCacheMaxOrder + 1);
+                for (auto& magazine : claimed->magazines) {
+                    magazine.reserve(2 * options.magazineSize);
+                }
+            }
+        }
+        claimed->inUse = true;
+    }
+
+    local.slots.push_back({instanceId, this, claimed});
+    return *claimed;
+}
+
+/**
+ * @brief Returns the calling thread's state if the current operation is to be timed, else nullptr.
+ *
+ * Must be called before taking allocatorMutex: a thread's first call claims its state under
+ * liveAllocatorMutex, which exiting threads hold while they flush into the pool.
+ */
+CustomAllocator::ThreadCache* CustomAllocator::sampleLatency() {
+    return timer.sample() ? &localThreadCache() : nullptr;
+}
+
+CustomAllocator::Block* CustomAllocator::allocateFromThreadCache(size_t order) {
+    ThreadCache& cache = localThreadCache();
+    bool timed = timer.sample();
+    uint64_t startTicks = timed ? timer.now() : 0;
+
+    std::vector<Block*>& magazine = cache.magazines[order];
+    if (magazine.empty()) {
+        refillMagazine(cache, order);
+        if (magazine.empty()) {
+            return nullptr;  // Pool exhausted
+        }
+        bumpOwnedCounter(cache.misses);
+    } else {
+        bumpOwnedCounter(cache.hits);
+    }
+
+    Block* block = magazine.back();
+    magazine.pop_back();
+
+    // Allocation indices are reserved in batches so the hot path avoids the shared counter
+    if (cache.nextAllocationIndex == cache.allocationIndexLimit) {
+        cache.nextAllocationIndex = allocationCounter.fetch_add(THREAD_CACHE_INDEX_BATCH, std::memory_order_relaxed);
+        cache.allocationIndexLimit = cache.nextAllocationIndex + THREAD_CACHE_INDEX_BATCH;
+    }
+    setAllocationIndex(block, cache.nextAllocationIndex++);
+
+    if (timed) {
+        cache.allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+    return block;
+}
+
+void CustomAllocator::deallocateToThreadCache(CustomAllocator::Block* block, size_t order) {
+    ThreadCache& cache = localThreadCache();
+    bool timed = timer.sample();
+    uint64_t startTicks = timed ? timer.now() : 0;
+
+    setAllocationIndex(block, INVALID_ALLOCATION_ID);
+    std::vector<Block*>& magazine = cache.magazines[order];
+    magazine.push_back(block);
+    if (magazine.size() >= 2 * options.magazineSize) {
+        flushMagazine(cache, order, options.magazineSize);
+    }
+    bumpOwnedCounter(cache.deallocations);
+
+    if (timed) {
+        cache.deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+}
+
+/**
+ * @brief Moves up to magazineSize blocks of the given order from the pool into a magazine.
+ */
+void CustomAllocator::refillMagazine(ThreadCache& cache, size_t order) {
+    std::vector<Block*>& magazine = cache.magazines[order];
+    std::lock_guard<ContentionMutex> lock(allocatorMutex);
+    for (size_t i = 0; i < options.magazineSize; ++i) {
+        Block* block = takeBlock(order);
+        if (!block) {
+            break;
+        }
+        magazine.push_back(block);
+    }
+}
+
+/**
+ * @brief Returns the oldest count blocks of a magazine to the pool in one locked batch.
+ */
+void CustomAllocator::flushMagazine(ThreadCache& cache, size_t order, size_t count) {
+    std::vector<Block*>& magazine = cache.magazines[order];
+    count = std::min(count, magazine.size());
+    if (count == 0) {
+        return;
+    }
+    {
+        std::lock_guard<ContentionMutex> lock(allocatorMutex);
+        for (size_t i = 0; i < count; ++i) {
+            releaseBlock(magazine[i]);
+        }
+    }
+    magazine.erase(magazine.begin(), magazine.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+/**
+ * @brief Flushes every magazine of a cache and makes it available to another thread.
+ */
+void CustomAllocator::releaseThreadCache(ThreadCache& cache) {
+    for (size_t order = 0; order < cache.magazines.size(); ++order) {
+        flushMagazine(cache, order, cache.magazines[order].size());
+    }
+    std::lock_guard<std::mutex> cacheLock(threadCacheMutex);
+    cache.inUse = false;
+}
+
+void CustomAllocator::flushThreadCache() {
+    if (!options.threadCache) {
+        return;
+    }
+    ThreadCache& cache = localThreadCache();
+    for (size_t order = 0; order < cache.magazines.size(); ++order) {
+        flushMagazine(cache, order, cache.magazines[order].size());
+    }
+}
+
+// ============================================================================
+// Lock-free stack layer
+// ============================================================================
+
+/**
+ * @brief Encodes a block as a 1-based index in units of the smallest block size.
+ */
+uint32_t CustomAllocator::blockToStackIndex(const Block* block) const {
+    size_t offset = static_cast<size_t>(reinterpret_cast<const char*>(block) - reinterpret_cast<char*>(memoryPool));
+    return static_cast<uint32_t>((offset >> minOrder) + 1);
+}
+
+CustomAllocator::Block* CustomAllocator::stackIndexToBlock(uint32_t index) const {
+    size_t offset = static_cast<size_t>(index - 1) << minOrder;
+    return reinterpret_cast<Block*>(reinterpret_cast<char*>(memoryPool) + offset);
+}
+
+/**
+ * @brief Parks a released block on the stack for its order without taking the mutex.
+ * @return false if the stack is already at its depth limit; the block is left untouched.
+ */
+bool CustomAllocator::pushLockFree(CustomAllocator::Block* block) {
+    LockFreeStack& stack = lockFreeStacks[orderOf(block)];
+    if (stack.depth.fetch_add(1, std::memory_order_relaxed) >= stack.limit) {
+        stack.depth.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t index = blockToStackIndex(block);
+    uint64_t head = stack.head.load(std::memory_order_relaxed);
+    uint64_t replacement;
+    do {
+        block->stackNext.store(static_cast<uint32_t>(head & STACK_INDEX_MASK), std::memory_order_relaxed);
+        replacement = ((head & ~STACK_INDEX_MASK) + STACK_TAG_STEP) | index;
+    } while (!stack.head.compare_exchange_weak(head, replacement, std::memory_order_release,
+                                               std::memory_order_relaxed));
+
+    return true;
+}
+
+/**
+ * @brief Pops a parked block of exactly the given order without taking the mutex.
+ * @return The block, or nullptr if the stack is empty.
+ */
+CustomAllocator::Block* CustomAllocator::popLockFree(size_t order) {
+    LockFreeStack& stack = lockFreeStacks[order];
+    uint64_t head = stack.head.load(std::memory_order_acquire);
+    while ((head & STACK_INDEX_MASK) != 0) {
+        // The pool outlives every stack, so reading a link that was popped meanwhile is harmless;
+        // the changed tag makes the compare-exchange below fail.
+        Block* block = stackIndexToBlock(static_cast<uint32_t>(head & STACK_INDEX_MASK));
+        uint64_t next = block->stackNext.load(std::memory_order_relaxed);
+        uint64_t replacement = ((head & ~STACK_INDEX_MASK) + STACK_TAG_STEP) | next;
+        if (stack.head.compare_exchange_weak(head, replacement, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            stack.depth.fetch_sub(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns every parked block to the buddy free lists so that it can coalesce again.
+ *
+ * Caller must hold allocatorMutex. Lock-free pushes and pops may continue concurrently.
+ */
+void CustomAllocator::drainLockFreeStacks() {
+    for (size_t order = minOrder; order <= lockFreeMaxOrder; ++order) {
+        while (Block* block = popLockFree(order)) {
+            releaseBlock(block);
+        }
+    }
+}
@@ -1,84 +1,478 @@
 #ifndef CUSTOM_ALLOCATOR_H
 #define CUSTOM_ALLOCATOR_H
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
-#include <list>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "allocator_observer.h"
+#include "buddy_core.h"
+#include "heap_snapshot.h"
+#include "latency_histogram.h"
+#include "lock_contention.h"
+#include "memory_pool.h"
+
+/**
+ * @struct AllocatorOptions
+ * @brief Optional features layered on top of the core buddy algorithm.
+ *
+ * A default-constructed value reproduces the plain mutex-protected buddy allocator.
+ */
+struct AllocatorOptions {
+    bool threadCache = false;  ///< Serve small orders from per-thread magazines
+    size_t magazineSize = 32;  ///< Blocks moved between a magazine and the pool per refill/flush
+    bool lockFree = false;     ///< Park freed blocks on per-order lock-free stacks (exclusive with threadCache)
+    size_t lockFreeDepth = 64; ///< Upper bound on blocks parked per order
+    bool headerless = false;   ///< Keep block metadata in side tables; user pointer is the block start
+    bool deferredCoalescing = false;  ///< Leave freed blocks of recently allocated orders unmerged
+    size_t deferredWatermark = 64;    ///< Unmerged blocks kept per order before frees merge again
+    double coalesceThreshold = 0.75;  ///< External fragmentation above which deferred blocks are merged
+    PoolOptions pool;          ///< Backing memory (malloc or mmap, huge pages, NUMA node, prefault)
+    TimingOptions timing;      ///< Latency sampling rate and clock source
+};
+
+/**
+ * @struct AllocatorStats
+ * @brief Free space of a CustomAllocator by block order.
+ *
+ * Blocks parked on the lock-free stacks count as free blocks of their order; blocks in thread-cache
+ * magazines count as in use. Taken while other threads allocate, the fields are each recent but
+ * need not agree with one another exactly.
+ */
+struct AllocatorStats {
+    static constexpr size_t MAX_ORDERS = 64;
+
+    size_t totalBytes = 0;        ///< Pool size
+    size_t freeBytes = 0;         ///< Bytes in free blocks
+    size_t largestFreeOrder = 0;  ///< Order of the largest free block; 0 when nothing is free
+    std::array<size_t, MAX_ORDERS> freeBlocks{};  ///< Free blocks of each order
+
+    size_t largestFreeBlock() const { return freeBytes ? static_cast<size_t>(1) << largestFreeOrder : 0; }
+
+    /**
+     * @brief 1 - largestFreeBlock / freeBytes: 0 while the free memory is one block, tending to 1 as it
+     * scatters into small ones. 0 when nothing is free.
+     */
+    double externalFragmentation() const {
+        size_t largest = largestFreeBlock();
+        return largest < freeBytes ? 1.0 - static_cast<double>(largest) / static_cast<double>(freeBytes) : 0.0;
+    }
+};
+
+/**
+ * @struct CoalescingStats
+ * @brief Buddy merges a CustomAllocator performed, and frees that skipped merging under
+ *        AllocatorOptions::deferredCoalescing.
+ */
+struct CoalescingStats {
+    uint64_t merges = 0;         ///< Buddy pairs joined, eagerly or in bulk
+    uint64_t deferredFrees = 0;  ///< Frees that left their block unmerged
+    uint64_t bulkCoalesces = 0;  ///< Passes that merged the deferred blocks
+    uint64_t bulkMerges = 0;     ///< Of merges, those made by the bulk passes
+};
+
+/**
+ * @struct OperationTotals
+ * @brief Successful allocations and deallocations of a CustomAllocator, read in one pass.
+ */
+struct OperationTotals {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+    size_t live() const { return allocations - deallocations; }  ///< Blocks handed out and not yet freed
+};
+
 /**
  * @class CustomAllocator
  * @brief A custom memory allocator implementing the buddy allocation algorithm.
  */
 class CustomAllocator {
    public:
-    CustomAllocator(size_t min_order, size_t max_order);
+    CustomAllocator(size_t min_order, size_t max_order, const AllocatorOptions& options = AllocatorOptions());
     ~CustomAllocator();
 
+    CustomAllocator(const CustomAllocator&) = delete;
+    CustomAllocator& operator=(const CustomAllocator&) = delete;
+
     void* allocate(size_t size);
     void deallocate(void* ptr);
 
+    /// Alignment of every pointer allocate(size) returns.
+    static constexpr size_t NATURAL_ALIGNMENT = alignof(std::max_align_t);
+
+    /**
+     * @brief Allocates size bytes aligned to alignment, a power of two.
+     *
+     * Buddy blocks are aligned to their size, so the block chosen provides the alignment itself.
+     * In the headerless layout the user pointer is the block start and no padding is added beyond
+     * rounding the order up to log2(alignment). With headers the pointer sits alignment-aligned at
+     * least two headers into the block, and a forwarding header in front of it lets deallocate(ptr)
+     * find the block. Alignments up to NATURAL_ALIGNMENT are plain allocate(size).
+     *
+     * @return The pointer, or nullptr if the pool is exhausted, or alignment is not a power of two
+     *         or exceeds getPoolAlignment().
+     */
+    void* allocate(size_t size, size_t alignment);
+
+    /**
+     * @brief Frees ptr given the size and alignment it was allocated with.
+     *
+     * The block start and order are computed from them rather than read from the header, and the
+     * pointer is not checked against the pool, so routing the block (to a thread cache magazine or
+     * lock-free stack) reads no metadata. Passing a size or alignment other than the allocation's
+     * (for allocateBatch, its size) is undefined behaviour, as with sized operator delete.
+     */
+    void deallocate(void* ptr, size_t size, size_t alignment = NATURAL_ALIGNMENT);
+
+    /**
+     * @brief Resizes the allocation at ptr to at least newSize bytes, moving it only when it must.
+     *
+     * Growing absorbs the block's upper buddies while the block is the lower half at each order and
+     * each buddy is a whole free block; shrinking splits the block and frees its upper halves.
+     * Only when growth is blocked are the contents copied to a new allocation and ptr freed. A block
+     * resized in place keeps its allocation index; either way an observer sees the old block freed
+     * and the new one allocated. A null ptr is allocate(newSize).
+     *
+     * The result is freed by deallocate(ptr), or by deallocate(ptr, newSize) when ptr came from
+     * allocate(size). Pointers from allocate(size, alignment) keep their alignment only while
+     * resized in place.
+     *
+     * @return The resized allocation, or nullptr (leaving ptr intact) if ptr is foreign or no block
+     *         of the new size is available.
+     */
+    void* reallocate(void* ptr, size_t newSize);
+
+    /**
+     * @brief Allocates count blocks of the same size under a single lock acquisition.
+     *
+     * Free blocks of the exact order are used first; larger blocks are carved into siblings in
+     * one pass, with the unused tail returned to the free lists as the buddies a sequence of
+     * splits would have left. Bypasses the thread cache and lock-free stacks.
+     *
+     * @param size Minimum size of each block.
+     * @param count Number of blocks requested.
+     * @param out Receives the pointers; must have room for count entries.
+     * @return Number of blocks allocated (less than count only if the pool is exhausted).
+     */
+    size_t allocateBatch(size_t size, size_t count, void** out);
+
+    /**
+     * @brief Frees count pointers under a single lock acquisition.
+     *
+     * The blocks are sorted by address and buddies within the batch are merged with each other
+     * before touching the free lists. Null and foreign pointers are skipped.
+     *
+     * @param ptrs Pointers previously returned by this allocator; the array is reordered.
+     * @param count Number of entries in ptrs.
+     */
+    void deallocateBatch(void** ptrs, size_t count);
+
+    /**
+     * @brief Returns every block cached by the calling thread to the shared buddy pool.
+     *
+     * Cached blocks count as in use for getFragmentation() until they are flushed. Threads
+     * flush automatically when they exit; this is only needed to settle the calling thread's
+     * cache earlier, e.g. before inspecting fragmentation.
+     */
+    void flushThreadCache();
+
+    /**
+     * @brief Reports every block handed out or taken back to observer; nullptr turns reporting off.
+     *
+     * With no observer each public call pays one relaxed load and branch. With one, the calls are
+     * timed and their events built from the block's own metadata, without taking the lock again.
+     * Internal traffic (thread cache refills and flushes, lock-free drains) is not reported. The
+     * observer must outlive its installation; a call racing with setObserver may still report to
+     * the previous observer.
+     */
+    void setObserver(AllocatorObserver* observer);
+
     // Performance metrics
     double getAllocationTime() const;
     double getDeallocationTime() const;
-    double getFragmentation() const;
+    double getFragmentation() const;  // Free fraction of the pool, not how scattered it is
+
+    /**
+     * @brief Per-order free block counts and the largest free block, without taking the lock.
+     *
+     * The counts are kept up to date as blocks enter and leave the free lists, so a snapshot is
+     * one relaxed load per order and can be taken after every operation of a benchmark.
+     */
+    AllocatorStats getStats() const;
+
+    /**
+     * @brief getStats().externalFragmentation(), without reading the per-order counts.
+     */
+    double getExternalFragmentation() const;
 
-    // Public methods to access allocation information
-    std::string getAllocationID(void* ptr);
-    std::string getMemoryAddress(void* ptr);
+    /**
+     * @brief Records the order and free state of every block in the pool into snapshot.
+     *
+     * Walks the pool block by block under the allocator lock, so it costs one metadata read per
+     * block rather than per minimum-size unit. Reuses the capacity of snapshot.runs; taking
+     * snapshots into the same object allocates only when the layout needs more runs than before.
+     */
+    void snapshotHeap(HeapSnapshot& snapshot);
+
+    /**
+     * @brief Latency distributions of the timed operations, merged from per-thread histograms.
+     *
+     * Each thread records into its own histograms without synchronisation; this merges them,
+     * so percentiles are available without logging every event. All empty when built with
+     * ALLOCATOR_TIMING=0.
+     */
+    LatencyStats getLatencyStats() const;
+    LatencySnapshot getAllocationLatency() const;  // getLatencyStats().allocation
+    LatencySnapshot getDeallocationLatency() const;
+
+    /**
+     * @brief Allocation index of the block holding ptr: the N of getAllocationID's "AllocN".
+     *
+     * Reads the block's own metadata after a pool range check, without taking the lock, so the
+     * caller must own ptr (allocated and not concurrently freed). INVALID_ALLOCATION_ID for null
+     * and foreign pointers. Builds no string, for callers logging structured events.
+     */
+    size_t getAllocationIndex(const void* ptr) const;
+
+    /**
+     * @brief Order of the block holding ptr (it spans 2^order bytes, metadata included).
+     *
+     * Lock-free under the same conditions as getAllocationIndex; 0 for null and foreign pointers.
+     */
+    size_t getBlockOrder(const void* ptr) const;
+
+    // String forms of the above, for output; they allocate, so keep them out of measured loops
+    std::string getAllocationID(const void* ptr) const;   // "AllocN", or "" when there is no index
+    std::string getMemoryAddress(const void* ptr) const;  // As std::ostream prints a pointer
+
+    static constexpr size_t INVALID_ALLOCATION_ID = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Allocation and deallocation counts from a single pass over the per-thread counters.
+     *
+     * The pass holds the short thread-registry lock (not the allocator lock), which thread
+     * registration also takes; callers that need both counts, or poll them, should use this
+     * rather than the two getters below, which each make the same pass.
+     */
+    OperationTotals getTotals() const;
 
     // Getter methods for throughput metrics
-    size_t getTotalAllocations() const;
+    size_t getTotalAllocations() const;  // getTotals().allocations
     size_t getTotalDeallocations() const;
 
+    // Pool geometry, used by front ends that route pointers between several allocators
+    bool owns(const void* ptr) const;
+    const void* getPoolBase() const;
+    size_t getPoolSize() const;
+    size_t getMinOrder() const;           // Orders of the smallest and largest blocks (2^order bytes)
+    size_t getMaxOrder() const;
+    size_t getMaxAllocationSize() const;  // Largest request that can ever succeed
+    size_t getPoolAlignment() const;      // Largest alignment allocate(size, alignment) can provide
+
+    // Thread cache metrics (both zero when the thread cache is disabled)
+    size_t getThreadCacheHits() const;
+    size_t getThreadCacheMisses() const;
+
+    // Allocations served from the lock-free stacks without taking the mutex (zero when disabled)
+    size_t getLockFreeHits() const;
+
+    // reallocate() calls that resized the block without moving it
+    size_t getInPlaceReallocations() const;
+
+    /**
+     * @brief Merges performed and deferred so far; lock-free.
+     *
+     * With deferredCoalescing, a free of an order allocated since the last bulk pass goes onto
+     * its order's free list without merging, up to deferredWatermark blocks per order, so
+     * alloc/free churn of one size does not split and merge on every cycle. The deferred blocks
+     * are merged in one pass when a request finds no block of its order while smaller ones are
+     * deferred (including when the pool would otherwise be exhausted), or when a deferred free
+     * pushes the external fragmentation above coalesceThreshold and above what the last pass left,
+     * so live allocations that keep the pool fragmented do not trigger a pass on every free.
+     */
+    CoalescingStats getCoalescingStats() const;
+
+    /**
+     * @brief Acquisitions of the allocator lock and the time callers spent waiting for it.
+     *
+     * Paths that avoid the lock (thread cache and lock-free hits) do not appear. All zero when
+     * built with ALLOCATOR_TIMING=0.
+     */
+    LockContention getLockContention() const;
+
    private:
+    friend struct BuddyCore<CustomAllocator>;
+    using Core = BuddyCore<CustomAllocator>;
+
+    // Free-list links lead the header so that, with options.headerless, they are the only fields
+    // kept in-band (and only while the block is free); use the metadata accessors for the rest.
+    // Order, free flag and stack link share one word, keeping the header at 32 bytes.
     struct alignas(std::max_align_t) Block {
-        size_t order;
+        Block* next;  // Next free block of the same order (free blocks only)
+        Block* prev;  // Previous free block of the same order (free blocks only)
+        uint8_t order;
         bool free;
-        Block* next;
+        std::atomic<uint32_t> stackNext;  // Lock-free stack link: index of the next parked block, 0 = end
         size_t allocationIndex;
     };
+    static_assert(sizeof(Block) <= 32, "the block header must stay within 32 bytes");
 
-    static constexpr size_t INVALID_ALLOCATION_ID = std::numeric_limits<size_t>::max();
+    // Per-thread magazines and latency histograms; defined in custom_allocator.cpp
+    struct ThreadCache;
+    struct ThreadCacheSlots;
+    struct LockFreeStack;
+
+    // Operation counts of every thread's state, summed in one pass by sumThreadCounters()
+    struct ThreadCounters {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t deallocations = 0;
+        size_t lockFreeHits = 0;
+        size_t lockFreeFrees = 0;
+    };
+
+    // Block::order of a forwarding header, written before an over-aligned pointer in the header
+    // layout; its next field points at the block the pointer lies in
+    static constexpr uint8_t FORWARDED_ORDER = std::numeric_limits<uint8_t>::max();
 
     size_t minOrder;
     size_t maxOrder;
     size_t totalSize;
-    void* memoryPool;
+    size_t poolAlignment;  // Alignment of the pool base, capped at totalSize
+    std::unique_ptr<MemoryPool> poolMemory;
+    void* memoryPool;  // poolMemory->data(), cached for the hot paths
+    AllocatorOptions options;
+    size_t headerSize;  // Bytes between a block and its user pointer: sizeof(Block), or 0 when headerless
+
+    // Headerless side tables, indexed by block offset >> minOrder
+    std::vector<uint8_t> blockStates;  // Order | BLOCK_FREE_BIT, valid at block starts
+    std::vector<size_t> blockAllocationIndices;
+
+    // Heads of the intrusive doubly-linked free lists for each order
+    std::vector<Block*> freeLists;
 
-    // Free lists for each order
-    std::vector<std::list<Block*>> freeLists;
+    // Bit i is set while freeLists[i] is non-empty, so the first usable order is one bit-scan away.
+    // The mask and the per-order list lengths are written under allocatorMutex and read without
+    // it by getStats().
+    std::atomic<uint64_t> freeOrderMask;
+    std::unique_ptr<std::atomic<size_t>[]> freeBlockCounts;
 
-    // Timing metrics
-    double allocationTime;
-    double deallocationTime;
+    // Timing metrics; samples are recorded into the per-thread state (ThreadCache)
+    LatencyTimer timer;
 
-    // Fragmentation metrics
-    size_t totalFreeMemory;
+    // Fragmentation metrics; written under allocatorMutex, read without it by getFragmentation()
+    std::atomic<size_t> totalFreeMemory;
 
-    // Mutex for thread safety
-    std::mutex allocatorMutex;
+    // Mutex for thread safety; counts how often, and for how long, callers wait on it
+    ContentionMutex allocatorMutex;
 
     // Allocation counters for generating unique IDs and tracking throughput
     std::atomic<size_t> allocationCounter;
     std::atomic<size_t> totalAllocations;
     std::atomic<size_t> totalDeallocations;
+    std::atomic<size_t> inPlaceReallocations;
+
+    // Deferred coalescing state, under allocatorMutex: orders allocated since the last bulk pass,
+    // orders holding deferred blocks, and about how many each holds (merges and resizes that absorb
+    // a deferred block do not decrement it; the next bulk pass resets all three)
+    uint64_t hotOrderMask;
+    uint64_t deferredOrderMask;
+    std::vector<size_t> deferredBlocks;
+    double fragmentationAfterCoalesce;  // What the last bulk pass left; the threshold acts above it
+
+    // Written under allocatorMutex, read without it by getCoalescingStats()
+    std::atomic<uint64_t> mergeCount;
+    std::atomic<uint64_t> deferredFreeCount;
+    std::atomic<uint64_t> bulkCoalesceCount;
+    std::atomic<uint64_t> bulkMergeCount;
+
+    std::atomic<AllocatorObserver*> observer;
+
+    // Per-thread state: owned here and handed out to one thread at a time
+    uint64_t instanceId;
+    size_t threadCacheMaxOrder;
+    std::vector<std::unique_ptr<ThreadCache>> threadCaches;
+    mutable std::mutex threadCacheMutex;
+
+    // Lock-free mode state: one tagged-index Treiber stack per order up to lockFreeMaxOrder
+    size_t lockFreeMaxOrder;
+    std::unique_ptr<LockFreeStack[]> lockFreeStacks;
+
+    // Block metadata accessors (header fields, or the side tables when headerless)
+    size_t unitOf(const Block* block) const;
+    size_t orderOf(const Block* block) const;
+    void setOrder(Block* block, size_t order);
+    bool isFree(const Block* block) const;
+    void setFree(Block* block, bool free);
+    size_t allocationIndexOf(const Block* block) const;
+    void setAllocationIndex(Block* block, size_t index);
+
+    // Public entry points without observer reporting
+    void* allocateUnobserved(size_t size);
+    void deallocateUnobserved(void* ptr);
+    void* allocateAlignedUnobserved(size_t size, size_t alignment);
+    void deallocateSizedUnobserved(void* ptr, size_t size, size_t alignment);
+    size_t allocateBatchUnobserved(size_t size, size_t count, void** out);
+    void deallocateBatchUnobserved(void** ptrs, size_t count);
+    AllocatorEvent blockEvent(AllocatorEventType type, void* ptr, const Block* block) const;
+    void notifyObserver(AllocatorObserver& target, AllocatorEventType type, void* ptr, size_t size,
+                        uint64_t latencyNs) const;
+    size_t freeBytes() const;  // Free pool bytes, counting blocks parked on the lock-free stacks
+    size_t largestFreeOrder() const;
 
     // Helper functions
     size_t sizeToOrder(size_t size) const;
-    Block* splitBlock(Block* block, size_t targetOrder);
-    Block* mergeBlock(Block* block);
+    void pushFreeBlock(Block* block);
+    void removeFreeBlock(Block* block);
+    Block* popFreeBlock(size_t order);
+    void onFreeListPush(size_t order);
+    void onFreeListRemove(size_t order, bool emptied);
     Block* getBuddy(Block* block);
+    bool resizeInPlace(Block* block, size_t order);
     bool isValidBlock(Block* block) const;
+    Block* blockFromPointer(const void* ptr) const;
+    size_t carveBlock(Block* block, size_t order, size_t count, size_t firstIndex, void** out);
+
+    // Core buddy operations; callers must hold allocatorMutex
+    Block* takeBlock(size_t order);
+    void releaseBlock(Block* block);
+
+    // Deferred coalescing; callers must hold allocatorMutex
+    bool deferBlock(Block* block, size_t order);
+    bool needsCoalesceFor(size_t order) const;
+    void coalesceDeferred(size_t fromOrder);
+
+    // Order-level entry points shared by the sized, aligned and plain calls
+    Block* allocateBlock(size_t order);
+    void deallocateBlock(Block* block, size_t order);
+    size_t alignedOffset(size_t alignment) const;  // User pointer offset into the block
+    size_t alignedOrder(size_t size, size_t alignment) const;
+
+    // Thread cache paths
+    static ThreadCacheSlots& localThreadCacheSlots();
+    ThreadCache& localThreadCache();
+    ThreadCache* sampleLatency();
+    Block* allocateFromThreadCache(size_t order);
+    void deallocateToThreadCache(Block* block, size_t order);
+    void refillMagazine(ThreadCache& cache, size_t order);
+    void flushMagazine(ThreadCache& cache, size_t order, size_t count);
+    void releaseThreadCache(ThreadCache& cache);
+    ThreadCounters sumThreadCounters() const;
 
-    // Instrumentation functions
-    void recordAllocationTime(double time);
-    void recordDeallocationTime(double time);
+    // Lock-free stack paths
+    uint32_t blockToStackIndex(const Block* block) const;
+    Block* stackIndexToBlock(uint32_t index) const;
+    bool pushLockFree(Block* block);
+    Block* popLockFree(size_t order);
+    void drainLockFreeStacks();  // Caller must hold allocatorMutex
 
     // Generates a unique allocation index for ID formatting
     size_t generateAllocationIndex();
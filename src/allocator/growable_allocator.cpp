@@ -0,0 +1,248 @@
+// growable_allocator.cpp
+#include "growable_allocator.h"
+
+#include <algorithm>
+#include <mutex>
+
+GrowableAllocator::GrowableAllocator(size_t min_order, size_t max_order, const GrowableOptions& growth,
+                                     const AllocatorOptions& options)
+    : minOrder(min_order),
+      maxOrder(max_order),
+      growth(growth),
+      options(options),
+      retiredAllocationTime(0.0),
+      retiredDeallocationTime(0.0),
+      retiredAllocations(0),
+      retiredDeallocations(0) {
+    addArena();
+}
+
+/**
+ * @brief Allocates from an existing arena, adding a new arena if every one is full.
+ * @param size The minimum size to allocate.
+ * @return Pointer to the allocated memory, or nullptr if the request exceeds an arena or the
+ *         arena limit has been reached.
+ */
+void* GrowableAllocator::allocate(size_t size) {
+    {
+        std::shared_lock<std::shared_mutex> lock(arenasMutex);
+        if (size > arenas.front()->getMaxAllocationSize()) {
+            return nullptr;  // No arena could ever hold it; do not grow
+        }
+
+        // Newest arena first: older arenas are the ones the live set has already filled
+        for (auto it = arenas.rbegin(); it != arenas.rend(); ++it) {
+            if (void* ptr = (*it)->allocate(size)) {
+                return ptr;
+            }
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(arenasMutex);
+
+    // Another thread may have grown the set or freed memory while the lock was released
+    if (void* ptr = arenas.back()->allocate(size)) {
+        return ptr;
+    }
+    if (growth.maxArenas != 0 && arenas.size() >= growth.maxArenas) {
+        return nullptr;
+    }
+    return addArena()->allocate(size);
+}
+
+/**
+ * @brief Returns memory to its arena and releases surplus empty arenas.
+ * @param ptr Pointer previously returned by allocate(); pointers from elsewhere are ignored.
+ */
+void GrowableAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    bool arenaEmptied = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(arenasMutex);
+        CustomAllocator* owner = findOwnerLocked(ptr);
+        if (!owner) {
+            return;
+        }
+        owner->deallocate(ptr);
+        // Only look for emptiness once there are arenas to release; it reads every thread's counters
+        arenaEmptied = arenas.size() > growth.retainEmptyArenas && isEmpty(*owner);
+    }
+
+    if (arenaEmptied) {
+        std::unique_lock<std::shared_mutex> lock(arenasMutex);
+        releaseEmptyArenas();
+    }
+}
+
+CustomAllocator* GrowableAllocator::findOwner(const void* ptr) const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    return findOwnerLocked(ptr);
+}
+
+CustomAllocator* GrowableAllocator::findOwnerLocked(const void* ptr) const {
+    if (!ptr) {
+        return nullptr;
+    }
+    auto it = arenaIndex.find(reinterpret_cast<uintptr_t>(ptr) >> maxOrder);
+    if (it == arenaIndex.end()) {
+        return nullptr;
+    }
+    for (CustomAllocator* arena : it->second) {
+        if (arena && arena->owns(ptr)) {
+            return arena;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Creates a new arena and makes it findable. Caller must hold arenasMutex exclusively.
+ */
+CustomAllocator* GrowableAllocator::addArena() {
+    arenas.push_back(std::make_unique<CustomAllocator>(minOrder, maxOrder, options));
+    CustomAllocator* arena = arenas.back().get();
+    indexArena(arena);
+    return arena;
+}
+
+/**
+ * @brief Registers an arena under the one or two slots its pool overlaps.
+ */
+void GrowableAllocator::indexArena(CustomAllocator* arena) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(arena->getPoolBase());
+    uintptr_t firstSlot = base >> maxOrder;
+    uintptr_t lastSlot = (base + arena->getPoolSize() - 1) >> maxOrder;
+    for (uintptr_t slot = firstSlot; slot <= lastSlot; ++slot) {
+        ArenaSlot& entry = arenaIndex.try_emplace(slot, ArenaSlot{nullptr, nullptr}).first->second;
+        (entry[0] ? entry[1] : entry[0]) = arena;
+    }
+}
+
+void GrowableAllocator::unindexArena(CustomAllocator* arena) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(arena->getPoolBase());
+    uintptr_t firstSlot = base >> maxOrder;
+    uintptr_t lastSlot = (base + arena->getPoolSize() - 1) >> maxOrder;
+    for (uintptr_t slot = firstSlot; slot <= lastSlot; ++slot) {
+        auto it = arenaIndex.find(slot);
+        if (it == arenaIndex.end()) {
+            continue;
+        }
+        ArenaSlot& entry = it->second;
+        for (CustomAllocator*& candidate : entry) {
+            if (candidate == arena) {
+                candidate = nullptr;
+            }
+        }
+        if (!entry[0] && !entry[1]) {
+            arenaIndex.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief Whether every block handed out by the arena has been freed.
+ *
+ * Counts live allocations rather than free bytes: blocks parked in thread cache magazines or
+ * lock-free stacks are free but not back on the buddy lists, so the free fraction of an arena
+ * with those fast paths enabled stays below 1.0 after its last block is freed. Destroying the
+ * arena discards the parked blocks along with the pool. One pass over the arena's per-thread
+ * counters, made under its thread-registry lock.
+ */
+bool GrowableAllocator::isEmpty(const CustomAllocator& arena) {
+    return arena.getTotals().live() == 0;
+}
+
+/**
+ * @brief Destroys empty arenas beyond the retained count, oldest arenas being kept.
+ *
+ * Caller must hold arenasMutex exclusively, so no allocation can race with the emptiness check.
+ * At least one arena always remains.
+ */
+void GrowableAllocator::releaseEmptyArenas() {
+    size_t keepEmpty = std::max<size_t>(growth.retainEmptyArenas, 1);
+    size_t emptySeen = 0;
+    for (size_t i = 0; i < arenas.size();) {
+        CustomAllocator& arena = *arenas[i];
+        if (!isEmpty(arena) || ++emptySeen <= keepEmpty) {
+            ++i;
+            continue;
+        }
+        retiredAllocationTime += arena.getAllocationTime();
+        retiredDeallocationTime += arena.getDeallocationTime();
+        OperationTotals totals = arena.getTotals();
+        retiredAllocations += totals.allocations;
+        retiredDeallocations += totals.deallocations;
+        unindexArena(&arena);
+        arenas.erase(arenas.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+size_t GrowableAllocator::getArenaCount() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    return arenas.size();
+}
+
+size_t GrowableAllocator::getMappedBytes() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    return arenas.size() * arenas.front()->getPoolSize();
+}
+
+double GrowableAllocator::getAllocationTime() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    double total = retiredAllocationTime;
+    for (const auto& arena : arenas) {
+        total += arena->getAllocationTime();
+    }
+    return total;
+}
+
+double GrowableAllocator::getDeallocationTime() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    double total = retiredDeallocationTime;
+    for (const auto& arena : arenas) {
+        total += arena->getDeallocationTime();
+    }
+    return total;
+}
+
+/**
+ * @brief Free fraction of the currently mapped arenas; every arena has the same size.
+ */
+double GrowableAllocator::getFragmentation() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    double total = 0.0;
+    for (const auto& arena : arenas) {
+        total += arena->getFragmentation();
+    }
+    return total / static_cast<double>(arenas.size());
+}
+
+double GrowableAllocator::getExternalFragmentation() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    double total = 0.0;
+    for (const auto& arena : arenas) {
+        total += arena->getExternalFragmentation();
+    }
+    return total / static_cast<double>(arenas.size());
+}
+
+size_t GrowableAllocator::getTotalAllocations() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    size_t total = retiredAllocations;
+    for (const auto& arena : arenas) {
+        total += arena->getTotalAllocations();
+    }
+    return total;
+}
+
+size_t GrowableAllocator::getTotalDeallocations() const {
+    std::shared_lock<std::shared_mutex> lock(arenasMutex);
+    size_t total = retiredDeallocations;
+    for (const auto& arena : arenas) {
+        total += arena->getTotalDeallocations();
+    }
+    return total;
+}
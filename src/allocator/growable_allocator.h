@@ -0,0 +1,97 @@
+#ifndef GROWABLE_ALLOCATOR_H
+#define GROWABLE_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "custom_allocator.h"
+
+/**
+ * @struct GrowableOptions
+ * @brief Growth and shrink policy of a GrowableAllocator.
+ */
+struct GrowableOptions {
+    size_t maxArenas = 0;          ///< Upper bound on mapped arenas; 0 = unlimited
+    size_t retainEmptyArenas = 1;  ///< Empty arenas kept mapped; further empty arenas are released
+};
+
+/**
+ * @class GrowableAllocator
+ * @brief Front end that adds buddy arenas on exhaustion and releases them once they are empty.
+ *
+ * Every arena is a complete CustomAllocator with a pool of 1 << max_order bytes. When no arena
+ * can satisfy a request, a new arena is created; when a deallocation leaves an arena empty and
+ * more than retainEmptyArenas arenas are empty, the surplus arenas are destroyed and their
+ * memory returned to the OS. An arena is empty when all of its allocations have been freed, even
+ * if its thread cache or lock-free stacks still hold the blocks. The keep-some-empty threshold provides the hysteresis that stops a
+ * live set oscillating around an arena boundary from mapping and unmapping on every operation.
+ *
+ * Owners are found in O(1): the address space is cut into slots of the pool size, so an arena
+ * overlaps at most two slots and a slot at most two arenas, and a hash map from slot number to
+ * those arenas resolves any pointer with one lookup and at most two range checks.
+ */
+class GrowableAllocator {
+   public:
+    /**
+     * @brief Creates the allocator with a single arena.
+     * @param min_order Minimum block order of each arena.
+     * @param max_order Maximum block order (pool size) of each arena.
+     * @param growth Growth and release policy.
+     * @param options Options applied to every arena.
+     */
+    GrowableAllocator(size_t min_order, size_t max_order, const GrowableOptions& growth = GrowableOptions(),
+                      const AllocatorOptions& options = AllocatorOptions());
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr);
+
+    /**
+     * @brief Finds the arena whose pool contains ptr.
+     * @return The owning arena, or nullptr if ptr was not allocated here.
+     */
+    CustomAllocator* findOwner(const void* ptr) const;
+
+    size_t getArenaCount() const;
+    size_t getMappedBytes() const;
+
+    // Aggregated metrics; counters include arenas that have since been released
+    double getAllocationTime() const;
+    double getDeallocationTime() const;
+    double getFragmentation() const;
+    double getExternalFragmentation() const;  // Mean of the mapped arenas' external fragmentation
+    size_t getTotalAllocations() const;
+    size_t getTotalDeallocations() const;
+
+   private:
+    using ArenaSlot = std::array<CustomAllocator*, 2>;
+
+    size_t minOrder;
+    size_t maxOrder;
+    GrowableOptions growth;
+    AllocatorOptions options;
+
+    std::vector<std::unique_ptr<CustomAllocator>> arenas;
+    std::unordered_map<uintptr_t, ArenaSlot> arenaIndex;  ///< Slot (address >> maxOrder) -> arenas overlapping it
+    mutable std::shared_mutex arenasMutex;               ///< Shared for allocate/deallocate, exclusive to grow/shrink
+
+    // Metrics carried over from released arenas
+    double retiredAllocationTime;
+    double retiredDeallocationTime;
+    size_t retiredAllocations;
+    size_t retiredDeallocations;
+
+    // Callers must hold arenasMutex (shared for lookups, exclusive for the rest)
+    CustomAllocator* findOwnerLocked(const void* ptr) const;
+    CustomAllocator* addArena();
+    void indexArena(CustomAllocator* arena);
+    void unindexArena(CustomAllocator* arena);
+    void releaseEmptyArenas();
+    static bool isEmpty(const CustomAllocator& arena);
+};
+
+#endif  // GROWABLE_ALLOCATOR_H
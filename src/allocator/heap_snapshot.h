@@ -0,0 +1,33 @@
+#ifndef HEAP_SNAPSHOT_H
+#define HEAP_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct HeapRun
+ * @brief Consecutive blocks of one order and state.
+ */
+struct HeapRun {
+    uint8_t order;
+    bool free;
+    uint64_t blocks;
+};
+
+/**
+ * @struct HeapSnapshot
+ * @brief Layout of a whole CustomAllocator pool, run-length encoded by block.
+ *
+ * The runs tile the pool from its base in address order; run i covers blocks << order bytes, so
+ * the state of every minimum-size block follows from them. Blocks parked on the lock-free stacks
+ * or cached in thread-cache magazines have not been returned to the buddy lists and show as
+ * allocated.
+ */
+struct HeapSnapshot {
+    size_t minOrder = 0;
+    size_t maxOrder = 0;
+    std::vector<HeapRun> runs;
+};
+
+#endif  // HEAP_SNAPSHOT_H
@@ -0,0 +1,148 @@
+// latency_histogram.cpp
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Returns the index of the highest set bit; value must be non-zero.
+ */
+inline size_t highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(63 - __builtin_clzll(value));
+#endif
+}
+
+#if defined(ALLOCATOR_HAS_TSC)
+/**
+ * @brief Measures the timestamp counter against the steady clock once per process.
+ */
+double measureNanosecondsPerTick() {
+    static const double nanosecondsPerTick = [] {
+        auto clockStart = std::chrono::steady_clock::now();
+        uint64_t tickStart = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        uint64_t tickEnd = __rdtsc();
+        auto clockEnd = std::chrono::steady_clock::now();
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(clockEnd - clockStart).count();
+        return tickEnd > tickStart ? nanoseconds / static_cast<double>(tickEnd - tickStart) : 1.0;
+    }();
+    return nanosecondsPerTick;
+}
+#endif
+
+}  // namespace
+
+// ============================================================================
+// LatencySnapshot
+// ============================================================================
+
+size_t LatencySnapshot::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < LINEAR_BUCKETS) {
+        return static_cast<size_t>(nanoseconds);
+    }
+    size_t exponent = highestBit(nanoseconds);  // >= 4
+    if (exponent > MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    size_t subBucket = static_cast<size_t>(nanoseconds >> (exponent - 3)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + (exponent - 4) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencySnapshot::bucketLowerBound(size_t bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return bucket;
+    }
+    size_t exponent = 4 + (bucket - LINEAR_BUCKETS) / SUB_BUCKETS;
+    uint64_t subBucket = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    return (static_cast<uint64_t>(SUB_BUCKETS) + subBucket) << (exponent - 3);
+}
+
+uint64_t LatencySnapshot::percentile(double fraction) const {
+    if (samples == 0) {
+        return 0;
+    }
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(samples))));
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return bucketLowerBound(bucket);
+        }
+    }
+    return bucketLowerBound(BUCKETS - 1);
+}
+
+double LatencySnapshot::meanNanoseconds() const {
+    return samples == 0 ? 0.0 : static_cast<double>(totalNanoseconds) / static_cast<double>(samples);
+}
+
+void LatencySnapshot::merge(const LatencySnapshot& other) {
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        counts[bucket] += other.counts[bucket];
+    }
+    samples += other.samples;
+    totalNanoseconds += other.totalNanoseconds;
+}
+
+void LatencySnapshot::subtract(const LatencySnapshot& earlier) {
+    // Saturating, so a merge that caught a sample half-recorded cannot wrap a count around
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        counts[bucket] -= std::min(counts[bucket], earlier.counts[bucket]);
+    }
+    samples -= std::min(samples, earlier.samples);
+    totalNanoseconds -= std::min(totalNanoseconds, earlier.totalNanoseconds);
+}
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    counts[LatencySnapshot::bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::recordOwned(uint64_t nanoseconds) {
+    std::atomic<uint64_t>& bucket = counts[LatencySnapshot::bucketOf(nanoseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    samples.store(samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    totalNanoseconds.store(totalNanoseconds.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::addTo(LatencySnapshot& snapshot) const {
+    for (size_t bucket = 0; bucket < LatencySnapshot::BUCKETS; ++bucket) {
+        snapshot.counts[bucket] += counts[bucket].load(std::memory_order_relaxed);
+    }
+    snapshot.samples += samples.load(std::memory_order_relaxed);
+    snapshot.totalNanoseconds += totalNanoseconds.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// LatencyTimer
+// ============================================================================
+
+LatencyTimer::LatencyTimer(const TimingOptions& options)
+    : sampleRate(options.sampleRate), useTsc(false), nanosecondsPerTick(1.0) {
+#if defined(ALLOCATOR_HAS_TSC)
+    if (options.useTsc && sampleRate != 0) {
+        useTsc = true;
+        nanosecondsPerTick = measureNanosecondsPerTick();
+    }
+#endif
+}
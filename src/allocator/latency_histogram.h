@@ -0,0 +1,162 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Set to 0 (CMake: -DALLOCATOR_TIMING=OFF) to compile every timing read and record out of the
+// allocation paths; the latency getters then report empty histograms.
+#ifndef ALLOCATOR_TIMING
+    #define ALLOCATOR_TIMING 1
+#endif
+
+#if ALLOCATOR_TIMING && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+    #define ALLOCATOR_HAS_TSC 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+/**
+ * @struct TimingOptions
+ * @brief How allocation and deallocation latencies are measured.
+ *
+ * A default-constructed value times every operation with std::chrono, as the allocator always has.
+ */
+struct TimingOptions {
+    size_t sampleRate = 1;  ///< Time about one in sampleRate operations, chosen at random; 0 = no timing
+    bool useTsc = false;    ///< Read the CPU timestamp counter instead of the steady clock (x86 only)
+};
+
+/**
+ * @struct LatencySnapshot
+ * @brief Point-in-time copy of a LatencyHistogram, with percentile queries.
+ *
+ * Buckets are log-linear: exact below 16 ns, then eight buckets per power of two, so a reported
+ * percentile is within 12.5% of the true value.
+ */
+struct LatencySnapshot {
+    static constexpr size_t LINEAR_BUCKETS = 16;
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t MAX_EXPONENT = 40;  // Values of 2^41 ns (~36 min) and above share the top bucket
+    static constexpr size_t BUCKETS = LINEAR_BUCKETS + (MAX_EXPONENT - 3) * SUB_BUCKETS;
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t samples = 0;
+    uint64_t totalNanoseconds = 0;
+
+    static size_t bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketLowerBound(size_t bucket);
+
+    /**
+     * @brief Latency at or below which the given fraction of samples fall.
+     * @param fraction Percentile in [0, 1], e.g. 0.99.
+     * @return Lower bound of the bucket holding that sample in nanoseconds; 0 if empty.
+     */
+    uint64_t percentile(double fraction) const;
+    double meanNanoseconds() const;
+
+    void merge(const LatencySnapshot& other);
+
+    /**
+     * @brief Removes the counts of an earlier snapshot of the same histograms, leaving the
+     * distribution of the samples recorded between the two.
+     */
+    void subtract(const LatencySnapshot& earlier);
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Concurrent latency recorder feeding a LatencySnapshot.
+ *
+ * record() may be called from any number of threads. recordOwned() is cheaper (no locked
+ * read-modify-write) but requires that only one thread, or threads serialised by a lock,
+ * records at a time; readers may snapshot concurrently with either.
+ */
+class LatencyHistogram {
+   public:
+    void record(uint64_t nanoseconds);
+    void recordOwned(uint64_t nanoseconds);
+
+    /// Adds this histogram's counts to snapshot.
+    void addTo(LatencySnapshot& snapshot) const;
+
+   private:
+    std::array<std::atomic<uint64_t>, LatencySnapshot::BUCKETS> counts{};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> totalNanoseconds{0};
+};
+
+/**
+ * @struct LatencyStats
+ * @brief Allocation and deallocation latency distributions, merged across threads on demand.
+ */
+struct LatencyStats {
+    LatencySnapshot allocation;
+    LatencySnapshot deallocation;
+    size_t threads = 0;  ///< Per-thread histogram pairs merged into the snapshots
+};
+
+/**
+ * @class LatencyTimer
+ * @brief Decides which operations are timed and reads the configured clock.
+ *
+ * An operation that sample() rejects costs one thread-local random draw and no clock reads.
+ * With ALLOCATOR_TIMING set to 0 sample() is constant false and the timing code folds away.
+ */
+class LatencyTimer {
+   public:
+    explicit LatencyTimer(const TimingOptions& options = TimingOptions());
+
+    /// Whether the next operation should be timed.
+    bool sample() const {
+#if ALLOCATOR_TIMING
+        return sampleRate == 1 || (sampleRate > 1 && sampled());
+#else
+        return false;
+#endif
+    }
+
+    /// Current reading of the configured clock, in ticks.
+    uint64_t now() const {
+#if defined(ALLOCATOR_HAS_TSC)
+        if (useTsc) {
+            return static_cast<uint64_t>(__rdtsc());
+        }
+#endif
+        auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count());
+    }
+
+    /// Nanoseconds since startTicks, a value returned by now().
+    uint64_t elapsedNanoseconds(uint64_t startTicks) const {
+        uint64_t ticks = now() - startTicks;
+        return useTsc ? static_cast<uint64_t>(static_cast<double>(ticks) * nanosecondsPerTick) : ticks;
+    }
+
+    /// Factor from sampled time to estimated total time.
+    double scale() const { return static_cast<double>(sampleRate); }
+
+    bool usesTsc() const { return useTsc; }
+
+   private:
+    size_t sampleRate;
+    bool useTsc;
+    double nanosecondsPerTick;
+
+    /// Bernoulli(1 / sampleRate) draw from a per-thread xorshift generator.
+    bool sampled() const {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return ((state >> 32) * sampleRate >> 32) == 0;
+    }
+};
+
+#endif  // LATENCY_HISTOGRAM_H
@@ -0,0 +1,83 @@
+#ifndef LOCK_CONTENTION_H
+#define LOCK_CONTENTION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "latency_histogram.h"  // ALLOCATOR_TIMING
+
+/**
+ * @struct LockContention
+ * @brief How often a ContentionMutex was acquired, how often it was already held, and how long
+ *        the waiting threads blocked in total.
+ */
+struct LockContention {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;        ///< Acquisitions that found the mutex held and had to wait
+    uint64_t waitNanoseconds = 0;  ///< Summed over contended acquisitions
+
+    /// Fraction of acquisitions that had to wait.
+    double contendedFraction() const {
+        return acquisitions > 0 ? static_cast<double>(contended) / static_cast<double>(acquisitions) : 0.0;
+    }
+};
+
+/**
+ * @class ContentionMutex
+ * @brief std::mutex that counts its acquisitions and times the ones that have to wait.
+ *
+ * lock() first tries the mutex; only when that fails does it read the clock around the blocking
+ * lock, so an uncontended acquisition costs a try_lock and a counter update made while holding
+ * the mutex. Usable with std::lock_guard and std::unique_lock. With ALLOCATOR_TIMING set to 0 it
+ * is a plain mutex and contention() reports zeros.
+ */
+class ContentionMutex {
+   public:
+    void lock() {
+#if ALLOCATOR_TIMING
+        if (!mutex.try_lock()) {
+            auto start = std::chrono::steady_clock::now();
+            mutex.lock();
+            auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            // Written only by the holder, so a load and store suffice; readers may see a stale value
+            contended.store(contended.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            waitNanoseconds.store(waitNanoseconds.load(std::memory_order_relaxed) + static_cast<uint64_t>(waited.count()),
+                                  std::memory_order_relaxed);
+        }
+        acquisitions.store(acquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+#else
+        mutex.lock();
+#endif
+    }
+
+    bool try_lock() {
+        if (!mutex.try_lock()) {
+            return false;
+        }
+#if ALLOCATOR_TIMING
+        acquisitions.store(acquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+#endif
+        return true;
+    }
+
+    void unlock() { mutex.unlock(); }
+
+    /// Counters so far; safe to call while other threads use the mutex.
+    LockContention contention() const {
+        LockContention result;
+        result.acquisitions = acquisitions.load(std::memory_order_relaxed);
+        result.contended = contended.load(std::memory_order_relaxed);
+        result.waitNanoseconds = waitNanoseconds.load(std::memory_order_relaxed);
+        return result;
+    }
+
+   private:
+    std::mutex mutex;
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> waitNanoseconds{0};
+};
+
+#endif  // LOCK_CONTENTION_H
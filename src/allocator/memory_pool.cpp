@@ -0,0 +1,175 @@
+// memory_pool.cpp
+#include "memory_pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define MEMORY_POOL_HAS_MMAP 1
+#endif
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+#endif
+
+namespace {
+
+size_t systemPageSize() {
+#if defined(MEMORY_POOL_HAS_MMAP)
+    long size = sysconf(_SC_PAGESIZE);
+    if (size > 0) {
+        return static_cast<size_t>(size);
+    }
+#endif
+    return 4096;
+}
+
+#if defined(MEMORY_POOL_HAS_MMAP)
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+#endif
+
+}  // namespace
+
+MemoryPool::MemoryPool(size_t size, const PoolOptions& options)
+    : base(nullptr), allocation(nullptr), poolSize(size), mappedSize(0), hugeTlb(false) {
+    bool prefaulted = false;
+    if (options.useMmap || options.hugePages || options.numaNode >= 0) {
+        prefaulted = mapPages(options);
+    } else {
+        // Over-allocate so the base can be rounded up to the alignment mmap would have given
+        size_t alignment = std::max<size_t>(std::min(poolSize & (~poolSize + 1), systemPageSize()), 1);
+        allocation = poolSize < SIZE_MAX - alignment ? std::malloc(poolSize + alignment - 1) : nullptr;
+        if (!allocation) {
+            throw std::bad_alloc();
+        }
+        uintptr_t address = reinterpret_cast<uintptr_t>(allocation);
+        base = reinterpret_cast<void*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+    }
+
+    if (options.prefault && !prefaulted) {
+        touchPages();
+    }
+}
+
+MemoryPool::~MemoryPool() {
+    release();
+}
+
+/**
+ * @brief Maps the pool, applying the huge page and NUMA options.
+ * @return true if the pages were already populated by the mapping itself.
+ */
+bool MemoryPool::mapPages(const PoolOptions& options) {
+#if defined(MEMORY_POOL_HAS_MMAP)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    bool populate = false;
+    #if defined(MAP_POPULATE)
+    // A NUMA policy only affects pages faulted after it is set, so populate later in that case
+    if (options.prefault && options.numaNode < 0) {
+        flags |= MAP_POPULATE;
+        populate = true;
+    }
+    #endif
+
+    #if defined(MAP_HUGETLB)
+    if (options.hugePages) {
+        // Default huge page size on x86-64 and aarch64; MAP_HUGETLB lengths must be a multiple of it
+        constexpr size_t hugePageSize = static_cast<size_t>(2) * 1024 * 1024;
+        size_t length = roundUp(poolSize, hugePageSize);
+        void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if (mapped != MAP_FAILED) {
+            base = mapped;
+            mappedSize = length;
+            hugeTlb = true;
+        }
+    }
+    #endif
+
+    if (!base) {
+        // No reserved huge pages (or not requested): regular pages, with THP advice if asked
+        size_t length = roundUp(poolSize, systemPageSize());
+        void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        base = mapped;
+        mappedSize = length;
+    #if defined(MADV_HUGEPAGE)
+        if (options.hugePages) {
+            madvise(base, mappedSize, MADV_HUGEPAGE);  // Advisory; ignored when THP is disabled
+        }
+    #endif
+    }
+
+    if (options.numaNode >= 0) {
+        bindToNode(options.numaNode);
+    }
+    return populate;
+#else
+    (void)options;
+    throw std::invalid_argument("MemoryPool: mmap-backed pools are not supported on this platform");
+#endif
+}
+
+/**
+ * @brief Binds the mapped pages to one NUMA node with mbind(MPOL_BIND).
+ *
+ * Releases the mapping and throws std::system_error if the kernel rejects the binding.
+ */
+void MemoryPool::bindToNode(int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    constexpr int mpolBind = 2;  // MPOL_BIND from <linux/mempolicy.h>, so libnuma is not required
+    constexpr size_t bitsPerWord = 8 * sizeof(unsigned long);
+    size_t nodeIndex = static_cast<size_t>(node);
+    std::vector<unsigned long> nodeMask(nodeIndex / bitsPerWord + 1, 0);
+    nodeMask[nodeIndex / bitsPerWord] |= 1UL << (nodeIndex % bitsPerWord);
+
+    // The kernel reads maxnode - 1 bits from the mask
+    unsigned long maxNode = static_cast<unsigned long>(nodeMask.size() * bitsPerWord + 1);
+    if (syscall(SYS_mbind, base, mappedSize, mpolBind, nodeMask.data(), maxNode, 0) != 0) {
+        int error = errno;
+        release();
+        throw std::system_error(error, std::generic_category(), "MemoryPool: mbind to NUMA node failed");
+    }
+#else
+    (void)node;
+    release();
+    throw std::invalid_argument("MemoryPool: NUMA binding is only supported on Linux");
+#endif
+}
+
+/**
+ * @brief Writes one byte per page so every page is faulted in before the pool is used.
+ */
+void MemoryPool::touchPages() {
+    volatile char* bytes = static_cast<volatile char*>(base);
+    size_t stride = systemPageSize();
+    for (size_t offset = 0; offset < poolSize; offset += stride) {
+        bytes[offset] = 0;
+    }
+}
+
+void MemoryPool::release() {
+    if (!base) {
+        return;
+    }
+#if defined(MEMORY_POOL_HAS_MMAP)
+    if (mappedSize != 0) {
+        munmap(base, mappedSize);
+    }
+#endif
+    std::free(allocation);
+    base = nullptr;
+    allocation = nullptr;
+    mappedSize = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstddef>
+
+/**
+ * @struct PoolOptions
+ * @brief Where the backing memory of an allocator pool comes from and how its pages are placed.
+ *
+ * A default-constructed value reproduces the original std::malloc-backed pool.
+ */
+struct PoolOptions {
+    bool useMmap = false;    ///< Map the pool with mmap instead of std::malloc (POSIX only)
+    bool hugePages = false;  ///< Try MAP_HUGETLB, else advise transparent huge pages; implies useMmap
+    int numaNode = -1;       ///< Bind the pages to this NUMA node (Linux only; -1 = no binding); implies useMmap
+    bool prefault = false;   ///< Touch every page up front so the first accesses do not fault
+};
+
+/**
+ * @class MemoryPool
+ * @brief Owns the raw memory behind one allocator pool.
+ *
+ * The base is aligned to the pool size or the page size, whichever is smaller, so buddy blocks
+ * (aligned to their size relative to the base) are aligned in absolute terms up to a page.
+ * The memory is released when the pool is destroyed. Construction throws std::bad_alloc if the
+ * memory cannot be obtained, and std::system_error if a requested NUMA binding fails.
+ */
+class MemoryPool {
+   public:
+    MemoryPool(size_t size, const PoolOptions& options = PoolOptions());
+    ~MemoryPool();
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    void* data() const { return base; }
+    size_t size() const { return poolSize; }
+
+    /// True if the pool was obtained with mmap.
+    bool isMapped() const { return mappedSize != 0; }
+
+    /// True if the pool is backed by explicitly reserved huge pages (MAP_HUGETLB).
+    bool usesHugeTlb() const { return hugeTlb; }
+
+   private:
+    void* base;
+    void* allocation;  // What std::malloc returned, for malloc pools; base is rounded up from it
+    size_t poolSize;
+    size_t mappedSize;  // Length passed to mmap, rounded up to the page size; 0 for malloc pools
+    bool hugeTlb;
+
+    bool mapPages(const PoolOptions& options);
+    void bindToNode(int node);
+    void touchPages();
+    void release();
+};
+
+#endif  // MEMORY_POOL_H
@@ -0,0 +1,165 @@
+// sharded_allocator.cpp
+#include "sharded_allocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+namespace {
+
+/// Source of per-instance ids for the thread-to-arena table.
+std::atomic<uint64_t> nextShardedInstanceId{1};
+
+/**
+ * @brief Per-thread arena assignments, keyed by ShardedAllocator instance id.
+ */
+struct ThreadArenaSlot {
+    uint64_t allocatorId;
+    size_t arena;
+};
+
+std::vector<ThreadArenaSlot>& threadArenaSlots() {
+    thread_local std::vector<ThreadArenaSlot> slots;
+    return slots;
+}
+
+}  // namespace
+
+ShardedAllocator::ShardedAllocator(size_t min_order, size_t max_order, size_t numArenas, ArenaRouting routing,
+                                   const AllocatorOptions& options)
+    : routing(routing),
+      instanceId(nextShardedInstanceId.fetch_add(1, std::memory_order_relaxed)),
+      nextThreadArena(0) {
+    if (numArenas == 0) {
+        numArenas = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    arenas.reserve(numArenas);
+    arenaRanges.reserve(numArenas);
+    for (size_t i = 0; i < numArenas; ++i) {
+        arenas.push_back(std::make_unique<CustomAllocator>(min_order, max_order, options));
+        arenaRanges.emplace_back(reinterpret_cast<uintptr_t>(arenas.back()->getPoolBase()), i);
+    }
+    std::sort(arenaRanges.begin(), arenaRanges.end());
+}
+
+/**
+ * @brief Picks the arena the calling thread should allocate from.
+ */
+size_t ShardedAllocator::homeArena() {
+#if defined(__linux__)
+    if (routing == ArenaRouting::Cpu) {
+        int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return static_cast<size_t>(cpu) % arenas.size();
+        }
+    }
+#endif
+
+    std::vector<ThreadArenaSlot>& slots = threadArenaSlots();
+    for (const ThreadArenaSlot& slot : slots) {
+        if (slot.allocatorId == instanceId) {
+            return slot.arena;
+        }
+    }
+    size_t arena = nextThreadArena.fetch_add(1, std::memory_order_relaxed) % arenas.size();
+    slots.push_back({instanceId, arena});
+    return arena;
+}
+
+/**
+ * @brief Allocates from the caller's home arena, falling back to the others when it is full.
+ * @param size The minimum size to allocate.
+ * @return Pointer to the allocated memory or nullptr if every arena is exhausted.
+ */
+void* ShardedAllocator::allocate(size_t size) {
+    size_t home = homeArena();
+    void* ptr = arenas[home]->allocate(size);
+    if (ptr) {
+        return ptr;
+    }
+
+    for (size_t i = 1; i < arenas.size(); ++i) {
+        ptr = arenas[(home + i) % arenas.size()]->allocate(size);
+        if (ptr) {
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns memory to the arena that owns it, whichever thread frees it.
+ * @param ptr Pointer previously returned by allocate(); pointers from elsewhere are ignored.
+ */
+void ShardedAllocator::deallocate(void* ptr) {
+    CustomAllocator* owner = findOwner(ptr);
+    if (owner) {
+        owner->deallocate(ptr);
+    }
+}
+
+CustomAllocator* ShardedAllocator::findOwner(const void* ptr) const {
+    if (!ptr) {
+        return nullptr;
+    }
+
+    // Last arena whose pool starts at or below ptr
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    auto it = std::upper_bound(arenaRanges.begin(), arenaRanges.end(), address,
+                               [](uintptr_t value, const std::pair<uintptr_t, size_t>& range) {
+                                   return value < range.first;
+                               });
+    if (it == arenaRanges.begin()) {
+        return nullptr;
+    }
+    CustomAllocator* candidate = arenas[std::prev(it)->second].get();
+    return candidate->owns(ptr) ? candidate : nullptr;
+}
+
+double ShardedAllocator::getAllocationTime() const {
+    double total = 0.0;
+    for (const auto& arena : arenas) {
+        total += arena->getAllocationTime();
+    }
+    return total;
+}
+
+double ShardedAllocator::getDeallocationTime() const {
+    double total = 0.0;
+    for (const auto& arena : arenas) {
+        total += arena->getDeallocationTime();
+    }
+    return total;
+}
+
+/**
+ * @brief Free fraction of the combined pools; every arena has the same size, so this is the mean.
+ */
+double ShardedAllocator::getFragmentation() const {
+    double total = 0.0;
+    for (const auto& arena : arenas) {
+        total += arena->getFragmentation();
+    }
+    return total / static_cast<double>(arenas.size());
+}
+
+size_t ShardedAllocator::getTotalAllocations() const {
+    size_t total = 0;
+    for (const auto& arena : arenas) {
+        total += arena->getTotalAllocations();
+    }
+    return total;
+}
+
+size_t ShardedAllocator::getTotalDeallocations() const {
+    size_t total = 0;
+    for (const auto& arena : arenas) {
+        total += arena->getTotalDeallocations();
+    }
+    return total;
+}
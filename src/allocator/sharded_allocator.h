@@ -0,0 +1,72 @@
+#ifndef SHARDED_ALLOCATOR_H
+#define SHARDED_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "custom_allocator.h"
+
+/**
+ * @enum ArenaRouting
+ * @brief Policy used by ShardedAllocator to pick the arena for an allocation.
+ */
+enum class ArenaRouting {
+    Thread,  ///< Each thread is pinned to an arena, assigned round-robin on first use
+    Cpu      ///< Use the arena of the CPU the caller is running on (Linux only; falls back to Thread)
+};
+
+/**
+ * @class ShardedAllocator
+ * @brief Front end that spreads allocations over several independent buddy arenas.
+ *
+ * Each arena is a complete CustomAllocator with its own pool and mutex, so threads routed to
+ * different arenas never contend. Allocations fall back to the other arenas when the home arena
+ * is exhausted, and deallocations are routed back to the owning arena by address range.
+ */
+class ShardedAllocator {
+   public:
+    /**
+     * @brief Creates the arena set.
+     * @param min_order Minimum block order of each arena.
+     * @param max_order Maximum block order (pool size) of each arena.
+     * @param numArenas Number of arenas; 0 selects one per hardware thread.
+     * @param routing How allocations are mapped to arenas.
+     * @param options Options applied to every arena.
+     */
+    ShardedAllocator(size_t min_order, size_t max_order, size_t numArenas = 0,
+                     ArenaRouting routing = ArenaRouting::Thread, const AllocatorOptions& options = AllocatorOptions());
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr);
+
+    /**
+     * @brief Finds the arena whose pool contains ptr.
+     * @return The owning arena, or nullptr if ptr was not allocated here.
+     */
+    CustomAllocator* findOwner(const void* ptr) const;
+
+    size_t getArenaCount() const { return arenas.size(); }
+    CustomAllocator& getArena(size_t index) { return *arenas[index]; }
+
+    // Aggregated metrics across all arenas
+    double getAllocationTime() const;
+    double getDeallocationTime() const;
+    double getFragmentation() const;
+    size_t getTotalAllocations() const;
+    size_t getTotalDeallocations() const;
+
+   private:
+    std::vector<std::unique_ptr<CustomAllocator>> arenas;
+    std::vector<std::pair<uintptr_t, size_t>> arenaRanges;  ///< (pool base, arena index), sorted by base
+    ArenaRouting routing;
+    uint64_t instanceId;
+    std::atomic<size_t> nextThreadArena;
+
+    size_t homeArena();
+};
+
+#endif  // SHARDED_ALLOCATOR_H
@@ -0,0 +1,387 @@
+// slab_allocator.cpp
+#include "slab_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace {
+
+/// Candidate object sizes: 16-byte steps up to 128, then four classes per power of two.
+constexpr size_t CANDIDATE_CLASSES[] = {16,  32,  48,  64,  80,  96,   112,  128,  160,  192,  224,  256,
+                                        320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048};
+
+/// A class is only worth a slab if the slab holds at least this many objects.
+constexpr size_t MIN_OBJECTS_PER_SLAB = 8;
+
+/**
+ * @brief Returns the index of the lowest set bit; value must be non-zero.
+ */
+inline size_t countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+}
+
+inline size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+SlabAllocator::SlabAllocator(size_t min_order, size_t max_order, size_t slab_order, const AllocatorOptions& options)
+    : buddy(min_order, max_order, options),
+      timer(options.timing),
+      slabOrder(slab_order),
+      slabSize(static_cast<size_t>(1) << slab_order),
+      pageOverhead(buddy.getPoolSize() - buddy.getMaxAllocationSize()),
+      poolBase(static_cast<const char*>(buddy.getPoolBase())),
+      classCount(0),
+      maxSlabObjectSize(0),
+      largeAllocations(0),
+      largeDeallocations(0),
+      slabAllocations(0),
+      slabDeallocations(0) {
+    if (slab_order < min_order || slab_order > max_order) {
+        throw std::invalid_argument("SlabAllocator: slab order must be within [min_order, max_order]");
+    }
+    pageClasses.assign(buddy.getPoolSize() >> slabOrder, 0);
+    buildClasses();
+}
+
+SlabAllocator::~SlabAllocator() = default;  // Slabs live in the buddy pool, released with it
+
+/**
+ * @brief Lays out every candidate class that fits enough objects in a slab and fills the
+ *        size lookup table.
+ */
+void SlabAllocator::buildClasses() {
+    constexpr size_t candidateCount = sizeof(CANDIDATE_CLASSES) / sizeof(CANDIDATE_CLASSES[0]);
+    classes = std::make_unique<SizeClass[]>(candidateCount);
+
+    size_t usable = slabSize - pageOverhead;
+    for (size_t objectSize : CANDIDATE_CLASSES) {
+        // The bitmap shrinks the space for objects, which may in turn shrink the bitmap
+        size_t capacity = usable / objectSize;
+        size_t bitmapWords = 0;
+        size_t objectOffset = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            bitmapWords = (capacity + 63) / 64;
+            objectOffset = roundUp(sizeof(Slab) + bitmapWords * sizeof(uint64_t), CLASS_GRANULARITY);
+            capacity = objectOffset < usable ? (usable - objectOffset) / objectSize : 0;
+        }
+        if (capacity < MIN_OBJECTS_PER_SLAB) {
+            break;  // Larger classes fit even fewer objects
+        }
+
+        SizeClass& sizeClass = classes[classCount++];
+        sizeClass.objectSize = objectSize;
+        sizeClass.capacity = capacity;
+        sizeClass.bitmapWords = bitmapWords;
+        sizeClass.objectOffset = objectOffset;
+        maxSlabObjectSize = objectSize;
+    }
+
+    classLookup.assign(maxSlabObjectSize / CLASS_GRANULARITY + 1, 0);
+    size_t classIndex = 0;
+    for (size_t slot = 0; slot < classLookup.size() && classIndex < classCount; ++slot) {
+        while (classes[classIndex].objectSize < slot * CLASS_GRANULARITY) {
+            ++classIndex;
+        }
+        classLookup[slot] = static_cast<uint8_t>(classIndex);
+    }
+}
+
+/**
+ * @brief Allocates from the size class covering size, or from the buddy allocator if none does.
+ * @param size The minimum size to allocate.
+ * @return Pointer to memory aligned to std::max_align_t, or nullptr if the pool is exhausted.
+ */
+void* SlabAllocator::allocate(size_t size) {
+    if (size == 0) {
+        size = 1;  // Allocate at least 1 byte
+    }
+    if (size <= maxSlabObjectSize) {
+        return allocateFromSlab(classLookup[(size + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY]);
+    }
+
+    bool timed = timer.sample();
+    uint64_t startTicks = timed ? timer.now() : 0;
+    void* ptr = buddy.allocate(size);
+    if (timed) {
+        largeAllocationLatency.record(timer.elapsedNanoseconds(startTicks));
+    }
+    if (ptr) {
+        largeAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Returns memory to its slab or to the buddy allocator.
+ * @param ptr Pointer previously returned by allocate(); null and foreign pointers are ignored.
+ */
+void SlabAllocator::deallocate(void* ptr) {
+    if (!ptr || !buddy.owns(ptr)) {
+        return;
+    }
+
+    size_t pageIndex = pageIndexOf(ptr);
+    uint8_t pageClass = pageClasses[pageIndex];
+    if (pageClass != 0) {
+        deallocateToSlab(ptr, pageIndex, pageClass - 1);
+        return;
+    }
+
+    bool timed = timer.sample();
+    uint64_t startTicks = timed ? timer.now() : 0;
+    buddy.deallocate(ptr);
+    if (timed) {
+        largeDeallocationLatency.record(timer.elapsedNanoseconds(startTicks));
+    }
+    largeDeallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* SlabAllocator::allocateFromSlab(size_t classIndex) {
+    SizeClass& sizeClass = classes[classIndex];
+    bool timed = timer.sample();
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    uint64_t startTicks = timed ? timer.now() : 0;
+
+    Slab* slab = sizeClass.partial;
+    if (!slab) {
+        if (sizeClass.spare) {
+            slab = sizeClass.spare;
+            sizeClass.spare = nullptr;
+        } else {
+            slab = createSlab(sizeClass, classIndex);
+            if (!slab) {
+                return nullptr;
+            }
+        }
+        pushPartial(sizeClass, slab);
+    }
+
+    uint64_t* bits = slab->freeBits();
+    size_t word = slab->freeWordHint;
+    while (bits[word] == 0) {
+        ++word;  // freeCount > 0 guarantees a set bit at or after the hint
+    }
+    size_t bit = countTrailingZeros(bits[word]);
+    bits[word] &= bits[word] - 1;
+    slab->freeWordHint = word;
+    if (--slab->freeCount == 0) {
+        removePartial(sizeClass, slab);
+    }
+    ++sizeClass.liveObjects;
+
+    void* ptr = objectsOf(slab, sizeClass) + (word * 64 + bit) * sizeClass.objectSize;
+    if (timed) {
+        sizeClass.allocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+    slabAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+void SlabAllocator::deallocateToSlab(void* ptr, size_t pageIndex, size_t classIndex) {
+    SizeClass& sizeClass = classes[classIndex];
+    bool timed = timer.sample();
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    uint64_t startTicks = timed ? timer.now() : 0;
+
+    Slab* slab = slabAt(pageIndex);
+    const char* objects = objectsOf(slab, sizeClass);
+    const char* object = static_cast<const char*>(ptr);
+    if (object < objects) {
+        return;  // Points into the slab header
+    }
+    size_t offset = static_cast<size_t>(object - objects);
+    size_t index = offset / sizeClass.objectSize;
+    if (index >= sizeClass.capacity || index * sizeClass.objectSize != offset) {
+        return;  // Not the start of an object
+    }
+
+    uint64_t* bits = slab->freeBits();
+    size_t word = index / 64;
+    uint64_t mask = static_cast<uint64_t>(1) << (index % 64);
+    if (bits[word] & mask) {
+        return;  // Double free
+    }
+    bits[word] |= mask;
+    if (word < slab->freeWordHint) {
+        slab->freeWordHint = word;
+    }
+    --sizeClass.liveObjects;
+
+    if (++slab->freeCount == 1) {
+        pushPartial(sizeClass, slab);  // Was full
+    } else if (slab->freeCount == sizeClass.capacity) {
+        removePartial(sizeClass, slab);
+        if (sizeClass.spare) {
+            destroySlab(slab, sizeClass);
+        } else {
+            sizeClass.spare = slab;
+        }
+    }
+
+    if (timed) {
+        sizeClass.deallocationLatency.recordOwned(timer.elapsedNanoseconds(startTicks));
+    }
+    slabDeallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Takes a page from the buddy allocator and formats it as an empty slab of one class.
+ * @return The new slab, or nullptr if the buddy pool has no free page.
+ */
+SlabAllocator::Slab* SlabAllocator::createSlab(SizeClass& sizeClass, size_t classIndex) {
+    // Asking for the page minus the buddy header lands exactly on slabOrder, page-aligned
+    void* page = buddy.allocate(slabSize - pageOverhead);
+    if (!page) {
+        return nullptr;
+    }
+
+    Slab* slab = static_cast<Slab*>(page);
+    slab->next = nullptr;
+    slab->prev = nullptr;
+    slab->freeCount = sizeClass.capacity;
+    slab->freeWordHint = 0;
+
+    uint64_t* bits = slab->freeBits();
+    std::memset(bits, 0xFF, sizeClass.bitmapWords * sizeof(uint64_t));
+    size_t tailBits = sizeClass.capacity % 64;
+    if (tailBits != 0) {
+        bits[sizeClass.bitmapWords - 1] = (static_cast<uint64_t>(1) << tailBits) - 1;
+    }
+
+    pageClasses[pageIndexOf(page)] = static_cast<uint8_t>(classIndex + 1);
+    ++sizeClass.slabCount;
+    return slab;
+}
+
+void SlabAllocator::destroySlab(Slab* slab, SizeClass& sizeClass) {
+    pageClasses[pageIndexOf(slab)] = 0;
+    --sizeClass.slabCount;
+    buddy.deallocate(slab);
+}
+
+void SlabAllocator::pushPartial(SizeClass& sizeClass, Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = sizeClass.partial;
+    if (sizeClass.partial) {
+        sizeClass.partial->prev = slab;
+    }
+    sizeClass.partial = slab;
+}
+
+void SlabAllocator::removePartial(SizeClass& sizeClass, Slab* slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        sizeClass.partial = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+    slab->next = nullptr;
+    slab->prev = nullptr;
+}
+
+size_t SlabAllocator::pageIndexOf(const void* ptr) const {
+    return static_cast<size_t>(static_cast<const char*>(ptr) - poolBase) >> slabOrder;
+}
+
+SlabAllocator::Slab* SlabAllocator::slabAt(size_t pageIndex) const {
+    return reinterpret_cast<Slab*>(const_cast<char*>(poolBase) + (pageIndex << slabOrder) + pageOverhead);
+}
+
+char* SlabAllocator::objectsOf(Slab* slab, const SizeClass& sizeClass) const {
+    return reinterpret_cast<char*>(slab) + sizeClass.objectOffset;
+}
+
+void SlabAllocator::releaseEmptySlabs() {
+    for (size_t i = 0; i < classCount; ++i) {
+        SizeClass& sizeClass = classes[i];
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if (sizeClass.spare) {
+            destroySlab(sizeClass.spare, sizeClass);
+            sizeClass.spare = nullptr;
+        }
+    }
+}
+
+size_t SlabAllocator::getMaxSlabObjectSize() const {
+    return maxSlabObjectSize;
+}
+
+size_t SlabAllocator::getSizeClass(size_t size) const {
+    if (size > maxSlabObjectSize) {
+        return 0;
+    }
+    size_t slot = (std::max<size_t>(size, 1) + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY;
+    return classes[classLookup[slot]].objectSize;
+}
+
+size_t SlabAllocator::getSlabCount() const {
+    size_t total = 0;
+    for (size_t i = 0; i < classCount; ++i) {
+        std::lock_guard<std::mutex> lock(classes[i].mutex);
+        total += classes[i].slabCount;
+    }
+    return total;
+}
+
+double SlabAllocator::getSlabUtilization() const {
+    size_t liveBytes = 0;
+    size_t slabBytes = 0;
+    for (size_t i = 0; i < classCount; ++i) {
+        std::lock_guard<std::mutex> lock(classes[i].mutex);
+        liveBytes += classes[i].liveObjects * classes[i].objectSize;
+        slabBytes += classes[i].slabCount * slabSize;
+    }
+    return slabBytes == 0 ? 1.0 : static_cast<double>(liveBytes) / static_cast<double>(slabBytes);
+}
+
+double SlabAllocator::getAllocationTime() const {
+    return static_cast<double>(getLatencyStats().allocation.totalNanoseconds) * timer.scale() * 1e-9;
+}
+
+double SlabAllocator::getDeallocationTime() const {
+    return static_cast<double>(getLatencyStats().deallocation.totalNanoseconds) * timer.scale() * 1e-9;
+}
+
+/**
+ * @brief Merges the large-request histograms and those of every class; threads counts the class
+ *        histogram pairs merged, the large-request pair included.
+ */
+LatencyStats SlabAllocator::getLatencyStats() const {
+    LatencyStats stats;
+    largeAllocationLatency.addTo(stats.allocation);
+    largeDeallocationLatency.addTo(stats.deallocation);
+    for (size_t i = 0; i < classCount; ++i) {
+        classes[i].allocationLatency.addTo(stats.allocation);
+        classes[i].deallocationLatency.addTo(stats.deallocation);
+    }
+    stats.threads = classCount + 1;
+    return stats;
+}
+
+double SlabAllocator::getFragmentation() const {
+    return buddy.getFragmentation();
+}
+
+size_t SlabAllocator::getTotalAllocations() const {
+    return slabAllocations.load(std::memory_order_relaxed) + largeAllocations.load(std::memory_order_relaxed);
+}
+
+size_t SlabAllocator::getTotalDeallocations() const {
+    return slabDeallocations.load(std::memory_order_relaxed) + largeDeallocations.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,149 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "custom_allocator.h"
+
+/**
+ * @class SlabAllocator
+ * @brief Size-class front end that packs small objects into slabs carved from buddy pages.
+ *
+ * A power-of-two buddy block wastes up to half of every small request plus its header; a 72-byte
+ * object costs a 128-byte block. Requests up to the largest size class are instead rounded to one
+ * of a set of 16-byte-granular classes and served from slabs: buddy blocks of 1 << slab_order
+ * bytes ("pages"), each holding objects of a single class and a free bitmap in a small header at
+ * its start. Larger requests go straight to the underlying CustomAllocator.
+ *
+ * Every class has its own mutex and list of partially used slabs, so small allocations of
+ * different classes do not contend with each other or with the buddy lock. Slabs that become
+ * empty are returned to the buddy allocator, except for one spare per class, kept so that a
+ * workload hovering around a slab boundary does not split and merge a page on every operation.
+ */
+class SlabAllocator {
+   public:
+    /**
+     * @brief Creates the slab layer and its underlying buddy allocator.
+     * @param min_order Minimum block order of the buddy allocator.
+     * @param max_order Maximum block order (pool size) of the buddy allocator.
+     * @param slab_order Order of the buddy blocks slabs are carved from; must be within
+     *        [min_order, max_order]. Classes that would fit fewer than 8 objects in a slab are
+     *        disabled, so small slab orders route more sizes to the buddy allocator.
+     * @param options Options for the underlying buddy allocator.
+     */
+    SlabAllocator(size_t min_order, size_t max_order, size_t slab_order = 14,
+                  const AllocatorOptions& options = AllocatorOptions());
+    ~SlabAllocator();
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr);
+
+    /**
+     * @brief Returns the spare empty slab of every class to the buddy allocator.
+     */
+    void releaseEmptySlabs();
+
+    /// Largest request served from a slab; larger requests use the buddy allocator.
+    size_t getMaxSlabObjectSize() const;
+
+    /// Object size a request is rounded to, or 0 if it is served by the buddy allocator.
+    size_t getSizeClass(size_t size) const;
+
+    /// Slab pages currently taken from the buddy allocator, spares included.
+    size_t getSlabCount() const;
+
+    /// Bytes of live slab objects divided by bytes of slab pages; 1.0 when no slab is mapped.
+    double getSlabUtilization() const;
+
+    const CustomAllocator& getBuddyAllocator() const { return buddy; }
+
+    // Performance metrics; slab and buddy paths combined
+    double getAllocationTime() const;
+    double getDeallocationTime() const;
+
+    /**
+     * @brief Latency distributions of slab and large requests, merged from the per-class
+     *        histograms; sampled and clocked per the buddy allocator's TimingOptions.
+     */
+    LatencyStats getLatencyStats() const;
+    double getFragmentation() const;  // Free fraction of the buddy pool; slab pages count as used
+    size_t getTotalAllocations() const;
+    size_t getTotalDeallocations() const;
+
+   private:
+    /**
+     * @brief Header at the start of every slab, followed by the free bitmap and the objects.
+     */
+    struct Slab {
+        Slab* next;  // Partial list links
+        Slab* prev;
+        size_t freeCount;
+        size_t freeWordHint;  // No free bit below this bitmap word
+        uint64_t* freeBits() { return reinterpret_cast<uint64_t*>(this + 1); }
+    };
+
+    struct SizeClass {
+        size_t objectSize = 0;
+        size_t capacity = 0;      // Objects per slab
+        size_t bitmapWords = 0;
+        size_t objectOffset = 0;  // From the slab header to the first object
+        Slab* partial = nullptr;  // Slabs with at least one free and one used object (or fresh)
+        Slab* spare = nullptr;    // One retained empty slab
+        size_t slabCount = 0;
+        size_t liveObjects = 0;
+        LatencyHistogram allocationLatency;  // Recorded under mutex
+        LatencyHistogram deallocationLatency;
+        mutable std::mutex mutex;
+    };
+
+    static constexpr size_t CLASS_GRANULARITY = 16;
+
+    CustomAllocator buddy;
+    LatencyTimer timer;
+    size_t slabOrder;
+    size_t slabSize;
+    size_t pageOverhead;  // Bytes the buddy allocator keeps in front of each page (its block header)
+    const char* poolBase;
+
+    std::unique_ptr<SizeClass[]> classes;
+    size_t classCount;
+    std::vector<uint8_t> classLookup;  // (size + 15) / 16 -> index of the smallest class that fits
+    size_t maxSlabObjectSize;
+
+    // Class index + 1 of the slab occupying each page-sized chunk of the pool, 0 = not a slab.
+    // Written under the class mutex before the page's objects are handed out and cleared before
+    // the page goes back to the buddy allocator, so readers always see the value for their object.
+    std::vector<uint8_t> pageClasses;
+
+    // Large-request metrics (slab metrics live in each SizeClass)
+    LatencyHistogram largeAllocationLatency;
+    LatencyHistogram largeDeallocationLatency;
+    std::atomic<size_t> largeAllocations;
+    std::atomic<size_t> largeDeallocations;
+    std::atomic<size_t> slabAllocations;
+    std::atomic<size_t> slabDeallocations;
+
+    void buildClasses();
+    size_t pageIndexOf(const void* ptr) const;
+    Slab* slabAt(size_t pageIndex) const;
+    char* objectsOf(Slab* slab, const SizeClass& sizeClass) const;
+
+    // Callers must hold the class mutex
+    Slab* createSlab(SizeClass& sizeClass, size_t classIndex);
+    void destroySlab(Slab* slab, SizeClass& sizeClass);
+    static void pushPartial(SizeClass& sizeClass, Slab* slab);
+    static void removePartial(SizeClass& sizeClass, Slab* slab);
+
+    void* allocateFromSlab(size_t classIndex);
+    void deallocateToSlab(void* ptr, size_t pageIndex, size_t classIndex);
+};
+
+#endif  // SLAB_ALLOCATOR_H
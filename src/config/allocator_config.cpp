@@ -0,0 +1,27 @@
+#include "allocator_config.h"
+
+AllocatorOptions allocatorOptionsFromConfig(const ConfigManager& config) {
+    AllocatorOptions options;
+    options.threadCache = config.getBool("thread-cache", false);
+    options.magazineSize = config.getSize("magazine-size", 32);
+    options.lockFree = config.getBool("lock-free", false);
+    options.lockFreeDepth = config.getSize("lock-free-depth", 64);
+    options.deferredCoalescing = config.getBool("deferred-coalescing", false);
+    options.deferredWatermark = config.getSize("deferred-watermark", 64);
+    options.coalesceThreshold = config.getDouble("coalesce-threshold", 0.75);
+    options.headerless = config.getBool("headerless", false);
+    options.pool.useMmap = config.getBool("mmap", false);
+    options.pool.hugePages = config.getBool("huge-pages", false);
+    options.pool.numaNode = config.getInt("numa-node", -1);
+    options.pool.prefault = config.getBool("prefault", false);
+    options.timing.sampleRate = config.getSize("timing-sample-rate", 1);
+    options.timing.useTsc = config.getBool("timing-tsc", false);
+    return options;
+}
+
+GrowableOptions growableOptionsFromConfig(const ConfigManager& config) {
+    GrowableOptions growth;
+    growth.maxArenas = config.getSize("max-arenas", 0);
+    growth.retainEmptyArenas = config.getSize("retain-empty-arenas", 1);
+    return growth;
+}
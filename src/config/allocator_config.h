@@ -0,0 +1,24 @@
+#ifndef ALLOCATOR_CONFIG_H
+#define ALLOCATOR_CONFIG_H
+
+#include "config_manager.h"
+#include "custom_allocator.h"
+#include "growable_allocator.h"
+
+/**
+ * @brief Builds the allocator options every driver shares from the [allocator] settings.
+ *
+ * The one place a new allocator key is mapped, so no driver silently ignores it. The pool
+ * orders stay with the caller (min-order, max-order), as do options a benchmark overrides.
+ *
+ * @param config Loaded configuration, after parseCLI().
+ * @return Options for CustomAllocator and the allocators built on it.
+ */
+AllocatorOptions allocatorOptionsFromConfig(const ConfigManager& config);
+
+/**
+ * @brief Builds the growth policy of GrowableAllocator from max-arenas and retain-empty-arenas.
+ */
+GrowableOptions growableOptionsFromConfig(const ConfigManager& config);
+
+#endif  // ALLOCATOR_CONFIG_H
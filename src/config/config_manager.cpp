@@ -36,6 +36,58 @@ void ConfigManager::loadTomlConfig() {
             if (allocator.contains("alignment")) {
                 configValues["alignment"] = std::to_string(toml::find<int>(allocator, "alignment"));
             }
+            if (allocator.contains("thread_cache")) {
+                configValues["thread-cache"] = toml::find<bool>(allocator, "thread_cache") ? "true" : "false";
+            }
+            if (allocator.contains("magazine_size")) {
+                configValues["magazine-size"] = std::to_string(toml::find<int>(allocator, "magazine_size"));
+            }
+            if (allocator.contains("lock_free")) {
+                configValues["lock-free"] = toml::find<bool>(allocator, "lock_free") ? "true" : "false";
+            }
+            if (allocator.contains("lock_free_depth")) {
+                configValues["lock-free-depth"] = std::to_string(toml::find<int>(allocator, "lock_free_depth"));
+            }
+            if (allocator.contains("deferred_coalescing")) {
+                configValues["deferred-coalescing"] =
+                    toml::find<bool>(allocator, "deferred_coalescing") ? "true" : "false";
+            }
+            if (allocator.contains("deferred_watermark")) {
+                configValues["deferred-watermark"] = std::to_string(toml::find<int>(allocator, "deferred_watermark"));
+            }
+            if (allocator.contains("coalesce_threshold")) {
+                configValues["coalesce-threshold"] = std::to_string(toml::find<double>(allocator, "coalesce_threshold"));
+            }
+            if (allocator.contains("headerless")) {
+                configValues["headerless"] = toml::find<bool>(allocator, "headerless") ? "true" : "false";
+            }
+            if (allocator.contains("mmap")) {
+                configValues["mmap"] = toml::find<bool>(allocator, "mmap") ? "true" : "false";
+            }
+            if (allocator.contains("huge_pages")) {
+                configValues["huge-pages"] = toml::find<bool>(allocator, "huge_pages") ? "true" : "false";
+            }
+            if (allocator.contains("numa_node")) {
+                configValues["numa-node"] = std::to_string(toml::find<int>(allocator, "numa_node"));
+            }
+            if (allocator.contains("prefault")) {
+                configValues["prefault"] = toml::find<bool>(allocator, "prefault") ? "true" : "false";
+            }
+            if (allocator.contains("arenas")) {
+                configValues["arenas"] = std::to_string(toml::find<int>(allocator, "arenas"));
+            }
+            if (allocator.contains("max_arenas")) {
+                configValues["max-arenas"] = std::to_string(toml::find<int>(allocator, "max_arenas"));
+            }
+            if (allocator.contains("retain_empty_arenas")) {
+                configValues["retain-empty-arenas"] = std::to_string(toml::find<int>(allocator, "retain_empty_arenas"));
+            }
+            if (allocator.contains("timing_sample_rate")) {
+                configValues["timing-sample-rate"] = std::to_string(toml::find<int>(allocator, "timing_sample_rate"));
+            }
+            if (allocator.contains("timing_tsc")) {
+                configValues["timing-tsc"] = toml::find<bool>(allocator, "timing_tsc") ? "true" : "false";
+            }
         }
 
         // Load testing section
@@ -55,6 +107,20 @@ void ConfigManager::loadTomlConfig() {
             }
         }
 
+        // Load replay section
+        if (data.contains("replay")) {
+            const auto& replay = toml::find(data, "replay");
+            if (replay.contains("trace")) {
+                configValues["trace"] = toml::find<std::string>(replay, "trace");
+            }
+            if (replay.contains("speed")) {
+                configValues["replay-speed"] = std::to_string(toml::find<double>(replay, "speed"));
+            }
+            if (replay.contains("ordering")) {
+                configValues["replay-order"] = toml::find<std::string>(replay, "ordering");
+            }
+        }
+
         // Load output section
         if (data.contains("output")) {
             const auto& output = toml::find(data, "output");
@@ -64,6 +130,39 @@ void ConfigManager::loadTomlConfig() {
             if (output.contains("format")) {
                 configValues["format"] = toml::find<std::string>(output, "format");
             }
+            if (output.contains("async_logging")) {
+                configValues["async-logging"] = toml::find<bool>(output, "async_logging") ? "true" : "false";
+            }
+            if (output.contains("log_ring_capacity")) {
+                configValues["log-ring-capacity"] = std::to_string(toml::find<int>(output, "log_ring_capacity"));
+            }
+            if (output.contains("log_drop_when_full")) {
+                configValues["log-drop-when-full"] = toml::find<bool>(output, "log_drop_when_full") ? "true" : "false";
+            }
+            if (output.contains("log_echo")) {
+                configValues["log-echo"] = toml::find<bool>(output, "log_echo") ? "true" : "false";
+            }
+            if (output.contains("heap_snapshot_interval")) {
+                configValues["heap-snapshot-interval"] =
+                    std::to_string(toml::find<int>(output, "heap_snapshot_interval"));
+            }
+            if (output.contains("log_events")) {
+                configValues["log-events"] = toml::find<bool>(output, "log_events") ? "true" : "false";
+            }
+        }
+
+        // Load metrics section
+        if (data.contains("metrics")) {
+            const auto& metrics = toml::find(data, "metrics");
+            if (metrics.contains("interval_ms")) {
+                configValues["metrics-interval"] = std::to_string(toml::find<int>(metrics, "interval_ms"));
+            }
+            if (metrics.contains("windows")) {
+                configValues["metrics-windows"] = std::to_string(toml::find<int>(metrics, "windows"));
+            }
+            if (metrics.contains("format")) {
+                configValues["metrics-format"] = toml::find<std::string>(metrics, "format");
+            }
         }
 
     } catch (const std::exception& e) {
@@ -82,16 +181,48 @@ void ConfigManager::parseCLI(int argc, char* argv[], const std::string& programN
         "max-order", "Maximum buddy order (2^max-order bytes)", cxxopts::value<size_t>())(
         "min-block", "Minimum block size in bytes (alternative to min-order)", cxxopts::value<size_t>())(
         "max-block", "Maximum block size in bytes (alternative to max-order)", cxxopts::value<size_t>())(
-        "alignment", "Memory alignment in bytes", cxxopts::value<size_t>())(
+        "alignment", "Minimum alignment of the container adapters in bytes", cxxopts::value<size_t>())(
+        "thread-cache", "Enable per-thread magazine caches", cxxopts::value<bool>())(
+        "magazine-size", "Blocks per thread-cache refill/flush batch", cxxopts::value<size_t>())(
+        "lock-free", "Park freed blocks on per-order lock-free stacks", cxxopts::value<bool>())(
+        "lock-free-depth", "Maximum blocks parked per order in lock-free mode", cxxopts::value<size_t>())(
+        "deferred-coalescing", "Defer buddy merges of recently allocated orders", cxxopts::value<bool>())(
+        "deferred-watermark", "Maximum blocks left unmerged per order with deferred coalescing",
+        cxxopts::value<size_t>())(
+        "coalesce-threshold", "External fragmentation (0-1) that forces a bulk coalesce", cxxopts::value<double>())(
+        "headerless", "Keep block metadata in side tables instead of in-band headers", cxxopts::value<bool>())(
+        "mmap", "Obtain the pool from mmap instead of malloc", cxxopts::value<bool>())(
+        "huge-pages", "Back the pool with huge pages (implies --mmap)", cxxopts::value<bool>())(
+        "numa-node", "Bind the pool to a NUMA node, -1 for none (implies --mmap)", cxxopts::value<int>())(
+        "prefault", "Fault in every pool page before running", cxxopts::value<bool>())(
+        "arenas", "Arenas for the sharded allocator (0 = one per hardware thread)", cxxopts::value<size_t>())(
+        "max-arenas", "Arenas the growable allocator may map (0 = unlimited)", cxxopts::value<size_t>())(
+        "retain-empty-arenas", "Empty arenas the growable allocator keeps mapped", cxxopts::value<size_t>())(
+        "timing-sample-rate", "Time one in N allocator operations (0 = no timing)", cxxopts::value<size_t>())(
+        "timing-tsc", "Time with the CPU timestamp counter (x86 only)", cxxopts::value<bool>())(
         "threads", "Number of threads for multi-threaded tests", cxxopts::value<size_t>())(
         "ops", "Number of operations", cxxopts::value<size_t>())(
         "duration", "Test duration in seconds", cxxopts::value<double>())("seed", "Random seed for reproducibility",
                                                                           cxxopts::value<size_t>())(
-        "out", "Output directory or file path", cxxopts::value<std::string>())("format", "Output format (csv or json)",
+        "out", "Output directory or file path", cxxopts::value<std::string>())("format", "Output format (csv, csv.gz, csv.zst or binary)",
                                                                                cxxopts::value<std::string>())(
-        "benchmark", "Benchmark type [fixed|variable|throughput]", cxxopts::value<std::string>())(
-        "test", "Allocator test scenario [sequential|random|mixed]", cxxopts::value<std::string>())("h,help",
-                                                                                                    "Print help");
+        "async-logging", "Queue log events for a background writer thread", cxxopts::value<bool>())(
+        "log-ring-capacity", "Events buffered per thread in async logging mode", cxxopts::value<size_t>())(
+        "log-drop-when-full", "Drop events instead of waiting when an async log ring is full",
+        cxxopts::value<bool>())("log-echo", "Also print every logged row to the console", cxxopts::value<bool>())(
+        "heap-snapshot-interval", "Operations between heap snapshots in the fragmentation benchmark (0 = none)",
+        cxxopts::value<size_t>())("log-events", "Log a row per allocator event (false leaves only summaries)",
+                                  cxxopts::value<bool>())(
+        "metrics-interval", "Milliseconds per windowed metrics sample (0 = no sampler)", cxxopts::value<size_t>())(
+        "metrics-windows", "Metrics windows kept in memory", cxxopts::value<size_t>())(
+        "metrics-format", "Metrics export format (csv or prometheus)", cxxopts::value<std::string>())(
+        "benchmark", "Benchmark type [fixed|fixed-batch|variable|throughput]", cxxopts::value<std::string>())(
+        "batch-size", "Blocks per call for the fixed-batch benchmark", cxxopts::value<size_t>())(
+        "test", "Allocator test scenario [sequential|random|mixed]", cxxopts::value<std::string>())(
+        "trace", "Binary trace (.trace) to replay", cxxopts::value<std::string>())(
+        "replay-speed", "Replay pacing: 0 = full speed, 1 = recorded timing, N = N times faster",
+        cxxopts::value<double>())("replay-order", "Replay thread ordering [strict|causal]",
+                                  cxxopts::value<std::string>())("h,help", "Print help");
 
     try {
         auto result = options.parse(argc, argv);
@@ -118,6 +249,57 @@ void ConfigManager::parseCLI(int argc, char* argv[], const std::string& programN
         if (result.count("alignment")) {
             cliValues["alignment"] = std::to_string(result["alignment"].as<size_t>());
         }
+        if (result.count("thread-cache")) {
+            cliValues["thread-cache"] = result["thread-cache"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("magazine-size")) {
+            cliValues["magazine-size"] = std::to_string(result["magazine-size"].as<size_t>());
+        }
+        if (result.count("lock-free")) {
+            cliValues["lock-free"] = result["lock-free"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("lock-free-depth")) {
+            cliValues["lock-free-depth"] = std::to_string(result["lock-free-depth"].as<size_t>());
+        }
+        if (result.count("deferred-coalescing")) {
+            cliValues["deferred-coalescing"] = result["deferred-coalescing"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("deferred-watermark")) {
+            cliValues["deferred-watermark"] = std::to_string(result["deferred-watermark"].as<size_t>());
+        }
+        if (result.count("coalesce-threshold")) {
+            cliValues["coalesce-threshold"] = std::to_string(result["coalesce-threshold"].as<double>());
+        }
+        if (result.count("headerless")) {
+            cliValues["headerless"] = result["headerless"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("mmap")) {
+            cliValues["mmap"] = result["mmap"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("huge-pages")) {
+            cliValues["huge-pages"] = result["huge-pages"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("numa-node")) {
+            cliValues["numa-node"] = std::to_string(result["numa-node"].as<int>());
+        }
+        if (result.count("prefault")) {
+            cliValues["prefault"] = result["prefault"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("arenas")) {
+            cliValues["arenas"] = std::to_string(result["arenas"].as<size_t>());
+        }
+        if (result.count("max-arenas")) {
+            cliValues["max-arenas"] = std::to_string(result["max-arenas"].as<size_t>());
+        }
+        if (result.count("retain-empty-arenas")) {
+            cliValues["retain-empty-arenas"] = std::to_string(result["retain-empty-arenas"].as<size_t>());
+        }
+        if (result.count("timing-sample-rate")) {
+            cliValues["timing-sample-rate"] = std::to_string(result["timing-sample-rate"].as<size_t>());
+        }
+        if (result.count("timing-tsc")) {
+            cliValues["timing-tsc"] = result["timing-tsc"].as<bool>() ? "true" : "false";
+        }
         if (result.count("threads")) {
             cliValues["threads"] = std::to_string(result["threads"].as<size_t>());
         }
@@ -136,12 +318,51 @@ void ConfigManager::parseCLI(int argc, char* argv[], const std::string& programN
         if (result.count("format")) {
             cliValues["format"] = result["format"].as<std::string>();
         }
+        if (result.count("async-logging")) {
+            cliValues["async-logging"] = result["async-logging"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("log-ring-capacity")) {
+            cliValues["log-ring-capacity"] = std::to_string(result["log-ring-capacity"].as<size_t>());
+        }
+        if (result.count("log-drop-when-full")) {
+            cliValues["log-drop-when-full"] = result["log-drop-when-full"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("log-echo")) {
+            cliValues["log-echo"] = result["log-echo"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("heap-snapshot-interval")) {
+            cliValues["heap-snapshot-interval"] = std::to_string(result["heap-snapshot-interval"].as<size_t>());
+        }
+        if (result.count("log-events")) {
+            cliValues["log-events"] = result["log-events"].as<bool>() ? "true" : "false";
+        }
+        if (result.count("metrics-interval")) {
+            cliValues["metrics-interval"] = std::to_string(result["metrics-interval"].as<size_t>());
+        }
+        if (result.count("metrics-windows")) {
+            cliValues["metrics-windows"] = std::to_string(result["metrics-windows"].as<size_t>());
+        }
+        if (result.count("metrics-format")) {
+            cliValues["metrics-format"] = result["metrics-format"].as<std::string>();
+        }
         if (result.count("benchmark")) {
             cliValues["benchmark"] = result["benchmark"].as<std::string>();
         }
+        if (result.count("batch-size")) {
+            cliValues["batch-size"] = std::to_string(result["batch-size"].as<size_t>());
+        }
         if (result.count("test")) {
             cliValues["test"] = result["test"].as<std::string>();
         }
+        if (result.count("trace")) {
+            cliValues["trace"] = result["trace"].as<std::string>();
+        }
+        if (result.count("replay-speed")) {
+            cliValues["replay-speed"] = std::to_string(result["replay-speed"].as<double>());
+        }
+        if (result.count("replay-order")) {
+            cliValues["replay-order"] = result["replay-order"].as<std::string>();
+        }
 
         // If a different config file was specified, reload it
         if (result.count("config")) {
@@ -180,6 +401,15 @@ size_t ConfigManager::getSize(const std::string& key, size_t defaultValue) const
     }
 }
 
+int ConfigManager::getInt(const std::string& key, int defaultValue) const {
+    std::string value = getValue(key, std::to_string(defaultValue));
+    try {
+        return std::stoi(value);
+    } catch (const std::exception&) {
+        return defaultValue;
+    }
+}
+
 double ConfigManager::getDouble(const std::string& key, double defaultValue) const {
     std::string value = getValue(key, std::to_string(defaultValue));
     try {
@@ -206,7 +436,8 @@ void ConfigManager::validate() const {
         throw std::invalid_argument("min-order must be less than max-order");
     }
 
-    if (maxOrder > 30) {
+    // 4 GiB pools are only practical with mmap-backed pools and huge pages
+    if (maxOrder > 32) {
         throw std::invalid_argument("max-order too large (would exceed reasonable memory limits)");
     }
 
@@ -215,6 +446,36 @@ void ConfigManager::validate() const {
         throw std::invalid_argument("alignment must be a power of 2");
     }
 
+    if (getBool("thread-cache", false) && getSize("magazine-size", 32) == 0) {
+        throw std::invalid_argument("magazine-size must be at least 1 when thread-cache is enabled");
+    }
+
+    if (getBool("thread-cache", false) && getBool("lock-free", false)) {
+        throw std::invalid_argument("thread-cache and lock-free cannot both be enabled");
+    }
+
+    if (getBool("deferred-coalescing", false) && getSize("deferred-watermark", 64) == 0) {
+        throw std::invalid_argument("deferred-watermark must be at least 1 when deferred-coalescing is enabled");
+    }
+
+    double coalesceThreshold = getDouble("coalesce-threshold", 0.75);
+    if (coalesceThreshold < 0.0 || coalesceThreshold > 1.0) {
+        throw std::invalid_argument("coalesce-threshold must be between 0 and 1");
+    }
+
+    if (getBool("headerless", false)) {
+        if (getBool("lock-free", false)) {
+            throw std::invalid_argument("headerless and lock-free cannot both be enabled");
+        }
+        if (minOrder < 4) {
+            throw std::invalid_argument("headerless requires min-order of at least 4");
+        }
+    }
+
+    if (getInt("numa-node", -1) < -1) {
+        throw std::invalid_argument("numa-node must be -1 (no binding) or a node number");
+    }
+
     size_t threads = getSize("threads", 1);
     if (threads == 0) {
         throw std::invalid_argument("threads must be at least 1");
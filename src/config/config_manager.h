@@ -38,6 +38,14 @@ class ConfigManager {
      */
     size_t getSize(const std::string& key, size_t defaultValue) const;
 
+    /**
+     * @brief Gets a signed integer configuration value with precedence.
+     * @param key Configuration key.
+     * @param defaultValue Fallback value if key not found.
+     * @return Configuration value.
+     */
+    int getInt(const std::string& key, int defaultValue) const;
+
     /**
      * @brief Gets a double configuration value with precedence.
      * @param key Configuration key.
@@ -0,0 +1,69 @@
+#ifndef ALLOCATOR_EVENT_LOGGER_H
+#define ALLOCATOR_EVENT_LOGGER_H
+
+#include <string>
+
+#include "allocator_observer.h"
+#include "custom_allocator.h"
+#include "data_logger.h"
+
+static_assert(CustomAllocator::INVALID_ALLOCATION_ID == LogEvent::NO_ALLOCATION_INDEX,
+              "events without an allocation index must log an empty AllocationID");
+
+/**
+ * @class AllocatorEventLogger
+ * @brief Logs every event of a CustomAllocator to a DataLogger while in scope.
+ *
+ * Installs itself as the allocator's observer on construction and removes itself on destruction,
+ * so a benchmark only makes its allocator calls; timing, addresses, allocation IDs and
+ * fragmentation come from the allocator. Deallocation rows report the block's usable size,
+ * since the allocator does not remember the requested one. Thread-safe as DataLogger::log is.
+ */
+class AllocatorEventLogger : public AllocatorObserver {
+   public:
+    /**
+     * @param allocator The allocator to observe; must not already have an observer.
+     * @param logger Destination of the events.
+     * @param source Source column of every row.
+     * @param callStack CallStack column of every row.
+     */
+    AllocatorEventLogger(CustomAllocator& allocator, DataLogger& logger, const std::string& source,
+                         const std::string& callStack)
+        : allocator(allocator),
+          logger(logger),
+          poolSize(static_cast<double>(allocator.getPoolSize())),
+          sourceId(logger.internString(source)),
+          callStackId(logger.internString(callStack)) {
+        allocator.setObserver(this);
+    }
+
+    ~AllocatorEventLogger() override { allocator.setObserver(nullptr); }
+
+    AllocatorEventLogger(const AllocatorEventLogger&) = delete;
+    AllocatorEventLogger& operator=(const AllocatorEventLogger&) = delete;
+
+    void onEvent(const AllocatorEvent& event) override {
+        LogEvent logEvent;
+        logEvent.timestampNs = DataLogger::currentTimeNanoseconds();
+        logEvent.operation =
+            event.type == AllocatorEventType::Allocation ? LogOperation::Allocation : LogOperation::Deallocation;
+        logEvent.blockSize = event.size;
+        logEvent.latencyNs = event.latencyNs;
+        logEvent.fragmentation = static_cast<double>(event.freeBytes) / poolSize;
+        logEvent.address = event.address;
+        logEvent.threadId = DataLogger::currentThreadId();
+        logEvent.allocationIndex = event.allocationIndex;
+        logEvent.sourceId = sourceId;
+        logEvent.callStackId = callStackId;
+        logger.log(logEvent);
+    }
+
+   private:
+    CustomAllocator& allocator;
+    DataLogger& logger;
+    double poolSize;
+    uint32_t sourceId;
+    uint32_t callStackId;
+};
+
+#endif  // ALLOCATOR_EVENT_LOGGER_H
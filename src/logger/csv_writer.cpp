@@ -0,0 +1,286 @@
+#include "csv_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Defined by CMake when zlib and libzstd are found
+#ifndef DATA_LOGGER_HAVE_ZLIB
+#define DATA_LOGGER_HAVE_ZLIB 0
+#endif
+#ifndef DATA_LOGGER_HAVE_ZSTD
+#define DATA_LOGGER_HAVE_ZSTD 0
+#endif
+
+#if DATA_LOGGER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if DATA_LOGGER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+/// Longest text appendUnsigned, appendDouble or appendPointer can produce.
+constexpr size_t MAX_NUMBER_LENGTH = 32;
+
+#if DATA_LOGGER_HAVE_ZLIB
+/// Compressed bytes produced per call into zlib.
+constexpr size_t COMPRESSED_CHUNK_BYTES = 1 << 16;
+
+/**
+ * @brief gzip stream through zlib, at its fastest level so the writer keeps up with the benchmark.
+ */
+class GzipCompressor : public CsvWriter::Compressor {
+   public:
+    GzipCompressor() : output(COMPRESSED_CHUNK_BYTES) {
+        std::memset(&stream, 0, sizeof(stream));
+        // 15 window bits plus 16 selects the gzip wrapper
+        ready = deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipCompressor() override {
+        if (ready) {
+            deflateEnd(&stream);
+        }
+    }
+
+    bool compress(const char* data, size_t size, Flush flush, std::ostream& out) override {
+        if (!ready) {
+            return false;
+        }
+        int mode = flush == Flush::Finish ? Z_FINISH : flush == Flush::Sync ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(size);  // Callers pass at most one buffer
+        do {
+            stream.next_out = output.data();
+            stream.avail_out = static_cast<uInt>(output.size());
+            int result = deflate(&stream, mode);
+            if (result == Z_STREAM_ERROR) {
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(output.data()),
+                      static_cast<std::streamsize>(output.size() - stream.avail_out));
+        } while (stream.avail_out == 0);
+        if (flush == Flush::Finish) {
+            deflateReset(&stream);  // Ready for another member
+        }
+        return true;
+    }
+
+   private:
+    z_stream stream;
+    std::vector<Bytef> output;
+    bool ready;
+};
+#endif
+
+#if DATA_LOGGER_HAVE_ZSTD
+/**
+ * @brief zstd frames at the library's default level.
+ */
+class ZstdCompressor : public CsvWriter::Compressor {
+   public:
+    ZstdCompressor() : context(ZSTD_createCCtx()), output(ZSTD_CStreamOutSize()) {
+        if (context) {
+            ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, 3);
+        }
+    }
+
+    ~ZstdCompressor() override { ZSTD_freeCCtx(context); }
+
+    bool compress(const char* data, size_t size, Flush flush, std::ostream& out) override {
+        if (!context) {
+            return false;
+        }
+        ZSTD_EndDirective directive =
+            flush == Flush::Finish ? ZSTD_e_end : flush == Flush::Sync ? ZSTD_e_flush : ZSTD_e_continue;
+        ZSTD_inBuffer input = {data, size, 0};
+        while (true) {
+            ZSTD_outBuffer chunk = {output.data(), output.size(), 0};
+            size_t remaining = ZSTD_compressStream2(context, &chunk, &input, directive);
+            if (ZSTD_isError(remaining)) {
+                return false;
+            }
+            out.write(output.data(), static_cast<std::streamsize>(chunk.pos));
+            // Flushing directives are done once the library has nothing left to emit
+            if (directive == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+                return true;
+            }
+        }
+    }
+
+   private:
+    ZSTD_CCtx* context;
+    std::vector<char> output;
+};
+#endif
+
+const char* compressionName(CsvCompression compression) {
+    return compression == CsvCompression::Gzip ? "gzip" : "zstd";
+}
+
+}  // namespace
+
+CsvWriter::CsvWriter(const std::string& filename, const std::string& header, CsvCompression compression,
+                     size_t bufferBytes)
+    : stream(nullptr), used(0), rowStart(0), bufferBytes(std::max<size_t>(bufferBytes, 1)) {
+    if (!supports(compression)) {
+        std::cerr << "Cannot write " << filename << ": " << compressionName(compression)
+                  << " compression was not compiled in" << std::endl;
+        return;
+    }
+#if DATA_LOGGER_HAVE_ZLIB
+    if (compression == CsvCompression::Gzip) {
+        compressor = std::make_unique<GzipCompressor>();
+    }
+#endif
+#if DATA_LOGGER_HAVE_ZSTD
+    if (compression == CsvCompression::Zstd) {
+        compressor = std::make_unique<ZstdCompressor>();
+    }
+#endif
+
+    file.open(filename, std::ios::out | std::ios::app | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return;
+    }
+    stream = &file;
+    buffer.resize(this->bufferBytes + MAX_NUMBER_LENGTH);
+
+    // Check if the file is empty to write headers
+    file.seekp(0, std::ios::end);
+    if (file.tellp() == 0) {
+        append(header);
+        endRow();
+    }
+}
+
+CsvWriter::CsvWriter(std::ostream& stream, size_t bufferBytes)
+    : stream(&stream), used(0), rowStart(0), bufferBytes(std::max<size_t>(bufferBytes, 1)) {
+    buffer.resize(this->bufferBytes + MAX_NUMBER_LENGTH);
+}
+
+CsvWriter::~CsvWriter() {
+    close();
+}
+
+bool CsvWriter::supports(CsvCompression compression) {
+    switch (compression) {
+        case CsvCompression::None:
+            return true;
+        case CsvCompression::Gzip:
+            return DATA_LOGGER_HAVE_ZLIB != 0;
+        case CsvCompression::Zstd:
+            return DATA_LOGGER_HAVE_ZSTD != 0;
+    }
+    return false;
+}
+
+void CsvWriter::append(const char* text, size_t length) {
+    reserve(length);
+    std::memcpy(buffer.data() + used, text, length);
+    used += length;
+}
+
+void CsvWriter::append(const char* text) {
+    append(text, std::strlen(text));
+}
+
+void CsvWriter::append(char c) {
+    reserve(1);
+    buffer[used++] = c;
+}
+
+void CsvWriter::appendUnsigned(uint64_t value) {
+    reserve(MAX_NUMBER_LENGTH);
+    char* end = std::to_chars(buffer.data() + used, buffer.data() + used + MAX_NUMBER_LENGTH, value).ptr;
+    used = static_cast<size_t>(end - buffer.data());
+}
+
+void CsvWriter::appendDouble(double value) {
+    reserve(MAX_NUMBER_LENGTH);
+    char* first = buffer.data() + used;
+#if defined(__cpp_lib_to_chars)
+    // The general format with precision 6 is printf's "%g", which is what ostreams print by default
+    char* end = std::to_chars(first, first + MAX_NUMBER_LENGTH, value, std::chars_format::general, 6).ptr;
+#else
+    char* end = first + std::snprintf(first, MAX_NUMBER_LENGTH, "%g", value);
+#endif
+    used = static_cast<size_t>(end - buffer.data());
+}
+
+void CsvWriter::appendPointer(const void* address) {
+    uintptr_t value = reinterpret_cast<uintptr_t>(address);
+    if (value == 0) {
+        append('0');
+        return;
+    }
+    reserve(MAX_NUMBER_LENGTH);
+    buffer[used++] = '0';
+    buffer[used++] = 'x';
+    char* end = std::to_chars(buffer.data() + used, buffer.data() + used + MAX_NUMBER_LENGTH - 2, value, 16).ptr;
+    used = static_cast<size_t>(end - buffer.data());
+}
+
+void CsvWriter::endRow() {
+    append('\n');
+    rowStart = used;
+    if (used >= bufferBytes) {
+        writeBuffer(used, Compressor::Flush::None);
+    }
+}
+
+void CsvWriter::flush() {
+    if (stream) {
+        writeBuffer(rowStart, Compressor::Flush::Sync);
+        stream->flush();
+    }
+}
+
+void CsvWriter::close() {
+    if (!stream) {
+        return;
+    }
+    writeBuffer(rowStart, Compressor::Flush::Finish);  // An unfinished row is dropped
+    stream->flush();
+    if (file.is_open()) {
+        file.close();
+    }
+    stream = nullptr;
+}
+
+/**
+ * @brief Makes room for bytes more; the buffer only grows for a row longer than bufferBytes.
+ */
+void CsvWriter::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        buffer.resize(std::max(buffer.size() * 2, used + bytes));
+    }
+}
+
+/**
+ * @brief Writes out the first bytes of the buffer and moves the rest (a partial row) to the front.
+ */
+void CsvWriter::writeBuffer(size_t bytes, Compressor::Flush flush) {
+    if (!stream) {
+        return;
+    }
+    if (compressor) {
+        if (!compressor->compress(buffer.data(), bytes, flush, *stream)) {
+            std::cerr << "Compression failed; closing the log file" << std::endl;
+            compressor.reset();
+            file.close();
+            stream = nullptr;
+            return;
+        }
+    } else if (bytes > 0) {
+        stream->write(buffer.data(), static_cast<std::streamsize>(bytes));
+    }
+    std::memmove(buffer.data(), buffer.data() + bytes, used - bytes);
+    used -= bytes;
+    rowStart -= bytes;
+}
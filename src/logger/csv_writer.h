@@ -0,0 +1,128 @@
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compression applied to a CSV log as it is written.
+ */
+enum class CsvCompression {
+    None,
+    Gzip,  ///< .csv.gz, through zlib
+    Zstd,  ///< .csv.zst, through libzstd
+};
+
+/**
+ * @class CsvWriter
+ * @brief Buffered writer of DataLogger's CSV rows, optionally compressing them on the fly.
+ *
+ * Fields are formatted with std::to_chars straight into one reusable buffer, which is handed to
+ * the output (through zlib or zstd when compressing) only once it holds bufferBytes, or on
+ * flush(); a row costs its formatting and nothing else. Numbers print as the standard streams
+ * print them (doubles like "%g"), so rows are unchanged from the ostream text they replace.
+ *
+ * Appending to an existing compressed file starts a new gzip member or zstd frame, which gzip,
+ * zstd and pandas read back as one continuous file. Rows still in the buffer are lost if the
+ * process dies; close() or destruction writes them out.
+ * Not thread-safe; DataLogger serialises calls under its log mutex.
+ */
+class CsvWriter {
+   public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 4 << 20;
+
+    /**
+     * @brief Opens filename for appending, writing header if the file is new or empty.
+     *
+     * Reports failures (including compression that was not compiled in) on std::cerr and leaves
+     * the writer closed.
+     *
+     * @param filename Path of the CSV file.
+     * @param header First line of a new file, without the line break.
+     * @param compression Compression of the file's contents.
+     * @param bufferBytes Formatted bytes buffered before they are written out.
+     */
+    CsvWriter(const std::string& filename, const std::string& header,
+              CsvCompression compression = CsvCompression::None, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    /**
+     * @brief Writes rows to a stream the caller owns (e.g. std::cout), uncompressed.
+     */
+    explicit CsvWriter(std::ostream& stream, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    /**
+     * @brief Writes out buffered rows and finishes the compressed stream.
+     */
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    bool isOpen() const { return stream != nullptr; }
+
+    /**
+     * @brief Whether this build can write compression (None always can).
+     */
+    static bool supports(CsvCompression compression);
+
+    void append(const char* text, size_t length);
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void append(const char* text);
+    void append(char c);
+    void appendUnsigned(uint64_t value);
+    void appendDouble(double value);  ///< As an ostream with default flags prints it
+    void appendPointer(const void* address);  ///< 0x-prefixed lowercase hex, or 0 for null, as libstdc++ prints it
+
+    /**
+     * @brief The part of the current row appended so far; valid until the next append.
+     */
+    const char* rowData() const { return buffer.data() + rowStart; }
+    size_t rowLength() const { return used - rowStart; }
+
+    /**
+     * @brief Ends the current row, and writes the buffer out once it holds bufferBytes.
+     */
+    void endRow();
+
+    /**
+     * @brief Hands every complete row to the output; compressed streams are flushed to a byte boundary.
+     */
+    void flush();
+
+    /**
+     * @brief Writes out buffered rows, finishes the compressed stream and closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Compression back end; the zlib and zstd implementations live in csv_writer.cpp.
+     */
+    class Compressor {
+       public:
+        enum class Flush { None, Sync, Finish };
+
+        virtual ~Compressor() = default;
+
+        /// Compresses size bytes of data to out; returns false on a compression error.
+        virtual bool compress(const char* data, size_t size, Flush flush, std::ostream& out) = 0;
+    };
+
+   private:
+    std::ofstream file;
+    std::ostream* stream;  // file, or the caller's stream; nullptr when closed
+    std::unique_ptr<Compressor> compressor;
+    std::vector<char> buffer;
+    size_t used;
+    size_t rowStart;
+    size_t bufferBytes;
+
+    void reserve(size_t bytes);
+    void writeBuffer(size_t bytes, Compressor::Flush flush);
+};
+
+#endif  // CSV_WRITER_H
@@ -3,16 +3,92 @@
 #include <limits.h>  // For PATH_MAX
 #include <unistd.h>  // For getcwd
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
 #include <iomanip>  // For std::put_time
 #include <iostream>
 #include <sstream>  // For std::ostringstream
 
+#include "trace_writer.h"
+
+namespace {
+
+/// Source of per-instance ids; never reused, so a thread's cached ring cannot alias a new logger.
+std::atomic<uint64_t> nextLoggerId{1};
+
+/// How often the writer drains the rings when nobody is waiting on it.
+constexpr std::chrono::milliseconds WRITER_INTERVAL(10);
+
+/// Console text buffered per write to std::cout when echoing rows.
+constexpr size_t CONSOLE_BUFFER_BYTES = 1 << 16;
+
+/// First line of a new CSV file.
+const char* const CSV_HEADER =
+    "Timestamp,Operation,BlockSize,Time,Fragmentation,Source,CallStack,MemoryAddress,ThreadID,AllocationID";
+
+/// Per-ring cache of recently interned strings, so repeated sources skip the shared table.
+constexpr size_t RECENT_STRINGS = 16;
+
+constexpr int64_t NANOSECONDS_PER_SECOND = 1000000000;
+
+/**
+ * @brief Operation column text; also the first interned strings, so a LogOperation is its own id.
+ */
+const char* operationName(LogOperation operation) {
+    return operation == LogOperation::Allocation ? "Allocation" : "Deallocation";
+}
+
+/**
+ * @brief Copies value into a fixed-width, NUL-terminated field, truncating if necessary.
+ */
+template <size_t N>
+void copyField(char (&field)[N], const std::string& value) {
+    size_t length = std::min(value.size(), N - 1);
+    std::memcpy(field, value.data(), length);
+    field[length] = '\0';
+}
+
+}  // namespace
+
+/**
+ * @struct DataLogger::EventRing
+ * @brief Single-producer, single-consumer ring of queued events for one thread.
+ *
+ * The producing thread writes records and publishes them by advancing tail; the writer thread
+ * formats them and hands the slots back by advancing head. The indices sit on separate cache
+ * lines so the two sides do not false-share.
+ */
+struct DataLogger::EventRing {
+    explicit EventRing(size_t capacity) : slots(new EventRecord[capacity]), mask(capacity - 1) {}
+
+    std::unique_ptr<EventRecord[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};  ///< Next record to drain; written by the writer
+    alignas(64) std::atomic<size_t> tail{0};  ///< Next free slot; written by the producer
+    std::vector<std::pair<std::string, uint32_t>> recentStrings;  ///< Producer-side intern cache
+};
+
 /**
  * @brief Constructs a new DataLogger object and initializes the log file.
  *
  * @param filename The name of the CSV file to write logs to.
  */
-DataLogger::DataLogger(const std::string& filename) {
+DataLogger::DataLogger(const std::string& filename, const LoggerOptions& options)
+    : options(options),
+      instanceId(nextLoggerId.fetch_add(1, std::memory_order_relaxed)),
+      droppedEvents(0),
+      drainRequested(false),
+      stopping(false),
+      flushRequested(0),
+      flushCompleted(0) {
+    // LogOperation values double as their interned ids
+    internString(operationName(LogOperation::Allocation));
+    internString(operationName(LogOperation::Deallocation));
+
     // Print current working directory
     char cwd[PATH_MAX];
     if (getcwd(cwd, sizeof(cwd)) != NULL) {
@@ -30,19 +106,32 @@ DataLogger::DataLogger(const std::string& filename) {
     }
 
     // Opens the log file
-    logFile.open(actualFilename, std::ios::out | std::ios::app);
-    if (logFile.is_open()) {
-        // Check if the file is empty to write headers
-        logFile.seekp(0, std::ios::end);
-        if (logFile.tellp() == 0) {
-            std::cout << "File opened successfully: " << actualFilename << std::endl;
-            logFile << "Timestamp,Operation,BlockSize,Time,Fragmentation,Source,CallStack,MemoryAddress,ThreadID,"
-                       "AllocationID\n";
-        } else {
-            std::cout << "File opened successfully: " << actualFilename << std::endl;
+    if (this->options.format == LogFormat::Binary) {
+        // The trace writer reports its own open failure
+        traceWriter = std::make_unique<TraceWriter>(actualFilename);
+        if (traceWriter->isOpen()) {
+            std::cout << "Trace file opened successfully: " << actualFilename << std::endl;
         }
     } else {
-        std::cerr << "Failed to open file: " << actualFilename << std::endl;
+        // The CSV writer reports its own open failure, and writes the header into new files
+        csvWriter = std::make_unique<CsvWriter>(actualFilename, CSV_HEADER, this->options.compression,
+                                                this->options.writeBufferBytes);
+        if (csvWriter->isOpen()) {
+            std::cout << "File opened successfully: " << actualFilename << std::endl;
+        }
+    }
+    if (this->options.echoToConsole) {
+        consoleWriter = std::make_unique<CsvWriter>(std::cout, CONSOLE_BUFFER_BYTES);
+    }
+
+    if (this->options.async) {
+        // Power-of-two capacity so ring positions wrap with a mask
+        size_t capacity = 2;
+        while (capacity < this->options.ringCapacity) {
+            capacity <<= 1;
+        }
+        this->options.ringCapacity = capacity;
+        writerThread = std::thread(&DataLogger::writerLoop, this);
     }
 }
 
@@ -50,8 +139,45 @@ DataLogger::DataLogger(const std::string& filename) {
  * @brief Destroys the DataLogger object and closes the log file.
  */
 DataLogger::~DataLogger() {
-    if (logFile.is_open()) {
-        logFile.close();
+    if (writerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(writerMutex);
+            stopping = true;
+        }
+        writerWake.notify_one();
+        writerThread.join();  // The writer drains every ring before it exits
+    }
+    if (traceWriter && traceWriter->isOpen()) {
+        traceWriter->close();
+    }
+    if (csvWriter) {
+        csvWriter->close();
+    }
+    if (consoleWriter) {
+        consoleWriter->flush();
+    }
+}
+
+/**
+ * @brief Formats one row into the CSV file and, with echoToConsole, onto the console.
+ *
+ * format(out) appends the row's fields to out; it runs once even when the row is echoed.
+ * Caller holds logMutex.
+ */
+template <typename Format>
+void DataLogger::emitRow(const char* consolePrefix, Format format) {
+    if (csvWriter) {
+        format(*csvWriter);
+        if (consoleWriter) {
+            consoleWriter->append(consolePrefix);
+            consoleWriter->append(csvWriter->rowData(), csvWriter->rowLength());
+            consoleWriter->endRow();
+        }
+        csvWriter->endRow();
+    } else if (consoleWriter) {
+        consoleWriter->append(consolePrefix);
+        format(*consoleWriter);
+        consoleWriter->endRow();
     }
 }
 
@@ -75,21 +201,90 @@ DataLogger::~DataLogger() {
 void DataLogger::log(const std::string& timestamp, const std::string& operation, size_t blockSize, double time,
                      double fragmentation, const std::string& source, const std::string& callStack,
                      const std::string& memoryAddress, const std::string& threadID, const std::string& allocationID) {
+    if (options.async) {
+        enqueue(timestamp, operation, blockSize, time, fragmentation, source, callStack, memoryAddress, threadID,
+                allocationID);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(logMutex);
-    if (logFile.is_open()) {
-        // Log to console
-        std::cout << "Logging data: " << timestamp << "," << operation << "," << blockSize << "," << time << ","
-                  << fragmentation << "," << source << "," << callStack << "," << memoryAddress << "," << threadID
-                  << "," << allocationID << std::endl;
-
-        // Log to file
-        logFile << timestamp << "," << operation << "," << blockSize << "," << time << "," << fragmentation << ","
-                << source << "," << callStack << "," << memoryAddress << "," << threadID << "," << allocationID << "\n";
+    if (isOpen()) {
+        if (traceWriter) {
+            traceWriter->append(timestamp.c_str(), operation.c_str(), blockSize, time, fragmentation, source,
+                                callStack, memoryAddress.c_str(), threadID.c_str(), allocationID.c_str());
+        }
+        emitRow("Logging data: ", [&](CsvWriter& out) {
+            writeRow(out, timestamp.c_str(), operation.c_str(), blockSize, time, fragmentation, source, callStack,
+                     memoryAddress.c_str(), threadID.c_str(), allocationID.c_str());
+        });
+        if (consoleWriter) {
+            consoleWriter->flush();  // Keep the echo in step with the program's own output
+        }
     } else {
         std::cerr << "File not open during logging." << std::endl;
     }
 }
 
+/**
+ * @brief Logs a structured event, formatting it here (sync mode) or on the writer thread (async mode).
+ *
+ * @param event The event; its source and call stack ids must come from internString.
+ */
+void DataLogger::log(const LogEvent& event) {
+    if (options.async) {
+        enqueue(event);
+        return;
+    }
+
+    std::lock_guard<std::mutex> internLock(internMutex);  // Same order as the writer: internMutex, then logMutex
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (isOpen()) {
+        timestamps.update(event.timestampNs);
+        if (traceWriter) {
+            appendTraceEvent(event);
+        }
+        emitRow("Logging data: ", [&](CsvWriter& out) { writeEvent(out, event); });
+        if (consoleWriter) {
+            consoleWriter->flush();
+        }
+    } else {
+        std::cerr << "File not open during logging." << std::endl;
+    }
+}
+
+uint32_t DataLogger::internString(const std::string& value) {
+    std::lock_guard<std::mutex> lock(internMutex);
+    auto found = internedIds.find(value);
+    if (found != internedIds.end()) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(internedStrings.size());
+    internedStrings.push_back(value);
+    internedIds.emplace(value, id);
+    return id;
+}
+
+int64_t DataLogger::currentTimeNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t DataLogger::currentThreadId() {
+    // Worked out once per thread, so the string is not built per event
+    thread_local const uint64_t threadId = [] {
+        std::ostringstream printed;
+        printed << std::this_thread::get_id();
+        std::string text = printed.str();
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0') {
+            return static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        }
+        return static_cast<uint64_t>(value);
+    }();
+    return threadId;
+}
+
 /**
  * @brief Logs summary metrics for performance benchmarks.
  *
@@ -104,47 +299,487 @@ void DataLogger::log(const std::string& timestamp, const std::string& operation,
  */
 void DataLogger::logSummary(const std::string& summary, double allocThroughput, double deallocThroughput,
                             double fragmentation) {
+    flush();  // Keep the summary after the events it summarises
     std::lock_guard<std::mutex> lock(logMutex);
-    if (logFile.is_open()) {
-        // Current timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm;
+    if (isOpen()) {
+        std::string timestamp = currentTimestamp();
+        writeSummaryRow(timestamp, "Summary", 0, allocThroughput, deallocThroughput, fragmentation, summary);
+    } else {
+        std::cerr << "File not open during summary logging." << std::endl;
+    }
+}
+
+/**
+ * @brief Logs summary metrics followed by one latency row per operation type.
+ *
+ * The latency rows use the operations "AllocationLatency" and "DeallocationLatency" and reuse
+ * the columns like the summary row: BlockSize holds the sample count, Time, Fragmentation and
+ * Source hold p50, p99 and p999 in nanoseconds, and CallStack holds the summary description.
+ *
+ * @param summary A descriptive summary of the benchmark.
+ * @param allocThroughput Allocation throughput in operations per second.
+ * @param deallocThroughput Deallocation throughput in operations per second.
+ * @param fragmentation Current memory fragmentation percentage.
+ * @param allocationLatency Allocation latency percentiles.
+ * @param deallocationLatency Deallocation latency percentiles.
+ */
+void DataLogger::logSummary(const std::string& summary, double allocThroughput, double deallocThroughput,
+                            double fragmentation, const LatencyPercentiles& allocationLatency,
+                            const LatencyPercentiles& deallocationLatency) {
+    flush();
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (isOpen()) {
+        std::string timestamp = currentTimestamp();
+        writeSummaryRow(timestamp, "Summary", 0, allocThroughput, deallocThroughput, fragmentation, summary);
+        writeSummaryRow(timestamp, "AllocationLatency", allocationLatency.samples, allocationLatency.p50,
+                        allocationLatency.p99, allocationLatency.p999, summary);
+        writeSummaryRow(timestamp, "DeallocationLatency", deallocationLatency.samples, deallocationLatency.p50,
+                        deallocationLatency.p99, deallocationLatency.p999, summary);
+    } else {
+        std::cerr << "File not open during summary logging." << std::endl;
+    }
+}
+
+/**
+ * @brief Formats the current local time as "YYYY-MM-DD HH:MM:SS".
+ */
+std::string DataLogger::currentTimestamp() {
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm now_tm;
 #if defined(_WIN32) || defined(_WIN64)
-        localtime_s(&now_tm, &now_time_t);
+    localtime_s(&now_tm, &now_time_t);
 #else
-        localtime_r(&now_time_t, &now_tm);
+    localtime_r(&now_time_t, &now_tm);
 #endif
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Log to console
-        std::cout << "Logging summary: " << timestamp << ","
-                  << "Summary"
-                  << ","
-                  << "0"
-                  << "," << allocThroughput << "," << deallocThroughput << "," << fragmentation << "," << summary << ","
-                  << ","  // MemoryAddress
-                  << ","  // ThreadID
-                  << ","  // AllocationID
-                  << "\n";
-
-        // Log to file
-        logFile << timestamp << ","
-                << "Summary"
-                << ","  // Operation
-                << "0"
-                << ","                       // BlockSize (0 indicates summary)
-                << allocThroughput << ","    // Time (alloc throughput)
-                << deallocThroughput << ","  // Fragmentation (dealloc throughput)
-                << fragmentation << ","      // Source (fragmentation)
-                << summary << ","            // CallStack (summary description)
-                << ","                       // MemoryAddress
-                << ","                       // ThreadID
-                << ","                       // AllocationID
-                << "\n";
+    std::ostringstream timestampStream;
+    timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
+    return timestampStream.str();
+}
+
+/**
+ * @brief Whether the active writer (binary trace or CSV) has an open file; caller holds logMutex.
+ */
+bool DataLogger::isOpen() const {
+    return traceWriter ? traceWriter->isOpen() : csvWriter && csvWriter->isOpen();
+}
+
+/**
+ * @brief Writes one summary-style row to the log file and, if echoing, the console; caller holds logMutex.
+ */
+void DataLogger::writeSummaryRow(const std::string& timestamp, const std::string& operation, uint64_t blockSize,
+                                 double time, double fragmentation, double source, const std::string& summary) {
+    if (traceWriter) {
+        std::ostringstream sourceText;  // Same text as the CSV column
+        sourceText << source;
+        traceWriter->append(timestamp.c_str(), operation.c_str(), blockSize, time, fragmentation, sourceText.str(),
+                            summary, "", "", "");
+    }
+    emitRow("Logging summary: ", [&](CsvWriter& out) {
+        out.append(timestamp);
+        out.append(',');
+        out.append(operation);
+        out.append(',');
+        out.appendUnsigned(blockSize);  // BlockSize (0 or sample count)
+        out.append(',');
+        out.appendDouble(time);  // Time (alloc throughput or p50)
+        out.append(',');
+        out.appendDouble(fragmentation);  // Fragmentation (dealloc throughput or p99)
+        out.append(',');
+        out.appendDouble(source);  // Source (fragmentation or p999)
+        out.append(',');
+        out.append(summary);  // CallStack (summary description)
+        out.append(",,,");    // MemoryAddress, ThreadID, AllocationID
+    });
+    if (consoleWriter) {
+        consoleWriter->flush();
+    }
+}
+
+/**
+ * @brief Writes the fields of a string event (see log()) as a CSV row without the line break.
+ */
+void DataLogger::writeRow(CsvWriter& out, const char* timestamp, const char* operation, uint64_t blockSize,
+                          double time, double fragmentation, const std::string& source, const std::string& callStack,
+                          const char* memoryAddress, const char* threadID, const char* allocationID) {
+    out.append(timestamp);
+    out.append(',');
+    out.append(operation);
+    out.append(',');
+    out.appendUnsigned(blockSize);
+    out.append(',');
+    out.appendDouble(time);
+    out.append(',');
+    out.appendDouble(fragmentation);
+    out.append(',');
+    out.append(source);
+    out.append(',');
+    out.append(callStack);
+    out.append(',');
+    out.append(memoryAddress);
+    out.append(',');
+    out.append(threadID);
+    out.append(',');
+    out.append(allocationID);
+}
+
+void DataLogger::flushWriters() {
+    if (csvWriter) {
+        csvWriter->flush();
+    }
+    if (consoleWriter) {
+        consoleWriter->flush();
+    }
+}
+
+/**
+ * @brief Makes text and wallClockNs describe the second containing timestampNs.
+ */
+void DataLogger::TimestampCache::update(int64_t timestampNs) {
+    int64_t eventSecond = timestampNs / NANOSECONDS_PER_SECOND - (timestampNs % NANOSECONDS_PER_SECOND < 0);
+    if (eventSecond == second) {
+        return;
+    }
+    second = eventSecond;
+
+    std::time_t time = static_cast<std::time_t>(eventSecond);
+    std::tm local;
+#if defined(_WIN32) || defined(_WIN64)
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+    int64_t days = TraceWriter::daysFromCivil(local.tm_year + 1900, static_cast<unsigned>(local.tm_mon + 1),
+                                              static_cast<unsigned>(local.tm_mday));
+    wallClockNs = (days * 86400 + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec) * NANOSECONDS_PER_SECOND;
+}
+
+const std::string& DataLogger::internedString(uint32_t id) {
+    static const std::string unknown;
+    return id < internedStrings.size() ? internedStrings[id] : unknown;
+}
+
+/**
+ * @brief Writes event as a CSV row without the line break; timestamps must be updated for it.
+ *
+ * Caller holds internMutex.
+ */
+void DataLogger::writeEvent(CsvWriter& out, const LogEvent& event) {
+    out.append(timestamps.text);
+    out.append(',');
+    out.append(operationName(event.operation));
+    out.append(',');
+    out.appendUnsigned(event.blockSize);
+    out.append(',');
+    out.appendDouble(static_cast<double>(event.latencyNs) / 1000.0);
+    out.append(',');
+    out.appendDouble(event.fragmentation);
+    out.append(',');
+    out.append(internedString(event.sourceId));
+    out.append(',');
+    out.append(internedString(event.callStackId));
+    out.append(',');
+    out.appendPointer(event.address);
+    out.append(',');
+    out.appendUnsigned(event.threadId);
+    out.append(',');
+    if (event.allocationIndex != LogEvent::NO_ALLOCATION_INDEX) {
+        out.append("Alloc", 5);
+        out.appendUnsigned(event.allocationIndex);
+    }
+}
+
+/**
+ * @brief Appends event to the binary trace, translating its interned ids to trace string ids.
+ *
+ * timestamps must be updated for the event.
+ */
+void DataLogger::appendTraceEvent(const LogEvent& event) {
+    if (!traceWriter->isOpen()) {
+        return;
+    }
+    // Strings interned after the last call map to NO_STRING until first used; empty strings stay
+    // NO_STRING, and re-interning them costs a length check
+    if (traceStringIds.size() < internedStrings.size()) {
+        traceStringIds.resize(internedStrings.size(), TraceWriter::NO_STRING);
+    }
+    auto traceString = [this](uint32_t id) {
+        if (id >= traceStringIds.size()) {
+            return TraceWriter::NO_STRING;
+        }
+        if (traceStringIds[id] == TraceWriter::NO_STRING) {
+            traceStringIds[id] = traceWriter->intern(internedStrings[id]);
+        }
+        return traceStringIds[id];
+    };
+
+    auto thread = traceThreadIds.find(event.threadId);
+    if (thread == traceThreadIds.end()) {
+        thread = traceThreadIds.emplace(event.threadId, traceWriter->intern(std::to_string(event.threadId))).first;
+    }
+
+    TraceWriter::TraceRecord record;
+    record.timestampNs = timestamps.wallClockNs + (event.timestampNs - timestamps.second * NANOSECONDS_PER_SECOND);
+    record.blockSize = event.blockSize;
+    record.time = static_cast<double>(event.latencyNs) / 1000.0;
+    record.fragmentation = event.fragmentation;
+    record.memoryAddress = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(event.address));
+    record.allocationId = event.allocationIndex == LogEvent::NO_ALLOCATION_INDEX
+                              ? TraceWriter::NO_ALLOCATION_ID
+                              : static_cast<int64_t>(event.allocationIndex);
+    record.operation = traceString(static_cast<uint32_t>(event.operation));
+    record.source = traceString(event.sourceId);
+    record.callStack = traceString(event.callStackId);
+    record.threadId = thread->second;
+    traceWriter->append(record);
+}
+
+void DataLogger::flush() {
+    if (!options.async) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        flushWriters();
+        return;
+    }
+    // The writer flushes the file after draining for a request
+    std::unique_lock<std::mutex> lock(writerMutex);
+    uint64_t request = ++flushRequested;
+    writerWake.notify_one();
+    flushDone.wait(lock, [this, request]() { return flushCompleted >= request; });
+}
+
+bool DataLogger::parseFormat(const std::string& name, LoggerOptions& options) {
+    if (name == "csv") {
+        options.format = LogFormat::Csv;
+        options.compression = CsvCompression::None;
+    } else if (name == "csv.gz") {
+        options.format = LogFormat::Csv;
+        options.compression = CsvCompression::Gzip;
+    } else if (name == "csv.zst") {
+        options.format = LogFormat::Csv;
+        options.compression = CsvCompression::Zstd;
+    } else if (name == "binary") {
+        options.format = LogFormat::Binary;
+        options.compression = CsvCompression::None;
     } else {
-        std::cerr << "File not open during summary logging." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* DataLogger::fileExtension(const LoggerOptions& options) {
+    if (options.format == LogFormat::Binary) {
+        return ".trace";
+    }
+    switch (options.compression) {
+        case CsvCompression::Gzip:
+            return ".csv.gz";
+        case CsvCompression::Zstd:
+            return ".csv.zst";
+        case CsvCompression::None:
+            break;
+    }
+    return ".csv";
+}
+
+size_t DataLogger::getDroppedEvents() const {
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Async mode
+// ============================================================================
+
+/**
+ * @brief Finds or creates the calling thread's ring for this logger.
+ *
+ * A thread-local cache of the last logger used makes the common case one comparison; threads
+ * alternating between loggers take ringsMutex on every switch.
+ */
+DataLogger::EventRing& DataLogger::localRing() {
+    thread_local uint64_t cachedLoggerId = 0;
+    thread_local EventRing* cachedRing = nullptr;
+    if (cachedLoggerId == instanceId) {
+        return *cachedRing;
+    }
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    EventRing*& ring = threadRings[std::this_thread::get_id()];
+    if (!ring) {
+        rings.push_back(std::make_unique<EventRing>(options.ringCapacity));
+        ring = rings.back().get();
+    }
+    cachedLoggerId = instanceId;
+    cachedRing = ring;
+    return *ring;
+}
+
+/**
+ * @brief Returns the id of value in the shared string table, adding it if new.
+ */
+uint32_t DataLogger::intern(EventRing& ring, const std::string& value) {
+    for (const auto& recent : ring.recentStrings) {
+        if (recent.first == value) {
+            return recent.second;
+        }
+    }
+
+    uint32_t id = internString(value);
+    if (ring.recentStrings.size() >= RECENT_STRINGS) {
+        ring.recentStrings.clear();
+    }
+    ring.recentStrings.emplace_back(value, id);
+    return id;
+}
+
+/**
+ * @brief Waits for a free slot in ring, or counts a drop; returns false if the event is dropped.
+ */
+bool DataLogger::reserveSlot(EventRing& ring, size_t& tail) {
+    tail = ring.tail.load(std::memory_order_relaxed);
+    while (tail - ring.head.load(std::memory_order_acquire) > ring.mask) {
+        if (options.dropWhenFull) {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        drainRequested.store(true, std::memory_order_relaxed);
+        writerWake.notify_one();
+        std::this_thread::yield();
     }
-}
\ No newline at end of file
+    return true;
+}
+
+/**
+ * @brief Copies one structured event into the calling thread's ring.
+ */
+void DataLogger::enqueue(const LogEvent& event) {
+    EventRing& ring = localRing();
+    size_t tail;
+    if (!reserveSlot(ring, tail)) {
+        return;
+    }
+
+    EventRecord& record = ring.slots[tail & ring.mask];
+    record.structured = true;
+    record.event = event;
+
+    ring.tail.store(tail + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Copies one string event into the calling thread's ring.
+ */
+void DataLogger::enqueue(const std::string& timestamp, const std::string& operation, size_t blockSize, double time,
+                         double fragmentation, const std::string& source, const std::string& callStack,
+                         const std::string& memoryAddress, const std::string& threadID,
+                         const std::string& allocationID) {
+    EventRing& ring = localRing();
+    size_t tail;
+    if (!reserveSlot(ring, tail)) {
+        return;
+    }
+
+    EventRecord& record = ring.slots[tail & ring.mask];
+    record.structured = false;
+    copyField(record.timestamp, timestamp);
+    copyField(record.operation, operation);
+    copyField(record.memoryAddress, memoryAddress);
+    copyField(record.threadID, threadID);
+    copyField(record.allocationID, allocationID);
+    record.time = time;
+    record.event.blockSize = blockSize;
+    record.event.fragmentation = fragmentation;
+    record.event.sourceId = intern(ring, source);
+    record.event.callStackId = intern(ring, callStack);
+
+    ring.tail.store(tail + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Background thread: drains the rings every WRITER_INTERVAL, or sooner when asked.
+ */
+void DataLogger::writerLoop() {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (true) {
+        writerWake.wait_for(lock, WRITER_INTERVAL, [this]() {
+            return stopping || flushRequested != flushCompleted || drainRequested.load(std::memory_order_relaxed);
+        });
+        bool stop = stopping;
+        uint64_t request = flushRequested;
+        bool flushFile = request != flushCompleted;
+        drainRequested.store(false, std::memory_order_relaxed);
+        lock.unlock();
+
+        drainRings();
+        {
+            // Between flush requests CSV rows reach the file in writeBufferBytes chunks
+            std::lock_guard<std::mutex> logLock(logMutex);
+            if (flushFile) {
+                flushWriters();
+            } else if (consoleWriter) {
+                consoleWriter->flush();
+            }
+        }
+
+        lock.lock();
+        flushCompleted = request;
+        flushDone.notify_all();
+        if (stop) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Formats every queued record into the output writers, one ring at a time.
+ */
+void DataLogger::drainRings() {
+    std::vector<EventRing*> pending;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (const auto& ring : rings) {
+            pending.push_back(ring.get());
+        }
+    }
+
+    for (EventRing* ring : pending) {
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        size_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head == tail) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> internLock(internMutex);
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (isOpen()) {
+                for (; head != tail; ++head) {
+                    const EventRecord& record = ring->slots[head & ring->mask];
+                    const LogEvent& event = record.event;
+                    if (record.structured) {
+                        timestamps.update(event.timestampNs);
+                        if (traceWriter) {
+                            appendTraceEvent(event);
+                        }
+                        emitRow("Logging data: ", [&](CsvWriter& out) { writeEvent(out, event); });
+                    } else {
+                        const std::string& source = internedStrings[event.sourceId];
+                        const std::string& callStack = internedStrings[event.callStackId];
+                        if (traceWriter) {
+                            traceWriter->append(record.timestamp, record.operation, event.blockSize, record.time,
+                                                event.fragmentation, source, callStack, record.memoryAddress,
+                                                record.threadID, record.allocationID);
+                        }
+                        emitRow("Logging data: ", [&](CsvWriter& out) {
+                            writeRow(out, record.timestamp, record.operation, event.blockSize, record.time,
+                                     event.fragmentation, source, callStack, record.memoryAddress, record.threadID,
+                                     record.allocationID);
+                        });
+                    }
+                }
+            } else {
+                std::cerr << "File not open during logging." << std::endl;
+            }
+        }
+        ring->head.store(tail, std::memory_order_release);
+    }
+}
@@ -1,9 +1,90 @@
 #ifndef DATA_LOGGER_H
 #define DATA_LOGGER_H
 
-#include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "csv_writer.h"
+
+class TraceWriter;
+
+/**
+ * @brief On-disk format of a DataLogger file.
+ */
+enum class LogFormat {
+    Csv,     ///< One text row per event
+    Binary,  ///< Fixed-width records with an interned string table (see TraceWriter)
+};
+
+/**
+ * @struct LoggerOptions
+ * @brief How DataLogger writes events.
+ *
+ * A default-constructed value formats every event synchronously inside log(), as uncompressed
+ * CSV buffered in multi-megabyte writes, and prints nothing to the console.
+ */
+struct LoggerOptions {
+    LogFormat format = LogFormat::Csv;  ///< Binary traces are much smaller and load without parsing
+    CsvCompression compression = CsvCompression::None;  ///< Compress CSV files as they are written
+    size_t writeBufferBytes = CsvWriter::DEFAULT_BUFFER_BYTES;  ///< CSV bytes formatted per write to the file
+    bool echoToConsole = false;  ///< Also print every row to std::cout (much slower; for debugging)
+    bool async = false;          ///< Queue events for a background writer thread instead of writing in log()
+    size_t ringCapacity = 8192;  ///< Events buffered per producer thread (rounded up to a power of two)
+    bool dropWhenFull = false;   ///< When a ring is full, drop the event instead of waiting for the writer
+};
+
+/**
+ * @brief Operation of a structured LogEvent.
+ */
+enum class LogOperation : uint8_t {
+    Allocation,
+    Deallocation,
+};
+
+/**
+ * @struct LogEvent
+ * @brief One allocation or deallocation event, in the typed form accepted by DataLogger::log.
+ *
+ * Every field is a plain value, so building and logging an event allocates nothing; the logger
+ * formats it only when it is written (on the writer thread in async mode). The written row is the
+ * same as for the string overload of log(): Time in microseconds, the address as a pointer, and
+ * allocationIndex N as "AllocN".
+ */
+struct LogEvent {
+    static constexpr size_t NO_ALLOCATION_INDEX = std::numeric_limits<size_t>::max();  ///< Empty AllocationID
+
+    int64_t timestampNs = 0;  ///< System clock nanoseconds since 1970-01-01 (see DataLogger::currentTimeNanoseconds)
+    LogOperation operation = LogOperation::Allocation;
+    uint64_t blockSize = 0;
+    uint64_t latencyNs = 0;
+    double fragmentation = 0.0;
+    const void* address = nullptr;
+    uint64_t threadId = 0;  ///< See DataLogger::currentThreadId
+    size_t allocationIndex = NO_ALLOCATION_INDEX;
+    uint32_t sourceId = 0;     ///< Ids returned by DataLogger::internString
+    uint32_t callStackId = 0;
+};
+
+/**
+ * @struct LatencyPercentiles
+ * @brief Latency percentiles of one operation type, in nanoseconds.
+ */
+struct LatencyPercentiles {
+    uint64_t samples = 0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+};
 
 /**
  * @class DataLogger
@@ -12,21 +93,33 @@
  * The DataLogger class provides thread-safe logging of memory allocator events
  * and summary metrics to a CSV file. It records detailed information about each
  * operation and can log summary statistics for performance benchmarks.
+ *
+ * With LoggerOptions::async, log() copies the event into a fixed-size record in the calling
+ * thread's single-producer ring buffer and returns; a background thread drains the rings,
+ * formats the records and writes them in large chunks. Rows from different threads may then
+ * reach the file out of order (each carries its timestamp). Short fields are truncated to the
+ * record's fixed widths; Source and CallStack are interned, so they are stored in full.
  */
 class DataLogger {
    public:
     /**
      * @brief Constructs a new DataLogger object and initializes the log file.
      *
-     * @param filename The name of the CSV file to write logs to.
+     * CSV files are appended to; binary traces are always created afresh.
+     *
+     * @param filename The name of the CSV or trace file to write logs to.
+     * @param options Output format and async mode.
      */
-    DataLogger(const std::string& filename);
+    DataLogger(const std::string& filename, const LoggerOptions& options = LoggerOptions());
 
     /**
-     * @brief Destroys the DataLogger object and closes the log file.
+     * @brief Destroys the DataLogger object, writing any queued events, and closes the log file.
      */
     ~DataLogger();
 
+    DataLogger(const DataLogger&) = delete;
+    DataLogger& operator=(const DataLogger&) = delete;
+
     /**
      * @brief Logs an allocation or deallocation event.
      *
@@ -48,6 +141,50 @@ class DataLogger {
              double fragmentation, const std::string& source, const std::string& callStack,
              const std::string& memoryAddress, const std::string& threadID, const std::string& allocationID);
 
+    /**
+     * @brief Logs a structured allocation or deallocation event.
+     *
+     * Preferred in benchmark loops: no strings are built or copied per event, and formatting is
+     * deferred until the row is written.
+     *
+     * @param event The event; its source and call stack ids must come from this logger's internString.
+     */
+    void log(const LogEvent& event);
+
+    /**
+     * @brief Returns a stable id for value, for LogEvent::sourceId and LogEvent::callStackId.
+     *
+     * Interning takes a lock, so callers intern their sources once, outside the loop.
+     */
+    uint32_t internString(const std::string& value);
+
+    /**
+     * @brief Current system clock time in nanoseconds since 1970-01-01, for LogEvent::timestampNs.
+     */
+    static int64_t currentTimeNanoseconds();
+
+    /**
+     * @brief Numeric id of the calling thread, written as the ThreadID column.
+     *
+     * The number std::this_thread::get_id() prints as, so rows match those logged through the
+     * string overload; a hash of the id on standard libraries that print something else.
+     */
+    static uint64_t currentThreadId();
+
+    /**
+     * @brief Sets options.format and options.compression from an `[output] format` name.
+     *
+     * @param name "csv", "csv.gz", "csv.zst" or "binary".
+     * @param options Options to update; unchanged if name is not one of those.
+     * @return Whether name was recognised.
+     */
+    static bool parseFormat(const std::string& name, LoggerOptions& options);
+
+    /**
+     * @brief File extension for the options' format: ".csv", ".csv.gz", ".csv.zst" or ".trace".
+     */
+    static const char* fileExtension(const LoggerOptions& options);
+
     /**
      * @brief Logs summary metrics for performance benchmarks.
      *
@@ -62,9 +199,120 @@ class DataLogger {
      */
     void logSummary(const std::string& summary, double allocThroughput, double deallocThroughput, double fragmentation);
 
+    /**
+     * @brief Logs summary metrics together with allocation and deallocation latency percentiles.
+     *
+     * Appends the "Summary" row followed by an "AllocationLatency" and a "DeallocationLatency"
+     * row, so tail latency is recorded without logging every event. In the latency rows BlockSize
+     * holds the sample count and Time, Fragmentation and Source hold p50, p99 and p999.
+     *
+     * @param summary A descriptive summary of the benchmark.
+     * @param allocThroughput Allocation throughput in operations per second.
+     * @param deallocThroughput Deallocation throughput in operations per second.
+     * @param fragmentation Current memory fragmentation percentage.
+     * @param allocationLatency Allocation latency percentiles in nanoseconds.
+     * @param deallocationLatency Deallocation latency percentiles in nanoseconds.
+     */
+    void logSummary(const std::string& summary, double allocThroughput, double deallocThroughput, double fragmentation,
+                    const LatencyPercentiles& allocationLatency, const LatencyPercentiles& deallocationLatency);
+
+    /**
+     * @brief Hands every event logged before the call to the file, waiting for the writer thread in
+     * async mode.
+     *
+     * CSV rows are otherwise written out once LoggerOptions::writeBufferBytes of them are buffered,
+     * and when the logger is destroyed.
+     */
+    void flush();
+
+    /**
+     * @brief Events discarded because their ring was full (async mode with dropWhenFull).
+     */
+    size_t getDroppedEvents() const;
+
    private:
-    std::ofstream logFile;  ///< The output file stream for logging data.
-    std::mutex logMutex;    ///< Mutex to ensure thread-safe logging.
+    /**
+     * @brief Fixed-size copy of one log() call, as queued in async mode.
+     *
+     * Structured events are queued as they are; string events have their short fields copied and
+     * their Source and CallStack interned into event.sourceId and event.callStackId.
+     */
+    struct EventRecord {
+        bool structured;
+        LogEvent event;
+        char timestamp[32];
+        char operation[16];
+        char memoryAddress[24];
+        char threadID[24];
+        char allocationID[24];
+        double time;
+    };
+
+    /**
+     * @brief Formats LogEvent timestamps, re-deriving the local calendar time once per second.
+     */
+    struct TimestampCache {
+        int64_t second = std::numeric_limits<int64_t>::min();
+        char text[32] = {};      ///< "YYYY-MM-DD HH:MM:SS" in local time
+        int64_t wallClockNs = 0;  ///< The same local time as nanoseconds since 1970-01-01 (for traces)
+
+        void update(int64_t timestampNs);
+    };
+
+    struct EventRing;
+
+    std::unique_ptr<CsvWriter> csvWriter;      ///< Output for LogFormat::Csv.
+    std::unique_ptr<TraceWriter> traceWriter;  ///< Output for LogFormat::Binary.
+    std::unique_ptr<CsvWriter> consoleWriter;  ///< std::cout, with LoggerOptions::echoToConsole.
+    std::mutex logMutex;                       ///< Mutex to ensure thread-safe logging.
+
+    // Async mode state
+    LoggerOptions options;
+    uint64_t instanceId;
+    std::mutex ringsMutex;  // Guards threadRings and rings (not their contents)
+    std::unordered_map<std::thread::id, EventRing*> threadRings;
+    std::vector<std::unique_ptr<EventRing>> rings;
+    std::mutex internMutex;
+    std::deque<std::string> internedStrings;  // References stay valid as strings are added
+    std::unordered_map<std::string, uint32_t> internedIds;
+    TimestampCache timestamps;  // Used under logMutex in sync mode, by the writer thread in async mode
+    std::vector<uint32_t> traceStringIds;  // internedStrings id -> trace string id; guarded by logMutex
+    std::unordered_map<uint64_t, uint32_t> traceThreadIds;  // Thread id -> trace string id; guarded by logMutex
+    std::atomic<size_t> droppedEvents;
+    std::atomic<bool> drainRequested;  // Set by producers waiting on a full ring
+
+    std::thread writerThread;
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::condition_variable flushDone;
+    bool stopping;
+    uint64_t flushRequested;  // Flush generations; both guarded by writerMutex
+    uint64_t flushCompleted;
+
+    static std::string currentTimestamp();
+    bool isOpen() const;  // Caller holds logMutex
+
+    // Async mode paths
+    EventRing& localRing();
+    uint32_t intern(EventRing& ring, const std::string& value);
+    bool reserveSlot(EventRing& ring, size_t& tail);
+    void enqueue(const LogEvent& event);
+    void enqueue(const std::string& timestamp, const std::string& operation, size_t blockSize, double time,
+                 double fragmentation, const std::string& source, const std::string& callStack,
+                 const std::string& memoryAddress, const std::string& threadID, const std::string& allocationID);
+    void writerLoop();
+    void drainRings();
+    const std::string& internedString(uint32_t id);  // Caller holds internMutex
+    template <typename Format>
+    void emitRow(const char* consolePrefix, Format format);  // Caller holds logMutex
+    void writeEvent(CsvWriter& out, const LogEvent& event);
+    static void writeRow(CsvWriter& out, const char* timestamp, const char* operation, uint64_t blockSize, double time,
+                         double fragmentation, const std::string& source, const std::string& callStack,
+                         const char* memoryAddress, const char* threadID, const char* allocationID);
+    void flushWriters();  // Caller holds logMutex
+    void appendTraceEvent(const LogEvent& event);  // Caller holds logMutex and internMutex
+    void writeSummaryRow(const std::string& timestamp, const std::string& operation, uint64_t blockSize, double time,
+                         double fragmentation, double source, const std::string& summary);
 };
 
 #endif  // DATA_LOGGER_H
@@ -0,0 +1,55 @@
+#include "heap_snapshot_writer.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "custom_allocator.h"
+#include "data_logger.h"
+
+HeapSnapshotWriter::HeapSnapshotWriter(const std::string& filename) : snapshotCount(0) {
+    file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open heap snapshot file: " << filename << std::endl;
+        return;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void HeapSnapshotWriter::capture(CustomAllocator& allocator) {
+    allocator.snapshotHeap(scratch);
+    write(scratch, DataLogger::currentTimeNanoseconds());
+}
+
+void HeapSnapshotWriter::write(const HeapSnapshot& snapshot, int64_t timestampNs) {
+    if (!file.is_open()) {
+        return;
+    }
+    payload.clear();
+    encode(snapshot, payload);
+
+    SnapshotHeader header{};
+    header.timestampNs = timestampNs;
+    header.payloadBytes = static_cast<uint32_t>(payload.size());
+    header.runCount = static_cast<uint32_t>(snapshot.runs.size());
+    header.minOrder = static_cast<uint8_t>(snapshot.minOrder);
+    header.maxOrder = static_cast<uint8_t>(snapshot.maxOrder);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    ++snapshotCount;
+}
+
+void HeapSnapshotWriter::encode(const HeapSnapshot& snapshot, std::vector<uint8_t>& out) {
+    for (const HeapRun& run : snapshot.runs) {
+        out.push_back(static_cast<uint8_t>(run.order | (run.free ? FREE_BIT : 0)));
+        uint64_t blocks = run.blocks;
+        while (blocks >= 0x80) {
+            out.push_back(static_cast<uint8_t>(blocks | 0x80));
+            blocks >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(blocks));
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef HEAP_SNAPSHOT_WRITER_H
+#define HEAP_SNAPSHOT_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "heap_snapshot.h"
+
+class CustomAllocator;
+
+/**
+ * @class HeapSnapshotWriter
+ * @brief Appends CustomAllocator heap snapshots to a file, for occupancy maps over time.
+ *
+ * File layout (little-endian):
+ *   - a 16-byte FileHeader;
+ *   - per snapshot, a 32-byte SnapshotHeader followed by payloadBytes of runs, each one state
+ *     byte (order, plus FREE_BIT for free blocks) and the run's block count as an unsigned LEB128
+ *     varint.
+ *
+ * A pool that is mostly large free blocks and evenly sized allocations encodes in a few bytes
+ * per run, so snapshots can be taken every few thousand operations of a benchmark. Timestamps
+ * are DataLogger::currentTimeNanoseconds(), the clock of the event logs, so snapshots line up
+ * with them. scripts/heap_snapshot_reader.py reads the file back. Not thread-safe.
+ */
+class HeapSnapshotWriter {
+   public:
+    static constexpr char MAGIC[8] = {'D', 'M', 'A', 'H', 'E', 'A', 'P', 'S'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint8_t FREE_BIT = 0x80;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    struct SnapshotHeader {
+        int64_t timestampNs;
+        uint32_t payloadBytes;
+        uint32_t runCount;
+        uint8_t minOrder;
+        uint8_t maxOrder;
+        uint8_t reserved[14];
+    };
+
+    /**
+     * @brief Creates (or truncates) the snapshot file and writes its header.
+     * @param filename Path of the snapshot file.
+     */
+    explicit HeapSnapshotWriter(const std::string& filename);
+
+    HeapSnapshotWriter(const HeapSnapshotWriter&) = delete;
+    HeapSnapshotWriter& operator=(const HeapSnapshotWriter&) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+
+    /**
+     * @brief Snapshots allocator now and appends it.
+     */
+    void capture(CustomAllocator& allocator);
+
+    /**
+     * @brief Appends a snapshot taken at timestampNs.
+     */
+    void write(const HeapSnapshot& snapshot, int64_t timestampNs);
+
+    /**
+     * @brief Appends the encoded runs of snapshot (the payload of a file record) to out.
+     */
+    static void encode(const HeapSnapshot& snapshot, std::vector<uint8_t>& out);
+
+    uint64_t getSnapshotCount() const { return snapshotCount; }
+
+   private:
+    std::ofstream file;
+    uint64_t snapshotCount;
+
+    // Reused across captures, so a snapshot allocates only when the layout outgrows them
+    HeapSnapshot scratch;
+    std::vector<uint8_t> payload;
+};
+
+static_assert(sizeof(HeapSnapshotWriter::FileHeader) == 16, "snapshot file header layout is part of the format");
+static_assert(sizeof(HeapSnapshotWriter::SnapshotHeader) == 32, "snapshot header layout is part of the format");
+
+#endif  // HEAP_SNAPSHOT_WRITER_H
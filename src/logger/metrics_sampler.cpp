@@ -0,0 +1,248 @@
+#include "metrics_sampler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+LatencyPercentiles percentilesOf(const LatencySnapshot& snapshot) {
+    LatencyPercentiles result;
+    result.samples = snapshot.samples;
+    result.p50 = static_cast<double>(snapshot.percentile(0.50));
+    result.p99 = static_cast<double>(snapshot.percentile(0.99));
+    result.p999 = static_cast<double>(snapshot.percentile(0.999));
+    return result;
+}
+
+}  // namespace
+
+MetricsSampler::MetricsSampler(const CustomAllocator& allocator, const MetricsSamplerOptions& options)
+    : allocator(allocator),
+      options(options),
+      lastNs(DataLogger::currentTimeNanoseconds()),
+      lastAllocations(0),
+      lastDeallocations(0),
+      lastLatency(allocator.getLatencyStats()),
+      ringNext(0),
+      windowCount(0),
+      stopping(false) {
+    if (this->options.windowCapacity == 0) {
+        this->options.windowCapacity = 1;
+    }
+    ring.reserve(this->options.windowCapacity);
+    OperationTotals totals = allocator.getTotals();
+    lastAllocations = totals.allocations;
+    lastDeallocations = totals.deallocations;
+
+    if (this->options.format == MetricsFormat::Csv && !this->options.path.empty()) {
+        csv.open(this->options.path, std::ios::out | std::ios::trunc);
+        if (!csv.is_open()) {
+            std::cerr << "Failed to open metrics file: " << this->options.path << std::endl;
+            return;
+        }
+        writeCsvHeader();
+    }
+}
+
+MetricsSampler::~MetricsSampler() {
+    stop();
+}
+
+void MetricsSampler::start() {
+    if (samplerThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = false;
+    }
+    samplerThread = std::thread(&MetricsSampler::run, this);
+}
+
+void MetricsSampler::stop() {
+    if (!samplerThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    samplerThread.join();
+    sample();  // The time since the last full interval
+}
+
+void MetricsSampler::run() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!wake.wait_for(lock, options.interval, [this]() { return stopping; })) {
+        lock.unlock();
+        sample();
+        lock.lock();
+    }
+}
+
+MetricsWindow MetricsSampler::sample() {
+    std::lock_guard<std::mutex> lock(sampleMutex);
+
+    MetricsWindow window;
+    window.endNs = DataLogger::currentTimeNanoseconds();
+    OperationTotals totals = allocator.getTotals();
+    window.totalAllocations = totals.allocations;
+    window.totalDeallocations = totals.deallocations;
+    LatencyStats latency = allocator.getLatencyStats();
+    AllocatorStats stats = allocator.getStats();
+
+    window.startNs = lastNs;
+    window.allocations = window.totalAllocations - std::min(window.totalAllocations, lastAllocations);
+    window.deallocations = window.totalDeallocations - std::min(window.totalDeallocations, lastDeallocations);
+    window.freeBytes = stats.freeBytes;
+    window.externalFragmentation = stats.externalFragmentation();
+    window.freeBlocks = stats.freeBlocks;
+
+    LatencySnapshot allocation = latency.allocation;
+    allocation.subtract(lastLatency.allocation);
+    LatencySnapshot deallocation = latency.deallocation;
+    deallocation.subtract(lastLatency.deallocation);
+    window.allocationLatency = percentilesOf(allocation);
+    window.deallocationLatency = percentilesOf(deallocation);
+
+    lastNs = window.endNs;
+    lastAllocations = window.totalAllocations;
+    lastDeallocations = window.totalDeallocations;
+    lastLatency = latency;
+
+    {
+        std::lock_guard<std::mutex> ringLock(ringMutex);
+        if (ring.size() < options.windowCapacity) {
+            ring.push_back(window);
+        } else {
+            ring[ringNext] = window;
+        }
+        ringNext = (ringNext + 1) % options.windowCapacity;
+        ++windowCount;
+    }
+
+    if (csv.is_open()) {
+        writeCsv(window);
+    } else if (options.format == MetricsFormat::Prometheus && !options.path.empty()) {
+        writePrometheus(window);
+    }
+    return window;
+}
+
+std::vector<MetricsWindow> MetricsSampler::windows() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    if (ring.size() < options.windowCapacity) {
+        return ring;
+    }
+    std::vector<MetricsWindow> ordered(ring.begin() + static_cast<std::ptrdiff_t>(ringNext), ring.end());
+    ordered.insert(ordered.end(), ring.begin(), ring.begin() + static_cast<std::ptrdiff_t>(ringNext));
+    return ordered;
+}
+
+uint64_t MetricsSampler::getWindowCount() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    return windowCount;
+}
+
+bool MetricsSampler::parseFormat(const std::string& name, MetricsSamplerOptions& options) {
+    if (name == "csv") {
+        options.format = MetricsFormat::Csv;
+    } else if (name == "prometheus") {
+        options.format = MetricsFormat::Prometheus;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* MetricsSampler::fileExtension(MetricsFormat format) {
+    return format == MetricsFormat::Prometheus ? ".prom" : ".metrics.csv";
+}
+
+void MetricsSampler::writeCsvHeader() {
+    csv << "StartNs,EndNs,Allocations,Deallocations,AllocThroughput,DeallocThroughput,TotalAllocations,"
+           "TotalDeallocations,FreeBytes,ExternalFragmentation,AllocSamples,AllocP50,AllocP99,AllocP999,"
+           "DeallocSamples,DeallocP50,DeallocP99,DeallocP999";
+    for (size_t order = allocator.getMinOrder(); order <= allocator.getMaxOrder(); ++order) {
+        csv << ",FreeBlocks" << order;
+    }
+    csv << '\n';
+    csv.flush();
+}
+
+void MetricsSampler::writeCsv(const MetricsWindow& window) {
+    csv << window.startNs << ',' << window.endNs << ',' << window.allocations << ',' << window.deallocations << ','
+        << window.allocationsPerSecond() << ',' << window.deallocationsPerSecond() << ',' << window.totalAllocations
+        << ',' << window.totalDeallocations << ',' << window.freeBytes << ',' << window.externalFragmentation << ','
+        << window.allocationLatency.samples << ',' << window.allocationLatency.p50 << ','
+        << window.allocationLatency.p99 << ',' << window.allocationLatency.p999 << ','
+        << window.deallocationLatency.samples << ',' << window.deallocationLatency.p50 << ','
+        << window.deallocationLatency.p99 << ',' << window.deallocationLatency.p999;
+    for (size_t order = allocator.getMinOrder(); order <= allocator.getMaxOrder(); ++order) {
+        csv << ',' << window.freeBlocks[order];
+    }
+    csv << '\n';
+    // Flushed per window so the file can be followed while the run continues
+    csv.flush();
+}
+
+/**
+ * @brief Rewrites the Prometheus text file with the latest window.
+ *
+ * The file is written beside the target and renamed over it, so a collector never reads a
+ * partial file.
+ */
+void MetricsSampler::writePrometheus(const MetricsWindow& window) {
+    std::ostringstream out;
+    out << "# HELP allocator_allocations_total Allocations made by the allocator.\n"
+        << "# TYPE allocator_allocations_total counter\n"
+        << "allocator_allocations_total " << window.totalAllocations << '\n'
+        << "# HELP allocator_deallocations_total Deallocations made by the allocator.\n"
+        << "# TYPE allocator_deallocations_total counter\n"
+        << "allocator_deallocations_total " << window.totalDeallocations << '\n'
+        << "# HELP allocator_window_operations_per_second Operations per second over the last window.\n"
+        << "# TYPE allocator_window_operations_per_second gauge\n"
+        << "allocator_window_operations_per_second{operation=\"allocation\"} " << window.allocationsPerSecond() << '\n'
+        << "allocator_window_operations_per_second{operation=\"deallocation\"} " << window.deallocationsPerSecond()
+        << '\n'
+        << "# HELP allocator_window_latency_nanoseconds Latency percentiles of the operations timed in the last window.\n"
+        << "# TYPE allocator_window_latency_nanoseconds gauge\n";
+    const std::pair<const char*, const LatencyPercentiles*> operations[] = {
+        {"allocation", &window.allocationLatency}, {"deallocation", &window.deallocationLatency}};
+    for (const auto& [operation, latency] : operations) {
+        out << "allocator_window_latency_nanoseconds{operation=\"" << operation << "\",quantile=\"0.5\"} "
+            << latency->p50 << '\n'
+            << "allocator_window_latency_nanoseconds{operation=\"" << operation << "\",quantile=\"0.99\"} "
+            << latency->p99 << '\n'
+            << "allocator_window_latency_nanoseconds{operation=\"" << operation << "\",quantile=\"0.999\"} "
+            << latency->p999 << '\n';
+    }
+    out << "# HELP allocator_free_bytes Bytes in free blocks.\n"
+        << "# TYPE allocator_free_bytes gauge\n"
+        << "allocator_free_bytes " << window.freeBytes << '\n'
+        << "# HELP allocator_external_fragmentation 1 - largest free block / free bytes.\n"
+        << "# TYPE allocator_external_fragmentation gauge\n"
+        << "allocator_external_fragmentation " << window.externalFragmentation << '\n'
+        << "# HELP allocator_free_blocks Free blocks of each order.\n"
+        << "# TYPE allocator_free_blocks gauge\n";
+    for (size_t order = allocator.getMinOrder(); order <= allocator.getMaxOrder(); ++order) {
+        out << "allocator_free_blocks{order=\"" << order << "\"} " << window.freeBlocks[order] << '\n';
+    }
+
+    std::string temporary = options.path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open metrics file: " << temporary << std::endl;
+            return;
+        }
+        file << out.str();
+    }
+    if (std::rename(temporary.c_str(), options.path.c_str()) != 0) {
+        std::cerr << "Failed to replace metrics file: " << options.path << std::endl;
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef METRICS_SAMPLER_H
+#define METRICS_SAMPLER_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "custom_allocator.h"
+#include "data_logger.h"  // LatencyPercentiles
+
+/**
+ * @enum MetricsFormat
+ * @brief How MetricsSampler exports its windows.
+ */
+enum class MetricsFormat {
+    Csv,        ///< One row per window appended to a CSV file
+    Prometheus  ///< A Prometheus text-format file rewritten after each window (node_exporter textfile style)
+};
+
+/**
+ * @struct MetricsSamplerOptions
+ * @brief Sampling period, ring size and export destination of a MetricsSampler.
+ */
+struct MetricsSamplerOptions {
+    std::chrono::milliseconds interval{1000};  ///< Length of a window
+    size_t windowCapacity = 120;               ///< Windows kept in memory; the oldest is overwritten
+    MetricsFormat format = MetricsFormat::Csv;
+    std::string path;  ///< Export file; empty keeps the windows in memory only
+};
+
+/**
+ * @struct MetricsWindow
+ * @brief What an allocator did between two samples, and its free space at the end.
+ */
+struct MetricsWindow {
+    int64_t startNs = 0;  ///< DataLogger::currentTimeNanoseconds() at the previous sample
+    int64_t endNs = 0;
+    uint64_t allocations = 0;    ///< In this window
+    uint64_t deallocations = 0;  ///< In this window
+    uint64_t totalAllocations = 0;    ///< getTotalAllocations() at endNs
+    uint64_t totalDeallocations = 0;  ///< getTotalDeallocations() at endNs
+    size_t freeBytes = 0;
+    double externalFragmentation = 0.0;
+    std::array<size_t, AllocatorStats::MAX_ORDERS> freeBlocks{};  ///< Free blocks of each order at endNs
+    LatencyPercentiles allocationLatency;    ///< Of the operations timed in this window
+    LatencyPercentiles deallocationLatency;
+
+    double seconds() const { return static_cast<double>(endNs - startNs) / 1e9; }
+    double allocationsPerSecond() const { return endNs > startNs ? static_cast<double>(allocations) / seconds() : 0.0; }
+    double deallocationsPerSecond() const {
+        return endNs > startNs ? static_cast<double>(deallocations) / seconds() : 0.0;
+    }
+};
+
+/**
+ * @class MetricsSampler
+ * @brief Background thread turning an allocator's counters into windowed throughput and latency.
+ *
+ * Every interval the sampler reads the allocation counters, getStats() and getLatencyStats() and
+ * stores the difference from the previous sample as a MetricsWindow in a ring of windowCapacity
+ * entries, so a run of any length uses fixed memory and needs no per-event logging. None of
+ * these reads takes the allocator lock; the counters and the latency histograms are each read in
+ * one pass over the per-thread state under the allocator's thread-registry lock, which a thread
+ * allocating for the first time briefly contends for. Each window is exported as it closes, so a long soak run
+ * can be watched while it runs; stop() closes a final, possibly shorter, window.
+ *
+ * Latency percentiles cover only the operations the allocator timed (see TimingOptions), and are
+ * zero when built with ALLOCATOR_TIMING=0.
+ */
+class MetricsSampler {
+   public:
+    /**
+     * @brief Takes the baseline sample and opens the export file; call start() to begin sampling.
+     * @param allocator The allocator to sample; must outlive the sampler.
+     * @param options Interval, ring capacity and export destination.
+     */
+    MetricsSampler(const CustomAllocator& allocator, const MetricsSamplerOptions& options);
+    ~MetricsSampler();
+
+    MetricsSampler(const MetricsSampler&) = delete;
+    MetricsSampler& operator=(const MetricsSampler&) = delete;
+
+    /// Starts the sampling thread; does nothing if it is running.
+    void start();
+
+    /// Stops the sampling thread and closes the last window. Called by the destructor.
+    void stop();
+
+    /**
+     * @brief Closes the current window now, as the sampling thread does every interval.
+     * @return The window recorded.
+     */
+    MetricsWindow sample();
+
+    /// Windows still in the ring, oldest first.
+    std::vector<MetricsWindow> windows() const;
+
+    /// Windows recorded so far, including those overwritten in the ring.
+    uint64_t getWindowCount() const;
+
+    /**
+     * @brief Sets options.format from a name: "csv" or "prometheus".
+     * @return False, leaving options unchanged, for an unknown name.
+     */
+    static bool parseFormat(const std::string& name, MetricsSamplerOptions& options);
+
+    /// File name suffix for the format: ".metrics.csv" or ".prom".
+    static const char* fileExtension(MetricsFormat format);
+
+   private:
+    const CustomAllocator& allocator;
+    MetricsSamplerOptions options;
+
+    // Previous sample, which the next window is measured from; guarded by sampleMutex
+    std::mutex sampleMutex;
+    int64_t lastNs;
+    uint64_t lastAllocations;
+    uint64_t lastDeallocations;
+    LatencyStats lastLatency;
+    std::ofstream csv;
+
+    mutable std::mutex ringMutex;
+    std::vector<MetricsWindow> ring;
+    size_t ringNext;
+    uint64_t windowCount;
+
+    std::thread samplerThread;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void run();
+    void writeCsvHeader();
+    void writeCsv(const MetricsWindow& window);
+    void writePrometheus(const MetricsWindow& window);
+};
+
+#endif  // METRICS_SAMPLER_H
@@ -0,0 +1,68 @@
+#include "trace_reader.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const std::string EMPTY_STRING;
+
+}  // namespace
+
+TraceReader::TraceReader(const std::string& filename) : open(false) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open trace file: " << filename << std::endl;
+        return;
+    }
+
+    TraceWriter::TraceHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, TraceWriter::MAGIC, sizeof(TraceWriter::MAGIC)) != 0 ||
+        header.version != TraceWriter::VERSION || header.recordSize != sizeof(TraceWriter::TraceRecord)) {
+        std::cerr << filename << " is not a version " << TraceWriter::VERSION << " allocator trace" << std::endl;
+        return;
+    }
+    if (header.stringTableOffset == 0) {
+        std::cerr << filename << " was not closed by its writer (no string table)" << std::endl;
+        return;
+    }
+
+    records.resize(header.recordCount);
+    file.read(reinterpret_cast<char*>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(TraceWriter::TraceRecord)));
+
+    file.seekg(static_cast<std::streamoff>(header.stringTableOffset));
+    uint32_t count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    strings.reserve(count);
+    for (uint32_t i = 0; i < count && file; ++i) {
+        uint32_t length = 0;
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string value(length, '\0');
+        file.read(&value[0], length);
+        strings.push_back(std::move(value));
+    }
+
+    if (!file) {
+        std::cerr << filename << " is truncated" << std::endl;
+        records.clear();
+        strings.clear();
+        return;
+    }
+    open = true;
+}
+
+const std::string& TraceReader::getString(uint32_t id) const {
+    return id < strings.size() ? strings[id] : EMPTY_STRING;
+}
+
+uint32_t TraceReader::findString(const std::string& value) const {
+    for (size_t i = 0; i < strings.size(); ++i) {
+        if (strings[i] == value) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    return TraceWriter::NO_STRING;
+}
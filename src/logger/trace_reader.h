@@ -0,0 +1,42 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "trace_writer.h"
+
+/**
+ * @class TraceReader
+ * @brief Loads a binary trace written by TraceWriter (see trace_writer.h for the layout).
+ *
+ * Reads the records and the string table into memory; scripts/trace_reader.py is the
+ * memory-mapped equivalent for the visualizer. A file that is missing, of another version, or
+ * was never closed by its writer is reported on std::cerr and leaves the reader empty.
+ */
+class TraceReader {
+   public:
+    explicit TraceReader(const std::string& filename);
+
+    bool isOpen() const { return open; }
+
+    const std::vector<TraceWriter::TraceRecord>& getRecords() const { return records; }
+
+    /**
+     * @brief The string with table index id; empty for NO_STRING or an index out of range.
+     */
+    const std::string& getString(uint32_t id) const;
+
+    /**
+     * @brief Table index of value, or NO_STRING if the trace never logged it.
+     */
+    uint32_t findString(const std::string& value) const;
+
+   private:
+    bool open;
+    std::vector<TraceWriter::TraceRecord> records;
+    std::vector<std::string> strings;
+};
+
+#endif  // TRACE_READER_H
@@ -0,0 +1,152 @@
+#include "trace_replay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include "custom_allocator.h"
+
+namespace {
+
+/// Slot value while its allocation has not run yet.
+constexpr uintptr_t SLOT_PENDING = 0;
+/// Slot value once there is no block to free: its allocation failed, or it has been freed.
+constexpr uintptr_t SLOT_EMPTY = 1;
+
+/**
+ * @brief Spins until done() holds, yielding once a short spin has not been enough.
+ */
+template <typename Condition>
+void waitUntil(Condition done) {
+    for (unsigned spins = 0; !done(); ++spins) {
+        if (spins >= 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}  // namespace
+
+ReplayWorkload ReplayWorkload::fromTrace(const TraceReader& trace) {
+    ReplayWorkload workload;
+    const std::vector<TraceWriter::TraceRecord>& records = trace.getRecords();
+    uint32_t allocationId = trace.findString("Allocation");
+    uint32_t deallocationId = trace.findString("Deallocation");
+
+    std::vector<size_t> order;
+    order.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        uint32_t operation = records[i].operation;
+        if (operation != TraceWriter::NO_STRING && (operation == allocationId || operation == deallocationId)) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&records](size_t a, size_t b) { return records[a].timestampNs < records[b].timestampNs; });
+
+    std::unordered_map<uint32_t, uint32_t> threads;  // ThreadID string index -> replay thread
+    std::unordered_map<uint64_t, uint32_t> live;     // AllocationID or address -> slot
+    workload.operations.reserve(order.size());
+    for (size_t index : order) {
+        const TraceWriter::TraceRecord& record = records[index];
+        uint64_t key = record.allocationId != TraceWriter::NO_ALLOCATION_ID
+                           ? static_cast<uint64_t>(record.allocationId)
+                           : record.memoryAddress;
+
+        ReplayOperation operation;
+        operation.timestampNs = record.timestampNs;
+        operation.size = record.blockSize;
+        operation.allocation = record.operation == allocationId;
+        if (operation.allocation) {
+            operation.slot = static_cast<uint32_t>(workload.slots++);
+            live[key] = operation.slot;  // A key whose free was not recorded is simply overwritten
+        } else {
+            auto found = live.find(key);
+            if (found == live.end()) {
+                ++workload.unmatchedFrees;
+                continue;
+            }
+            operation.slot = found->second;
+            live.erase(found);
+        }
+        operation.thread = threads.emplace(record.threadId, static_cast<uint32_t>(threads.size())).first->second;
+        workload.operations.push_back(operation);
+    }
+    workload.threads = threads.size();
+    return workload;
+}
+
+ReplayResult replayWorkload(CustomAllocator& allocator, const ReplayWorkload& workload, const ReplayOptions& options) {
+    ReplayResult result;
+    std::vector<std::vector<uint32_t>> perThread(workload.threads);
+    for (size_t i = 0; i < workload.operations.size(); ++i) {
+        perThread[workload.operations[i].thread].push_back(static_cast<uint32_t>(i));
+    }
+
+    std::unique_ptr<std::atomic<uintptr_t>[]> addresses(new std::atomic<uintptr_t>[workload.slots]());
+    std::vector<ReplayResult> counts(workload.threads);
+    std::atomic<size_t> turn{0};  // Next operation to run in strict order
+    int64_t firstTimestamp = workload.operations.empty() ? 0 : workload.operations.front().timestampNs;
+    auto start = std::chrono::steady_clock::now();
+
+    auto run = [&](size_t thread) {
+        ReplayResult& count = counts[thread];
+        for (uint32_t index : perThread[thread]) {
+            const ReplayOperation& operation = workload.operations[index];
+            if (options.speed > 0.0) {
+                auto offset = std::chrono::nanoseconds(
+                    static_cast<int64_t>(static_cast<double>(operation.timestampNs - firstTimestamp) / options.speed));
+                std::this_thread::sleep_until(start + offset);
+            }
+            if (options.ordering == ReplayOrdering::Strict) {
+                waitUntil([&] { return turn.load(std::memory_order_acquire) == index; });
+            }
+
+            std::atomic<uintptr_t>& address = addresses[operation.slot];
+            if (operation.allocation) {
+                void* ptr = allocator.allocate(operation.size);
+                address.store(ptr ? reinterpret_cast<uintptr_t>(ptr) : SLOT_EMPTY, std::memory_order_release);
+                ++(ptr ? count.allocations : count.failedAllocations);
+            } else {
+                waitUntil([&] { return address.load(std::memory_order_acquire) != SLOT_PENDING; });
+                uintptr_t value = address.load(std::memory_order_relaxed);
+                if (value != SLOT_EMPTY) {
+                    allocator.deallocate(reinterpret_cast<void*>(value));
+                    address.store(SLOT_EMPTY, std::memory_order_relaxed);
+                    ++count.deallocations;
+                }
+            }
+
+            if (options.ordering == ReplayOrdering::Strict) {
+                turn.store(index + 1, std::memory_order_release);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workload.threads);
+    for (size_t thread = 0; thread < workload.threads; ++thread) {
+        threads.emplace_back(run, thread);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const ReplayResult& count : counts) {
+        result.allocations += count.allocations;
+        result.deallocations += count.deallocations;
+        result.failedAllocations += count.failedAllocations;
+    }
+    for (size_t slot = 0; slot < workload.slots; ++slot) {
+        uintptr_t value = addresses[slot].load(std::memory_order_relaxed);
+        if (value != SLOT_PENDING && value != SLOT_EMPTY) {
+            allocator.deallocate(reinterpret_cast<void*>(value));
+            ++result.leakedBlocks;
+        }
+    }
+    return result;
+}
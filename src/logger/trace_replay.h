@@ -0,0 +1,78 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "trace_reader.h"
+
+class CustomAllocator;
+
+/**
+ * @brief How replay threads are kept in step with one another.
+ */
+enum class ReplayOrdering {
+    Strict,  ///< Operations run one at a time in the recorded global order; fully deterministic
+    Causal,  ///< Threads run freely; a free only waits for the allocation it releases
+};
+
+/**
+ * @struct ReplayOperation
+ * @brief One allocation or deallocation of a recorded workload.
+ */
+struct ReplayOperation {
+    int64_t timestampNs;  ///< When it was recorded, for time-scaled replay
+    uint64_t size;        ///< Requested bytes (allocations only)
+    uint32_t slot;        ///< Dense id of the allocation; a free names the slot it releases
+    uint32_t thread;      ///< Dense id of the recording thread
+    bool allocation;
+};
+
+/**
+ * @struct ReplayWorkload
+ * @brief Allocations and frees of a trace, paired and in recorded order.
+ */
+struct ReplayWorkload {
+    std::vector<ReplayOperation> operations;
+    size_t threads = 0;
+    size_t slots = 0;
+    size_t unmatchedFrees = 0;  ///< Frees of blocks allocated before recording began; dropped
+
+    /**
+     * @brief Builds a workload from the Allocation and Deallocation rows of a trace.
+     *
+     * Rows are ordered by timestamp (stably, so equal timestamps keep their logged order). A
+     * free is paired with the live allocation of the same AllocationID, or of the same address
+     * when the trace has no IDs; ThreadID strings become dense replay thread ids.
+     */
+    static ReplayWorkload fromTrace(const TraceReader& trace);
+};
+
+/**
+ * @struct ReplayOptions
+ * @brief Pacing and ordering of a replay.
+ */
+struct ReplayOptions {
+    double speed = 0.0;  ///< 0 replays at full speed; otherwise recorded time divided by speed (1 = real time)
+    ReplayOrdering ordering = ReplayOrdering::Strict;
+};
+
+/**
+ * @struct ReplayResult
+ * @brief Outcome of one replay.
+ */
+struct ReplayResult {
+    double seconds = 0.0;  ///< Wall time of the replay, from starting the threads to the last operation
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t failedAllocations = 0;  ///< Allocations the pool could not satisfy; their frees are skipped
+    size_t leakedBlocks = 0;       ///< Allocations the trace never freed, released after timing
+};
+
+/**
+ * @brief Replays workload against allocator on one thread per recorded thread.
+ */
+ReplayResult replayWorkload(CustomAllocator& allocator, const ReplayWorkload& workload, const ReplayOptions& options);
+
+#endif  // TRACE_REPLAY_H
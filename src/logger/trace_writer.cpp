@@ -0,0 +1,168 @@
+#include "trace_writer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+/// datetime64 "not a time"; written for timestamps that do not parse.
+constexpr int64_t INVALID_TIMESTAMP = std::numeric_limits<int64_t>::min();
+
+/**
+ * @brief Reads exactly count decimal digits; returns false if any is missing.
+ */
+bool readDigits(const char*& cursor, size_t count, int64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < count; ++i, ++cursor) {
+        if (*cursor < '0' || *cursor > '9') {
+            return false;
+        }
+        value = value * 10 + (*cursor - '0');
+    }
+    return true;
+}
+
+}  // namespace
+
+TraceWriter::TraceWriter(const std::string& filename) : recordCount(0), lastTimestampNs(INVALID_TIMESTAMP) {
+    file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open trace file: " << filename << std::endl;
+        return;
+    }
+    buffer.reserve(BUFFERED_RECORDS);
+
+    TraceHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+TraceWriter::~TraceWriter() {
+    if (file.is_open()) {
+        close();
+    }
+}
+
+void TraceWriter::append(const char* timestamp, const char* operation, uint64_t blockSize, double time,
+                         double fragmentation, const std::string& source, const std::string& callStack,
+                         const char* memoryAddress, const char* threadID, const char* allocationID) {
+    TraceRecord record;
+    record.timestampNs = parseTimestamp(timestamp);
+    record.blockSize = blockSize;
+    record.time = time;
+    record.fragmentation = fragmentation;
+    record.memoryAddress = std::strtoull(memoryAddress, nullptr, 16);  // Accepts a 0x prefix; 0 if empty
+    record.allocationId = NO_ALLOCATION_ID;
+    if (std::strncmp(allocationID, "Alloc", 5) == 0 && allocationID[5] != '\0') {
+        record.allocationId = std::strtoll(allocationID + 5, nullptr, 10);
+    }
+    record.operation = intern(operation, std::strlen(operation));
+    record.source = intern(source);
+    record.callStack = intern(callStack);
+    record.threadId = intern(threadID, std::strlen(threadID));
+
+    append(record);
+}
+
+void TraceWriter::append(const TraceRecord& record) {
+    buffer.push_back(record);
+    if (buffer.size() == BUFFERED_RECORDS) {
+        writeBuffer();
+    }
+}
+
+void TraceWriter::close() {
+    writeBuffer();
+
+    TraceHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.recordCount = recordCount;
+    header.stringTableOffset = sizeof(TraceHeader) + recordCount * sizeof(TraceRecord);
+
+    uint32_t count = static_cast<uint32_t>(strings.size());
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const std::string& value : strings) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(value.data(), static_cast<std::streamsize>(length));
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+}
+
+int64_t TraceWriter::daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+uint32_t TraceWriter::intern(const char* value, size_t length) {
+    if (length == 0) {
+        return NO_STRING;
+    }
+    std::string key(value, length);
+    auto found = stringIds.find(key);
+    if (found != stringIds.end()) {
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(key);
+    stringIds.emplace(std::move(key), id);
+    return id;
+}
+
+/**
+ * @brief Converts "YYYY-MM-DD HH:MM:SS[.fraction]" to nanoseconds since 1970-01-01 on the same clock.
+ */
+int64_t TraceWriter::parseTimestamp(const char* timestamp) {
+    if (lastTimestamp == timestamp) {
+        return lastTimestampNs;
+    }
+    lastTimestamp = timestamp;
+
+    const char* cursor = timestamp;
+    int64_t year, month, day, hour, minute, second;
+    bool valid = readDigits(cursor, 4, year) && *cursor++ == '-' && readDigits(cursor, 2, month) &&
+                 *cursor++ == '-' && readDigits(cursor, 2, day) && *cursor++ == ' ' && readDigits(cursor, 2, hour) &&
+                 *cursor++ == ':' && readDigits(cursor, 2, minute) && *cursor++ == ':' &&
+                 readDigits(cursor, 2, second) && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+    if (!valid) {
+        lastTimestampNs = INVALID_TIMESTAMP;
+        return lastTimestampNs;
+    }
+
+    int64_t fraction = 0;
+    if (*cursor == '.') {
+        ++cursor;
+        int64_t scale = 100000000;
+        for (; *cursor >= '0' && *cursor <= '9'; ++cursor, scale /= 10) {
+            fraction += (*cursor - '0') * scale;
+        }
+    }
+
+    int64_t seconds = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+                      hour * 3600 + minute * 60 + second;
+    lastTimestampNs = seconds * 1000000000 + fraction;
+    return lastTimestampNs;
+}
+
+void TraceWriter::writeBuffer() {
+    if (buffer.empty()) {
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()),
+               static_cast<std::streamsize>(buffer.size() * sizeof(TraceRecord)));
+    recordCount += buffer.size();
+    buffer.clear();
+}
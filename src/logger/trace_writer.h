@@ -0,0 +1,126 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TraceWriter
+ * @brief Writes DataLogger rows as a compact binary trace instead of CSV text.
+ *
+ * File layout (little-endian):
+ *   - a 64-byte TraceHeader;
+ *   - recordCount fixed-width TraceRecords, one per row;
+ *   - the string table at stringTableOffset: a uint32 count, then per string a uint32 byte
+ *     length and the bytes.
+ *
+ * Operation, Source, CallStack and ThreadID are stored as indices into the string table, so
+ * repeated strings cost four bytes per row. Timestamps are nanoseconds since 1970-01-01 in the
+ * wall clock they were logged in (no time zone conversion, matching the naive CSV strings).
+ * Record count and table offset are patched into the header by close(); a trace whose writer
+ * did not close has recordCount 0 and no string table.
+ *
+ * scripts/trace_reader.py maps the record block straight into a numpy structured array.
+ * Not thread-safe; DataLogger serialises calls under its log mutex.
+ */
+class TraceWriter {
+   public:
+    static constexpr char MAGIC[8] = {'D', 'M', 'A', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t NO_STRING = 0xFFFFFFFFu;   ///< String index of an empty field
+    static constexpr int64_t NO_ALLOCATION_ID = -1;      ///< Allocation index of an empty field
+
+    struct TraceHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t recordCount;
+        uint64_t stringTableOffset;
+        uint8_t reserved[32];
+    };
+
+    struct TraceRecord {
+        int64_t timestampNs;
+        uint64_t blockSize;
+        double time;
+        double fragmentation;
+        uint64_t memoryAddress;
+        int64_t allocationId;  ///< Number after the "Alloc" prefix, or NO_ALLOCATION_ID
+        uint32_t operation;    ///< String table indices, or NO_STRING
+        uint32_t source;
+        uint32_t callStack;
+        uint32_t threadId;
+    };
+
+    /**
+     * @brief Creates (or truncates) the trace file and writes a provisional header.
+     * @param filename Path of the trace file.
+     */
+    explicit TraceWriter(const std::string& filename);
+
+    /**
+     * @brief Closes the trace if close() was not called.
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+
+    /**
+     * @brief Appends one row; the arguments are those of DataLogger::log.
+     */
+    void append(const char* timestamp, const char* operation, uint64_t blockSize, double time, double fragmentation,
+                const std::string& source, const std::string& callStack, const char* memoryAddress,
+                const char* threadID, const char* allocationID);
+
+    /**
+     * @brief Appends one prepared record; its string fields must be ids returned by intern().
+     */
+    void append(const TraceRecord& record);
+
+    /**
+     * @brief Returns the string table index of value, adding it if new; NO_STRING if it is empty.
+     */
+    uint32_t intern(const char* value, size_t length);
+    uint32_t intern(const std::string& value) { return intern(value.data(), value.size()); }
+
+    /**
+     * @brief Writes buffered records, the string table and the final header, then closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Days from 1970-01-01 to the given proleptic Gregorian date; used to encode timestamps.
+     */
+    static int64_t daysFromCivil(int64_t year, unsigned month, unsigned day);
+
+    uint64_t getRecordCount() const { return recordCount; }
+
+   private:
+    static constexpr size_t BUFFERED_RECORDS = 4096;
+
+    std::ofstream file;
+    std::vector<TraceRecord> buffer;
+    uint64_t recordCount;
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIds;
+
+    // Timestamps repeat for every row logged within the same second, so the last parse is cached
+    std::string lastTimestamp;
+    int64_t lastTimestampNs;
+
+    int64_t parseTimestamp(const char* timestamp);
+    void writeBuffer();
+};
+
+static_assert(sizeof(TraceWriter::TraceHeader) == 64, "trace header layout is part of the file format");
+static_assert(sizeof(TraceWriter::TraceRecord) == 64, "trace record layout is part of the file format");
+
+#endif  // TRACE_WRITER_H
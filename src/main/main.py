@@ -1,17 +1,70 @@
 import argparse
+import multiprocessing
 import os
 import sys
+from concurrent.futures import ProcessPoolExecutor
 from datetime import datetime
 from pathlib import Path
-from typing import List
+from typing import List, Optional, Tuple
 
 PROJECT_ROOT = Path(__file__).resolve().parents[2]
 if str(PROJECT_ROOT) not in sys.path:
     sys.path.insert(0, str(PROJECT_ROOT))
 
 from scripts.data_loader import DataLoader
+from scripts.heap_snapshot_reader import is_heap_snapshot_file, read_heap_snapshots
+from scripts.plot_data import DEFAULT_MAX_EVENT_ROWS, PlotData
 from scripts.visualizer import Visualizer
 
+# State of each plot worker process, set once by _init_plot_worker rather than pickled per plot
+_worker_viz: Optional[Visualizer] = None
+_worker_data: Optional[PlotData] = None
+
+
+def _init_plot_worker(data: PlotData) -> None:
+    """
+    Prepares a plot worker: a non-interactive backend, its own Visualizer, and the shared data.
+    """
+    global _worker_viz, _worker_data
+    import matplotlib.pyplot as plt
+    plt.switch_backend('Agg')
+    _worker_viz = Visualizer()
+    _worker_data = data
+
+
+def _render_plot(method_name: str, output_path: str) -> None:
+    """
+    Draws one plot in a worker process.
+    """
+    getattr(_worker_viz, method_name)(_worker_data, output_path=output_path)
+
+
+def render_plots(viz: Visualizer, data: PlotData, jobs: List[Tuple[str, str]], workers: int) -> None:
+    """
+    Draws each (method name, output path) job, in parallel worker processes when workers > 1.
+
+    Each plot is drawn on a figure of its own, so the plots are independent and the files are
+    the same whichever way they are drawn. Workers are forked where the platform allows it, so
+    they start with the data already in memory.
+    """
+    workers = min(workers, len(jobs))
+    if workers <= 1:
+        for method_name, output_path in jobs:
+            getattr(viz, method_name)(data, output_path=output_path)
+        return
+
+    methods = multiprocessing.get_all_start_methods()
+    context = multiprocessing.get_context('fork' if 'fork' in methods else None)
+    with ProcessPoolExecutor(max_workers=workers, mp_context=context,
+                             initializer=_init_plot_worker, initargs=(data,)) as pool:
+        futures = [pool.submit(_render_plot, method_name, output_path) for method_name, output_path in jobs]
+        for (method_name, output_path), future in zip(jobs, futures):
+            try:
+                future.result()
+            except Exception as e:
+                print(f"Error generating '{os.path.basename(output_path)}': {e}")
+
+
 def main():
     """
     The main entry point for the visualization tool.
@@ -28,7 +81,7 @@ def main():
         type=str,
         nargs='+',
         default=[],
-        help='Path(s) to the input CSV file(s) containing performance data.'
+        help='Path(s) to the input CSV, trace or .heap snapshot file(s) containing performance data.'
     )
     parser.add_argument(
         '-o', '--output',
@@ -56,11 +109,32 @@ def main():
             'allocation_size_vs_time_heatmap',
             'call_stack_trace_frequency',
             'throughput_trends',
+            'latency_summary_percentiles',
+            'heap_occupancy_map',
             'all'
         ],
         default=['all'],
         help='Types of plots to generate. Choose from the list or select "all" for all plots.'
     )
+    parser.add_argument(
+        '-j', '--jobs',
+        type=int,
+        default=os.cpu_count() or 1,
+        help='Number of processes drawing plots in parallel. Defaults to the number of CPUs; 1 draws them in turn.'
+    )
+    parser.add_argument(
+        '--chunk-rows',
+        type=int,
+        default=0,
+        help='Stream each input in chunks of this many rows instead of loading it whole. Defaults to 0 (load whole).'
+    )
+    parser.add_argument(
+        '--max-event-rows',
+        type=int,
+        default=DEFAULT_MAX_EVENT_ROWS,
+        help=f'When streaming, the number of event rows kept for per-event plots; larger inputs are sampled evenly. '
+             f'Defaults to {DEFAULT_MAX_EVENT_ROWS}.'
+    )
 
     args = parser.parse_args()
 
@@ -72,10 +146,12 @@ def main():
         # Look for CSV files in reports directory
         reports_dir = "reports"
         if os.path.exists(reports_dir):
+            # Windowed metrics (.metrics.csv) are not event logs
             csv_files = [os.path.join(reports_dir, f) for f in os.listdir(reports_dir) 
-                        if f.endswith('.csv')]
+                        if f.endswith(('.csv', '.csv.gz', '.csv.zst', '.trace', '.heap'))
+                        and not f.endswith('.metrics.csv')]
             if csv_files:
-                print(f"No input files provided. Found {len(csv_files)} CSV file(s) in reports/ directory.")
+                print(f"No input files provided. Found {len(csv_files)} CSV or trace file(s) in reports/ directory.")
             else:
                 print("No input CSV files provided and no CSV files found in reports/ directory. Exiting.")
                 return
@@ -117,54 +193,60 @@ def main():
             'average_allocation_latency_by_source',
             'allocation_size_vs_time_heatmap',
             'call_stack_trace_frequency',
-            'throughput_trends'
+            'throughput_trends',
+            'latency_summary_percentiles',
+            'heap_occupancy_map'
         ]
 
     # Mapping of plot types to Visualizer methods and output filenames
     plot_methods = {
         'memory_usage_over_time': {
-            'method': viz.total_memory_usage_over_time,
+            'method': 'total_memory_usage_over_time',
             'filename': 'total_memory_usage_over_time.png'
         },
         'allocation_deallocation_rates': {
-            'method': viz.allocation_deallocation_rates_over_time,
+            'method': 'allocation_deallocation_rates_over_time',
             'filename': 'allocation_deallocation_rates_over_time.png'
         },
         'allocation_latency_over_time': {
-            'method': viz.allocation_latency_over_time,
+            'method': 'allocation_latency_over_time',
             'filename': 'allocation_latency_over_time.png'
         },
         'allocation_latency_percentiles': {
-            'method': viz.allocation_latency_percentiles,
+            'method': 'allocation_latency_percentiles',
             'filename': 'allocation_latency_percentiles.png'
         },
         'allocation_size_distribution': {
-            'method': viz.allocation_size_distribution,
+            'method': 'allocation_size_distribution',
             'filename': 'allocation_size_distribution.png'
         },
         'memory_usage_by_source': {
-            'method': viz.memory_usage_by_source,
+            'method': 'memory_usage_by_source',
             'filename': 'memory_usage_by_source.png'
         },
         'number_of_allocations_by_source': {
-            'method': viz.number_of_allocations_by_source,
+            'method': 'number_of_allocations_by_source',
             'filename': 'number_of_allocations_by_source.png'
         },
         'average_allocation_latency_by_source': {
-            'method': viz.average_allocation_latency_by_source,
+            'method': 'average_allocation_latency_by_source',
             'filename': 'average_allocation_latency_by_source.png'
         },
         'allocation_size_vs_time_heatmap': {
-            'method': viz.allocation_size_vs_time_heatmap,
+            'method': 'allocation_size_vs_time_heatmap',
             'filename': 'allocation_size_vs_time_heatmap.png'
         },
         'call_stack_trace_frequency': {
-            'method': viz.call_stack_trace_frequency,
+            'method': 'call_stack_trace_frequency',
             'filename': 'call_stack_trace_frequency.png'
         },
         'throughput_trends': {
-            'method': viz.throughput_trends,
+            'method': 'throughput_trends',
             'filename': 'throughput_trends.png'
+        },
+        'latency_summary_percentiles': {
+            'method': 'latency_summary_percentiles',
+            'filename': 'latency_summary_percentiles.png'
         }
     }
 
@@ -174,23 +256,47 @@ def main():
             print(f"CSV file '{csv_file}' does not exist. Skipping.")
             continue
 
+        # Heap snapshot files carry pool layouts rather than events, and feed only the occupancy map
+        if is_heap_snapshot_file(csv_file):
+            if 'heap_occupancy_map' in plots_to_generate:
+                print(f"\nProcessing heap snapshot file: {csv_file}")
+                base_name = os.path.splitext(os.path.basename(csv_file))[0]
+                prefixed_filename = f"{base_name}_heap_occupancy_map.png"
+                print(f"Generating plot: Heap Occupancy Map -> {prefixed_filename}")
+                viz.heap_occupancy_map(read_heap_snapshots(csv_file),
+                                       output_path=os.path.join(output_dir, prefixed_filename))
+            continue
+
         print(f"\nProcessing CSV file: {csv_file}")
 
-        # Load and preprocess data
+        # Load and preprocess data, then aggregate it once for every plot
         loader = DataLoader(csv_file)
-        df = loader.load_data()
-        if df is None or df.empty:
-            print(f"No data loaded from '{csv_file}'. Skipping.")
-            continue
-        df = loader.preprocess_data(df)
-        if df is None or df.empty:
-            print(f"Data preprocessing resulted in an empty DataFrame for '{csv_file}'. Skipping.")
-            continue
+        if args.chunk_rows > 0:
+            data = loader.load_plot_data(chunk_rows=args.chunk_rows, max_event_rows=args.max_event_rows)
+            if data is None or (data.event_count == 0 and data.summary.empty):
+                print(f"No data loaded from '{csv_file}'. Skipping.")
+                continue
+        else:
+            df = loader.load_data()
+            if df is None or df.empty:
+                print(f"No data loaded from '{csv_file}'. Skipping.")
+                continue
+            df = loader.preprocess_data(df)
+            if df is None or df.empty:
+                print(f"Data preprocessing resulted in an empty DataFrame for '{csv_file}'. Skipping.")
+                continue
+            data = PlotData.from_frame(df)
+            del df
 
-        # Extract base name without extension for plot naming
-        base_name = os.path.splitext(os.path.basename(csv_file))[0]
+        # Extract base name without extension (or compression suffix) for plot naming
+        base_name = os.path.basename(csv_file)
+        for suffix in ('.gz', '.zst'):
+            if base_name.endswith(suffix):
+                base_name = base_name[:-len(suffix)]
+        base_name = os.path.splitext(base_name)[0]
 
         # Generate plots based on user input
+        jobs = []
         for plot_type in plots_to_generate:
             if plot_type in plot_methods:
                 method = plot_methods[plot_type]['method']
@@ -200,9 +306,10 @@ def main():
                 output_path = os.path.join(output_dir, prefixed_filename)
                 readable_plot_name = plot_type.replace('_', ' ').title()
                 print(f"Generating plot: {readable_plot_name} -> {prefixed_filename}")
-                method(df, output_path=output_path)
-            else:
+                jobs.append((method, output_path))
+            elif plot_type != 'heap_occupancy_map':
                 print(f"Plot type '{plot_type}' is not recognized and will be skipped.")
+        render_plots(viz, data, jobs, args.jobs)
 
     print("\nAll requested plots have been generated.")
 
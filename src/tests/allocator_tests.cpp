@@ -5,9 +5,10 @@
 #include <random>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "allocator_event_logger.h"
+#include "allocator_config.h"
 #include "config_manager.h"
 #include "custom_allocator.h"
 #include "data_logger.h"
@@ -76,6 +77,8 @@ int main(int argc, char* argv[]) {
     size_t minOrder = config.getSize("min-order", 6);
     size_t maxOrder = config.getSize("max-order", 20);
 
+    AllocatorOptions allocatorOptions = allocatorOptionsFromConfig(config);
+
     // Prepare output file with timestamp
     std::string outputDir = config.getString("out", "reports");
     std::filesystem::create_directories(outputDir);
@@ -89,14 +92,26 @@ int main(int argc, char* argv[]) {
     localtime_r(&in_time_t, &tm_buf);
 #endif
     std::ostringstream oss;
-    oss << outputDir << "/allocator_tests_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S") << ".csv";
+    LoggerOptions loggerOptions;
+    std::string format = config.getString("format", "csv");
+    if (!DataLogger::parseFormat(format, loggerOptions)) {
+        std::cerr << "Configuration error: unknown output format '" << format
+                  << "' (use csv, csv.gz, csv.zst or binary)" << std::endl;
+        return 1;
+    }
+    loggerOptions.async = config.getBool("async-logging", false);
+    loggerOptions.ringCapacity = config.getSize("log-ring-capacity", 8192);
+    loggerOptions.dropWhenFull = config.getBool("log-drop-when-full", false);
+    loggerOptions.echoToConsole = config.getBool("log-echo", false);
+    oss << outputDir << "/allocator_tests_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S")
+        << DataLogger::fileExtension(loggerOptions);
     std::string outputFile = oss.str();
 
     // Initialize the DataLogger
-    DataLogger logger(outputFile);
+    DataLogger logger(outputFile, loggerOptions);
 
     // Initialize the allocator
-    CustomAllocator allocator(minOrder, maxOrder);
+    CustomAllocator allocator(minOrder, maxOrder, allocatorOptions);
 
     // Run the selected test
     if (testType == "sequential") {
@@ -115,86 +130,24 @@ int main(int argc, char* argv[]) {
 }
 
 void sequentialAllocationTest(CustomAllocator& allocator, size_t blockSize, size_t numOperations, DataLogger& logger) {
+    // Every allocation and deallocation is timed and logged by the allocator's observer
+    AllocatorEventLogger events(allocator, logger, __FUNCTION__, "sequentialAllocationTest");
+
     std::vector<void*> pointers;
     pointers.reserve(numOperations);
 
-    std::vector<std::string> allocationIDs;
-    allocationIDs.reserve(numOperations);
-
     for (size_t i = 0; i < numOperations; ++i) {
-        // Time the allocation
-        auto allocStart = std::chrono::high_resolution_clock::now();
         void* ptr = allocator.allocate(blockSize);
-        auto allocEnd = std::chrono::high_resolution_clock::now();
-        double allocTime = std::chrono::duration<double>(allocEnd - allocStart).count();
-
         if (ptr == nullptr) {
             std::cerr << "Allocation failed at iteration " << i << std::endl;
             break;
         }
-
-        // Get allocation ID
-        std::string allocationID = allocator.getAllocationID(ptr);
-
         pointers.push_back(ptr);
-        allocationIDs.push_back(allocationID);
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "sequentialAllocationTest";
-
-        // Log allocation time and fragmentation
-        logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationID);
     }
 
     // Deallocate in the same order
-    for (size_t i = 0; i < pointers.size(); ++i) {
-        // Time the deallocation
-        auto deallocStart = std::chrono::high_resolution_clock::now();
-        allocator.deallocate(pointers[i]);
-        auto deallocEnd = std::chrono::high_resolution_clock::now();
-        double deallocTime = std::chrono::duration<double>(deallocEnd - deallocStart).count();
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(pointers[i]);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "sequentialAllocationTest";
-
-        // Log deallocation time and fragmentation
-        logger.log(timestamp, "Deallocation", blockSize, deallocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationIDs[i]);
+    for (void* ptr : pointers) {
+        allocator.deallocate(ptr);
     }
 
     std::cout << "Sequential Allocation Test completed with " << numOperations << " operations." << std::endl;
@@ -203,100 +156,36 @@ void sequentialAllocationTest(CustomAllocator& allocator, size_t blockSize, size
 void randomAllocationTest(CustomAllocator& allocator, size_t minBlockSize, size_t maxBlockSize, size_t numOperations,
                           DataLogger& logger) {
     std::vector<void*> pointers;
-    std::vector<size_t> sizes;
-    std::vector<std::string> allocationIDs;
     pointers.reserve(numOperations);
-    sizes.reserve(numOperations);
-    allocationIDs.reserve(numOperations);
 
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<size_t> sizeDist(minBlockSize, maxBlockSize);
     std::uniform_int_distribution<int> opDist(0, 1);  // 0: allocate, 1: deallocate
 
-    for (size_t i = 0; i < numOperations; ++i) {
-        int operation = opDist(gen);
-
-        if (operation == 0 || pointers.empty()) {
-            // Allocation
-            size_t blockSize = sizeDist(gen);
-            auto allocStart = std::chrono::high_resolution_clock::now();
-            void* ptr = allocator.allocate(blockSize);
-            auto allocEnd = std::chrono::high_resolution_clock::now();
-            double allocTime = std::chrono::duration<double>(allocEnd - allocStart).count();
-
-            if (ptr != nullptr) {
-                pointers.push_back(ptr);
-                sizes.push_back(blockSize);
-
-                // Get allocation ID
-                std::string allocationID = allocator.getAllocationID(ptr);
-                allocationIDs.push_back(allocationID);
-
-                // Generate timestamp
-                auto now = std::chrono::system_clock::now();
-                std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-                std::tm now_tm = *std::localtime(&now_time_t);
-                std::ostringstream timestampStream;
-                timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-                std::string timestamp = timestampStream.str();
-
-                // Get thread ID
-                std::ostringstream threadIDStream;
-                threadIDStream << std::this_thread::get_id();
-                std::string threadID = threadIDStream.str();
-
-                // Get memory address
-                std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-                // Source and CallStack (placeholders)
-                std::string source = __FUNCTION__;  // Function name
-                std::string callStack = "randomAllocationTest";
-
-                // Log allocation time and fragmentation
-                logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source,
-                           callStack, memoryAddress, threadID, allocationID);
-            } else {
-                std::cerr << "Allocation failed at iteration " << i << std::endl;
+    {
+        // Only the random phase is logged; the cleanup below is not
+        AllocatorEventLogger events(allocator, logger, __FUNCTION__, "randomAllocationTest");
+
+        for (size_t i = 0; i < numOperations; ++i) {
+            int operation = opDist(gen);
+
+            if (operation == 0 || pointers.empty()) {
+                // Allocation
+                void* ptr = allocator.allocate(sizeDist(gen));
+                if (ptr != nullptr) {
+                    pointers.push_back(ptr);
+                } else {
+                    std::cerr << "Allocation failed at iteration " << i << std::endl;
+                }
+            } else if (!pointers.empty()) {
+                // Deallocation
+                std::uniform_int_distribution<size_t> indexDist(0, pointers.size() - 1);
+                size_t index = indexDist(gen);
+
+                allocator.deallocate(pointers[index]);
+                pointers.erase(pointers.begin() + index);
             }
-        } else if (!pointers.empty()) {
-            // Deallocation
-            std::uniform_int_distribution<size_t> indexDist(0, pointers.size() - 1);
-            size_t index = indexDist(gen);
-
-            auto deallocStart = std::chrono::high_resolution_clock::now();
-            allocator.deallocate(pointers[index]);
-            auto deallocEnd = std::chrono::high_resolution_clock::now();
-            double deallocTime = std::chrono::duration<double>(deallocEnd - deallocStart).count();
-
-            // Generate timestamp
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-            std::tm now_tm = *std::localtime(&now_time_t);
-            std::ostringstream timestampStream;
-            timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-            std::string timestamp = timestampStream.str();
-
-            // Get thread ID
-            std::ostringstream threadIDStream;
-            threadIDStream << std::this_thread::get_id();
-            std::string threadID = threadIDStream.str();
-
-            // Get memory address
-            std::string memoryAddress = allocator.getMemoryAddress(pointers[index]);
-
-            // Source and CallStack (placeholders)
-            std::string source = __FUNCTION__;  // Function name
-            std::string callStack = "randomAllocationTest";
-
-            // Log deallocation time and fragmentation
-            logger.log(timestamp, "Deallocation", sizes[index], deallocTime, allocator.getFragmentation(), source,
-                       callStack, memoryAddress, threadID, allocationIDs[index]);
-
-            // Remove from vectors
-            pointers.erase(pointers.begin() + index);
-            sizes.erase(sizes.begin() + index);
-            allocationIDs.erase(allocationIDs.begin() + index);
         }
     }
 
@@ -311,101 +200,36 @@ void randomAllocationTest(CustomAllocator& allocator, size_t minBlockSize, size_
 void mixedSizesTest(CustomAllocator& allocator, const std::vector<size_t>& sizeDistribution, size_t numOperations,
                     DataLogger& logger) {
     std::vector<void*> pointers;
-    std::vector<size_t> sizes;
-    std::vector<std::string> allocationIDs;
     pointers.reserve(numOperations);
-    sizes.reserve(numOperations);
-    allocationIDs.reserve(numOperations);
 
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<size_t> sizeIndexDist(0, sizeDistribution.size() - 1);
     std::uniform_int_distribution<int> opDist(0, 1);  // 0: allocate, 1: deallocate
 
-    for (size_t i = 0; i < numOperations; ++i) {
-        int operation = opDist(gen);
-
-        if (operation == 0 || pointers.empty()) {
-            // Allocation
-            size_t sizeIndex = sizeIndexDist(gen);
-            size_t blockSize = sizeDistribution[sizeIndex];
-            auto allocStart = std::chrono::high_resolution_clock::now();
-            void* ptr = allocator.allocate(blockSize);
-            auto allocEnd = std::chrono::high_resolution_clock::now();
-            double allocTime = std::chrono::duration<double>(allocEnd - allocStart).count();
-
-            if (ptr != nullptr) {
-                pointers.push_back(ptr);
-                sizes.push_back(blockSize);
-
-                // Get allocation ID
-                std::string allocationID = allocator.getAllocationID(ptr);
-                allocationIDs.push_back(allocationID);
-
-                // Generate timestamp
-                auto now = std::chrono::system_clock::now();
-                std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-                std::tm now_tm = *std::localtime(&now_time_t);
-                std::ostringstream timestampStream;
-                timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-                std::string timestamp = timestampStream.str();
-
-                // Get thread ID
-                std::ostringstream threadIDStream;
-                threadIDStream << std::this_thread::get_id();
-                std::string threadID = threadIDStream.str();
-
-                // Get memory address
-                std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-                // Source and CallStack (placeholders)
-                std::string source = __FUNCTION__;  // Function name
-                std::string callStack = "mixedSizesTest";
-
-                // Log allocation time and fragmentation
-                logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source,
-                           callStack, memoryAddress, threadID, allocationID);
-            } else {
-                std::cerr << "Allocation failed at iteration " << i << std::endl;
+    {
+        // Only the mixed phase is logged; the cleanup below is not
+        AllocatorEventLogger events(allocator, logger, __FUNCTION__, "mixedSizesTest");
+
+        for (size_t i = 0; i < numOperations; ++i) {
+            int operation = opDist(gen);
+
+            if (operation == 0 || pointers.empty()) {
+                // Allocation
+                void* ptr = allocator.allocate(sizeDistribution[sizeIndexDist(gen)]);
+                if (ptr != nullptr) {
+                    pointers.push_back(ptr);
+                } else {
+                    std::cerr << "Allocation failed at iteration " << i << std::endl;
+                }
+            } else if (!pointers.empty()) {
+                // Deallocation
+                std::uniform_int_distribution<size_t> indexDist(0, pointers.size() - 1);
+                size_t index = indexDist(gen);
+
+                allocator.deallocate(pointers[index]);
+                pointers.erase(pointers.begin() + index);
             }
-        } else if (!pointers.empty()) {
-            // Deallocation
-            std::uniform_int_distribution<size_t> indexDist(0, pointers.size() - 1);
-            size_t index = indexDist(gen);
-
-            auto deallocStart = std::chrono::high_resolution_clock::now();
-            allocator.deallocate(pointers[index]);
-            auto deallocEnd = std::chrono::high_resolution_clock::now();
-            double deallocTime = std::chrono::duration<double>(deallocEnd - deallocStart).count();
-
-            // Generate timestamp
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-            std::tm now_tm = *std::localtime(&now_time_t);
-            std::ostringstream timestampStream;
-            timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-            std::string timestamp = timestampStream.str();
-
-            // Get thread ID
-            std::ostringstream threadIDStream;
-            threadIDStream << std::this_thread::get_id();
-            std::string threadID = threadIDStream.str();
-
-            // Get memory address
-            std::string memoryAddress = allocator.getMemoryAddress(pointers[index]);
-
-            // Source and CallStack (placeholders)
-            std::string source = __FUNCTION__;  // Function name
-            std::string callStack = "mixedSizesTest";
-
-            // Log deallocation time and fragmentation
-            logger.log(timestamp, "Deallocation", sizes[index], deallocTime, allocator.getFragmentation(), source,
-                       callStack, memoryAddress, threadID, allocationIDs[index]);
-
-            // Remove from vectors
-            pointers.erase(pointers.begin() + index);
-            sizes.erase(sizes.begin() + index);
-            allocationIDs.erase(allocationIDs.begin() + index);
         }
     }
 
@@ -415,4 +239,4 @@ void mixedSizesTest(CustomAllocator& allocator, const std::vector<size_t>& sizeD
     }
 
     std::cout << "Mixed Sizes Test completed with " << numOperations << " operations." << std::endl;
-}
\ No newline at end of file
+}
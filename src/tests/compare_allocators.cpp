@@ -0,0 +1,425 @@
+/**
+ * @file compare_allocators.cpp
+ * @brief Runs the stress test scenarios through CustomAllocator and the allocators it would replace.
+ *
+ * AllocationSpeed, MemoryFragmentation and MaxLoadTest are written once against a small backend
+ * interface and instantiated for each allocator, so their rows line up in the Google Benchmark
+ * output: items per second, the process's resident set size with the scenario's blocks live, and
+ * fragmentation where the allocator can report it.
+ *
+ * jemalloc and mimalloc replace malloc for the whole process they are linked into, which would
+ * turn the malloc baseline (and std::pmr's upstream) into them. CMake therefore builds them into
+ * separate executables (compare_allocators_jemalloc, compare_allocators_mimalloc) compiled from this
+ * file with COMPARE_WITH_JEMALLOC or COMPARE_WITH_MIMALLOC, which register only that backend.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "allocator_config.h"
+#include "config_manager.h"
+#include "custom_allocator.h"
+#include "growable_allocator.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifndef COMPARE_WITH_JEMALLOC
+#define COMPARE_WITH_JEMALLOC 0
+#endif
+#ifndef COMPARE_WITH_MIMALLOC
+#define COMPARE_WITH_MIMALLOC 0
+#endif
+#define COMPARE_EXTERNAL (COMPARE_WITH_JEMALLOC || COMPARE_WITH_MIMALLOC)
+
+#if COMPARE_WITH_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+#if COMPARE_WITH_MIMALLOC
+#include <mimalloc.h>
+#endif
+
+#if !COMPARE_EXTERNAL && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define COMPARE_HAVE_PMR 1
+#endif
+#endif
+#ifndef COMPARE_HAVE_PMR
+#define COMPARE_HAVE_PMR 0
+#endif
+
+// Global ConfigManager pointer for access in backends
+static ConfigManager* g_config = nullptr;
+
+/// Alignment requested from allocators that take one, matching what malloc guarantees.
+static constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+/**
+ * @brief Resident set size of the process in bytes; 0 where it cannot be read.
+ *
+ * Linux reports the current size. macOS only offers the peak, which never shrinks, so later
+ * scenarios there inherit the high-water mark of earlier ones.
+ */
+static double residentBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss);
+#else
+    return 0.0;
+#endif
+}
+
+// ============================================================================
+// Backends
+// ============================================================================
+//
+// A backend provides:
+//   static constexpr const char* NAME;
+//   void* allocate(size_t size);              // nullptr when out of memory
+//   void deallocate(void* ptr, size_t size);  // size is the one passed to allocate
+//   double fragmentation();                   // in [0, 1], or a negative value if unknown
+//   size_t capacity() const;                  // bytes MaxLoadTest may request
+//
+// Each benchmark run constructs a fresh backend.
+
+/**
+ * @brief Bytes MaxLoadTest requests from allocators without a fixed pool: the CustomAllocator pool size.
+ */
+static size_t comparisonBudget() {
+    return static_cast<size_t>(1) << g_config->getSize("max-order", 20);
+}
+
+#if !COMPARE_EXTERNAL
+/**
+ * @brief CustomAllocator configured from the config file and CLI, as in stress_test.
+ */
+class CustomBackend {
+   public:
+    static constexpr const char* NAME = "CustomAllocator";
+
+    CustomBackend() : allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                                allocatorOptionsFromConfig(*g_config)) {}
+
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr, size_t /* size */) { allocator.deallocate(ptr); }
+    double fragmentation() { return allocator.getExternalFragmentation(); }
+    size_t capacity() const { return allocator.getPoolSize(); }
+
+   private:
+    CustomAllocator allocator;
+};
+
+/**
+ * @brief GrowableAllocator over arenas of the CustomBackend configuration, grown and released
+ *        per max-arenas and retain-empty-arenas.
+ *
+ * MaxLoadTest gives it the same budget as the allocators without a fixed pool, which takes more
+ * than one arena once block headers and rounding are counted.
+ */
+class GrowableBackend {
+   public:
+    static constexpr const char* NAME = "GrowableAllocator";
+
+    GrowableBackend()
+        : allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                    growableOptionsFromConfig(*g_config), allocatorOptionsFromConfig(*g_config)) {}
+
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr, size_t /* size */) { allocator.deallocate(ptr); }
+    double fragmentation() { return allocator.getExternalFragmentation(); }
+    size_t capacity() const { return comparisonBudget(); }
+
+   private:
+    GrowableAllocator allocator;
+};
+
+/**
+ * @brief The C library's malloc and free.
+ */
+class MallocBackend {
+   public:
+    static constexpr const char* NAME = "malloc";
+
+    void* allocate(size_t size) { return std::malloc(size); }
+    void deallocate(void* ptr, size_t /* size */) { std::free(ptr); }
+    double fragmentation() { return -1.0; }
+    size_t capacity() const { return comparisonBudget(); }
+};
+#endif
+
+#if COMPARE_HAVE_PMR
+/**
+ * @brief std::pmr::unsynchronized_pool_resource over the default (new/delete) upstream.
+ */
+class PmrPoolBackend {
+   public:
+    static constexpr const char* NAME = "pmr::unsynchronized_pool_resource";
+
+    void* allocate(size_t size) { return pool.allocate(size, BLOCK_ALIGNMENT); }
+    void deallocate(void* ptr, size_t size) { pool.deallocate(ptr, size, BLOCK_ALIGNMENT); }
+    double fragmentation() { return -1.0; }
+    size_t capacity() const { return comparisonBudget(); }
+
+   private:
+    std::pmr::unsynchronized_pool_resource pool;
+};
+#endif
+
+#if COMPARE_WITH_JEMALLOC
+/**
+ * @brief jemalloc through its sized non-standard API; fragmentation is 1 - allocated / active bytes.
+ */
+class JemallocBackend {
+   public:
+    static constexpr const char* NAME = "jemalloc";
+
+    void* allocate(size_t size) { return mallocx(size, 0); }
+    void deallocate(void* ptr, size_t size) { sdallocx(ptr, size, 0); }
+    size_t capacity() const { return comparisonBudget(); }
+
+    double fragmentation() {
+        // Statistics are refreshed only when the epoch is advanced
+        uint64_t epoch = 1;
+        size_t length = sizeof(epoch);
+        mallctl("epoch", &epoch, &length, &epoch, length);
+        size_t allocated = 0;
+        size_t active = 0;
+        length = sizeof(size_t);
+        if (mallctl("stats.allocated", &allocated, &length, nullptr, 0) != 0 ||
+            mallctl("stats.active", &active, &length, nullptr, 0) != 0 || active == 0) {
+            return -1.0;
+        }
+        return 1.0 - static_cast<double>(allocated) / static_cast<double>(active);
+    }
+};
+#endif
+
+#if COMPARE_WITH_MIMALLOC
+/**
+ * @brief mimalloc through its own API.
+ */
+class MimallocBackend {
+   public:
+    static constexpr const char* NAME = "mimalloc";
+
+    void* allocate(size_t size) { return mi_malloc(size); }
+    void deallocate(void* ptr, size_t size) { mi_free_size(ptr, size); }
+    double fragmentation() { return -1.0; }
+    size_t capacity() const { return comparisonBudget(); }
+};
+#endif
+
+// ============================================================================
+// Scenarios
+// ============================================================================
+
+/**
+ * @brief Records RSS and, when the backend reports it, fragmentation; called with blocks live.
+ */
+template <typename Backend>
+static void reportMemory(benchmark::State& state, Backend& backend) {
+    state.counters["RSS"] = residentBytes();
+    double fragmentation = backend.fragmentation();
+    if (fragmentation >= 0.0) {
+        state.counters["Fragmentation"] = fragmentation;
+    }
+}
+
+/**
+ * @brief stress_test's AllocationSpeed: range(0) 128-byte allocations, then their frees.
+ */
+template <typename Backend>
+static void AllocationSpeed(benchmark::State& state) {
+    const size_t num_allocations = static_cast<size_t>(state.range(0));
+    Backend backend;
+    std::vector<void*> pointers;
+    pointers.reserve(num_allocations);
+    size_t operations = 0;
+    bool measured = false;
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < num_allocations; ++i) {
+            void* ptr = backend.allocate(128);
+            if (ptr) {
+                pointers.push_back(ptr);
+            }
+        }
+        if (!measured) {
+            state.PauseTiming();
+            reportMemory(state, backend);
+            measured = true;
+            state.ResumeTiming();
+        }
+        for (void* ptr : pointers) {
+            backend.deallocate(ptr, 128);
+        }
+        operations += 2 * pointers.size();
+        pointers.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+}
+
+/**
+ * @brief stress_test's MemoryFragmentation: range(0) random allocations (64-1024 bytes) and frees.
+ *
+ * Memory is reported once per iteration, just before the survivors are freed.
+ */
+template <typename Backend>
+static void MemoryFragmentation(benchmark::State& state) {
+    const size_t num_operations = static_cast<size_t>(state.range(0));
+    Backend backend;
+    std::vector<std::pair<void*, size_t>> blocks;
+    blocks.reserve(num_operations);
+    std::mt19937 rng(42);                                       // Fixed seed for reproducibility
+    std::uniform_int_distribution<size_t> size_dist(64, 1024);  // Allocation sizes between 64 and 1024 bytes
+    std::uniform_int_distribution<int> op_dist(0, 1);           // 0 for allocate, 1 for deallocate
+    size_t operations = 0;
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < num_operations; ++i) {
+            if (op_dist(rng) == 0) {
+                size_t size = size_dist(rng);
+                void* ptr = backend.allocate(size);
+                if (ptr) {
+                    blocks.emplace_back(ptr, size);
+                    ++operations;
+                }
+            } else if (!blocks.empty()) {
+                size_t index = rng() % blocks.size();
+                backend.deallocate(blocks[index].first, blocks[index].second);
+                blocks[index] = blocks.back();
+                blocks.pop_back();
+                ++operations;
+            }
+        }
+
+        state.PauseTiming();
+        reportMemory(state, backend);
+        state.ResumeTiming();
+
+        for (const auto& block : blocks) {
+            backend.deallocate(block.first, block.second);
+        }
+        operations += blocks.size();
+        blocks.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+}
+
+/**
+ * @brief stress_test's MaxLoadTest: 128-byte allocations until failure or the backend's capacity.
+ *
+ * Allocators without a fixed pool are stopped at the CustomAllocator pool size, so MaxAllocations
+ * compares per-block overhead and the time compares the cost of filling the same budget.
+ */
+template <typename Backend>
+static void MaxLoadTest(benchmark::State& state) {
+    Backend backend;
+    std::vector<void*> pointers;
+    size_t limit = backend.capacity() / 128;
+    pointers.reserve(limit);
+    size_t operations = 0;
+
+    for (auto _ : state) {
+        while (pointers.size() < limit) {
+            void* ptr = backend.allocate(128);
+            if (!ptr) {
+                break;
+            }
+            pointers.push_back(ptr);
+        }
+
+        state.PauseTiming();
+        state.counters["MaxAllocations"] = static_cast<double>(pointers.size());
+        reportMemory(state, backend);
+        state.ResumeTiming();
+
+        for (void* ptr : pointers) {
+            backend.deallocate(ptr, 128);
+        }
+        operations += 2 * pointers.size();
+        pointers.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+}
+
+/**
+ * @brief Registers every scenario for one backend, labelled with its NAME.
+ */
+template <typename Backend>
+static void registerComparison() {
+    std::string suffix = std::string("/") + Backend::NAME;
+    benchmark::RegisterBenchmark(("AllocationSpeed" + suffix).c_str(), AllocationSpeed<Backend>)
+        ->Arg(1000)
+        ->Arg(3000)
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("MemoryFragmentation" + suffix).c_str(), MemoryFragmentation<Backend>)
+        ->Arg(1000)
+        ->Arg(10000)
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("MaxLoadTest" + suffix).c_str(), MaxLoadTest<Backend>)
+        ->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char** argv) {
+    // Initialize ConfigManager
+    ConfigManager config("config/default.toml");
+    config.parseCLI(argc, argv, "compare_allocators", "CustomAllocator against other allocators using Google Benchmark");
+
+    if (config.helpRequested()) {
+        std::cout << config.getHelpMessage() << std::endl;
+        return 0;
+    }
+
+    try {
+        config.validate();
+    } catch (const std::exception& e) {
+        std::cerr << "Configuration error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Store global config pointer for the backends
+    g_config = &config;
+
+#if !COMPARE_EXTERNAL
+    registerComparison<CustomBackend>();
+    registerComparison<GrowableBackend>();
+    registerComparison<MallocBackend>();
+#endif
+#if COMPARE_HAVE_PMR
+    registerComparison<PmrPoolBackend>();
+#endif
+#if COMPARE_WITH_JEMALLOC
+    registerComparison<JemallocBackend>();
+#endif
+#if COMPARE_WITH_MIMALLOC
+    registerComparison<MimallocBackend>();
+#endif
+
+    // Initialize Google Benchmark
+    ::benchmark::Initialize(&argc, argv);
+
+    // Run all registered benchmarks
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
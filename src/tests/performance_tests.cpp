@@ -7,19 +7,24 @@
  * and memory fragmentation. Results are logged using the DataLogger class.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "allocator_event_logger.h"
+#include "allocator_config.h"
 #include "config_manager.h"
 #include "custom_allocator.h"
 #include "data_logger.h"
+#include "metrics_sampler.h"
 
 /**
  * @brief Performs fixed-size allocation and deallocation benchmark.
@@ -31,8 +36,27 @@
  * @param blockSize Size of each memory block to allocate (in bytes).
  * @param numOperations Number of allocation/deallocation operations to perform.
  * @param logger Reference to the DataLogger instance for logging performance metrics.
+ * @param logEvents Whether to log a row per allocation and deallocation.
  */
-void fixedSizeBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, DataLogger& logger);
+void fixedSizeBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, DataLogger& logger,
+                        bool logEvents);
+
+/**
+ * @brief Batched variant of fixedSizeBenchmark.
+ *
+ * Allocates and deallocates the same number of fixed-size blocks through allocateBatch() and
+ * deallocateBatch(). Each block is logged with the batch time divided by the batch size, so the
+ * output is directly comparable with fixedSizeBenchmark.
+ *
+ * @param allocator Reference to the CustomAllocator instance.
+ * @param blockSize Size of each memory block to allocate (in bytes).
+ * @param numOperations Number of allocation/deallocation operations to perform.
+ * @param batchSize Number of blocks per allocateBatch()/deallocateBatch() call.
+ * @param logger Reference to the DataLogger instance for logging performance metrics.
+ * @param logEvents Whether to log a row per allocation and deallocation.
+ */
+void fixedSizeBatchBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, size_t batchSize,
+                             DataLogger& logger, bool logEvents);
 
 /**
  * @brief Performs variable-size allocation and deallocation benchmark.
@@ -45,9 +69,10 @@ void fixedSizeBenchmark(CustomAllocator& allocator, size_t blockSize, size_t num
  * @param maxBlockSize Maximum size of memory blocks to allocate (in bytes).
  * @param numOperations Number of allocation/deallocation operations to perform.
  * @param logger Reference to the DataLogger instance for logging performance metrics.
+ * @param logEvents Whether to log a row per allocation and deallocation.
  */
 void variableSizeBenchmark(CustomAllocator& allocator, size_t minBlockSize, size_t maxBlockSize, size_t numOperations,
-                           DataLogger& logger);
+                           DataLogger& logger, bool logEvents);
 
 /**
  * @brief Measures the throughput of allocation and deallocation operations.
@@ -59,8 +84,18 @@ void variableSizeBenchmark(CustomAllocator& allocator, size_t minBlockSize, size
  * @param blockSize Size of each memory block to allocate (in bytes).
  * @param duration Duration of the benchmark in seconds.
  * @param logger Reference to the DataLogger instance for logging performance metrics.
+ * @param logEvents Whether to log a row per allocation and deallocation; the summary is always logged.
  */
-void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double duration, DataLogger& logger);
+void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double duration, DataLogger& logger,
+                         bool logEvents);
+
+/**
+ * @brief Reduces an allocator latency histogram to the percentiles written by DataLogger::logSummary.
+ *
+ * @param snapshot Merged latency histogram of one operation type.
+ * @return Sample count and p50/p99/p999 in nanoseconds.
+ */
+LatencyPercentiles latencyPercentiles(const LatencySnapshot& snapshot);
 
 /**
  * @brief Entry point for the performance tests.
@@ -94,12 +129,16 @@ int main(int argc, char* argv[]) {
     // Extract configuration values
     size_t minOrder = config.getSize("min-order", 6);
     size_t maxOrder = config.getSize("max-order", 20);
+
+    AllocatorOptions allocatorOptions = allocatorOptionsFromConfig(config);
     size_t blockSize = config.getSize("block-size", 64);
+    size_t batchSize = config.getSize("batch-size", 64);
     size_t minBlockSize = config.getSize("min-block-size", 32);
     size_t maxBlockSize = config.getSize("max-block-size", 512);
     size_t numOperations = config.getSize("ops", 100000);
     double duration = config.getDouble("duration", 10.0);
     std::string benchmarkType = config.getString("benchmark", "fixed");
+    bool logEvents = config.getBool("log-events", true);
 
     // Prepare output file with timestamp
     std::string outputDir = config.getString("out", "reports");
@@ -114,223 +153,171 @@ int main(int argc, char* argv[]) {
     localtime_r(&in_time_t, &tm_buf);
 #endif
     std::ostringstream oss;
-    oss << outputDir << "/performance_tests_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S") << ".csv";
-    std::string outputFile = oss.str();
+    LoggerOptions loggerOptions;
+    std::string format = config.getString("format", "csv");
+    if (!DataLogger::parseFormat(format, loggerOptions)) {
+        std::cerr << "Configuration error: unknown output format '" << format
+                  << "' (use csv, csv.gz, csv.zst or binary)" << std::endl;
+        return 1;
+    }
+    loggerOptions.async = config.getBool("async-logging", false);
+    loggerOptions.ringCapacity = config.getSize("log-ring-capacity", 8192);
+    loggerOptions.dropWhenFull = config.getBool("log-drop-when-full", false);
+    loggerOptions.echoToConsole = config.getBool("log-echo", false);
+    oss << outputDir << "/performance_tests_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S");
+    std::string outputStem = oss.str();
+    std::string outputFile = outputStem + DataLogger::fileExtension(loggerOptions);
+
+    MetricsSamplerOptions metricsOptions;
+    size_t metricsInterval = config.getSize("metrics-interval", 0);
+    std::string metricsFormat = config.getString("metrics-format", "csv");
+    if (!MetricsSampler::parseFormat(metricsFormat, metricsOptions)) {
+        std::cerr << "Configuration error: unknown metrics format '" << metricsFormat << "' (use csv or prometheus)"
+                  << std::endl;
+        return 1;
+    }
+    metricsOptions.interval = std::chrono::milliseconds(metricsInterval);
+    metricsOptions.windowCapacity = config.getSize("metrics-windows", 120);
+    metricsOptions.path = outputStem + MetricsSampler::fileExtension(metricsOptions.format);
 
     // Initialize the DataLogger
-    DataLogger logger(outputFile);
+    DataLogger logger(outputFile, loggerOptions);
 
     // Initialize the allocator
-    CustomAllocator allocator(minOrder, maxOrder);
+    CustomAllocator allocator(minOrder, maxOrder, allocatorOptions);
+
+    // Windowed throughput and latency while the benchmark runs, declared after the allocator it reads
+    std::unique_ptr<MetricsSampler> metrics;
+    if (metricsInterval > 0) {
+        metrics = std::make_unique<MetricsSampler>(allocator, metricsOptions);
+        metrics->start();
+        std::cout << "Sampling metrics every " << metricsInterval << " ms into " << metricsOptions.path << std::endl;
+    }
 
     // Execute the selected benchmark
     if (benchmarkType == "fixed") {
         std::cout << "Starting Fixed-Size Allocation Benchmark..." << std::endl;
-        fixedSizeBenchmark(allocator, blockSize, numOperations, logger);
+        fixedSizeBenchmark(allocator, blockSize, numOperations, logger, logEvents);
+    } else if (benchmarkType == "fixed-batch") {
+        std::cout << "Starting Batched Fixed-Size Allocation Benchmark..." << std::endl;
+        fixedSizeBatchBenchmark(allocator, blockSize, numOperations, batchSize, logger, logEvents);
     } else if (benchmarkType == "variable") {
         std::cout << "Starting Variable-Size Allocation Benchmark..." << std::endl;
-        variableSizeBenchmark(allocator, minBlockSize, maxBlockSize, numOperations, logger);
+        variableSizeBenchmark(allocator, minBlockSize, maxBlockSize, numOperations, logger, logEvents);
     } else if (benchmarkType == "throughput") {
         std::cout << "Starting Throughput Benchmark..." << std::endl;
-        throughputBenchmark(allocator, blockSize, duration, logger);
+        throughputBenchmark(allocator, blockSize, duration, logger, logEvents);
     } else {
-        std::cerr << "Invalid benchmark type specified. Use [fixed|variable|throughput]." << std::endl;
+        std::cerr << "Invalid benchmark type specified. Use [fixed|fixed-batch|variable|throughput]." << std::endl;
         return 1;
     }
 
+    if (metrics) {
+        metrics->stop();
+        std::cout << "Recorded " << metrics->getWindowCount() << " metrics windows." << std::endl;
+    }
+
     std::cout << "Performance Benchmarking Completed." << std::endl;
     return 0;
 }
 
-void fixedSizeBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, DataLogger& logger) {
+void fixedSizeBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, DataLogger& logger,
+                        bool logEvents) {
+    // Every allocation and deallocation is timed and logged by the allocator's observer
+    std::optional<AllocatorEventLogger> events;
+    if (logEvents) {
+        events.emplace(allocator, logger, __FUNCTION__, "fixedSizeBenchmark");
+    }
+
     std::vector<void*> pointers;
     pointers.reserve(numOperations);
 
-    std::vector<std::string> allocationIDs;
-    allocationIDs.reserve(numOperations);
-
     for (size_t i = 0; i < numOperations; ++i) {
-        // Time the allocation
-        auto allocStart = std::chrono::high_resolution_clock::now();
         void* ptr = allocator.allocate(blockSize);
-        auto allocEnd = std::chrono::high_resolution_clock::now();
-        double allocTime = std::chrono::duration<double, std::micro>(allocEnd - allocStart).count();  // in microseconds
-
         if (ptr == nullptr) {
             std::cerr << "Allocation failed at iteration " << i << std::endl;
             break;
         }
-
-        // Get allocation ID
-        std::string allocationID = allocator.getAllocationID(ptr);
-
         pointers.push_back(ptr);
-        allocationIDs.push_back(allocationID);
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "fixedSizeBenchmark";
-
-        // Log allocation time and fragmentation
-        logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationID);
     }
 
     // Deallocate all pointers
-    for (size_t i = 0; i < pointers.size(); ++i) {
-        // Time the deallocation
-        auto deallocStart = std::chrono::high_resolution_clock::now();
-        allocator.deallocate(pointers[i]);
-        auto deallocEnd = std::chrono::high_resolution_clock::now();
-        double deallocTime =
-            std::chrono::duration<double, std::micro>(deallocEnd - deallocStart).count();  // in microseconds
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(pointers[i]);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "fixedSizeBenchmark";
-
-        // Log deallocation time and fragmentation
-        logger.log(timestamp, "Deallocation", blockSize, deallocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationIDs[i]);
+    for (void* ptr : pointers) {
+        allocator.deallocate(ptr);
     }
 
     std::cout << "Fixed-Size Allocation Benchmark completed with " << numOperations << " operations." << std::endl;
 }
 
+void fixedSizeBatchBenchmark(CustomAllocator& allocator, size_t blockSize, size_t numOperations, size_t batchSize,
+                             DataLogger& logger, bool logEvents) {
+    if (batchSize == 0) {
+        batchSize = 1;
+    }
+
+    // Each block is logged with the batch time divided by the batch size
+    std::optional<AllocatorEventLogger> events;
+    if (logEvents) {
+        events.emplace(allocator, logger, __FUNCTION__, "fixedSizeBatchBenchmark");
+    }
+
+    std::vector<void*> pointers(numOperations);
+    size_t allocated = 0;
+
+    while (allocated < numOperations) {
+        size_t request = std::min(batchSize, numOperations - allocated);
+        size_t produced = allocator.allocateBatch(blockSize, request, pointers.data() + allocated);
+        allocated += produced;
+        if (produced < request) {
+            std::cerr << "Allocation failed at iteration " << allocated << std::endl;
+            break;
+        }
+    }
+
+    // Deallocate in the same batches
+    for (size_t start = 0; start < allocated; start += batchSize) {
+        allocator.deallocateBatch(pointers.data() + start, std::min(batchSize, allocated - start));
+    }
+
+    std::cout << "Batched Fixed-Size Allocation Benchmark completed with " << allocated << " operations in batches of "
+              << batchSize << "." << std::endl;
+}
+
 void variableSizeBenchmark(CustomAllocator& allocator, size_t minBlockSize, size_t maxBlockSize, size_t numOperations,
-                           DataLogger& logger) {
+                           DataLogger& logger, bool logEvents) {
+    std::optional<AllocatorEventLogger> events;
+    if (logEvents) {
+        events.emplace(allocator, logger, __FUNCTION__, "variableSizeBenchmark");
+    }
+
     std::vector<void*> pointers;
     pointers.reserve(numOperations);
 
-    std::vector<size_t> sizes;
-    sizes.reserve(numOperations);
-
-    std::vector<std::string> allocationIDs;
-    allocationIDs.reserve(numOperations);
-
     // Initialize random number generator for block sizes
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<size_t> sizeDist(minBlockSize, maxBlockSize);
 
     for (size_t i = 0; i < numOperations; ++i) {
-        size_t blockSize = sizeDist(gen);
-
-        // Time the allocation
-        auto allocStart = std::chrono::high_resolution_clock::now();
-        void* ptr = allocator.allocate(blockSize);
-        auto allocEnd = std::chrono::high_resolution_clock::now();
-        double allocTime = std::chrono::duration<double, std::micro>(allocEnd - allocStart).count();  // in microseconds
-
+        void* ptr = allocator.allocate(sizeDist(gen));
         if (ptr == nullptr) {
             std::cerr << "Allocation failed at iteration " << i << std::endl;
             break;
         }
-
-        // Get allocation ID
-        std::string allocationID = allocator.getAllocationID(ptr);
-
         pointers.push_back(ptr);
-        sizes.push_back(blockSize);
-        allocationIDs.push_back(allocationID);
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "variableSizeBenchmark";
-
-        // Log allocation time and fragmentation
-        logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationID);
     }
 
     // Deallocate all pointers
-    for (size_t i = 0; i < pointers.size(); ++i) {
-        // Time the deallocation
-        auto deallocStart = std::chrono::high_resolution_clock::now();
-        allocator.deallocate(pointers[i]);
-        auto deallocEnd = std::chrono::high_resolution_clock::now();
-        double deallocTime =
-            std::chrono::duration<double, std::micro>(deallocEnd - deallocStart).count();  // in microseconds
-
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm now_tm = *std::localtime(&now_time_t);
-        std::ostringstream timestampStream;
-        timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-        std::string timestamp = timestampStream.str();
-
-        // Get thread ID
-        std::ostringstream threadIDStream;
-        threadIDStream << std::this_thread::get_id();
-        std::string threadID = threadIDStream.str();
-
-        // Get memory address
-        std::string memoryAddress = allocator.getMemoryAddress(pointers[i]);
-
-        // Source and CallStack (placeholders)
-        std::string source = __FUNCTION__;  // Function name
-        std::string callStack = "variableSizeBenchmark";
-
-        // Log deallocation time and fragmentation
-        logger.log(timestamp, "Deallocation", sizes[i], deallocTime, allocator.getFragmentation(), source, callStack,
-                   memoryAddress, threadID, allocationIDs[i]);
+    for (void* ptr : pointers) {
+        allocator.deallocate(ptr);
     }
 
     std::cout << "Variable-Size Allocation Benchmark completed with " << numOperations << " operations." << std::endl;
 }
 
-void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double duration, DataLogger& logger) {
+void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double duration, DataLogger& logger,
+                         bool logEvents) {
     std::vector<void*> pointers;
-    std::vector<std::string> allocationIDs;
 
     // Initialize counters
     size_t allocCount = 0;
@@ -340,86 +327,27 @@ void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double du
     auto startTime = std::chrono::high_resolution_clock::now();
     auto endTime = startTime + std::chrono::duration<double>(duration);
 
-    // Run allocations and deallocations until duration is met
-    while (std::chrono::high_resolution_clock::now() < endTime) {
-        // Allocate memory
-        auto allocStart = std::chrono::high_resolution_clock::now();
-        void* ptr = allocator.allocate(blockSize);
-        auto allocEnd = std::chrono::high_resolution_clock::now();
-        double allocTime = std::chrono::duration<double, std::micro>(allocEnd - allocStart).count();  // in microseconds
-
-        if (ptr != nullptr) {
-            // Get allocation ID
-            std::string allocationID = allocator.getAllocationID(ptr);
-
-            pointers.push_back(ptr);
-            allocationIDs.push_back(allocationID);
-            allocCount++;
-
-            // Generate timestamp
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-            std::tm now_tm = *std::localtime(&now_time_t);
-            std::ostringstream timestampStream;
-            timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-            std::string timestamp = timestampStream.str();
-
-            // Get thread ID
-            std::ostringstream threadIDStream;
-            threadIDStream << std::this_thread::get_id();
-            std::string threadID = threadIDStream.str();
-
-            // Get memory address
-            std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-            // Source and CallStack (placeholders)
-            std::string source = __FUNCTION__;  // Function name
-            std::string callStack = "throughputBenchmark";
-
-            // Log allocation time and fragmentation
-            logger.log(timestamp, "Allocation", blockSize, allocTime, allocator.getFragmentation(), source, callStack,
-                       memoryAddress, threadID, allocationID);
+    {
+        // Only the timed loop is logged; the cleanup below is not
+        std::optional<AllocatorEventLogger> events;
+        if (logEvents) {
+            events.emplace(allocator, logger, __FUNCTION__, "throughputBenchmark");
         }
 
-        // Deallocate memory if any pointers are available
-        if (!pointers.empty()) {
-            // Deallocate the first pointer (FIFO)
-            void* ptr = pointers.front();
-            std::string allocationID = allocationIDs.front();
-
-            auto deallocStart = std::chrono::high_resolution_clock::now();
-            allocator.deallocate(ptr);
-            auto deallocEnd = std::chrono::high_resolution_clock::now();
-            double deallocTime =
-                std::chrono::duration<double, std::micro>(deallocEnd - deallocStart).count();  // in microseconds
-
-            pointers.erase(pointers.begin());
-            allocationIDs.erase(allocationIDs.begin());
-            deallocCount++;
-
-            // Generate timestamp
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-            std::tm now_tm = *std::localtime(&now_time_t);
-            std::ostringstream timestampStream;
-            timestampStream << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
-            std::string timestamp = timestampStream.str();
-
-            // Get thread ID
-            std::ostringstream threadIDStream;
-            threadIDStream << std::this_thread::get_id();
-            std::string threadID = threadIDStream.str();
-
-            // Get memory address
-            std::string memoryAddress = allocator.getMemoryAddress(ptr);
-
-            // Source and CallStack (placeholders)
-            std::string source = __FUNCTION__;  // Function name
-            std::string callStack = "throughputBenchmark";
-
-            // Log deallocation time and fragmentation
-            logger.log(timestamp, "Deallocation", blockSize, deallocTime, allocator.getFragmentation(), source,
-                       callStack, memoryAddress, threadID, allocationID);
+        // Run allocations and deallocations until duration is met
+        while (std::chrono::high_resolution_clock::now() < endTime) {
+            void* ptr = allocator.allocate(blockSize);
+            if (ptr != nullptr) {
+                pointers.push_back(ptr);
+                allocCount++;
+            }
+
+            // Deallocate the first pointer (FIFO) if any pointers are available
+            if (!pointers.empty()) {
+                allocator.deallocate(pointers.front());
+                pointers.erase(pointers.begin());
+                deallocCount++;
+            }
         }
     }
 
@@ -442,10 +370,24 @@ void throughputBenchmark(CustomAllocator& allocator, size_t blockSize, double du
     summaryStream << "Throughput Benchmark Summary";
     std::string summary = summaryStream.str();
 
-    logger.logSummary(summary, allocThroughput, deallocThroughput, allocator.getFragmentation());
+    LatencyStats latency = allocator.getLatencyStats();
+    logger.logSummary(summary, allocThroughput, deallocThroughput, allocator.getFragmentation(),
+                      latencyPercentiles(latency.allocation), latencyPercentiles(latency.deallocation));
 
     std::cout << "Throughput Benchmark completed." << std::endl;
     std::cout << "Duration: " << actualDuration << " seconds" << std::endl;
     std::cout << "Allocations: " << allocCount << " | Throughput: " << allocThroughput << " ops/sec" << std::endl;
     std::cout << "Deallocations: " << deallocCount << " | Throughput: " << deallocThroughput << " ops/sec" << std::endl;
+    std::cout << "Allocation latency p50/p99/p999: " << latency.allocation.percentile(0.5) << " / "
+              << latency.allocation.percentile(0.99) << " / " << latency.allocation.percentile(0.999) << " ns"
+              << std::endl;
+}
+
+LatencyPercentiles latencyPercentiles(const LatencySnapshot& snapshot) {
+    LatencyPercentiles percentiles;
+    percentiles.samples = snapshot.samples;
+    percentiles.p50 = static_cast<double>(snapshot.percentile(0.5));
+    percentiles.p99 = static_cast<double>(snapshot.percentile(0.99));
+    percentiles.p999 = static_cast<double>(snapshot.percentile(0.999));
+    return percentiles;
 }
\ No newline at end of file
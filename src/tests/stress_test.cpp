@@ -10,26 +10,55 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "allocator_adapters.h"
+#include "buddy_allocator.h"
+#include "allocator_config.h"
 #include "config_manager.h"
 #include "custom_allocator.h"
 #include "data_logger.h"
+#include "heap_snapshot_writer.h"
+#include "sharded_allocator.h"
+#include "slab_allocator.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 // Global config manager (loaded from command line in main)
 static ConfigManager* g_config = nullptr;
 
+/**
+ * @brief Reduces an allocator latency histogram to the percentiles written by DataLogger::logSummary.
+ */
+static LatencyPercentiles latencyPercentiles(const LatencySnapshot& snapshot) {
+    LatencyPercentiles percentiles;
+    percentiles.samples = snapshot.samples;
+    percentiles.p50 = static_cast<double>(snapshot.percentile(0.5));
+    percentiles.p99 = static_cast<double>(snapshot.percentile(0.99));
+    percentiles.p999 = static_cast<double>(snapshot.percentile(0.999));
+    return percentiles;
+}
+
 /**
  * @class AllocatorFixture
  * @brief Fixture class for setting up and tearing down the CustomAllocator and DataLogger.
@@ -51,8 +80,10 @@ class AllocatorFixture : public benchmark::Fixture {
         size_t min_order = g_config->getSize("min-order", 6);
         size_t max_order = g_config->getSize("max-order", 20);
 
+        AllocatorOptions options = allocatorOptionsFromConfig(*g_config);
+
         // Initialize the CustomAllocator
-        allocator = new CustomAllocator(min_order, max_order);
+        allocator = new CustomAllocator(min_order, max_order, options);
 
         // Initialize DataLogger with timestamped output file in reports directory
         std::string outputDir = g_config->getString("out", "reports");
@@ -67,7 +98,9 @@ class AllocatorFixture : public benchmark::Fixture {
         localtime_r(&in_time_t, &tm_buf);
 #endif
         std::ostringstream oss;
-        oss << outputDir << "/stress_test_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S") << ".csv";
+        oss << outputDir << "/stress_test_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S");
+        outputPrefix = oss.str();
+        oss << ".csv";
 
         dataLogger = new DataLogger(oss.str());
     }
@@ -87,17 +120,20 @@ class AllocatorFixture : public benchmark::Fixture {
             double fragmentation = allocator->getFragmentation();   // Fragmentation ratio (0.0 to 1.0)
 
             // Retrieve total allocations and deallocations from allocator
-            size_t totalAllocs = allocator->getTotalAllocations();
-            size_t totalDeallocs = allocator->getTotalDeallocations();
+            OperationTotals totals = allocator->getTotals();
+            size_t totalAllocs = totals.allocations;
+            size_t totalDeallocs = totals.deallocations;
 
             // Compute throughput (operations per second)
             double allocThroughput = (allocTime > 0.0) ? (static_cast<double>(totalAllocs) / allocTime) : 0.0;
             double deallocThroughput = (deallocTime > 0.0) ? (static_cast<double>(totalDeallocs) / deallocTime) : 0.0;
 
-            // Log summary
+            // Log summary with the merged per-thread latency percentiles
             std::string summary = "Stress Test Summary";
+            LatencyStats latency = allocator->getLatencyStats();
             dataLogger->logSummary(summary, allocThroughput, deallocThroughput,
-                                   fragmentation * 100.0);  // Convert to percentage
+                                   fragmentation * 100.0,  // Convert to percentage
+                                   latencyPercentiles(latency.allocation), latencyPercentiles(latency.deallocation));
 
             // Clean up
             delete allocator;
@@ -111,6 +147,7 @@ class AllocatorFixture : public benchmark::Fixture {
    protected:
     CustomAllocator* allocator; /**< Pointer to the CustomAllocator instance */
     DataLogger* dataLogger;     /**< Pointer to the DataLogger instance */
+    std::string outputPrefix;   /**< Log path without its extension, for files written beside it */
 
     // Removed the following atomic counters as they are now handled within CustomAllocator
     // std::atomic<size_t> totalAllocations{0};
@@ -179,6 +216,17 @@ BENCHMARK_DEFINE_F(AllocatorFixture, MemoryFragmentation)(benchmark::State& stat
     std::mt19937 rng(42);                                       // Fixed seed for reproducibility
     std::uniform_int_distribution<size_t> size_dist(64, 1024);  // Allocation sizes between 64 and 1024 bytes
     std::uniform_int_distribution<int> op_dist(0, 1);           // 0 for allocate, 1 for deallocate
+    double fragmentationSum = 0.0;
+    double fragmentationPeak = 0.0;
+    size_t samples = 0;
+
+    // Occupancy maps every heap-snapshot-interval operations, taken outside the timed region
+    size_t snapshotInterval = g_config->getSize("heap-snapshot-interval", 0);
+    std::unique_ptr<HeapSnapshotWriter> snapshots;
+    if (snapshotInterval > 0) {
+        snapshots = std::make_unique<HeapSnapshotWriter>(outputPrefix + "_fragmentation_" +
+                                                         std::to_string(num_operations) + ".heap");
+    }
 
     for (auto _ : state) {
         for (size_t i = 0; i < num_operations; ++i) {
@@ -199,6 +247,18 @@ BENCHMARK_DEFINE_F(AllocatorFixture, MemoryFragmentation)(benchmark::State& stat
                     pointers.pop_back();
                 }
             }
+
+            // Lock-free read of the incrementally maintained free-list counts
+            double fragmentation = allocator->getExternalFragmentation();
+            fragmentationSum += fragmentation;
+            fragmentationPeak = std::max(fragmentationPeak, fragmentation);
+            ++samples;
+
+            if (snapshots && (i + 1) % snapshotInterval == 0) {
+                state.PauseTiming();
+                snapshots->capture(*allocator);
+                state.ResumeTiming();
+            }
         }
 
         // Deallocate any remaining pointers to prevent memory leaks
@@ -215,6 +275,13 @@ BENCHMARK_DEFINE_F(AllocatorFixture, MemoryFragmentation)(benchmark::State& stat
     }
 
     state.SetComplexityN(num_operations);
+    state.counters["ExternalFragmentation"] = samples ? fragmentationSum / samples : 0.0;
+    state.counters["PeakExternalFragmentation"] = fragmentationPeak;
+    // Merge work, to weigh deferred coalescing against the fragmentation it leaves
+    CoalescingStats coalescing = allocator->getCoalescingStats();
+    state.counters["Merges"] = static_cast<double>(coalescing.merges);
+    state.counters["DeferredFrees"] = static_cast<double>(coalescing.deferredFrees);
+    state.counters["BulkCoalesces"] = static_cast<double>(coalescing.bulkCoalesces);
 }
 
 // Register the benchmark with a range of operation counts
@@ -271,6 +338,664 @@ BENCHMARK_DEFINE_F(AllocatorFixture, MaxLoadTest)(benchmark::State& state) {
 // Register the benchmark without specific arguments, it runs until failure
 BENCHMARK_REGISTER_F(AllocatorFixture, MaxLoadTest)->Unit(benchmark::kMicrosecond)->Complexity();
 
+// ============================================================================
+// Thread Scaling Benchmarks
+// ============================================================================
+
+/**
+ * @brief Upper end of the thread-count axis: one benchmark thread per hardware thread.
+ */
+static int maxBenchmarkThreads() {
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+/**
+ * @brief Per-thread churn loop: allocate a batch of 128-byte blocks, then free them all.
+ *
+ * Only successful allocations and their frees count as items; allocations that failed for lack
+ * of memory are reported as FailedAllocations (raise --max-order if this is not zero).
+ *
+ * @param shared Pointer to the allocator shared by every benchmark thread. Thread 0 sets it
+ *        before the timed loop, which other threads may reach first, so it is only read inside
+ *        the loop, after the start barrier.
+ * @param state Benchmark state; range(0) is the batch size.
+ */
+template <typename Allocator>
+static void runScalingChurn(Allocator* const& shared, benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<void*> pointers;
+    pointers.reserve(batch);
+    size_t operations = 0;
+    size_t failures = 0;
+
+    for (auto _ : state) {
+        Allocator& allocator = *shared;
+        for (size_t i = 0; i < batch; ++i) {
+            void* ptr = allocator.allocate(128);
+            if (ptr) {
+                pointers.push_back(ptr);
+            } else {
+                ++failures;
+            }
+        }
+        for (void* ptr : pointers) {
+            allocator.deallocate(ptr);
+        }
+        operations += 2 * pointers.size();
+        pointers.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+    state.counters["FailedAllocations"] = static_cast<double>(failures);
+}
+
+static CustomAllocator* g_singleArena = nullptr;     /**< Shared by all threads of the single-arena benchmarks */
+static ShardedAllocator* g_shardedArenas = nullptr;  /**< Shared by all threads of ThreadScalingSharded */
+
+/**
+ * @brief Runs the churn loop against one CustomAllocator shared by every thread.
+ *
+ * Google Benchmark synchronises all threads before and after the timed loop, so thread 0 can
+ * create and destroy the shared allocator around it as long as the other threads only touch it
+ * inside the loop.
+ *
+ * @param state Benchmark state.
+ * @param options Options for the shared allocator.
+ */
+static void runSingleArenaScaling(benchmark::State& state, const AllocatorOptions& options) {
+    if (state.thread_index() == 0) {
+        g_singleArena =
+            new CustomAllocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20), options);
+    }
+
+    runScalingChurn(g_singleArena, state);
+
+    if (state.thread_index() == 0) {
+        delete g_singleArena;
+        g_singleArena = nullptr;
+    }
+}
+
+/**
+ * @brief Thread-count axis for a single CustomAllocator configured from the config file.
+ *
+ * @param state Benchmark state.
+ */
+static void ThreadScalingSingleArena(benchmark::State& state) {
+    runSingleArenaScaling(state, allocatorOptionsFromConfig(*g_config));
+}
+
+/**
+ * @brief Thread-count axis for a single CustomAllocator in lock-free mode, for comparison with
+ *        the mutex-only and thread-cache configurations.
+ *
+ * @param state Benchmark state.
+ */
+static void ThreadScalingLockFree(benchmark::State& state) {
+    AllocatorOptions options = allocatorOptionsFromConfig(*g_config);
+    options.threadCache = false;
+    options.lockFree = true;
+    runSingleArenaScaling(state, options);
+}
+
+/**
+ * @brief Thread-count axis for ShardedAllocator, one arena per hardware thread unless configured.
+ *
+ * @param state Benchmark state.
+ */
+static void ThreadScalingSharded(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_shardedArenas = new ShardedAllocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                                               g_config->getSize("arenas", 0), ArenaRouting::Thread, allocatorOptionsFromConfig(*g_config));
+    }
+
+    runScalingChurn(g_shardedArenas, state);
+
+    if (state.thread_index() == 0) {
+        state.counters["Arenas"] = static_cast<double>(g_shardedArenas->getArenaCount());
+        delete g_shardedArenas;
+        g_shardedArenas = nullptr;
+    }
+}
+
+BENCHMARK(ThreadScalingSingleArena)->Arg(256)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+BENCHMARK(ThreadScalingLockFree)->Arg(256)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+BENCHMARK(ThreadScalingSharded)->Arg(256)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+
+// ============================================================================
+// Scalability Matrix
+// ============================================================================
+
+/**
+ * @brief Request sizes of the scalability matrix: its first argument.
+ */
+enum class MatrixSizes { Fixed = 0, Small = 1, Mixed = 2 };
+
+/**
+ * @brief Where the matrix's blocks are freed: its second argument.
+ */
+enum class MatrixFrees { Local = 0, CrossThread = 1 };
+
+/**
+ * @brief Blocks handed from one matrix thread to the next, guarded by its own mutex.
+ */
+struct MatrixMailbox {
+    std::mutex mutex;
+    std::vector<void*> blocks;
+};
+
+static std::vector<MatrixMailbox>* g_matrixMailboxes = nullptr;  /**< One per thread of ThreadScalingMatrix */
+
+/**
+ * @brief Pins the calling thread to one CPU for the lifetime of the object, then restores its mask.
+ *
+ * Benchmark thread i goes to CPU i modulo the CPUs available, so a run with N threads occupies
+ * N distinct cores and thread placement does not vary between runs. Linux only; elsewhere the
+ * scheduler places threads.
+ */
+class ThreadPinning {
+   public:
+    explicit ThreadPinning(int index) : pinned(false) {
+#if defined(__linux__)
+        if (pthread_getaffinity_np(pthread_self(), sizeof(original), &original) != 0) {
+            return;
+        }
+        int available = CPU_COUNT(&original);
+        if (available == 0) {
+            return;
+        }
+        int target = index % available;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &original) && target-- == 0) {
+                cpu_set_t single;
+                CPU_ZERO(&single);
+                CPU_SET(cpu, &single);
+                pinned = pthread_setaffinity_np(pthread_self(), sizeof(single), &single) == 0;
+                break;
+            }
+        }
+#else
+        (void)index;
+#endif
+    }
+
+    ~ThreadPinning() {
+#if defined(__linux__)
+        if (pinned) {
+            pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+        }
+#endif
+    }
+
+    ThreadPinning(const ThreadPinning&) = delete;
+    ThreadPinning& operator=(const ThreadPinning&) = delete;
+
+    bool isPinned() const { return pinned; }
+
+   private:
+    bool pinned;
+#if defined(__linux__)
+    cpu_set_t original;
+#endif
+};
+
+/**
+ * @brief Thread count x size distribution x free pattern on one shared CustomAllocator.
+ *
+ * Each iteration allocates a batch of 64 blocks. With local frees the thread then frees its own
+ * batch; with cross-thread frees it passes the batch to the next thread's mailbox and frees
+ * whatever the previous thread left in its own, so every block is freed by a thread that did not
+ * allocate it (a single thread frees its own). Sizes are fixed 128 bytes, uniform 16-256 bytes,
+ * or log-uniform 16 bytes-4 KiB.
+ *
+ * Reports total and per-thread operation rates, allocations that failed for lack of memory
+ * (raise --max-order if this is not zero), and the allocator lock's contention over the run.
+ *
+ * @param state Benchmark state; range(0) is a MatrixSizes, range(1) a MatrixFrees.
+ */
+static void ThreadScalingMatrix(benchmark::State& state) {
+    constexpr size_t BATCH = 64;
+    const MatrixSizes sizes = static_cast<MatrixSizes>(state.range(0));
+    const MatrixFrees frees = static_cast<MatrixFrees>(state.range(1));
+    const size_t index = static_cast<size_t>(state.thread_index());
+    const size_t threads = static_cast<size_t>(state.threads());
+
+    if (index == 0) {
+        g_singleArena = new CustomAllocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                                            allocatorOptionsFromConfig(*g_config));
+        g_matrixMailboxes = new std::vector<MatrixMailbox>(threads);
+    }
+
+    ThreadPinning pinning(static_cast<int>(index));
+    std::mt19937 rng(static_cast<uint32_t>(42 + index));  // Fixed per-thread seeds for reproducibility
+    std::uniform_int_distribution<size_t> smallSize(16, 256);
+    std::uniform_int_distribution<int> mixedShift(4, 12);
+    std::vector<void*> pointers;
+    std::vector<void*> received;
+    pointers.reserve(BATCH);
+    size_t operations = 0;
+    size_t failures = 0;
+    LockContention before = index == 0 ? g_singleArena->getLockContention() : LockContention();
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            size_t size = 128;
+            if (sizes == MatrixSizes::Small) {
+                size = smallSize(rng);
+            } else if (sizes == MatrixSizes::Mixed) {
+                size = (static_cast<size_t>(1) << mixedShift(rng)) + (rng() & 15);
+            }
+            void* ptr = g_singleArena->allocate(size);
+            if (ptr) {
+                pointers.push_back(ptr);
+            } else {
+                ++failures;
+            }
+        }
+        operations += pointers.size();
+
+        if (frees == MatrixFrees::CrossThread && threads > 1) {
+            MatrixMailbox& next = (*g_matrixMailboxes)[(index + 1) % threads];
+            {
+                std::lock_guard<std::mutex> lock(next.mutex);
+                next.blocks.insert(next.blocks.end(), pointers.begin(), pointers.end());
+            }
+            pointers.clear();
+            MatrixMailbox& own = (*g_matrixMailboxes)[index];
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                received.swap(own.blocks);
+            }
+            pointers.swap(received);
+        }
+
+        for (void* ptr : pointers) {
+            g_singleArena->deallocate(ptr);
+        }
+        operations += pointers.size();
+        pointers.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(operations));
+    state.counters["OpsPerThread"] =
+        benchmark::Counter(static_cast<double>(operations), benchmark::Counter::kAvgThreadsRate);
+    state.counters["FailedAllocations"] = static_cast<double>(failures);
+    state.counters["Pinned"] = benchmark::Counter(pinning.isPinned() ? 1.0 : 0.0, benchmark::Counter::kAvgThreads);
+
+    // Every thread has left the timed loop, so thread 0 alone drains the mailboxes
+    if (index == 0) {
+        LockContention after = g_singleArena->getLockContention();
+        LockContention run;
+        run.acquisitions = after.acquisitions - before.acquisitions;
+        run.contended = after.contended - before.contended;
+        run.waitNanoseconds = after.waitNanoseconds - before.waitNanoseconds;
+        state.counters["LockContended"] = run.contendedFraction();
+        state.counters["LockWaitSeconds"] = static_cast<double>(run.waitNanoseconds) / 1e9;
+        state.counters["LockWaitPerOp_ns"] =
+            run.acquisitions > 0 ? static_cast<double>(run.waitNanoseconds) / static_cast<double>(run.acquisitions)
+                                 : 0.0;
+
+        for (MatrixMailbox& mailbox : *g_matrixMailboxes) {
+            for (void* ptr : mailbox.blocks) {
+                g_singleArena->deallocate(ptr);
+            }
+        }
+        delete g_matrixMailboxes;
+        g_matrixMailboxes = nullptr;
+        delete g_singleArena;
+        g_singleArena = nullptr;
+    }
+}
+
+BENCHMARK(ThreadScalingMatrix)
+    ->ArgNames({"sizes", "crossThread"})
+    ->ArgsProduct({{static_cast<int64_t>(MatrixSizes::Fixed), static_cast<int64_t>(MatrixSizes::Small),
+                    static_cast<int64_t>(MatrixSizes::Mixed)},
+                   {static_cast<int64_t>(MatrixFrees::Local), static_cast<int64_t>(MatrixFrees::CrossThread)}})
+    ->ThreadRange(1, maxBenchmarkThreads())
+    ->UseRealTime();
+
+// ============================================================================
+// Compile-Time vs Runtime Orders
+// ============================================================================
+
+/**
+ * @brief Single-thread churn on a CustomAllocator with orders 6..20 given at runtime.
+ *
+ * Uses default options so the only difference from CompileTimeOrders is how the orders are known.
+ *
+ * @param state Benchmark state.
+ */
+static void RuntimeOrders(benchmark::State& state) {
+    CustomAllocator allocator(6, 20);
+    runScalingChurn(&allocator, state);
+}
+
+/**
+ * @brief Single-thread churn on BuddyAllocator<6, 20>, whose orders are template constants.
+ *
+ * Both allocators run the BuddyCore split/coalesce code and time every operation through the
+ * same LatencyTimer, so the difference is the constant folding alone.
+ *
+ * @param state Benchmark state.
+ */
+static void CompileTimeOrders(benchmark::State& state) {
+    BuddyAllocator<6, 20> allocator;
+    runScalingChurn(&allocator, state);
+}
+
+BENCHMARK(RuntimeOrders)->Arg(256)->Arg(4096);
+BENCHMARK(CompileTimeOrders)->Arg(256)->Arg(4096);
+
+// ============================================================================
+// Small Object Packing Benchmarks
+// ============================================================================
+
+/**
+ * @brief Allocates a live set of small mixed-size objects and reports how densely it is packed.
+ *
+ * The "Utilization" counter is requested bytes divided by the pool bytes in use while the whole
+ * live set is allocated, so the buddy and slab variants can be compared directly.
+ *
+ * @param allocator Allocator under test.
+ * @param state Benchmark state; range(0) is the number of live objects.
+ */
+template <typename Allocator>
+static void runSmallObjectPacking(Allocator& allocator, size_t poolSize, benchmark::State& state) {
+    const size_t num_objects = static_cast<size_t>(state.range(0));
+    const std::vector<size_t> sizes = {24, 40, 72, 100, 136, 200, 300, 500};
+    std::vector<void*> pointers;
+    pointers.reserve(num_objects);
+    double utilization = 0.0;
+
+    for (auto _ : state) {
+        std::mt19937 rng(42);  // Same object mix every iteration
+        size_t requested = 0;
+        for (size_t i = 0; i < num_objects; ++i) {
+            size_t size = sizes[rng() % sizes.size()];
+            void* ptr = allocator.allocate(size);
+            if (ptr) {
+                pointers.push_back(ptr);
+                requested += size;
+            }
+        }
+
+        state.PauseTiming();
+        double usedBytes = (1.0 - allocator.getFragmentation()) * static_cast<double>(poolSize);
+        utilization = usedBytes > 0.0 ? static_cast<double>(requested) / usedBytes : 0.0;
+        state.ResumeTiming();
+
+        for (void* ptr : pointers) {
+            allocator.deallocate(ptr);
+        }
+        pointers.clear();
+    }
+
+    state.counters["Utilization"] = utilization;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_objects * 2));
+}
+
+/**
+ * @brief Small-object packing with every request served by power-of-two buddy blocks.
+ *
+ * @param state Benchmark state.
+ */
+static void SmallObjectsBuddy(benchmark::State& state) {
+    CustomAllocator allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                              allocatorOptionsFromConfig(*g_config));
+    runSmallObjectPacking(allocator, allocator.getPoolSize(), state);
+}
+
+/**
+ * @brief Small-object packing with requests up to the largest size class served from slabs.
+ *
+ * @param state Benchmark state.
+ */
+static void SmallObjectsSlab(benchmark::State& state) {
+    SlabAllocator allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20), 14,
+                            allocatorOptionsFromConfig(*g_config));
+    runSmallObjectPacking(allocator, allocator.getBuddyAllocator().getPoolSize(), state);
+}
+
+BENCHMARK(SmallObjectsBuddy)->Arg(4096)->Unit(benchmark::kMicrosecond);
+BENCHMARK(SmallObjectsSlab)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+// ============================================================================
+// Growing Buffer Benchmarks
+// ============================================================================
+
+/**
+ * @brief Grows a few buffers side by side from 16 bytes to range(0) bytes, doubling each step.
+ *
+ * The buffers interleave their growth, so some steps find the next buddy taken and must move.
+ * With inPlace set they grow through reallocate(); otherwise by allocate, memcpy and deallocate.
+ * "InPlace" is the fraction of growth steps that reallocate() completed without copying.
+ *
+ * @param state Benchmark state; range(0) is the final buffer size.
+ * @param inPlace Whether to grow with reallocate().
+ */
+static void runGrowingBuffers(benchmark::State& state, bool inPlace) {
+    constexpr size_t BUFFERS = 4;
+    const size_t finalSize = static_cast<size_t>(state.range(0));
+    CustomAllocator allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20),
+                              allocatorOptionsFromConfig(*g_config));
+    std::array<void*, BUFFERS> buffers{};
+    size_t steps = 0;
+
+    for (auto _ : state) {
+        for (void*& buffer : buffers) {
+            buffer = allocator.allocate(16);
+        }
+        for (size_t size = 32; size <= finalSize; size *= 2) {
+            for (void*& buffer : buffers) {
+                void* grown = nullptr;
+                if (buffer && inPlace) {
+                    grown = allocator.reallocate(buffer, size);
+                } else if (buffer && (grown = allocator.allocate(size)) != nullptr) {
+                    std::memcpy(grown, buffer, size / 2);
+                    allocator.deallocate(buffer);
+                }
+                if (grown) {
+                    buffer = grown;
+                    ++steps;
+                }
+            }
+        }
+        for (void* buffer : buffers) {
+            allocator.deallocate(buffer);
+        }
+    }
+
+    if (inPlace) {
+        state.counters["InPlace"] = steps ? static_cast<double>(allocator.getInPlaceReallocations()) / steps : 0.0;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(steps));
+}
+
+/**
+ * @brief Growing buffers with reallocate(), which absorbs free buddies instead of copying.
+ *
+ * @param state Benchmark state.
+ */
+static void GrowingBufferReallocate(benchmark::State& state) {
+    runGrowingBuffers(state, true);
+}
+
+/**
+ * @brief Growing buffers by allocate-copy-free, the baseline for GrowingBufferReallocate.
+ *
+ * @param state Benchmark state.
+ */
+static void GrowingBufferCopy(benchmark::State& state) {
+    runGrowingBuffers(state, false);
+}
+
+BENCHMARK(GrowingBufferReallocate)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK(GrowingBufferCopy)->Arg(1 << 12)->Arg(1 << 16);
+
+// ============================================================================
+// Standard Container Benchmarks
+// ============================================================================
+
+/**
+ * @brief Container allocator source for the baseline: std::allocator, i.e. global operator new.
+ */
+class DefaultContainerAllocator {
+   public:
+    template <typename T>
+    std::allocator<T> get() {
+        return std::allocator<T>();
+    }
+};
+
+/**
+ * @brief CustomStlAllocator over a CustomAllocator configured like the other benchmarks.
+ */
+class CustomContainerAllocator {
+   public:
+    CustomContainerAllocator()
+        : allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20), allocatorOptionsFromConfig(*g_config)) {}
+
+    template <typename T>
+    CustomStlAllocator<T> get() {
+        return CustomStlAllocator<T>(allocator, g_config->getSize("alignment", 8));
+    }
+
+   private:
+    CustomAllocator allocator;
+};
+
+#if ALLOCATOR_HAS_PMR
+/**
+ * @brief std::pmr::polymorphic_allocator over a CustomMemoryResource.
+ */
+class PmrContainerAllocator {
+   public:
+    PmrContainerAllocator()
+        : allocator(g_config->getSize("min-order", 6), g_config->getSize("max-order", 20), allocatorOptionsFromConfig(*g_config)),
+          resource(allocator, g_config->getSize("alignment", 8)) {}
+
+    template <typename T>
+    std::pmr::polymorphic_allocator<T> get() {
+        return std::pmr::polymorphic_allocator<T>(&resource);
+    }
+
+   private:
+    CustomAllocator allocator;
+    CustomMemoryResource resource;
+};
+#endif
+
+/**
+ * @brief Grows a std::vector<uint64_t> to range(0) elements by push_back, then sums it.
+ *
+ * @tparam Source DefaultContainerAllocator, CustomContainerAllocator or PmrContainerAllocator.
+ * @param state Benchmark state.
+ */
+template <typename Source>
+static void ContainerVector(benchmark::State& state) {
+    const uint64_t count = static_cast<uint64_t>(state.range(0));
+    Source source;
+    auto allocator = source.template get<uint64_t>();
+
+    try {
+        for (auto _ : state) {
+            std::vector<uint64_t, decltype(allocator)> values(allocator);
+            for (uint64_t i = 0; i < count; ++i) {
+                values.push_back(i);
+            }
+            uint64_t sum = 0;
+            for (uint64_t value : values) {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+    } catch (const std::bad_alloc&) {
+        state.SkipWithError("Pool exhausted; raise --max-order");
+        return;
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+/**
+ * @brief Inserts range(0) scattered keys into a std::unordered_map, looks each up, then destroys it.
+ *
+ * @tparam Source DefaultContainerAllocator, CustomContainerAllocator or PmrContainerAllocator.
+ * @param state Benchmark state.
+ */
+template <typename Source>
+static void ContainerUnorderedMap(benchmark::State& state) {
+    const uint64_t count = static_cast<uint64_t>(state.range(0));
+    Source source;
+    auto allocator = source.template get<std::pair<const uint64_t, uint64_t>>();
+    using Map = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, decltype(allocator)>;
+
+    try {
+        for (auto _ : state) {
+            Map values(0, std::hash<uint64_t>(), std::equal_to<uint64_t>(), allocator);
+            for (uint64_t i = 0; i < count; ++i) {
+                values.emplace(i * 2654435761u, i);
+            }
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < count; ++i) {
+                sum += values.find(i * 2654435761u)->second;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+    } catch (const std::bad_alloc&) {
+        state.SkipWithError("Pool exhausted; raise --max-order");
+        return;
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+/**
+ * @brief Inserts range(0) scattered keys into a std::map, looks each up, then destroys it.
+ *
+ * @tparam Source DefaultContainerAllocator, CustomContainerAllocator or PmrContainerAllocator.
+ * @param state Benchmark state.
+ */
+template <typename Source>
+static void ContainerMap(benchmark::State& state) {
+    const uint64_t count = static_cast<uint64_t>(state.range(0));
+    Source source;
+    auto allocator = source.template get<std::pair<const uint64_t, uint64_t>>();
+    using Map = std::map<uint64_t, uint64_t, std::less<uint64_t>, decltype(allocator)>;
+
+    try {
+        for (auto _ : state) {
+            Map values(std::less<uint64_t>(), allocator);
+            for (uint64_t i = 0; i < count; ++i) {
+                values.emplace(i * 2654435761u, i);
+            }
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < count; ++i) {
+                sum += values.find(i * 2654435761u)->second;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+    } catch (const std::bad_alloc&) {
+        state.SkipWithError("Pool exhausted; raise --max-order");
+        return;
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+BENCHMARK_TEMPLATE(ContainerVector, DefaultContainerAllocator)->Arg(1 << 10)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(ContainerVector, CustomContainerAllocator)->Arg(1 << 10)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(ContainerUnorderedMap, DefaultContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(ContainerUnorderedMap, CustomContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(ContainerMap, DefaultContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(ContainerMap, CustomContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+#if ALLOCATOR_HAS_PMR
+BENCHMARK_TEMPLATE(ContainerVector, PmrContainerAllocator)->Arg(1 << 10)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(ContainerUnorderedMap, PmrContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(ContainerMap, PmrContainerAllocator)->Arg(1 << 10)->Arg(1 << 12);
+#endif
+
 int main(int argc, char** argv) {
     // Initialize ConfigManager
     ConfigManager config("config/default.toml");
@@ -0,0 +1,139 @@
+/**
+ * @file trace_replay.cpp
+ * @brief Replays a recorded allocation trace against CustomAllocator.
+ *
+ * Reads a binary trace (format = "binary", e.g. a service's allocator observed through
+ * AllocatorEventLogger), pairs each free with its allocation and replays the workload with one
+ * thread per recorded thread, in the recorded interleaving, at full speed or time-scaled. The
+ * result is logged as a benchmark summary with the allocator's latency percentiles.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "allocator_config.h"
+#include "config_manager.h"
+#include "custom_allocator.h"
+#include "data_logger.h"
+#include "trace_reader.h"
+#include "trace_replay.h"
+
+/**
+ * @brief Builds LatencyPercentiles from a histogram snapshot.
+ */
+LatencyPercentiles latencyPercentiles(const LatencySnapshot& snapshot);
+
+int main(int argc, char* argv[]) {
+    std::cout << "Running trace_replay.cpp main function." << std::endl;
+
+    ConfigManager config("config/default.toml");
+    config.parseCLI(argc, argv, "trace_replay", "Replay a recorded allocation trace against CustomAllocator");
+
+    if (config.helpRequested()) {
+        std::cout << config.getHelpMessage() << std::endl;
+        return 0;
+    }
+
+    try {
+        config.validate();
+    } catch (const std::exception& e) {
+        std::cerr << "Configuration error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::string tracePath = config.getString("trace", "");
+    if (tracePath.empty()) {
+        std::cerr << "Configuration error: --trace <file.trace> is required" << std::endl;
+        return 1;
+    }
+
+    ReplayOptions replayOptions;
+    replayOptions.speed = config.getDouble("replay-speed", 0.0);
+    std::string ordering = config.getString("replay-order", "strict");
+    if (ordering == "strict") {
+        replayOptions.ordering = ReplayOrdering::Strict;
+    } else if (ordering == "causal") {
+        replayOptions.ordering = ReplayOrdering::Causal;
+    } else {
+        std::cerr << "Configuration error: unknown replay order '" << ordering << "' (use strict or causal)"
+                  << std::endl;
+        return 1;
+    }
+    if (replayOptions.speed < 0.0) {
+        std::cerr << "Configuration error: replay speed must not be negative" << std::endl;
+        return 1;
+    }
+
+    size_t minOrder = config.getSize("min-order", 6);
+    size_t maxOrder = config.getSize("max-order", 20);
+
+    AllocatorOptions allocatorOptions = allocatorOptionsFromConfig(config);
+
+    TraceReader trace(tracePath);
+    if (!trace.isOpen()) {
+        return 1;
+    }
+    ReplayWorkload workload = ReplayWorkload::fromTrace(trace);
+    std::cout << "Loaded " << workload.operations.size() << " operations on " << workload.threads
+              << " thread(s) from " << tracePath << " (" << workload.unmatchedFrees
+              << " frees of blocks allocated before recording dropped)" << std::endl;
+
+    // Prepare output file with timestamp
+    std::string outputDir = config.getString("out", "reports");
+    std::filesystem::create_directories(outputDir);
+
+    auto now = std::chrono::system_clock::now();
+    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm tm_buf;
+#if defined(_WIN32) || defined(_WIN64)
+    localtime_s(&tm_buf, &in_time_t);
+#else
+    localtime_r(&in_time_t, &tm_buf);
+#endif
+    LoggerOptions loggerOptions;
+    std::string format = config.getString("format", "csv");
+    if (!DataLogger::parseFormat(format, loggerOptions)) {
+        std::cerr << "Configuration error: unknown output format '" << format
+                  << "' (use csv, csv.gz, csv.zst or binary)" << std::endl;
+        return 1;
+    }
+    loggerOptions.echoToConsole = config.getBool("log-echo", false);
+    std::ostringstream oss;
+    oss << outputDir << "/trace_replay_" << std::put_time(&tm_buf, "%Y-%m-%d_%H-%M-%S")
+        << DataLogger::fileExtension(loggerOptions);
+    DataLogger logger(oss.str(), loggerOptions);
+
+    CustomAllocator allocator(minOrder, maxOrder, allocatorOptions);
+    ReplayResult result = replayWorkload(allocator, workload, replayOptions);
+
+    double operations = static_cast<double>(result.allocations + result.deallocations);
+    double allocThroughput = result.seconds > 0.0 ? static_cast<double>(result.allocations) / result.seconds : 0.0;
+    double deallocThroughput = result.seconds > 0.0 ? static_cast<double>(result.deallocations) / result.seconds : 0.0;
+    LatencyStats latency = allocator.getLatencyStats();
+    logger.logSummary("Trace Replay Summary (" + ordering + ")", allocThroughput, deallocThroughput,
+                      allocator.getFragmentation(), latencyPercentiles(latency.allocation),
+                      latencyPercentiles(latency.deallocation));
+
+    std::cout << "Trace Replay completed in " << result.seconds << " seconds ("
+              << (result.seconds > 0.0 ? operations / result.seconds : 0.0) << " ops/sec)." << std::endl;
+    std::cout << "Allocations: " << result.allocations << " | Failed: " << result.failedAllocations
+              << " | Deallocations: " << result.deallocations << " | Never freed: " << result.leakedBlocks
+              << std::endl;
+    std::cout << "Allocation latency p50/p99/p999: " << latency.allocation.percentile(0.5) << " / "
+              << latency.allocation.percentile(0.99) << " / " << latency.allocation.percentile(0.999) << " ns"
+              << std::endl;
+    return 0;
+}
+
+LatencyPercentiles latencyPercentiles(const LatencySnapshot& snapshot) {
+    LatencyPercentiles percentiles;
+    percentiles.samples = snapshot.samples;
+    percentiles.p50 = static_cast<double>(snapshot.percentile(0.5));
+    percentiles.p99 = static_cast<double>(snapshot.percentile(0.99));
+    percentiles.p999 = static_cast<double>(snapshot.percentile(0.999));
+    return percentiles;
+}
@@ -1,11 +1,41 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
 #include <set>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
 #include <thread>
 #include <vector>
 
+#include "allocator_adapters.h"
+#include "allocator_event_logger.h"
+#include "buddy_allocator.h"
+#include "csv_writer.h"
 #include "custom_allocator.h"
+#include "data_logger.h"
+#include "growable_allocator.h"
 #include "gtest/gtest.h"
+#include "heap_snapshot_writer.h"
+#include "latency_histogram.h"
+#include "lock_contention.h"
+#include "memory_pool.h"
+#include "metrics_sampler.h"
+#include "sharded_allocator.h"
+#include "slab_allocator.h"
+#include "trace_reader.h"
+#include "trace_replay.h"
+#include "trace_writer.h"
 
 // ============================================================================
 // Basic Allocation/Deallocation Tests
@@ -87,6 +117,21 @@ TEST(CustomAllocatorTest, AllocateTooLarge) {
     }
 }
 
+TEST(CustomAllocatorTest, AllocateLargerThanPool) {
+    CustomAllocator allocator(6, 16);
+    // A request that cannot fit in the pool (header included) must fail even when the pool is empty
+    EXPECT_EQ(allocator.allocate(1 << 16), nullptr);
+    EXPECT_EQ(allocator.allocate(1 << 20), nullptr);
+
+    // Sizes whose header-inclusive size would wrap around must not map to a small order
+    size_t huge = std::numeric_limits<size_t>::max() - 8;
+    void* batch[4];
+    EXPECT_EQ(allocator.allocate(huge), nullptr);
+    EXPECT_EQ(allocator.allocate(huge, 64), nullptr);
+    EXPECT_EQ(allocator.allocateBatch(huge, 4, batch), 0u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
 TEST(CustomAllocatorTest, AllocateUntilFull) {
     CustomAllocator allocator(6, 12);  // Small pool for testing
     std::vector<void*> ptrs;
@@ -198,6 +243,525 @@ TEST(CustomAllocatorTest, FragmentationPattern) {
     }
 }
 
+TEST(CustomAllocatorTest, StatsTrackFreeBlocksByOrder) {
+    AllocatorOptions options;
+    options.headerless = true;  // A 64-byte request is exactly one order-6 block
+    CustomAllocator allocator(6, 12, options);
+
+    AllocatorStats stats = allocator.getStats();
+    EXPECT_EQ(stats.totalBytes, 4096u);
+    EXPECT_EQ(stats.freeBlocks[12], 1u);
+    EXPECT_EQ(stats.largestFreeBlock(), 4096u);
+    EXPECT_DOUBLE_EQ(stats.externalFragmentation(), 0.0);
+
+    // Splitting the pool down to order 6 leaves one buddy at each order from 6 to 11
+    void* ptr = allocator.allocate(64);
+    ASSERT_NE(ptr, nullptr);
+    stats = allocator.getStats();
+    for (size_t order = 6; order <= 11; ++order) {
+        EXPECT_EQ(stats.freeBlocks[order], 1u) << "order " << order;
+    }
+    EXPECT_EQ(stats.freeBlocks[12], 0u);
+    EXPECT_EQ(stats.freeBytes, 4096u - 64);
+    EXPECT_EQ(stats.largestFreeOrder, 11u);
+    EXPECT_DOUBLE_EQ(stats.externalFragmentation(), 1.0 - 2048.0 / 4032.0);
+    EXPECT_DOUBLE_EQ(allocator.getExternalFragmentation(), stats.externalFragmentation());
+
+    // Filling the pool leaves nothing free, and nothing to fragment
+    std::vector<void*> rest;
+    while (void* more = allocator.allocate(64)) {
+        rest.push_back(more);
+    }
+    stats = allocator.getStats();
+    EXPECT_EQ(stats.freeBytes, 0u);
+    EXPECT_EQ(stats.largestFreeBlock(), 0u);
+    EXPECT_DOUBLE_EQ(allocator.getExternalFragmentation(), 0.0);
+
+    // Every other block free: 32 scattered order-6 blocks and no larger one
+    for (size_t i = 0; i < rest.size(); i += 2) {
+        allocator.deallocate(rest[i]);
+    }
+    stats = allocator.getStats();
+    EXPECT_EQ(stats.freeBlocks[6], 32u);
+    EXPECT_EQ(stats.largestFreeOrder, 6u);
+    EXPECT_DOUBLE_EQ(stats.externalFragmentation(), 1.0 - 1.0 / 32);
+
+    for (size_t i = 1; i < rest.size(); i += 2) {
+        allocator.deallocate(rest[i]);
+    }
+    allocator.deallocate(ptr);
+    stats = allocator.getStats();
+    EXPECT_EQ(stats.freeBlocks[6], 0u);
+    EXPECT_EQ(stats.freeBlocks[12], 1u);
+    EXPECT_DOUBLE_EQ(stats.externalFragmentation(), 0.0);
+}
+
+TEST(CustomAllocatorTest, StatsAgreeWithFreeBytesThroughARandomWorkload) {
+    AllocatorOptions lockFree;
+    lockFree.lockFree = true;
+    AllocatorOptions headerless;
+    headerless.headerless = true;
+
+    for (const AllocatorOptions& options : {AllocatorOptions(), lockFree, headerless}) {
+        CustomAllocator allocator(6, 16, options);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<size_t> sizeDist(16, 4000);
+        std::vector<void*> live;
+
+        for (int i = 0; i < 2000; ++i) {
+            if (live.empty() || rng() % 3 != 0) {
+                if (void* ptr = allocator.allocate(sizeDist(rng))) {
+                    live.push_back(ptr);
+                }
+            } else if (rng() % 4 == 0) {
+                allocator.deallocateBatch(live.data(), live.size() / 2);
+                live.erase(live.begin(), live.begin() + live.size() / 2);
+            } else {
+                size_t index = rng() % live.size();
+                allocator.deallocate(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            AllocatorStats stats = allocator.getStats();
+            size_t counted = 0;
+            size_t largest = 0;
+            for (size_t order = 0; order < AllocatorStats::MAX_ORDERS; ++order) {
+                counted += stats.freeBlocks[order] << order;
+                largest = stats.freeBlocks[order] ? order : largest;
+            }
+            ASSERT_EQ(counted, stats.freeBytes) << "after operation " << i;
+            ASSERT_EQ(stats.freeBytes, static_cast<size_t>(allocator.getFragmentation() * (1 << 16)));
+            if (stats.freeBytes) {
+                ASSERT_EQ(stats.largestFreeOrder, largest) << "after operation " << i;
+            }
+        }
+
+        for (void* ptr : live) {
+            allocator.deallocate(ptr);
+        }
+    }
+}
+
+TEST(CustomAllocatorTest, SizedDeallocationReturnsBlocksOnEveryPath) {
+    AllocatorOptions threadCache;
+    threadCache.threadCache = true;
+    AllocatorOptions lockFree;
+    lockFree.lockFree = true;
+    AllocatorOptions headerless;
+    headerless.headerless = true;
+
+    for (const AllocatorOptions& options : {AllocatorOptions(), threadCache, lockFree, headerless}) {
+        CustomAllocator allocator(6, 20, options);
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<size_t> sizeDist(0, 5000);
+        std::vector<std::pair<void*, size_t>> live;
+
+        for (int i = 0; i < 2000; ++i) {
+            if (live.empty() || rng() % 3 != 0) {
+                size_t size = sizeDist(rng);
+                if (void* ptr = allocator.allocate(size)) {
+                    live.emplace_back(ptr, size);
+                }
+            } else {
+                size_t index = rng() % live.size();
+                allocator.deallocate(live[index].first, live[index].second);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+        for (const auto& block : live) {
+            allocator.deallocate(block.first, block.second);
+        }
+        allocator.deallocate(nullptr, 64);
+
+        allocator.flushThreadCache();
+        EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+        EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+        if (!options.lockFree) {  // Parked blocks stay split until reused
+            EXPECT_DOUBLE_EQ(allocator.getExternalFragmentation(), 0.0);
+        }
+    }
+}
+
+TEST(CustomAllocatorTest, PoolBaseIsPageAlignedOrPoolSizeAligned) {
+    CustomAllocator large(6, 20);
+    EXPECT_GE(large.getPoolAlignment(), 4096u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large.getPoolBase()) % 4096, 0u);
+
+    CustomAllocator small(6, 10);
+    EXPECT_EQ(small.getPoolAlignment(), 1024u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(small.getPoolBase()) % 1024, 0u);
+}
+
+TEST(CustomAllocatorTest, HeaderlessAlignedAllocationUsesOneNaturallyAlignedBlock) {
+    AllocatorOptions options;
+    options.headerless = true;
+    CustomAllocator allocator(4, 16, options);
+
+    // A cache line aligned to a cache line costs exactly one order-6 block
+    std::vector<void*> lines;
+    for (int i = 0; i < 16; ++i) {
+        void* line = allocator.allocate(64, 64);
+        ASSERT_NE(line, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(line) % 64, 0u);
+        lines.push_back(line);
+    }
+    EXPECT_EQ(allocator.getStats().freeBytes, (1u << 16) - 16 * 64);
+
+    // Small objects with large alignment round the order up to the alignment
+    void* page = allocator.allocate(100, 4096);
+    ASSERT_NE(page, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(page) % 4096, 0u);
+    EXPECT_EQ(allocator.getStats().freeBytes, (1u << 16) - 16 * 64 - 4096);
+
+    allocator.deallocate(page, 100, 4096);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i % 2 == 0) {
+            allocator.deallocate(lines[i], 64, 64);
+        } else {
+            allocator.deallocate(lines[i]);  // The unsized call finds the same block
+        }
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, ReallocateGrowsAndShrinksInPlace) {
+    CustomAllocator allocator(6, 20);
+    char* ptr = static_cast<char*>(allocator.allocate(100));
+    ASSERT_NE(ptr, nullptr);
+    for (int i = 0; i < 100; ++i) {
+        ptr[i] = static_cast<char>(i);
+    }
+    size_t index = allocator.getAllocationIndex(ptr);
+
+    // The first block of a fresh pool has only free upper buddies
+    EXPECT_EQ(allocator.reallocate(ptr, 1000), ptr);
+    EXPECT_EQ(allocator.getStats().freeBytes, (1u << 20) - 2048);
+    EXPECT_EQ(allocator.reallocate(ptr, 1u << 19), ptr);
+    EXPECT_EQ(allocator.getStats().freeBytes, 0u);
+    EXPECT_EQ(allocator.reallocate(ptr, 10), ptr);
+    EXPECT_EQ(allocator.getStats().freeBytes, (1u << 20) - 64);
+    EXPECT_EQ(allocator.getInPlaceReallocations(), 3u);
+    EXPECT_EQ(allocator.getAllocationIndex(ptr), index);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(ptr[i], static_cast<char>(i));
+    }
+
+    // Same order: nothing to do
+    EXPECT_EQ(allocator.reallocate(ptr, 11), ptr);
+    EXPECT_EQ(allocator.getInPlaceReallocations(), 3u);
+
+    allocator.deallocate(ptr, 11);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_DOUBLE_EQ(allocator.getExternalFragmentation(), 0.0);
+}
+
+TEST(CustomAllocatorTest, ReallocateCopiesWhenABuddyIsTaken) {
+    CustomAllocator allocator(6, 20);
+    char* lower = static_cast<char*>(allocator.allocate(100));
+    char* upper = static_cast<char*>(allocator.allocate(100));
+    ASSERT_NE(lower, nullptr);
+    ASSERT_NE(upper, nullptr);
+    std::memset(lower, 'L', 100);
+    std::memset(upper, 'U', 100);
+
+    // The lower block's buddy is in use, and the upper block is nobody's lower half
+    char* movedLower = static_cast<char*>(allocator.reallocate(lower, 1000));
+    ASSERT_NE(movedLower, nullptr);
+    EXPECT_NE(movedLower, lower);
+    char* movedUpper = static_cast<char*>(allocator.reallocate(upper, 300));
+    ASSERT_NE(movedUpper, nullptr);
+    EXPECT_NE(movedUpper, upper);
+    EXPECT_EQ(allocator.getInPlaceReallocations(), 0u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(movedLower[i], 'L');
+        EXPECT_EQ(movedUpper[i], 'U');
+    }
+
+    // Failure leaves the allocation intact; a null pointer allocates
+    EXPECT_EQ(allocator.reallocate(movedLower, 1u << 20), nullptr);
+    EXPECT_EQ(allocator.reallocate(movedLower, std::numeric_limits<size_t>::max()), nullptr);
+    int foreign = 0;
+    EXPECT_EQ(allocator.reallocate(&foreign, 16), nullptr);
+    EXPECT_EQ(movedLower[0], 'L');
+    void* fresh = allocator.reallocate(nullptr, 32);
+    ASSERT_NE(fresh, nullptr);
+
+    allocator.deallocate(fresh);
+    allocator.deallocate(movedLower, 1000);
+    allocator.deallocate(movedUpper);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, ReallocateKeepsContentsOnEveryPath) {
+    AllocatorOptions threadCache;
+    threadCache.threadCache = true;
+    AllocatorOptions lockFree;
+    lockFree.lockFree = true;
+    AllocatorOptions headerless;
+    headerless.headerless = true;
+
+    for (const AllocatorOptions& options : {AllocatorOptions(), threadCache, lockFree, headerless}) {
+        CustomAllocator allocator(6, 20, options);
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<size_t> sizeDist(1, 8000);
+        struct Entry {
+            unsigned char* ptr;
+            size_t size;
+            unsigned char tag;
+        };
+        std::vector<Entry> live;
+
+        for (int i = 0; i < 3000; ++i) {
+            if (live.size() < 40) {
+                size_t size = sizeDist(rng);
+                auto* ptr = static_cast<unsigned char*>(allocator.allocate(size));
+                if (ptr) {
+                    unsigned char tag = static_cast<unsigned char>(i);
+                    std::memset(ptr, tag, size);
+                    live.push_back({ptr, size, tag});
+                }
+                continue;
+            }
+            Entry& entry = live[rng() % live.size()];
+            size_t newSize = sizeDist(rng);
+            auto* ptr = static_cast<unsigned char*>(allocator.reallocate(entry.ptr, newSize));
+            if (!ptr) {
+                continue;
+            }
+            for (size_t byte = 0; byte < std::min(entry.size, newSize); ++byte) {
+                ASSERT_EQ(ptr[byte], entry.tag);
+            }
+            std::memset(ptr, entry.tag, newSize);
+            entry.ptr = ptr;
+            entry.size = newSize;
+            if (rng() % 4 == 0) {
+                allocator.deallocate(entry.ptr, entry.size);
+                entry = live.back();
+                live.pop_back();
+            }
+        }
+        for (const Entry& entry : live) {
+            allocator.deallocate(entry.ptr, entry.size);
+        }
+
+        allocator.flushThreadCache();
+        EXPECT_GT(allocator.getInPlaceReallocations(), 0u);
+        EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+        EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    }
+}
+
+TEST(CustomAllocatorTest, DeferredCoalescingSkipsMergesForChurnOfOneSize) {
+    AllocatorOptions options;
+    options.deferredCoalescing = true;
+    options.coalesceThreshold = 1.0;
+    CustomAllocator deferred(6, 20, options);
+    CustomAllocator eager(6, 20);
+
+    // 64 bytes and a header take an order-7 block, 13 merges below the pool
+    for (int i = 0; i < 100; ++i) {
+        for (CustomAllocator* allocator : {&deferred, &eager}) {
+            void* ptr = allocator->allocate(64);
+            ASSERT_NE(ptr, nullptr);
+            allocator->deallocate(ptr);
+        }
+    }
+
+    // The freed block waits beside its buddy and is handed straight back
+    CoalescingStats stats = deferred.getCoalescingStats();
+    EXPECT_EQ(stats.merges, 0u);
+    EXPECT_EQ(stats.deferredFrees, 100u);
+    EXPECT_EQ(stats.bulkCoalesces, 0u);
+    EXPECT_EQ(eager.getCoalescingStats().merges, 100u * 13);
+    EXPECT_EQ(eager.getCoalescingStats().deferredFrees, 0u);
+    EXPECT_DOUBLE_EQ(deferred.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, DeferredCoalescingMergesInBulkForALargerOrder) {
+    AllocatorOptions options;
+    options.deferredCoalescing = true;
+    options.coalesceThreshold = 1.0;
+    CustomAllocator allocator(6, 20, options);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+        ptrs.push_back(allocator.allocate(64));
+        ASSERT_NE(ptrs.back(), nullptr);
+    }
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_EQ(allocator.getCoalescingStats().deferredFrees, 8u);
+    EXPECT_GT(allocator.getExternalFragmentation(), 0.0);
+
+    // Only the whole pool satisfies this, so the unmerged blocks are paired up first
+    void* whole = allocator.allocate(allocator.getMaxAllocationSize());
+    ASSERT_NE(whole, nullptr);
+    CoalescingStats stats = allocator.getCoalescingStats();
+    EXPECT_EQ(stats.bulkCoalesces, 1u);
+    EXPECT_EQ(stats.bulkMerges, 4u + 2 + 1 + 10);
+    EXPECT_EQ(stats.merges, stats.bulkMerges);
+
+    // The pass cleared the hot orders, so this free merges eagerly
+    allocator.deallocate(whole);
+    EXPECT_EQ(allocator.getStats().freeBlocks[20], 1u);
+    EXPECT_EQ(allocator.getCoalescingStats().deferredFrees, 8u);
+}
+
+TEST(CustomAllocatorTest, DeferredCoalescingHonoursThresholdAndWatermark) {
+    // A threshold of zero merges back after every deferred free
+    AllocatorOptions eagerThreshold;
+    eagerThreshold.deferredCoalescing = true;
+    eagerThreshold.coalesceThreshold = 0.0;
+    CustomAllocator allocator(6, 20, eagerThreshold);
+    for (int i = 0; i < 10; ++i) {
+        void* ptr = allocator.allocate(64);
+        ASSERT_NE(ptr, nullptr);
+        allocator.deallocate(ptr);
+        EXPECT_EQ(allocator.getStats().freeBlocks[20], 1u);
+    }
+    EXPECT_EQ(allocator.getCoalescingStats().deferredFrees, 10u);
+    EXPECT_EQ(allocator.getCoalescingStats().bulkCoalesces, 10u);
+
+    // Past the watermark, frees of the order merge eagerly again
+    AllocatorOptions watermark;
+    watermark.deferredCoalescing = true;
+    watermark.deferredWatermark = 2;
+    watermark.coalesceThreshold = 1.0;
+    CustomAllocator bounded(6, 20, watermark);
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+        ptrs.push_back(bounded.allocate(64));
+        ASSERT_NE(ptrs.back(), nullptr);
+    }
+    for (void* ptr : ptrs) {
+        bounded.deallocate(ptr);
+    }
+    CoalescingStats stats = bounded.getCoalescingStats();
+    EXPECT_EQ(stats.deferredFrees, 2u);
+    EXPECT_EQ(stats.merges, 1u);  // The last two blocks pair up; the first two wait
+}
+
+TEST(CustomAllocatorTest, DeferredCoalescingRecoversThePoolOnEveryPath) {
+    std::vector<AllocatorOptions> variants(4);
+    variants[1].threadCache = true;
+    variants[2].lockFree = true;
+    variants[3].headerless = true;
+
+    for (AllocatorOptions& options : variants) {
+        options.deferredCoalescing = true;
+        options.deferredWatermark = 16;
+        options.coalesceThreshold = 0.5;
+        CustomAllocator allocator(6, 20, options);
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<size_t> sizeDist(1, 4000);
+        std::vector<std::pair<void*, size_t>> live;
+
+        for (int i = 0; i < 5000; ++i) {
+            if (live.empty() || rng() % 2 == 0) {
+                size_t size = sizeDist(rng);
+                void* ptr = allocator.allocate(size);
+                if (ptr) {
+                    std::memset(ptr, 0xAB, size);
+                    live.emplace_back(ptr, size);
+                }
+            } else {
+                size_t index = rng() % live.size();
+                allocator.deallocate(live[index].first, live[index].second);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+        void* batch[8];
+        size_t produced = allocator.allocateBatch(200, 8, batch);
+        allocator.deallocateBatch(batch, produced);
+        for (const auto& entry : live) {
+            allocator.deallocate(entry.first, entry.second);
+        }
+        allocator.flushThreadCache();
+
+        EXPECT_GT(allocator.getCoalescingStats().deferredFrees, 0u);
+        EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+        void* whole = allocator.allocate(allocator.getMaxAllocationSize());
+        EXPECT_NE(whole, nullptr);
+        allocator.deallocate(whole);
+        EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    }
+}
+
+TEST(CustomAllocatorTest, HeapSnapshotRunsTileThePool) {
+    AllocatorOptions headerless;
+    headerless.headerless = true;
+    CustomAllocator allocator(6, 12, headerless);
+
+    HeapSnapshot snapshot;
+    allocator.snapshotHeap(snapshot);
+    ASSERT_EQ(snapshot.runs.size(), 1u);
+    EXPECT_EQ(snapshot.runs[0].order, 12);
+    EXPECT_TRUE(snapshot.runs[0].free);
+
+    // Four order-6 blocks fill the first 256 bytes; the order-8 to order-11 buddies follow them
+    std::vector<void*> ptrs = {allocator.allocate(64), allocator.allocate(64), allocator.allocate(64)};
+    allocator.deallocate(ptrs[1]);
+    allocator.snapshotHeap(snapshot);
+    ASSERT_EQ(snapshot.minOrder, 6u);
+    ASSERT_EQ(snapshot.maxOrder, 12u);
+    ASSERT_EQ(snapshot.runs.size(), 8u);
+    EXPECT_EQ(snapshot.runs[0].order, 6);
+    EXPECT_FALSE(snapshot.runs[0].free);
+    EXPECT_EQ(snapshot.runs[1].order, 6);
+    EXPECT_TRUE(snapshot.runs[1].free);
+    EXPECT_EQ(snapshot.runs[2].order, 6);
+    EXPECT_FALSE(snapshot.runs[2].free);
+    EXPECT_EQ(snapshot.runs[3].order, 6);
+    EXPECT_TRUE(snapshot.runs[3].free);
+    for (size_t i = 4; i < snapshot.runs.size(); ++i) {
+        EXPECT_EQ(snapshot.runs[i].order, i + 4);
+        EXPECT_TRUE(snapshot.runs[i].free);
+    }
+    allocator.deallocate(ptrs[0]);
+    allocator.deallocate(ptrs[2]);
+
+    // Every mode's snapshot covers the pool exactly, and its free blocks are those getStats counts
+    AllocatorOptions lockFree;
+    lockFree.lockFree = true;
+    AllocatorOptions threadCache;
+    threadCache.threadCache = true;
+    for (const AllocatorOptions& options : {AllocatorOptions(), headerless, lockFree, threadCache}) {
+        CustomAllocator pool(6, 16, options);
+        std::vector<void*> live;
+        for (size_t i = 0; i < 200; ++i) {
+            live.push_back(pool.allocate(32 + (i * 37) % 900));
+        }
+        for (size_t i = 0; i < live.size(); i += 3) {
+            pool.deallocate(live[i]);
+        }
+        pool.snapshotHeap(snapshot);
+
+        size_t covered = 0;
+        std::array<size_t, AllocatorStats::MAX_ORDERS> freeBlocks{};
+        for (const HeapRun& run : snapshot.runs) {
+            covered += static_cast<size_t>(run.blocks) << run.order;
+            if (run.free) {
+                freeBlocks[run.order] += run.blocks;
+            }
+        }
+        EXPECT_EQ(covered, pool.getPoolSize());
+        if (!options.lockFree) {  // Parked blocks show as allocated in a snapshot
+            EXPECT_EQ(freeBlocks, pool.getStats().freeBlocks);
+        }
+        for (size_t i = 1; i < live.size(); ++i) {
+            if (i % 3 != 0) {
+                pool.deallocate(live[i]);
+            }
+        }
+    }
+}
+
 // ============================================================================
 // Split Invariants Tests
 // ============================================================================
@@ -272,6 +836,210 @@ TEST(CustomAllocatorTest, MultipleCoalesce) {
     EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
 }
 
+TEST(CustomAllocatorTest, CoalesceOutOfOrderFrees) {
+    CustomAllocator allocator(6, 14);
+    std::vector<void*> ptrs;
+
+    // Fill the pool with minimum-order blocks
+    void* ptr;
+    while ((ptr = allocator.allocate(1)) != nullptr) {
+        ptrs.push_back(ptr);
+    }
+    ASSERT_GT(ptrs.size(), 1u);
+
+    // Free in an interleaved order so merges happen deep inside long free lists
+    for (size_t i = 0; i < ptrs.size(); i += 2) {
+        allocator.deallocate(ptrs[i]);
+    }
+    for (size_t i = 1; i < ptrs.size(); i += 2) {
+        allocator.deallocate(ptrs[i]);
+    }
+
+    // Everything must have coalesced back into a single max-order block
+    void* whole = allocator.allocate((1 << 14) - 128);
+    EXPECT_NE(whole, nullptr);
+    allocator.deallocate(whole);
+}
+
+// ============================================================================
+// Headerless Layout Tests
+// ============================================================================
+
+TEST(CustomAllocatorTest, HeaderlessPacksSmallObjects) {
+    AllocatorOptions options;
+    options.headerless = true;
+    CustomAllocator allocator(4, 16, options);
+    const char* base = static_cast<const char*>(allocator.getPoolBase());
+
+    // Without a header each 16-byte request takes exactly one 16-byte block, in address order
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < 64; ++i) {
+        void* ptr = allocator.allocate(16);
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(static_cast<char*>(ptr) - base, static_cast<std::ptrdiff_t>(i * 16));
+        ptrs.push_back(ptr);
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0 - (64.0 * 16) / (1 << 16));
+
+    std::set<std::string> ids;
+    for (void* ptr : ptrs) {
+        ids.insert(allocator.getAllocationID(ptr));
+    }
+    EXPECT_EQ(ids.size(), ptrs.size());
+
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+
+    // The whole pool is one block again, and the user gets all of it
+    void* whole = allocator.allocate(1 << 16);
+    EXPECT_EQ(whole, allocator.getPoolBase());
+    EXPECT_EQ(allocator.getAllocationID(whole), "Alloc64");
+    allocator.deallocate(whole);
+}
+
+TEST(CustomAllocatorTest, HeaderlessRejectsUnsupportedOptions) {
+    AllocatorOptions options;
+    options.headerless = true;
+    EXPECT_THROW(CustomAllocator(3, 16, options), std::invalid_argument);
+
+    options.lockFree = true;
+    EXPECT_THROW(CustomAllocator(6, 16, options), std::invalid_argument);
+}
+
+TEST(CustomAllocatorTest, HeaderlessWithThreadCacheAndBatches) {
+    AllocatorOptions options;
+    options.headerless = true;
+    options.threadCache = true;
+    options.magazineSize = 8;
+    CustomAllocator allocator(4, 20, options);
+    const int num_threads = 4;
+
+    auto worker = [&allocator](int seed) {
+        std::vector<void*> local_ptrs(64);
+        ASSERT_EQ(allocator.allocateBatch(24, local_ptrs.size(), local_ptrs.data()), local_ptrs.size());
+        for (int i = 0; i < 200; ++i) {
+            void* ptr = allocator.allocate(8 + ((i + seed) % 6) * 8);
+            if (ptr != nullptr) {
+                local_ptrs.push_back(ptr);
+            }
+            if (i % 3 == 0) {
+                allocator.deallocate(local_ptrs.back());
+                local_ptrs.pop_back();
+            }
+        }
+        allocator.deallocateBatch(local_ptrs.data(), local_ptrs.size());
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+}
+
+// ============================================================================
+// Batch API Tests
+// ============================================================================
+
+TEST(CustomAllocatorTest, AllocateBatchMatchesSequentialLayout) {
+    CustomAllocator sequential(6, 20);
+    CustomAllocator batched(6, 20);
+    constexpr size_t count = 100;
+
+    std::vector<void*> expected;
+    for (size_t i = 0; i < count; ++i) {
+        expected.push_back(sequential.allocate(64));
+    }
+    std::vector<void*> ptrs(count);
+    ASSERT_EQ(batched.allocateBatch(64, count, ptrs.data()), count);
+
+    // Same offsets and the same remaining free structure as one-at-a-time splitting
+    const char* seqBase = static_cast<const char*>(sequential.getPoolBase());
+    const char* batchBase = static_cast<const char*>(batched.getPoolBase());
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(static_cast<char*>(ptrs[i]) - batchBase, static_cast<char*>(expected[i]) - seqBase);
+    }
+    EXPECT_DOUBLE_EQ(batched.getFragmentation(), sequential.getFragmentation());
+    EXPECT_EQ(static_cast<char*>(batched.allocate(1000)) - batchBase,
+              static_cast<char*>(sequential.allocate(1000)) - seqBase);
+
+    std::set<std::string> ids;
+    for (void* ptr : ptrs) {
+        ids.insert(batched.getAllocationID(ptr));
+    }
+    EXPECT_EQ(ids.size(), count);
+    EXPECT_EQ(batched.getTotalAllocations(), count + 1);
+}
+
+TEST(CustomAllocatorTest, DeallocateBatchCoalescesShuffledFrees) {
+    CustomAllocator allocator(6, 14);
+    constexpr size_t count = 200;
+    std::vector<void*> ptrs(count);
+    ASSERT_EQ(allocator.allocateBatch(16, count, ptrs.data()), count);
+
+    std::reverse(ptrs.begin(), ptrs.end());
+    std::swap(ptrs[3], ptrs[150]);
+    allocator.deallocateBatch(ptrs.data(), count);
+
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalDeallocations(), count);
+    void* whole = allocator.allocate((1 << 14) - 64);
+    EXPECT_NE(whole, nullptr);
+    allocator.deallocate(whole);
+}
+
+TEST(CustomAllocatorTest, DeallocateBatchKeepsConcurrentSnapshotsTiled) {
+    CustomAllocator allocator(6, 14);
+    std::atomic<bool> done(false);
+
+    // The batch merge rewrites block orders, which the snapshot walk steps over
+    std::thread freer([&]() {
+        std::vector<void*> ptrs(64);
+        for (int round = 0; round < 500; ++round) {
+            size_t produced = allocator.allocateBatch(16, ptrs.size(), ptrs.data());
+            allocator.deallocateBatch(ptrs.data(), produced);
+        }
+        done = true;
+    });
+
+    HeapSnapshot snapshot;
+    while (!done) {
+        allocator.snapshotHeap(snapshot);
+        uint64_t bytes = 0;
+        for (const HeapRun& run : snapshot.runs) {
+            bytes += run.blocks << run.order;
+        }
+        EXPECT_EQ(bytes, 1u << 14);
+    }
+    freer.join();
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, AllocateBatchStopsWhenPoolExhausted) {
+    CustomAllocator allocator(6, 10);
+    std::vector<void*> ptrs(20);
+
+    // 1 KiB pool holds sixteen 64-byte blocks
+    size_t produced = allocator.allocateBatch(16, ptrs.size(), ptrs.data());
+    EXPECT_EQ(produced, 16u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 0.0);
+
+    // Null and foreign pointers are skipped
+    int local = 0;
+    ptrs[produced] = nullptr;
+    ptrs[produced + 1] = &local;
+    allocator.deallocateBatch(ptrs.data(), produced + 2);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalDeallocations(), produced);
+}
+
 // ============================================================================
 // Metadata Integrity Tests
 // ============================================================================
@@ -311,6 +1079,77 @@ TEST(CustomAllocatorTest, MemoryAddressConsistency) {
     allocator.deallocate(ptr);
 }
 
+TEST(CustomAllocatorTest, MemoryAddressMatchesStreamFormatting) {
+    CustomAllocator allocator(6, 20);
+    void* ptr = allocator.allocate(256);
+    for (const void* address : {static_cast<const void*>(ptr), static_cast<const void*>(nullptr)}) {
+        std::ostringstream expected;
+        expected << address;
+        EXPECT_EQ(allocator.getMemoryAddress(address), expected.str());
+    }
+    allocator.deallocate(ptr);
+}
+
+TEST(CustomAllocatorTest, HeaderTakesAQuarterOfASmallBlock) {
+    CustomAllocator allocator(6, 20);
+
+    // The 32-byte header leaves 96 bytes of a 128-byte block and 32 of a 64-byte one
+    void* fits = allocator.allocate(96);
+    void* tight = allocator.allocate(32);
+    void* over = allocator.allocate(97);
+    EXPECT_EQ(allocator.getBlockOrder(fits), 7u);
+    EXPECT_EQ(allocator.getBlockOrder(tight), 6u);
+    EXPECT_EQ(allocator.getBlockOrder(over), 8u);
+    allocator.deallocate(fits);
+    allocator.deallocate(tight);
+    allocator.deallocate(over);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, BlockMetadataAccessorsReadTheBlock) {
+    for (bool headerless : {false, true}) {
+        AllocatorOptions options;
+        options.headerless = headerless;
+        CustomAllocator allocator(6, 20, options);
+
+        void* small = allocator.allocate(10);
+        void* large = allocator.allocate(5000);
+        void* aligned = allocator.allocate(100, 4096);
+        ASSERT_NE(small, nullptr);
+        ASSERT_NE(large, nullptr);
+        ASSERT_NE(aligned, nullptr);
+        EXPECT_EQ(allocator.getBlockOrder(small), 6u);
+        EXPECT_EQ(allocator.getBlockOrder(large), 13u);
+        EXPECT_EQ(allocator.getBlockOrder(aligned), headerless ? 12u : 13u);
+        EXPECT_EQ(allocator.getAllocationIndex(small), 0u);
+        EXPECT_EQ(allocator.getAllocationIndex(large), 1u);
+        EXPECT_EQ(allocator.getAllocationIndex(aligned), 2u);
+        EXPECT_EQ(allocator.getAllocationID(aligned), "Alloc2");
+
+        int foreign = 0;
+        EXPECT_EQ(allocator.getBlockOrder(&foreign), 0u);
+        EXPECT_EQ(allocator.getBlockOrder(nullptr), 0u);
+        EXPECT_EQ(allocator.getAllocationIndex(&foreign), CustomAllocator::INVALID_ALLOCATION_ID);
+        EXPECT_EQ(allocator.getAllocationID(&foreign), "");
+        EXPECT_EQ(allocator.getAllocationID(nullptr), "");
+
+#if ALLOCATOR_TIMING
+        // None of the accessors take the allocator lock
+        uint64_t acquisitions = allocator.getLockContention().acquisitions;
+        for (int i = 0; i < 100; ++i) {
+            allocator.getAllocationIndex(small);
+            allocator.getBlockOrder(large);
+            allocator.getAllocationID(aligned);
+        }
+        EXPECT_EQ(allocator.getLockContention().acquisitions, acquisitions);
+#endif
+
+        allocator.deallocate(small);
+        allocator.deallocate(large);
+        allocator.deallocate(aligned);
+    }
+}
+
 // ============================================================================
 // Throughput Metrics Tests
 // ============================================================================
@@ -412,35 +1251,1767 @@ TEST(CustomAllocatorTest, ConcurrentMixedOperations) {
 }
 
 // ============================================================================
-// Timing Metrics Tests
+// Thread Cache Tests
 // ============================================================================
 
-TEST(CustomAllocatorTest, AllocationTimingRecorded) {
-    CustomAllocator allocator(6, 20);
+TEST(CustomAllocatorTest, ThreadCacheHitsAndMisses) {
+    AllocatorOptions options;
+    options.threadCache = true;
+    options.magazineSize = 8;
+    CustomAllocator allocator(6, 20, options);
 
-    EXPECT_DOUBLE_EQ(allocator.getAllocationTime(), 0.0);
+    // First allocation refills the magazine (miss), the rest of the batch are hits
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+        void* ptr = allocator.allocate(64);
+        ASSERT_NE(ptr, nullptr);
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(allocator.getThreadCacheMisses(), 1u);
+    EXPECT_EQ(allocator.getThreadCacheHits(), 7u);
+    EXPECT_EQ(allocator.getTotalAllocations(), 8u);
+    EXPECT_EQ(allocator.getTotals().live(), 8u);
 
-    void* ptr = allocator.allocate(256);
-    EXPECT_NE(ptr, nullptr);
+    std::set<void*> uniquePtrs(ptrs.begin(), ptrs.end());
+    EXPECT_EQ(uniquePtrs.size(), ptrs.size());
 
-    // Timing should be recorded (non-negative)
-    EXPECT_GE(allocator.getAllocationTime(), 0.0);
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    OperationTotals totals = allocator.getTotals();
+    EXPECT_EQ(totals.allocations, 8u);
+    EXPECT_EQ(totals.deallocations, 8u);
 
-    allocator.deallocate(ptr);
+    // Freed blocks stay cached until flushed
+    EXPECT_LT(allocator.getFragmentation(), 1.0);
+    allocator.flushThreadCache();
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
 }
 
-TEST(CustomAllocatorTest, DeallocationTimingRecorded) {
-    CustomAllocator allocator(6, 20);
-
-    void* ptr = allocator.allocate(256);
-    EXPECT_NE(ptr, nullptr);
+TEST(CustomAllocatorTest, ThreadCacheLargeOrdersBypassCache) {
+    AllocatorOptions options;
+    options.threadCache = true;
+    CustomAllocator allocator(6, 20, options);
 
-    EXPECT_DOUBLE_EQ(allocator.getDeallocationTime(), 0.0);
+    void* ptr = allocator.allocate(1 << 18);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(allocator.getThreadCacheHits() + allocator.getThreadCacheMisses(), 0u);
+    EXPECT_EQ(allocator.getTotalAllocations(), 1u);
 
     allocator.deallocate(ptr);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
 
-    // Deallocation timing should be recorded
-    EXPECT_GE(allocator.getDeallocationTime(), 0.0);
+TEST(CustomAllocatorTest, ThreadCacheConcurrentAllocations) {
+    AllocatorOptions options;
+    options.threadCache = true;
+    options.magazineSize = 4;
+    CustomAllocator allocator(6, 20, options);
+    const int num_threads = 4;
+    constexpr int allocs_per_thread = 200;
+
+    auto worker = [&allocator]() {
+        std::vector<void*> local_ptrs;
+        for (int i = 0; i < allocs_per_thread; ++i) {
+            void* ptr = allocator.allocate(64 + (i % 10) * 8);
+            if (ptr != nullptr) {
+                local_ptrs.push_back(ptr);
+            }
+        }
+        for (void* ptr : local_ptrs) {
+            allocator.deallocate(ptr);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Exiting threads flush their magazines back to the pool
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    EXPECT_EQ(allocator.getTotalAllocations(), static_cast<size_t>(num_threads * allocs_per_thread));
+    EXPECT_GT(allocator.getThreadCacheHits(), allocator.getThreadCacheMisses());
+}
+
+// ============================================================================
+// Lock-Free Stack Tests
+// ============================================================================
+
+TEST(CustomAllocatorTest, LockFreeReusesParkedBlocks) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    CustomAllocator allocator(6, 20, options);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+        ptrs.push_back(allocator.allocate(64));
+        ASSERT_NE(ptrs.back(), nullptr);
+    }
+    EXPECT_EQ(allocator.getLockFreeHits(), 0u);  // Stacks start empty: served by splitting
+
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    // Parked blocks count as free
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+
+    std::set<void*> parked(ptrs.begin(), ptrs.end());
+    for (void*& ptr : ptrs) {
+        ptr = allocator.allocate(64);
+        EXPECT_TRUE(parked.count(ptr));
+    }
+    EXPECT_EQ(allocator.getLockFreeHits(), 8u);
+
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_EQ(allocator.getTotalAllocations(), 16u);
+    EXPECT_EQ(allocator.getTotalDeallocations(), 16u);
+}
+
+TEST(CustomAllocatorTest, LockFreeCountsSurviveExitedThreads) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    CustomAllocator allocator(6, 20, options);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+        ptrs.push_back(allocator.allocate(64));
+    }
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+
+    // Another thread reuses the parked blocks; its per-thread counts outlive it
+    std::thread worker([&allocator, &ptrs] {
+        for (void*& ptr : ptrs) {
+            ptr = allocator.allocate(64);
+        }
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+    });
+    worker.join();
+
+    EXPECT_EQ(allocator.getLockFreeHits(), 8u);
+    EXPECT_EQ(allocator.getTotalAllocations(), 16u);
+    EXPECT_EQ(allocator.getTotalDeallocations(), 16u);
+}
+
+TEST(CustomAllocatorTest, LockFreeParkedBlocksDrainForLargeAllocation) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    CustomAllocator allocator(6, 12, options);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+        ptrs.push_back(allocator.allocate(16));
+    }
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+
+    // The whole pool is only available once the parked blocks have coalesced again
+    void* whole = allocator.allocate(4096 - 64);
+    ASSERT_NE(whole, nullptr);
+    allocator.deallocate(whole);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(CustomAllocatorTest, LockFreeExclusiveWithThreadCache) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    options.threadCache = true;
+    EXPECT_THROW(CustomAllocator(6, 20, options), std::invalid_argument);
+}
+
+TEST(CustomAllocatorTest, LockFreeConcurrentMixedOperations) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    options.lockFreeDepth = 16;
+    CustomAllocator allocator(6, 20, options);
+    const int num_threads = 4;
+    constexpr int ops_per_thread = 400;
+
+    auto worker = [&allocator](int seed) {
+        std::vector<void*> local_ptrs;
+        for (int i = 0; i < ops_per_thread; ++i) {
+            if (local_ptrs.size() < 20 && (i + seed) % 3 != 0) {
+                void* ptr = allocator.allocate(32 + ((i + seed) % 8) * 32);
+                if (ptr != nullptr) {
+                    local_ptrs.push_back(ptr);
+                }
+            } else if (!local_ptrs.empty()) {
+                allocator.deallocate(local_ptrs.back());
+                local_ptrs.pop_back();
+            }
+        }
+        for (void* ptr : local_ptrs) {
+            allocator.deallocate(ptr);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    EXPECT_GT(allocator.getLockFreeHits(), 0u);
+}
+
+// ============================================================================
+// Memory Pool Tests
+// ============================================================================
+
+TEST(MemoryPoolTest, DefaultPoolUsesMalloc) {
+    MemoryPool pool(1 << 16);
+    ASSERT_NE(pool.data(), nullptr);
+    EXPECT_FALSE(pool.isMapped());
+    EXPECT_EQ(pool.size(), static_cast<size_t>(1 << 16));
+    std::memset(pool.data(), 0xAB, pool.size());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(MemoryPoolTest, MappedPoolWithPrefault) {
+    PoolOptions options;
+    options.useMmap = true;
+    options.prefault = true;
+    MemoryPool pool(1 << 20, options);
+    ASSERT_NE(pool.data(), nullptr);
+    EXPECT_TRUE(pool.isMapped());
+    std::memset(pool.data(), 0xAB, pool.size());
+}
+
+TEST(MemoryPoolTest, HugePagesFallBackWhenNoneReserved) {
+    // Works whether or not the system has huge pages reserved: MAP_HUGETLB or THP advice
+    PoolOptions options;
+    options.hugePages = true;
+    MemoryPool pool(1 << 21, options);
+    ASSERT_NE(pool.data(), nullptr);
+    EXPECT_TRUE(pool.isMapped());
+    std::memset(pool.data(), 0xAB, pool.size());
+}
+#endif
+
+#if defined(__linux__)
+TEST(MemoryPoolTest, BindToNumaNodeZero) {
+    PoolOptions options;
+    options.numaNode = 0;
+    options.prefault = true;
+    try {
+        MemoryPool pool(1 << 20, options);
+        EXPECT_TRUE(pool.isMapped());
+        std::memset(pool.data(), 0xAB, pool.size());
+    } catch (const std::system_error& e) {
+        GTEST_SKIP() << "mbind unavailable: " << e.what();
+    }
+}
+#endif
+
+TEST(MemoryPoolTest, AllocatorOnMappedPool) {
+    AllocatorOptions options;
+#if defined(__unix__) || defined(__APPLE__)
+    options.pool.useMmap = true;
+#endif
+    options.pool.prefault = true;
+    CustomAllocator allocator(6, 20, options);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 100; ++i) {
+        void* ptr = allocator.allocate(200);
+        ASSERT_NE(ptr, nullptr);
+        std::memset(ptr, i, 200);
+        ptrs.push_back(ptr);
+    }
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+// ============================================================================
+// Sharded Allocator Tests
+// ============================================================================
+
+TEST(ShardedAllocatorTest, CrossThreadFreesReturnToOwningArena) {
+    ShardedAllocator allocator(6, 16, 4);
+    ASSERT_EQ(allocator.getArenaCount(), 4u);
+
+    // Each thread allocates from its own arena; the main thread frees everything
+    std::vector<std::vector<void*>> perThread(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < perThread.size(); ++t) {
+        threads.emplace_back([&allocator, &perThread, t]() {
+            for (int i = 0; i < 50; ++i) {
+                void* ptr = allocator.allocate(128);
+                if (ptr != nullptr) {
+                    perThread[t].push_back(ptr);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& ptrs : perThread) {
+        for (void* ptr : ptrs) {
+            EXPECT_NE(allocator.findOwner(ptr), nullptr);
+            allocator.deallocate(ptr);
+        }
+    }
+
+    for (size_t i = 0; i < allocator.getArenaCount(); ++i) {
+        EXPECT_DOUBLE_EQ(allocator.getArena(i).getFragmentation(), 1.0);
+    }
+    EXPECT_EQ(allocator.getTotalAllocations(), 200u);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+}
+
+TEST(ShardedAllocatorTest, FallsBackWhenHomeArenaIsFull) {
+    ShardedAllocator allocator(6, 10, 2);
+
+    // Each arena holds exactly one 1 KiB block
+    void* first = allocator.allocate(1024 - 64);
+    void* second = allocator.allocate(1024 - 64);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(allocator.findOwner(first), allocator.findOwner(second));
+    EXPECT_EQ(allocator.allocate(1024 - 64), nullptr);
+
+    allocator.deallocate(first);
+    allocator.deallocate(second);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+TEST(ShardedAllocatorTest, FindOwnerRejectsForeignPointers) {
+    ShardedAllocator allocator(6, 12, 2);
+    int local = 0;
+    EXPECT_EQ(allocator.findOwner(&local), nullptr);
+    EXPECT_EQ(allocator.findOwner(nullptr), nullptr);
+
+    // Ignored rather than corrupting an arena
+    allocator.deallocate(&local);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+// ============================================================================
+// Growable Allocator Tests
+// ============================================================================
+
+TEST(GrowableAllocatorTest, GrowsOnExhaustionAndShrinksWhenEmpty) {
+    GrowableAllocator allocator(6, 12);
+    ASSERT_EQ(allocator.getArenaCount(), 1u);
+
+    // Each 4 KiB arena holds four 1 KiB blocks
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 10; ++i) {
+        void* ptr = allocator.allocate(1024 - 64);
+        ASSERT_NE(ptr, nullptr);
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(allocator.getArenaCount(), 3u);
+    EXPECT_EQ(allocator.getMappedBytes(), 3u * 4096);
+
+    for (void* ptr : ptrs) {
+        EXPECT_NE(allocator.findOwner(ptr), nullptr);
+        allocator.deallocate(ptr);
+    }
+
+    // Only the retained empty arena stays mapped; counters survive the released arenas
+    EXPECT_EQ(allocator.getArenaCount(), 1u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), 10u);
+    EXPECT_EQ(allocator.getTotalDeallocations(), 10u);
+}
+
+TEST(GrowableAllocatorTest, RetainsEmptyArenasForHysteresis) {
+    GrowableOptions growth;
+    growth.retainEmptyArenas = 2;
+    GrowableAllocator allocator(6, 12, growth);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 12; ++i) {
+        ptrs.push_back(allocator.allocate(1024 - 64));
+    }
+    ASSERT_EQ(allocator.getArenaCount(), 3u);
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_EQ(allocator.getArenaCount(), 2u);
+
+    // Refilling within the retained arenas maps nothing new
+    for (int i = 0; i < 8; ++i) {
+        ptrs[i] = allocator.allocate(1024 - 64);
+    }
+    EXPECT_EQ(allocator.getArenaCount(), 2u);
+    for (int i = 0; i < 8; ++i) {
+        allocator.deallocate(ptrs[i]);
+    }
+}
+
+TEST(GrowableAllocatorTest, ReleasesArenasWithBlocksParkedInFastPaths) {
+    // Freed blocks stay in the magazines or lock-free stacks, so the arenas are empty but not
+    // fully free
+    for (bool threadCache : {true, false}) {
+        AllocatorOptions options;
+        options.threadCache = threadCache;
+        options.lockFree = !threadCache;
+        options.magazineSize = 4;
+        GrowableAllocator allocator(6, 16, GrowableOptions(), options);
+
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 2500; ++i) {
+            void* ptr = allocator.allocate(32);
+            ASSERT_NE(ptr, nullptr);
+            ptrs.push_back(ptr);
+        }
+        ASSERT_GE(allocator.getArenaCount(), 3u);
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+
+        EXPECT_EQ(allocator.getArenaCount(), 1u) << (threadCache ? "threadCache" : "lockFree");
+        EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    }
+}
+
+TEST(GrowableAllocatorTest, RespectsArenaLimitAndOversizeRequests) {
+    GrowableOptions growth;
+    growth.maxArenas = 2;
+    GrowableAllocator allocator(6, 12, growth);
+
+    std::vector<void*> ptrs;
+    void* ptr;
+    while ((ptr = allocator.allocate(1024 - 64)) != nullptr) {
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(ptrs.size(), 8u);
+    EXPECT_EQ(allocator.getArenaCount(), 2u);
+
+    // Larger than any arena: fails without mapping anything
+    for (void* p : ptrs) {
+        allocator.deallocate(p);
+    }
+    EXPECT_EQ(allocator.allocate(8192), nullptr);
+    EXPECT_EQ(allocator.getArenaCount(), 1u);
+
+    int local = 0;
+    EXPECT_EQ(allocator.findOwner(&local), nullptr);
+    allocator.deallocate(&local);  // Ignored
+}
+
+TEST(GrowableAllocatorTest, ConcurrentGrowthAndRelease) {
+    GrowableAllocator allocator(6, 14);
+    const int num_threads = 4;
+
+    auto worker = [&allocator](int seed) {
+        std::vector<void*> local_ptrs;
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 40; ++i) {
+                void* ptr = allocator.allocate(256 + ((i + seed) % 4) * 256);
+                if (ptr != nullptr) {
+                    local_ptrs.push_back(ptr);
+                }
+            }
+            for (void* ptr : local_ptrs) {
+                allocator.deallocate(ptr);
+            }
+            local_ptrs.clear();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(allocator.getArenaCount(), 1u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    EXPECT_EQ(allocator.getTotalAllocations(), static_cast<size_t>(num_threads * 5 * 40));
+}
+
+// ============================================================================
+// Slab Allocator Tests
+// ============================================================================
+
+TEST(SlabAllocatorTest, PacksSmallObjectsDensely) {
+    SlabAllocator allocator(6, 20, 14);
+    EXPECT_EQ(allocator.getSizeClass(72), 80u);
+    EXPECT_EQ(allocator.getSizeClass(16), 16u);
+    EXPECT_EQ(allocator.getSizeClass(allocator.getMaxSlabObjectSize() + 1), 0u);
+
+    // 1000 buddy blocks of 72 bytes would take 128 KiB; 80-byte slab objects need well under half
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 1000; ++i) {
+        void* ptr = allocator.allocate(72);
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+        std::memset(ptr, i & 0xFF, 72);
+        ptrs.push_back(ptr);
+    }
+    std::set<void*> unique(ptrs.begin(), ptrs.end());
+    EXPECT_EQ(unique.size(), ptrs.size());
+
+    size_t poolSize = allocator.getBuddyAllocator().getPoolSize();
+    double usedBytes = (1.0 - allocator.getFragmentation()) * static_cast<double>(poolSize);
+    EXPECT_LE(usedBytes, 6.0 * 16384);
+    EXPECT_GT(allocator.getSlabUtilization(), 0.9);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(static_cast<unsigned char*>(ptrs[i])[71], static_cast<unsigned char>(i & 0xFF));
+        allocator.deallocate(ptrs[i]);
+    }
+}
+
+TEST(SlabAllocatorTest, ReusesFreedSlotsAndReleasesEmptySlabs) {
+    SlabAllocator allocator(6, 16, 12);
+
+    void* a = allocator.allocate(40);
+    void* b = allocator.allocate(40);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    allocator.deallocate(a);
+    allocator.deallocate(a);  // Double free is ignored
+    EXPECT_EQ(allocator.allocate(40), a);
+    EXPECT_EQ(allocator.getSlabCount(), 1u);
+
+    allocator.deallocate(a);
+    allocator.deallocate(b);
+
+    // The emptied slab is kept as a spare until released explicitly
+    EXPECT_EQ(allocator.getSlabCount(), 1u);
+    EXPECT_LT(allocator.getFragmentation(), 1.0);
+    allocator.releaseEmptySlabs();
+    EXPECT_EQ(allocator.getSlabCount(), 0u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), 3u);
+    EXPECT_EQ(allocator.getTotalDeallocations(), 3u);
+}
+
+TEST(SlabAllocatorTest, LargeRequestsUseBuddyBlocks) {
+    SlabAllocator allocator(6, 16, 12);
+    size_t large = allocator.getMaxSlabObjectSize() + 1;
+
+    void* ptr = allocator.allocate(large);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(allocator.getSlabCount(), 0u);
+    EXPECT_EQ(allocator.getBuddyAllocator().getTotalAllocations(), 1u);
+    allocator.deallocate(ptr);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+
+    int local = 0;
+    allocator.deallocate(&local);  // Ignored
+    EXPECT_EQ(allocator.getTotalDeallocations(), 1u);
+
+    EXPECT_THROW(SlabAllocator(6, 16, 17), std::invalid_argument);
+}
+
+TEST(SlabAllocatorTest, SamplesSlabAndLargeRequestLatency) {
+    AllocatorOptions sampled;
+    sampled.timing.sampleRate = 4;
+    SlabAllocator everyOperation(6, 16, 12);
+    SlabAllocator oneInFour(6, 16, 12, sampled);
+    size_t large = everyOperation.getMaxSlabObjectSize() + 1;
+    for (int i = 0; i < 200; ++i) {
+        everyOperation.deallocate(everyOperation.allocate(48));
+        everyOperation.deallocate(everyOperation.allocate(large));
+        oneInFour.deallocate(oneInFour.allocate(48));
+    }
+
+#if ALLOCATOR_TIMING
+    LatencyStats stats = everyOperation.getLatencyStats();
+    EXPECT_EQ(stats.allocation.samples, 400u);
+    EXPECT_EQ(stats.deallocation.samples, 400u);
+    EXPECT_GT(everyOperation.getAllocationTime(), 0.0);
+    uint64_t sampledAllocations = oneInFour.getLatencyStats().allocation.samples;
+    EXPECT_GT(sampledAllocations, 0u);
+    EXPECT_LT(sampledAllocations, 200u);
+#else
+    EXPECT_EQ(everyOperation.getLatencyStats().allocation.samples, 0u);
+    EXPECT_DOUBLE_EQ(everyOperation.getAllocationTime(), 0.0);
+#endif
+}
+
+TEST(SlabAllocatorTest, ConcurrentMixedSizes) {
+    SlabAllocator allocator(6, 20, 14);
+    const int num_threads = 4;
+    const std::vector<size_t> sizes = {24, 72, 100, 200, 500, 3000};
+
+    auto worker = [&allocator, &sizes](int seed) {
+        std::vector<void*> local_ptrs;
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 200; ++i) {
+                size_t size = sizes[static_cast<size_t>(i + seed) % sizes.size()];
+                void* ptr = allocator.allocate(size);
+                if (ptr != nullptr) {
+                    std::memset(ptr, seed, size);
+                    local_ptrs.push_back(ptr);
+                }
+            }
+            for (void* ptr : local_ptrs) {
+                allocator.deallocate(ptr);
+            }
+            local_ptrs.clear();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+    allocator.releaseEmptySlabs();
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+// ============================================================================
+// Container Adapter Tests
+// ============================================================================
+
+TEST(AllocatorAdapterTest, StlAllocatorBacksStandardContainers) {
+    CustomAllocator allocator(6, 20);
+    {
+        CustomStlAllocator<int> ints(allocator);
+        std::vector<int, CustomStlAllocator<int>> values(ints);
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_TRUE(allocator.owns(values.data()));
+        EXPECT_EQ(values[999], 999);
+
+        // Node containers rebind the allocator, which still draws from the same pool
+        CustomStlAllocator<std::pair<const int, int>> nodes(ints);
+        std::map<int, int, std::less<int>, CustomStlAllocator<std::pair<const int, int>>> map(nodes);
+        for (int i = 0; i < 100; ++i) {
+            map.emplace(i, i * i);
+        }
+        EXPECT_TRUE(allocator.owns(&*map.find(50)));
+        EXPECT_TRUE(map.get_allocator() == ints);
+        EXPECT_FALSE(map.get_allocator() == CustomStlAllocator<int>(ints.getAllocator(), 64));
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+
+    CustomAllocator tiny(6, 10);
+    CustomStlAllocator<uint64_t> small(tiny);
+    EXPECT_THROW(small.allocate(4096), std::bad_alloc);
+    CustomStlAllocator<char> bytes(tiny);
+    EXPECT_THROW(bytes.allocate(std::numeric_limits<size_t>::max() - 8), std::bad_alloc);
+}
+
+TEST(AllocatorAdapterTest, AllocationsHonourRequestedAndMinimumAlignment) {
+    struct alignas(64) CacheLine {
+        char bytes[64];
+    };
+    CustomAllocator allocator(6, 20);
+    CustomStlAllocator<CacheLine> lines(allocator);
+    std::vector<CacheLine*> pointers;
+    for (int i = 0; i < 32; ++i) {
+        CacheLine* line = lines.allocate(1 + i % 3);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(line) % 64, 0u);
+        pointers.push_back(line);
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        lines.deallocate(pointers[i], 1 + i % 3);
+    }
+
+    // The configured alignment applies to every allocation, whatever the type asks for
+    CustomStlAllocator<char> pageAligned(allocator, 4096);
+    char* page = pageAligned.allocate(10);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(page) % 4096, 0u);
+    pageAligned.deallocate(page, 10);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+}
+
+#if ALLOCATOR_HAS_PMR
+TEST(AllocatorAdapterTest, MemoryResourceServesPmrContainers) {
+    CustomAllocator allocator(6, 20);
+    CustomMemoryResource resource(allocator, 32);
+    {
+        std::pmr::vector<std::pmr::string> strings(&resource);
+        for (int i = 0; i < 100; ++i) {
+            strings.emplace_back(std::string(100, static_cast<char>('a' + i % 26)));
+        }
+        EXPECT_TRUE(allocator.owns(strings.data()));
+        EXPECT_TRUE(allocator.owns(strings[42].data()));  // Elements use the container's resource
+        EXPECT_EQ(strings[27][0], 'b');
+    }
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+
+    void* aligned = resource.allocate(100, 256);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 256, 0u);
+    resource.deallocate(aligned, 100, 256);
+    void* minimum = resource.allocate(8, 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(minimum) % 32, 0u);
+    resource.deallocate(minimum, 8, 1);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+
+    CustomMemoryResource same(allocator, 32);
+    CustomMemoryResource stricter(allocator, 64);
+    EXPECT_TRUE(resource.is_equal(same));
+    EXPECT_FALSE(resource.is_equal(stricter));
+    EXPECT_FALSE(resource.is_equal(*std::pmr::new_delete_resource()));
+    EXPECT_THROW(static_cast<void>(resource.allocate(size_t(1) << 21)), std::bad_alloc);
+    EXPECT_THROW(static_cast<void>(resource.allocate(std::numeric_limits<size_t>::max() - 8)), std::bad_alloc);
+}
+#endif
+
+// ============================================================================
+// Compile-Time Buddy Allocator Tests
+// ============================================================================
+
+TEST(BuddyAllocatorTest, OrderComputationFoldsAtCompileTime) {
+    using Allocator = BuddyAllocator<6, 16>;
+    static_assert(Allocator::sizeToOrder(1) == 6, "small requests round up to MinOrder");
+    static_assert(Allocator::sizeToOrder(Allocator::getMaxAllocationSize()) == 16, "largest request fills the pool");
+    static_assert(Allocator::getPoolSize() == 65536, "pool size is 1 << MaxOrder");
+    EXPECT_EQ(Allocator::sizeToOrder(128), 8u);
+}
+
+TEST(BuddyAllocatorTest, MatchesRuntimeAllocatorBehaviour) {
+    BuddyAllocator<6, 16> allocator;
+    EXPECT_EQ(allocator.allocate(allocator.getMaxAllocationSize() + 1), nullptr);
+
+    std::vector<void*> ptrs;
+    for (size_t size = 1; size <= 4096; size *= 2) {
+        void* ptr = allocator.allocate(size);
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_TRUE(allocator.owns(ptr));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+        std::memset(ptr, 0xAB, size);
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(allocator.getAllocationID(ptrs.front()), "Alloc0");
+    EXPECT_LT(allocator.getFragmentation(), 1.0);
+
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    EXPECT_EQ(allocator.getAllocationID(ptrs.front()), "");
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), ptrs.size());
+    EXPECT_EQ(allocator.getTotalDeallocations(), ptrs.size());
+
+    // Everything coalesced back into one block
+    void* whole = allocator.allocate(allocator.getMaxAllocationSize());
+    EXPECT_NE(whole, nullptr);
+    EXPECT_EQ(allocator.allocate(1), nullptr);
+    allocator.deallocate(whole);
+
+    int local = 0;
+    allocator.deallocate(&local);  // Ignored
+    EXPECT_EQ(allocator.getTotalDeallocations(), ptrs.size() + 1);
+}
+
+TEST(BuddyAllocatorTest, TimesOperationsLikeTheRuntimeAllocator) {
+    TimingOptions sampled;
+    sampled.sampleRate = 4;
+    BuddyAllocator<6, 16> everyOperation;
+    BuddyAllocator<6, 16> oneInFour(PoolOptions(), sampled);
+    for (int i = 0; i < 400; ++i) {
+        everyOperation.deallocate(everyOperation.allocate(100));
+        oneInFour.deallocate(oneInFour.allocate(100));
+    }
+
+#if ALLOCATOR_TIMING
+    LatencyStats stats = everyOperation.getLatencyStats();
+    EXPECT_EQ(stats.allocation.samples, 400u);
+    EXPECT_EQ(stats.deallocation.samples, 400u);
+    EXPECT_GT(everyOperation.getAllocationTime(), 0.0);
+    uint64_t sampledAllocations = oneInFour.getLatencyStats().allocation.samples;
+    EXPECT_GT(sampledAllocations, 0u);
+    EXPECT_LT(sampledAllocations, 400u);
+#else
+    EXPECT_EQ(everyOperation.getLatencyStats().allocation.samples, 0u);
+    EXPECT_DOUBLE_EQ(everyOperation.getAllocationTime(), 0.0);
+#endif
+    EXPECT_DOUBLE_EQ(oneInFour.getFragmentation(), 1.0);
+}
+
+TEST(BuddyAllocatorTest, ConcurrentAllocationDeallocation) {
+    BuddyAllocator<6, 20> allocator;
+    const int num_threads = 4;
+
+    auto worker = [&allocator](int seed) {
+        std::vector<void*> local_ptrs;
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                void* ptr = allocator.allocate(32 + ((i + seed) % 8) * 64);
+                if (ptr != nullptr) {
+                    local_ptrs.push_back(ptr);
+                }
+            }
+            for (void* ptr : local_ptrs) {
+                allocator.deallocate(ptr);
+            }
+            local_ptrs.clear();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    EXPECT_EQ(allocator.getTotalAllocations(), allocator.getTotalDeallocations());
+}
+
+// ============================================================================
+// Observer Tests
+// ============================================================================
+
+namespace {
+
+/// Observer that keeps every event it receives.
+class RecordingObserver : public AllocatorObserver {
+   public:
+    std::vector<AllocatorEvent> events;
+
+    void onEvent(const AllocatorEvent& event) override { events.push_back(event); }
+};
+
+}  // namespace
+
+TEST(CustomAllocatorTest, ObserverReportsEveryBlockHandedOutOrTakenBack) {
+    for (bool headerless : {false, true}) {
+        AllocatorOptions options;
+        options.headerless = headerless;
+        CustomAllocator allocator(6, 20, options);
+        RecordingObserver observer;
+        allocator.setObserver(&observer);
+
+        void* ptr = allocator.allocate(100);
+        ASSERT_NE(ptr, nullptr);
+        ASSERT_EQ(observer.events.size(), 1u);
+        AllocatorEvent allocation = observer.events[0];
+        EXPECT_EQ(allocation.type, AllocatorEventType::Allocation);
+        EXPECT_EQ(allocation.address, ptr);
+        EXPECT_EQ(allocation.size, 100u);
+        EXPECT_GE(static_cast<size_t>(1) << allocation.order, 100u);
+        if (headerless) {
+            EXPECT_EQ(allocation.order, 7u);
+        }
+        EXPECT_EQ(allocation.allocationIndex, allocator.getAllocationIndex(ptr));
+        EXPECT_DOUBLE_EQ(static_cast<double>(allocation.freeBytes) / allocator.getPoolSize(),
+                         allocator.getFragmentation());
+
+        allocator.deallocate(ptr);
+        ASSERT_EQ(observer.events.size(), 2u);
+        AllocatorEvent deallocation = observer.events[1];
+        EXPECT_EQ(deallocation.type, AllocatorEventType::Deallocation);
+        EXPECT_EQ(deallocation.address, ptr);
+        EXPECT_EQ(deallocation.order, allocation.order);
+        EXPECT_GE(deallocation.size, 100u);  // Usable bytes of the block
+        EXPECT_EQ(deallocation.allocationIndex, allocation.allocationIndex);
+        EXPECT_EQ(deallocation.freeBytes, allocator.getPoolSize());
+
+        // Batches report one event per block
+        observer.events.clear();
+        void* batch[8];
+        ASSERT_EQ(allocator.allocateBatch(64, 8, batch), 8u);
+        std::vector<void*> allocated(batch, batch + 8);  // deallocateBatch may reorder the array
+        allocator.deallocateBatch(batch, 8);
+        ASSERT_EQ(observer.events.size(), 16u);
+        for (size_t i = 0; i < 8; ++i) {
+            EXPECT_EQ(observer.events[i].type, AllocatorEventType::Allocation);
+            EXPECT_EQ(observer.events[i].address, allocated[i]);
+            EXPECT_EQ(observer.events[8 + i].type, AllocatorEventType::Deallocation);
+        }
+        EXPECT_EQ(observer.events.back().freeBytes, allocator.getPoolSize());
+
+        // Null pointers report nothing, and neither does a removed observer
+        observer.events.clear();
+        allocator.deallocate(nullptr);
+        allocator.setObserver(nullptr);
+        allocator.deallocate(allocator.allocate(64));
+        EXPECT_TRUE(observer.events.empty());
+    }
+}
+
+TEST(CustomAllocatorTest, ObserverSeesReallocationAsFreeThenAllocate) {
+    CustomAllocator allocator(6, 20);
+    void* ptr = allocator.allocate(100);
+    RecordingObserver observer;
+    allocator.setObserver(&observer);
+
+    ASSERT_EQ(allocator.reallocate(ptr, 1000), ptr);
+    ASSERT_EQ(observer.events.size(), 2u);
+    EXPECT_EQ(observer.events[0].type, AllocatorEventType::Deallocation);
+    EXPECT_EQ(observer.events[0].order, 8u);
+    EXPECT_EQ(observer.events[1].type, AllocatorEventType::Allocation);
+    EXPECT_EQ(observer.events[1].order, 11u);
+    EXPECT_EQ(observer.events[1].size, 1000u);
+    EXPECT_EQ(observer.events[1].address, ptr);
+    EXPECT_EQ(observer.events[0].allocationIndex, observer.events[1].allocationIndex);
+
+    allocator.setObserver(nullptr);
+    allocator.deallocate(ptr);
+}
+
+TEST(CustomAllocatorTest, AlignedAllocationWithHeadersForwardsToTheBlock) {
+    CustomAllocator allocator(6, 20);
+    RecordingObserver observer;
+    allocator.setObserver(&observer);
+
+    std::vector<void*> pointers;
+    for (size_t alignment : {32, 64, 256, 4096}) {
+        void* ptr = allocator.allocate(200, alignment);
+        ASSERT_NE(ptr, nullptr) << "alignment " << alignment;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0u);
+        std::memset(ptr, 0xAB, 200);
+        EXPECT_NE(allocator.getAllocationIndex(ptr), CustomAllocator::INVALID_ALLOCATION_ID);
+        pointers.push_back(ptr);
+    }
+    ASSERT_EQ(observer.events.size(), 4u);
+    EXPECT_EQ(observer.events[3].address, pointers[3]);
+    EXPECT_EQ(observer.events[3].order, 13u);  // 4096 bytes of offset plus 200 of payload
+
+    allocator.deallocate(pointers[0]);
+    allocator.deallocate(pointers[1], 200, 64);
+    allocator.deallocate(pointers[2]);
+    allocator.deallocate(pointers[3], 200, 4096);
+    EXPECT_EQ(observer.events.size(), 8u);
+    EXPECT_EQ(observer.events[7].type, AllocatorEventType::Deallocation);
+    EXPECT_EQ(observer.events[7].order, 13u);
+    EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    allocator.setObserver(nullptr);
+
+    // Natural alignment is the plain call; impossible alignments fail
+    void* natural = allocator.allocate(10, 8);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(natural) % CustomAllocator::NATURAL_ALIGNMENT, 0u);
+    allocator.deallocate(natural, 10, 8);
+    EXPECT_EQ(allocator.allocate(10, 48), nullptr);
+    EXPECT_EQ(allocator.allocate(10, allocator.getPoolAlignment() * 2), nullptr);
+    EXPECT_EQ(allocator.allocate(allocator.getPoolSize(), 64), nullptr);
+}
+
+TEST(CustomAllocatorTest, ObserverSeesThreadCacheHitsButNotRefills) {
+    AllocatorOptions options;
+    options.threadCache = true;
+    options.magazineSize = 8;
+    CustomAllocator allocator(6, 20, options);
+    RecordingObserver observer;
+    allocator.setObserver(&observer);
+
+    std::vector<void*> pointers;
+    for (int i = 0; i < 20; ++i) {
+        pointers.push_back(allocator.allocate(64));
+    }
+    for (void* ptr : pointers) {
+        allocator.deallocate(ptr);
+    }
+    allocator.flushThreadCache();
+    allocator.setObserver(nullptr);
+
+    ASSERT_EQ(observer.events.size(), 40u);
+    std::set<size_t> indices;
+    for (size_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(observer.events[i].address, pointers[i]);
+        indices.insert(observer.events[i].allocationIndex);
+        EXPECT_EQ(observer.events[20 + i].allocationIndex, observer.events[i].allocationIndex);
+    }
+    EXPECT_EQ(indices.size(), 20u);
+}
+
+// ============================================================================
+// Timing Metrics Tests
+// ============================================================================
+
+TEST(CustomAllocatorTest, AllocationTimingRecorded) {
+    CustomAllocator allocator(6, 20);
+
+    EXPECT_DOUBLE_EQ(allocator.getAllocationTime(), 0.0);
+
+    void* ptr = allocator.allocate(256);
+    EXPECT_NE(ptr, nullptr);
+
+    // Timing should be recorded (non-negative)
+    EXPECT_GE(allocator.getAllocationTime(), 0.0);
+
+    allocator.deallocate(ptr);
+}
+
+TEST(CustomAllocatorTest, DeallocationTimingRecorded) {
+    CustomAllocator allocator(6, 20);
+
+    void* ptr = allocator.allocate(256);
+    EXPECT_NE(ptr, nullptr);
+
+    EXPECT_DOUBLE_EQ(allocator.getDeallocationTime(), 0.0);
+
+    allocator.deallocate(ptr);
+
+    // Deallocation timing should be recorded
+    EXPECT_GE(allocator.getDeallocationTime(), 0.0);
+}
+
+TEST(LatencyHistogramTest, PercentilesFollowLogLinearBuckets) {
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 1000; ++ns) {
+        histogram.record(ns);
+    }
+    histogram.recordOwned(1000000);
+
+    LatencySnapshot snapshot;
+    histogram.addTo(snapshot);
+    EXPECT_EQ(snapshot.samples, 1001u);
+    EXPECT_EQ(snapshot.percentile(0.0), 1u);
+    EXPECT_EQ(snapshot.percentile(1.0), LatencySnapshot::bucketLowerBound(LatencySnapshot::bucketOf(1000000)));
+
+    // Bucket bounds stay within 12.5% below the recorded value
+    uint64_t median = snapshot.percentile(0.5);
+    EXPECT_LE(median, 501u);
+    EXPECT_GE(static_cast<double>(median), 501 * 0.875);
+    for (uint64_t ns : {15ull, 16ull, 17ull, 1023ull, 1024ull, 123456789ull}) {
+        uint64_t lower = LatencySnapshot::bucketLowerBound(LatencySnapshot::bucketOf(ns));
+        EXPECT_LE(lower, ns);
+        EXPECT_GE(static_cast<double>(lower), static_cast<double>(ns) * 0.875);
+    }
+
+    LatencySnapshot merged;
+    merged.merge(snapshot);
+    merged.merge(snapshot);
+    EXPECT_EQ(merged.samples, 2002u);
+    EXPECT_DOUBLE_EQ(merged.meanNanoseconds(), snapshot.meanNanoseconds());
+    EXPECT_EQ(LatencySnapshot().percentile(0.99), 0u);
+}
+
+TEST(LatencyHistogramTest, SubtractLeavesTheSamplesRecordedSince) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 100; ++i) {
+        histogram.record(10);
+    }
+    LatencySnapshot earlier;
+    histogram.addTo(earlier);
+    for (int i = 0; i < 50; ++i) {
+        histogram.record(5000);
+    }
+    LatencySnapshot later;
+    histogram.addTo(later);
+
+    LatencySnapshot window = later;
+    window.subtract(earlier);
+    EXPECT_EQ(window.samples, 50u);
+    EXPECT_EQ(window.percentile(0.0), LatencySnapshot::bucketLowerBound(LatencySnapshot::bucketOf(5000)));
+    EXPECT_DOUBLE_EQ(window.meanNanoseconds(), 5000.0);
+
+    // Subtracting a later snapshot from an earlier one saturates at zero instead of wrapping
+    earlier.subtract(later);
+    EXPECT_EQ(earlier.samples, 0u);
+    EXPECT_EQ(earlier.percentile(0.5), 0u);
+}
+
+#if ALLOCATOR_TIMING
+TEST(CustomAllocatorTest, SampledTimingRecordsAFractionOfOperations) {
+    AllocatorOptions options;
+    options.timing.sampleRate = 8;
+    CustomAllocator allocator(6, 20, options);
+
+    for (int i = 0; i < 4000; ++i) {
+        allocator.deallocate(allocator.allocate(64));
+    }
+
+    // About 500 of each; the bound is loose enough for any reasonable random draw
+    LatencySnapshot allocations = allocator.getAllocationLatency();
+    EXPECT_GT(allocations.samples, 250u);
+    EXPECT_LT(allocations.samples, 1000u);
+    EXPECT_GT(allocator.getDeallocationLatency().samples, 250u);
+    EXPECT_DOUBLE_EQ(allocator.getAllocationTime(), allocations.totalNanoseconds * 8 * 1e-9);
+}
+
+TEST(CustomAllocatorTest, TimingCanBeDisabledOrUseTheTimestampCounter) {
+    AllocatorOptions options;
+    options.timing.sampleRate = 0;
+    CustomAllocator untimed(6, 16, options);
+    untimed.deallocate(untimed.allocate(64));
+    EXPECT_EQ(untimed.getAllocationLatency().samples, 0u);
+    EXPECT_DOUBLE_EQ(untimed.getAllocationTime(), 0.0);
+    EXPECT_EQ(untimed.getTotalAllocations(), 1u);
+
+    options.timing.sampleRate = 1;
+    options.timing.useTsc = true;  // Falls back to the steady clock where there is no TSC
+    options.threadCache = true;
+    CustomAllocator tsc(6, 16, options);
+    for (int i = 0; i < 100; ++i) {
+        tsc.deallocate(tsc.allocate(64));
+    }
+    EXPECT_EQ(tsc.getAllocationLatency().samples, 100u);
+    EXPECT_EQ(tsc.getDeallocationLatency().samples, 100u);
+    EXPECT_GT(tsc.getAllocationLatency().percentile(0.99), 0u);
+}
+
+TEST(LockContentionTest, OnlyAcquisitionsThatWaitAreTimed) {
+    ContentionMutex mutex;
+    mutex.lock();
+    std::thread waiter([&mutex] {
+        std::lock_guard<ContentionMutex> lock(mutex);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    mutex.unlock();
+    waiter.join();
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    LockContention contention = mutex.contention();
+    EXPECT_EQ(contention.acquisitions, 3u);
+    // The waiter may not have reached lock() before the sleep ended, but it almost always has
+    EXPECT_LE(contention.contended, 1u);
+    if (contention.contended == 1) {
+        EXPECT_GT(contention.waitNanoseconds, 0u);
+    }
+    EXPECT_LE(contention.contendedFraction(), 1.0 / 3.0);
+}
+
+TEST(CustomAllocatorTest, LockContentionCountsMutexAcquisitions) {
+    CustomAllocator allocator(6, 16);
+    LockContention before = allocator.getLockContention();
+    for (int i = 0; i < 100; ++i) {
+        allocator.deallocate(allocator.allocate(64));
+    }
+    LockContention after = allocator.getLockContention();
+    EXPECT_EQ(after.acquisitions - before.acquisitions, 200u);
+    EXPECT_EQ(after.contended, 0u);
+
+    // Thread cache hits skip the mutex, so its acquisitions are the refills and flushes
+    AllocatorOptions options;
+    options.threadCache = true;
+    CustomAllocator cached(6, 20, options);
+    for (int i = 0; i < 100; ++i) {
+        cached.deallocate(cached.allocate(64));
+    }
+    EXPECT_LT(cached.getLockContention().acquisitions, 10u);
+}
+
+TEST(CustomAllocatorTest, LatencyStatsMergePerThreadHistograms) {
+    AllocatorOptions options;
+    options.lockFree = true;
+    CustomAllocator allocator(6, 20, options);
+    const int numThreads = 4;
+    const int operationsPerThread = 500;
+
+    // Every thread stays alive until all have finished, so none inherits another's state
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < operationsPerThread; ++i) {
+                allocator.deallocate(allocator.allocate(64 << (i % 4)));
+            }
+            void* batch[8];
+            allocator.deallocateBatch(batch, allocator.allocateBatch(64, 8, batch));
+            finished.fetch_add(1);
+            while (finished.load() < numThreads) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    LatencyStats stats = allocator.getLatencyStats();
+    EXPECT_EQ(stats.threads, static_cast<size_t>(numThreads));
+    EXPECT_EQ(stats.allocation.samples, static_cast<uint64_t>(numThreads * (operationsPerThread + 1)));
+    EXPECT_EQ(stats.deallocation.samples, static_cast<uint64_t>(numThreads * (operationsPerThread + 1)));
+    EXPECT_LE(stats.allocation.percentile(0.5), stats.allocation.percentile(0.99));
+    EXPECT_LE(stats.allocation.percentile(0.99), stats.allocation.percentile(0.999));
+
+    // Histograms outlive their threads
+    EXPECT_EQ(allocator.getAllocationLatency().samples, stats.allocation.samples);
+}
+#endif
+
+// ============================================================================
+// Data Logger Tests
+// ============================================================================
+
+namespace {
+
+/// Number of rows in a CSV file with the given operation, or all rows but the header if empty.
+size_t countRows(const std::string& path, const std::string& operation = "") {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);  // Header
+    size_t rows = 0;
+    while (std::getline(file, line)) {
+        if (operation.empty() || line.find("," + operation + ",") != std::string::npos) {
+            ++rows;
+        }
+    }
+    return rows;
+}
+
+/// Discards std::cout for its lifetime; DataLogger echoes every row to the console.
+class SilenceConsole {
+   public:
+    SilenceConsole() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~SilenceConsole() { std::cout.rdbuf(saved); }
+
+   private:
+    std::ostringstream sink;
+    std::streambuf* saved;
+};
+
+}  // namespace
+
+TEST(DataLoggerTest, AsyncModeWritesEveryEventBeforeTheSummary) {
+    std::string path = ::testing::TempDir() + "async_logger_test.csv";
+    std::remove(path.c_str());
+    const int numThreads = 4;
+    const int eventsPerThread = 2000;
+    {
+        SilenceConsole silence;
+        LoggerOptions options;
+        options.async = true;
+        options.ringCapacity = 64;  // Small enough that producers wait on the writer
+        DataLogger logger(path, options);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&logger, t]() {
+                for (int i = 0; i < eventsPerThread; ++i) {
+                    logger.log("2026-01-01 00:00:00", "Allocation", 64, 0.5, 0.25, "source" + std::to_string(t),
+                               "callStack", "0x1000", std::to_string(t), "Alloc" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        logger.logSummary("Async Summary", 1.0, 2.0, 3.0);
+        EXPECT_EQ(logger.getDroppedEvents(), 0u);
+        EXPECT_EQ(countRows(path, "Allocation"), static_cast<size_t>(numThreads * eventsPerThread));
+    }
+
+    // The summary follows every event, and interned sources come back intact
+    std::ifstream file(path);
+    std::string line, last;
+    size_t source3Rows = 0;
+    while (std::getline(file, line)) {
+        source3Rows += line.find(",source3,callStack,") != std::string::npos;
+        last = line;
+    }
+    EXPECT_NE(last.find(",Summary,"), std::string::npos);
+    EXPECT_EQ(source3Rows, static_cast<size_t>(eventsPerThread));
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, AsyncModeCountsDroppedEvents) {
+    std::string path = ::testing::TempDir() + "async_logger_drop_test.csv";
+    std::remove(path.c_str());
+    const size_t events = 20000;
+    size_t dropped = 0;
+    {
+        SilenceConsole silence;
+        LoggerOptions options;
+        options.async = true;
+        options.ringCapacity = 2;
+        options.dropWhenFull = true;
+        DataLogger logger(path, options);
+        for (size_t i = 0; i < events; ++i) {
+            logger.log("2026-01-01 00:00:00", "Deallocation", 64, 0.5, 0.25, "source", "callStack", "0x1000", "1",
+                       "Alloc" + std::to_string(i));
+        }
+        logger.flush();
+        dropped = logger.getDroppedEvents();
+    }
+    EXPECT_EQ(countRows(path) + dropped, events);
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, StructuredEventsWriteTheSameRowsAsStrings) {
+    for (bool async : {false, true}) {
+        std::string path = ::testing::TempDir() + "structured_logger_test.csv";
+        std::remove(path.c_str());
+        int value = 0;
+        uint64_t threadId = DataLogger::currentThreadId();
+        {
+            SilenceConsole silence;
+            LoggerOptions options;
+            options.async = async;
+            DataLogger logger(path, options);
+
+            LogEvent event;
+            event.timestampNs = DataLogger::currentTimeNanoseconds();
+            event.operation = LogOperation::Deallocation;
+            event.blockSize = 128;
+            event.latencyNs = 1500;
+            event.fragmentation = 0.25;
+            event.address = &value;
+            event.threadId = threadId;
+            event.allocationIndex = 42;
+            event.sourceId = logger.internString("source");
+            event.callStackId = logger.internString("callStack");
+            logger.log(event);
+
+            // An event without an allocation index leaves the column empty
+            event.allocationIndex = LogEvent::NO_ALLOCATION_INDEX;
+            logger.log(event);
+        }
+
+        std::ifstream file(path);
+        std::string header, full, empty;
+        std::getline(file, header);
+        std::getline(file, full);
+        std::getline(file, empty);
+        std::ostringstream expected;
+        expected << ",Deallocation,128,1.5,0.25,source,callStack," << static_cast<const void*>(&value) << ","
+                 << threadId << ",";
+        ASSERT_GT(full.size(), 19u) << "async=" << async;
+        EXPECT_EQ(full.substr(19), expected.str() + "Alloc42") << "async=" << async;  // After the timestamp
+        EXPECT_EQ(empty.substr(19), expected.str()) << "async=" << async;
+        std::remove(path.c_str());
+    }
+
+    std::ostringstream printed;
+    printed << std::this_thread::get_id();
+    EXPECT_EQ(printed.str(), std::to_string(DataLogger::currentThreadId()));
+}
+
+TEST(DataLoggerTest, AllocatorEventLoggerWritesARowPerEventWhileInScope) {
+    std::string path = ::testing::TempDir() + "allocator_event_logger_test.csv";
+    std::remove(path.c_str());
+    CustomAllocator allocator(6, 20);
+    void* ptr = nullptr;
+    {
+        SilenceConsole silence;
+        DataLogger logger(path);
+        {
+            AllocatorEventLogger events(allocator, logger, "source", "callStack");
+            ptr = allocator.allocate(100);
+            allocator.deallocate(ptr);
+        }
+        allocator.deallocate(allocator.allocate(100));  // Not logged
+    }
+
+    EXPECT_EQ(countRows(path), 2u);
+    std::ifstream file(path);
+    std::string header, allocation, deallocation;
+    std::getline(file, header);
+    std::getline(file, allocation);
+    std::getline(file, deallocation);
+    std::ostringstream address;
+    address << ptr;
+    EXPECT_NE(allocation.find(",Allocation,100,"), std::string::npos);
+    EXPECT_NE(allocation.find(",source,callStack," + address.str() + ","), std::string::npos);
+    EXPECT_EQ(allocation.substr(allocation.rfind(',') + 1), "Alloc0");
+    EXPECT_NE(deallocation.find(",Deallocation,"), std::string::npos);
+    EXPECT_EQ(deallocation.substr(deallocation.rfind(',') + 1), "Alloc0");
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, CsvWriterFormatsLikeStreamsAndWritesInChunks) {
+    std::ostringstream out;
+    std::ostringstream expected;
+    {
+        CsvWriter writer(out, 64);
+        int value = 0;
+        for (double number : {0.0, 0.1, 1e-7, 12.765, 0.999878, 123456789.0, -2.5, 1.0 / 3.0}) {
+            writer.appendDouble(number);
+            writer.append(',');
+            expected << number << ',';
+        }
+        writer.appendUnsigned(18446744073709551615ull);
+        writer.append(',');
+        writer.appendPointer(&value);
+        writer.append(',');
+        writer.appendPointer(nullptr);
+        expected << 18446744073709551615ull << ',' << static_cast<const void*>(&value) << ',' << 0;
+        EXPECT_EQ(std::string(writer.rowData(), writer.rowLength()), expected.str());
+        EXPECT_TRUE(out.str().empty());  // Nothing is written before the row ends
+        writer.endRow();
+        expected << '\n';
+        EXPECT_EQ(out.str(), expected.str());  // A row longer than the buffer is written at once
+
+        // Short rows wait for the buffer to fill, or for flush()
+        writer.append("short");
+        writer.endRow();
+        EXPECT_EQ(out.str(), expected.str());
+        writer.append("partial");
+        writer.flush();
+        expected << "short\n";
+        EXPECT_EQ(out.str(), expected.str());
+    }
+    EXPECT_EQ(out.str(), expected.str());  // An unfinished row is dropped
+}
+
+TEST(DataLoggerTest, ConsoleEchoIsOptIn) {
+    std::string path = ::testing::TempDir() + "echo_logger_test.csv";
+    for (bool echo : {false, true}) {
+        std::remove(path.c_str());
+        std::ostringstream console;
+        std::streambuf* saved = std::cout.rdbuf(console.rdbuf());
+        {
+            LoggerOptions options;
+            options.echoToConsole = echo;
+            DataLogger logger(path, options);
+            logger.log("2026-01-01 00:00:00", "Allocation", 64, 0.5, 0.25, "source", "callStack", "0x1000", "7",
+                       "Alloc0");
+            logger.logSummary("summary", 1.0, 2.0, 0.5);
+        }
+        std::cout.rdbuf(saved);
+
+        EXPECT_EQ(console.str().find("Logging data: 2026-01-01 00:00:00,Allocation,64,0.5,0.25,source,callStack,"
+                                     "0x1000,7,Alloc0\n") != std::string::npos,
+                  echo);
+        EXPECT_EQ(console.str().find("Logging summary: ") != std::string::npos, echo);
+        EXPECT_EQ(countRows(path), 2u);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, CompressedCsvFilesStartWithTheirMagic) {
+    const std::pair<const char*, std::string> formats[] = {{"csv.gz", "\x1f\x8b"}, {"csv.zst", "\x28\xb5\x2f\xfd"}};
+    for (const auto& format : formats) {
+        LoggerOptions options;
+        ASSERT_TRUE(DataLogger::parseFormat(format.first, options));
+        EXPECT_EQ(std::string(DataLogger::fileExtension(options)), std::string(".") + format.first);
+        if (!CsvWriter::supports(options.compression)) {
+            continue;  // Built without the library
+        }
+        std::string path = ::testing::TempDir() + "compressed_logger_test" + DataLogger::fileExtension(options);
+        std::remove(path.c_str());
+        const int events = 20000;
+        for (int session = 0; session < 2; ++session) {  // Appending adds a second member or frame
+            SilenceConsole silence;
+            options.async = session == 1;
+            DataLogger logger(path, options);
+            for (int i = 0; i < events; ++i) {
+                logger.log("2026-01-01 00:00:00", "Allocation", 64, 0.5, 0.25, "source", "callStack", "0x1000", "7",
+                           "Alloc" + std::to_string(i));
+            }
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(contents.compare(0, format.second.size(), format.second), 0) << format.first;
+        EXPECT_LT(contents.size(), static_cast<size_t>(2 * events * 10)) << format.first;  // Rows are ~70 bytes
+        std::remove(path.c_str());
+    }
+
+    LoggerOptions options;
+    EXPECT_FALSE(DataLogger::parseFormat("xml", options));
+    EXPECT_TRUE(DataLogger::parseFormat("binary", options));
+    EXPECT_EQ(std::string(DataLogger::fileExtension(options)), ".trace");
+}
+
+TEST(DataLoggerTest, BinaryTraceInternsStringsAndPatchesTheHeader) {
+    std::string path = ::testing::TempDir() + "logger_test.trace";
+    const size_t events = 5000;  // More than one buffered batch
+    {
+        SilenceConsole silence;
+        LoggerOptions options;
+        options.format = LogFormat::Binary;
+        options.async = true;
+        DataLogger logger(path, options);
+        for (size_t i = 0; i < events; ++i) {
+            logger.log("2026-01-01 00:00:01.5", i % 2 ? "Deallocation" : "Allocation", 64, 0.5, 0.25, "source",
+                       "", "0x1000", "7", "Alloc" + std::to_string(i));
+        }
+        logger.logSummary("Binary Summary", 1.0, 2.0, 3.0);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    TraceWriter::TraceHeader header;
+    ASSERT_TRUE(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    EXPECT_EQ(std::string(header.magic, sizeof(header.magic)), "DMATRACE");
+    EXPECT_EQ(header.recordSize, sizeof(TraceWriter::TraceRecord));
+    ASSERT_EQ(header.recordCount, events + 1);
+
+    std::vector<TraceWriter::TraceRecord> records(header.recordCount);
+    file.read(reinterpret_cast<char*>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(TraceWriter::TraceRecord)));
+    std::vector<std::string> strings;
+    uint32_t count = 0;
+    ASSERT_TRUE(file.read(reinterpret_cast<char*>(&count), sizeof(count)));
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = 0;
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string value(length, '\0');
+        file.read(&value[0], length);
+        strings.push_back(value);
+    }
+    ASSERT_TRUE(file.good());
+
+    // 2026-01-01 00:00:01.5 on the logging clock
+    EXPECT_EQ(records[0].timestampNs, 1767225601500000000LL);
+    EXPECT_EQ(records[0].memoryAddress, 0x1000u);
+    EXPECT_EQ(records[3].allocationId, 3);
+    EXPECT_EQ(records[0].callStack, TraceWriter::NO_STRING);
+    EXPECT_NE(records[0].operation, records[1].operation);
+    EXPECT_EQ(records[0].operation, records[2].operation);
+    ASSERT_LT(records[0].source, strings.size());
+    EXPECT_EQ(strings[records[0].source], "source");
+    EXPECT_EQ(strings[records.back().operation], "Summary");
+    EXPECT_EQ(records.back().allocationId, TraceWriter::NO_ALLOCATION_ID);
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, HeapSnapshotWriterEncodesRunsAsVarints) {
+    HeapSnapshot snapshot;
+    snapshot.minOrder = 6;
+    snapshot.maxOrder = 20;
+    snapshot.runs = {{6, false, 1}, {6, true, 300}, {19, true, 1}};
+
+    std::vector<uint8_t> encoded;
+    HeapSnapshotWriter::encode(snapshot, encoded);
+    std::vector<uint8_t> expected = {6, 1, 6 | HeapSnapshotWriter::FREE_BIT, 0xAC, 0x02,
+                                     19 | HeapSnapshotWriter::FREE_BIT, 1};
+    EXPECT_EQ(encoded, expected);
+
+    std::string path = ::testing::TempDir() + "heap_snapshot_test.heap";
+    CustomAllocator allocator(6, 14);
+    void* ptr = allocator.allocate(100);
+    {
+        HeapSnapshotWriter writer(path);
+        ASSERT_TRUE(writer.isOpen());
+        writer.write(snapshot, 42);
+        writer.capture(allocator);
+        EXPECT_EQ(writer.getSnapshotCount(), 2u);
+    }
+    allocator.deallocate(ptr);
+
+    std::ifstream file(path, std::ios::binary);
+    HeapSnapshotWriter::FileHeader fileHeader;
+    ASSERT_TRUE(file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)));
+    EXPECT_EQ(std::string(fileHeader.magic, sizeof(fileHeader.magic)), "DMAHEAPS");
+    EXPECT_EQ(fileHeader.version, HeapSnapshotWriter::VERSION);
+
+    HeapSnapshotWriter::SnapshotHeader header;
+    ASSERT_TRUE(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    EXPECT_EQ(header.timestampNs, 42);
+    EXPECT_EQ(header.runCount, 3u);
+    EXPECT_EQ(header.minOrder, 6);
+    EXPECT_EQ(header.maxOrder, 20);
+    ASSERT_EQ(header.payloadBytes, encoded.size());
+    file.seekg(header.payloadBytes, std::ios::cur);
+
+    ASSERT_TRUE(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    EXPECT_GT(header.timestampNs, 42);
+    EXPECT_EQ(header.maxOrder, 14);
+    std::vector<char> payload(header.payloadBytes);
+    ASSERT_TRUE(file.read(payload.data(), static_cast<std::streamsize>(payload.size())));
+    EXPECT_FALSE(static_cast<uint8_t>(payload[0]) & HeapSnapshotWriter::FREE_BIT);  // The allocated block
+    EXPECT_EQ(file.peek(), std::char_traits<char>::eof());
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST(DataLoggerTest, MetricsSamplerRecordsWindowsInAFixedRing) {
+    CustomAllocator allocator(6, 14);
+    MetricsSamplerOptions options;
+    options.windowCapacity = 3;
+    MetricsSampler sampler(allocator, options);
+
+    std::vector<void*> pointers;
+    for (int i = 0; i < 10; ++i) {
+        pointers.push_back(allocator.allocate(100));
+    }
+    MetricsWindow first = sampler.sample();
+    EXPECT_EQ(first.allocations, 10u);
+    EXPECT_EQ(first.deallocations, 0u);
+    EXPECT_EQ(first.totalAllocations, 10u);
+    EXPECT_EQ(first.freeBytes, allocator.getStats().freeBytes);
+    EXPECT_GE(first.endNs, first.startNs);
+#if ALLOCATOR_TIMING
+    EXPECT_EQ(first.allocationLatency.samples, 10u);
+#endif
+
+    for (void* ptr : pointers) {
+        allocator.deallocate(ptr);
+    }
+    MetricsWindow second = sampler.sample();
+    EXPECT_EQ(second.startNs, first.endNs);
+    EXPECT_EQ(second.allocations, 0u);
+    EXPECT_EQ(second.deallocations, 10u);
+    EXPECT_EQ(second.freeBytes, allocator.getPoolSize());
+    EXPECT_EQ(second.freeBlocks[14], 1u);
+#if ALLOCATOR_TIMING
+    EXPECT_EQ(second.allocationLatency.samples, 0u);
+    EXPECT_EQ(second.deallocationLatency.samples, 10u);
+#endif
+
+    // Two more windows overwrite the first; the ring is returned oldest first
+    sampler.sample();
+    MetricsWindow last = sampler.sample();
+    EXPECT_EQ(sampler.getWindowCount(), 4u);
+    std::vector<MetricsWindow> windows = sampler.windows();
+    ASSERT_EQ(windows.size(), 3u);
+    EXPECT_EQ(windows.front().startNs, second.startNs);
+    EXPECT_EQ(windows.back().endNs, last.endNs);
+    EXPECT_EQ(windows[1].startNs, windows[0].endNs);
+}
+
+TEST(DataLoggerTest, MetricsSamplerExportsCsvRowsAndPrometheusText) {
+    CustomAllocator allocator(6, 14);
+    MetricsSamplerOptions options;
+    ASSERT_TRUE(MetricsSampler::parseFormat("csv", options));
+    options.path = ::testing::TempDir() + "metrics_test" + MetricsSampler::fileExtension(options.format);
+    {
+        MetricsSampler sampler(allocator, options);
+        void* ptr = allocator.allocate(100);
+        sampler.sample();
+        allocator.deallocate(ptr);
+        sampler.sample();
+    }
+    std::ifstream csv(options.path);
+    std::string header;
+    ASSERT_TRUE(std::getline(csv, header));
+    EXPECT_EQ(header.rfind("StartNs,EndNs,Allocations,Deallocations,", 0), 0u);
+    EXPECT_NE(header.find(",FreeBlocks6,"), std::string::npos);
+    EXPECT_EQ(header.substr(header.size() - 13), ",FreeBlocks14");
+    std::vector<std::string> rows;
+    for (std::string row; std::getline(csv, row);) {
+        rows.push_back(row);
+    }
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(std::count(rows[0].begin(), rows[0].end(), ','), std::count(header.begin(), header.end(), ','));
+    csv.close();
+    std::remove(options.path.c_str());
+
+    ASSERT_TRUE(MetricsSampler::parseFormat("prometheus", options));
+    EXPECT_FALSE(MetricsSampler::parseFormat("json", options));
+    EXPECT_EQ(options.format, MetricsFormat::Prometheus);
+    options.path = ::testing::TempDir() + "metrics_test" + MetricsSampler::fileExtension(options.format);
+    {
+        MetricsSampler sampler(allocator, options);
+        void* ptr = allocator.allocate(100);
+        sampler.sample();
+        allocator.deallocate(ptr);
+    }
+    std::ifstream prom(options.path);
+    std::stringstream text;
+    text << prom.rdbuf();
+    EXPECT_NE(text.str().find("# TYPE allocator_allocations_total counter\nallocator_allocations_total 2\n"),
+              std::string::npos);
+    EXPECT_NE(text.str().find("allocator_free_blocks{order=\"14\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.str().find("allocator_window_latency_nanoseconds{operation=\"allocation\",quantile=\"0.99\"}"),
+              std::string::npos);
+    prom.close();
+    std::remove(options.path.c_str());
+}
+
+TEST(DataLoggerTest, MetricsSamplerThreadClosesAFinalWindowOnStop) {
+    CustomAllocator allocator(6, 14);
+    MetricsSamplerOptions options;
+    options.interval = std::chrono::milliseconds(5);
+    MetricsSampler sampler(allocator, options);
+    sampler.start();
+
+    size_t operations = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(30);
+    while (std::chrono::steady_clock::now() < end) {
+        allocator.deallocate(allocator.allocate(64));
+        ++operations;
+    }
+    sampler.stop();
+    sampler.stop();  // Already stopped: no further window
+
+    std::vector<MetricsWindow> windows = sampler.windows();
+    ASSERT_EQ(windows.size(), sampler.getWindowCount());
+    ASSERT_GE(windows.size(), 2u);
+    uint64_t allocations = 0;
+    for (const MetricsWindow& window : windows) {
+        allocations += window.allocations;
+    }
+    EXPECT_EQ(allocations, operations);
+    EXPECT_EQ(windows.back().totalAllocations, operations);
+}
+
+TEST(DataLoggerTest, RecordedTraceReplaysWithItsThreadsAndLifetimes) {
+    std::string path = ::testing::TempDir() + "replay_test.trace";
+    const size_t perThread = 300;
+    {
+        SilenceConsole silence;
+        LoggerOptions options;
+        options.format = LogFormat::Binary;
+        DataLogger logger(path, options);
+        CustomAllocator service(6, 18);
+        void* beforeRecording = service.allocate(64);
+        void* neverFreed = nullptr;
+        {
+            AllocatorEventLogger events(service, logger, "service", "");
+            service.deallocate(beforeRecording);  // A free without its allocation in the trace
+            neverFreed = service.allocate(512);
+            auto worker = [&service](size_t seed) {
+                std::vector<void*> live;
+                for (size_t i = 0; i < perThread; ++i) {
+                    live.push_back(service.allocate(32 + (i * seed) % 700));
+                    if (i % 3 == 2) {
+                        service.deallocate(live[live.size() / 2]);
+                        live.erase(live.begin() + static_cast<std::ptrdiff_t>(live.size() / 2));
+                    }
+                }
+                for (void* ptr : live) {
+                    service.deallocate(ptr);
+                }
+            };
+            std::thread first(worker, 7);
+            std::thread second(worker, 13);
+            first.join();
+            second.join();
+        }
+        service.deallocate(neverFreed);
+    }
+
+    TraceReader trace(path);
+    ASSERT_TRUE(trace.isOpen());
+    EXPECT_NE(trace.findString("Allocation"), TraceWriter::NO_STRING);
+    EXPECT_EQ(trace.getString(trace.findString("service")), "service");
+
+    ReplayWorkload workload = ReplayWorkload::fromTrace(trace);
+    EXPECT_EQ(workload.threads, 3u);  // The recording thread and both workers
+    EXPECT_EQ(workload.unmatchedFrees, 1u);
+    EXPECT_EQ(workload.slots, 2 * perThread + 1);
+    EXPECT_EQ(workload.operations.size(), 2 * (2 * perThread) + 1);
+    for (size_t i = 1; i < workload.operations.size(); ++i) {
+        ASSERT_LE(workload.operations[i - 1].timestampNs, workload.operations[i].timestampNs);
+    }
+
+    for (ReplayOrdering ordering : {ReplayOrdering::Strict, ReplayOrdering::Causal}) {
+        CustomAllocator allocator(6, 18);
+        ReplayOptions options;
+        options.ordering = ordering;
+        ReplayResult result = replayWorkload(allocator, workload, options);
+        EXPECT_EQ(result.allocations, 2 * perThread + 1);
+        EXPECT_EQ(result.deallocations, 2 * perThread);
+        EXPECT_EQ(result.failedAllocations, 0u);
+        EXPECT_EQ(result.leakedBlocks, 1u);
+        EXPECT_DOUBLE_EQ(allocator.getFragmentation(), 1.0);
+    }
+
+    // A pool too small for the workload fails allocations and skips their frees
+    CustomAllocator tiny(6, 10);
+    ReplayResult cramped = replayWorkload(tiny, workload, ReplayOptions());
+    EXPECT_GT(cramped.failedAllocations, 0u);
+    EXPECT_EQ(cramped.allocations + cramped.failedAllocations, 2 * perThread + 1);
+    EXPECT_EQ(cramped.deallocations + cramped.leakedBlocks, cramped.allocations);
+    EXPECT_DOUBLE_EQ(tiny.getFragmentation(), 1.0);
+    std::remove(path.c_str());
 }
 
 // ============================================================================